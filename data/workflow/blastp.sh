@@ -27,6 +27,15 @@ ALN_RES_MERGE="$TMP_PATH/aln_0"
 while [ "$STEP" -lt "$STEPS" ]; do
     SENS_PARAM=SENSE_${STEP}
     eval SENS="\$$SENS_PARAM"
+    # align the hits of each query right after its prefilter, no prefilter database is written
+    if [ "$STEPS" -eq 1 ] && [ -n "$PREFILTER_ALIGNMENT_PAR" ]; then
+        if notExists "$3.dbtype"; then
+            # shellcheck disable=SC2086
+            "$MMSEQS" prefilteralign "$INPUT" "$TARGET" "$3" $PREFILTER_ALIGNMENT_PAR -s "$SENS" \
+                || fail "Prefilteralign died"
+        fi
+        break
+    fi
     # call prefilter module
     if notExists "$TMP_PATH/pref_$STEP.dbtype"; then
         # shellcheck disable=SC2086
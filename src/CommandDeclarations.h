@@ -29,6 +29,7 @@ extern int createsubdb(int argc, const char **argv, const Command& command);
 extern int view(int argc, const char **argv, const Command& command);
 extern int rmdb(int argc, const char **argv, const Command& command);
 extern int mvdb(int argc, const char **argv, const Command& command);
+extern int binaryindex(int argc, const char **argv, const Command& command);
 extern int createtsv(int argc, const char **argv, const Command& command);
 extern int databases(int argc, const char **argv, const Command& command);
 extern int dbtype(int argc, const char **argv, const Command& command);
@@ -86,6 +87,8 @@ extern int result2stats(int argc, const char **argv, const Command& command);
 extern int reverseseq(int argc, const char **argv, const Command& command);
 extern int search(int argc, const char **argv, const Command& command);
 extern int linsearch(int argc, const char **argv, const Command& command);
+extern int server(int argc, const char **argv, const Command& command);
+extern int prefilteralign(int argc, const char **argv, const Command& command);
 extern int sortresult(int argc, const char **argv, const Command& command);
 extern int splitdb(int argc, const char **argv, const Command& command);
 extern int splitsequence(int argc, const char **argv, const Command& command);
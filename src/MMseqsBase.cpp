@@ -344,6 +344,15 @@ std::vector<Command> baseCommands = {
                                                            {"targetDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::sequenceDb },
                                                            {"prefilterDB", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::prefilterDb }}},
 
+        {"prefilteralign",       prefilteralign,       &par.prefilteralign,       COMMAND_PREFILTER,
+                "Double consecutive diagonal k-mer search followed by gapped local alignment",
+                "Aligns the hits of each query as soon as they are found, the prefilter result is only written with --prefilter-db",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:queryDB> <i:targetDB> <o:alignmentDB>",
+                CITATION_MMSEQS2, {{"queryDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::sequenceDb },
+                                                           {"targetDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::sequenceDb },
+                                                           {"alignmentDB", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::alignmentDb }}},
+
         {"ungappedprefilter",    ungappedprefilter,    &par.ungappedprefilter,    COMMAND_PREFILTER,
                 "Optimal diagonal score search",
                 NULL,
@@ -477,6 +486,12 @@ std::vector<Command> baseCommands = {
                 "<i:srcDB> <o:dstDB>",
                 CITATION_MMSEQS2, {{"DB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, NULL },
                                           {"DB", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::allDb }}},
+        {"binaryindex",          binaryindex,          &par.onlyverbosity,        COMMAND_STORAGE,
+                "Write the binary index (.index.bin) of a DB or restore its .index from it",
+                NULL,
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:DB>",
+                CITATION_MMSEQS2, {{"DB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::allDb }}},
         {"touchdb",              touchdb,              &par.onlythreads,          COMMAND_STORAGE,
                 "Preload DB into memory (page cache)",
                 NULL,
@@ -888,6 +903,20 @@ std::vector<Command> baseCommands = {
                 "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
                 "<i:sequenceDB> ",
                 CITATION_MMSEQS2, {{"sequenceDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::sequenceDb }}},
+        {"server",              server,                &par.server,               COMMAND_SPECIAL,
+                "Serve searches against a precomputed index over a unix socket",
+                "Loads the index of the target database once and keeps it in memory. Clients connect to the socket,\n"
+                "send query sequences in FASTA format and shut down their writing side. The server answers with one\n"
+                "line per alignment: query and target identifier followed by the columns of an alignment result.\n"
+                "# Create the index and start the server\n"
+                "mmseqs createindex targetDB tmp\n"
+                "mmseqs server targetDB /tmp/mmseqs.sock\n\n"
+                "# Query the server\n"
+                "socat -t 600 - UNIX-CONNECT:/tmp/mmseqs.sock < query.fasta\n",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:targetDB> <o:socketFile>",
+                CITATION_MMSEQS2, {{"targetDB", DbType::ACCESS_MODE_INPUT, DbType::NEED_DATA, &DbValidator::sequenceDb },
+                                                           {"socketFile", DbType::ACCESS_MODE_OUTPUT, DbType::NEED_DATA, &DbValidator::flatfile }}},
 
 
 
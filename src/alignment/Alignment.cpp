@@ -13,6 +13,8 @@
 #include "LinsearchIndexReader.h"
 #include "IndexReader.h"
 #include "Parameters.h"
+#include "QueryScheduler.h"
+#include "MemoryBudget.h"
 
 
 #ifdef OPENMP
@@ -27,8 +29,8 @@ Alignment::Alignment(const std::string &querySeqDB,
 
         covThr(par.covThr), canCovThr(par.covThr), covMode(par.covMode), seqIdMode(par.seqIdMode), evalThr(par.evalThr), seqIdThr(par.seqIdThr),
         alnLenThr(par.alnLenThr), includeIdentity(par.includeIdentity), addBacktrace(par.addBacktrace), realign(par.realign), scoreBias(par.scoreBias),
-        threads(static_cast<unsigned int>(par.threads)), compressed(par.compressed), outDB(outDB), outDBIndex(outDBIndex),
-        maxSeqLen(par.maxSeqLen), compBiasCorrection(par.compBiasCorrection), altAlignment(par.altAlignment), qdbr(NULL), qDbrIdx(NULL),
+        threads(static_cast<unsigned int>(par.threads)), writerMode(par.writerMode(par.compressed)), sharedWriter(par.sharedWriter), binaryResults(par.binaryResults != 0), outDB(outDB), outDBIndex(outDBIndex),
+        maxSeqLen(par.maxSeqLen), compBiasCorrection(par.compBiasCorrection), altAlignment(par.altAlignment), alignmentEngine(par.alignmentEngine), qdbr(NULL), qDbrIdx(NULL),
         tdbr(NULL), tDbrIdx(NULL) {
 
 
@@ -124,9 +126,15 @@ Alignment::Alignment(const std::string &querySeqDB,
     Debug(Debug::INFO) << "Query database size: "  << qdbr->getSize() << " type: " << Parameters::getDbTypeName(querySeqType) << "\n";
     Debug(Debug::INFO) << "Target database size: " << tdbr->getSize() << " type: " << Parameters::getDbTypeName(targetSeqType) << "\n";
 
-    prefdbr = new DBReader<unsigned int>(prefDB.c_str(), prefDBIndex.c_str(), threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
-    prefdbr->open(DBReader<unsigned int>::LINEAR_ACCCESS);
-    reversePrefilterResult = (Parameters::isEqualDbtype(prefdbr->getDbtype(), Parameters::DBTYPE_PREFILTER_REV_RES));
+    // without a prefilter database the hits are passed to alignQuery directly (see Prefiltering::runStreaming)
+    if (prefDB.empty() == false) {
+        prefdbr = new DBReader<unsigned int>(prefDB.c_str(), prefDBIndex.c_str(), threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_BINARY);
+        prefdbr->open(DBReader<unsigned int>::LINEAR_ACCCESS);
+        reversePrefilterResult = (Parameters::isEqualDbtype(prefdbr->getDbtype(), Parameters::DBTYPE_PREFILTER_REV_RES));
+    } else {
+        prefdbr = NULL;
+        reversePrefilterResult = false;
+    }
 
     if (Parameters::isEqualDbtype(querySeqType, Parameters::DBTYPE_NUCLEOTIDES)) {
         m = new NucleotideMatrix(par.scoringMatrixFile.nucleotides, 1.0, scoreBias);
@@ -159,6 +167,7 @@ Alignment::Alignment(const std::string &querySeqDB,
     } else {
         realign_m = NULL;
     }
+    evaluer = new EvalueComputation(tdbr->getAminoAcidDBSize(), m, gapOpen, gapExtend);
 }
 
 void Alignment::initSWMode(unsigned int alignmentMode) {
@@ -201,6 +210,7 @@ void Alignment::initSWMode(unsigned int alignmentMode) {
 }
 
 Alignment::~Alignment() {
+    delete evaluer;
     if (realign == true) {
         delete realign_m;
     }
@@ -222,8 +232,10 @@ Alignment::~Alignment() {
         }
     }
 
-    prefdbr->close();
-    delete prefdbr;
+    if (prefdbr != NULL) {
+        prefdbr->close();
+        delete prefdbr;
+    }
 }
 
 void Alignment::run(const unsigned int mpiRank, const unsigned int mpiNumProc,
@@ -248,7 +260,7 @@ void Alignment::run(const unsigned int mpiRank, const unsigned int mpiNumProc,
         }
 
         // merge output databases
-        DBWriter::mergeResults(outDB, outDBIndex, splitFiles);
+        DBWriter::mergeResults(outDB, outDBIndex, splitFiles, (writerMode & Parameters::WRITER_BINARY_INDEX_MODE) != 0);
     }
 }
 
@@ -261,7 +273,7 @@ void Alignment::run(const std::string &outDB, const std::string &outDBIndex,
                     const unsigned int maxAlnNum, const unsigned int maxRejected, bool merge, bool wrappedScoring) {
     size_t alignmentsNum = 0;
     size_t totalPassedNum = 0;
-    DBWriter dbw(outDB.c_str(), outDBIndex.c_str(), threads, compressed, Parameters::DBTYPE_ALIGNMENT_RES);
+    DBWriter dbw(outDB.c_str(), outDBIndex.c_str(), threads, writerMode | (sharedWriter ? Parameters::WRITER_SHARED_MODE : 0), getDbtype());
     dbw.open();
 
     // handle no alignment case early, below would divide by 0 otherwise
@@ -270,20 +282,36 @@ void Alignment::run(const std::string &outDB, const std::string &outDBIndex,
         return;
     }
 
-    EvalueComputation evaluer(tdbr->getAminoAcidDBSize(), this->m, gapOpen, gapExtend);
-    size_t totalMemory = Util::getTotalSystemMemory();
     size_t flushSize = 1000000;
-    if(totalMemory > prefdbr->getTotalDataSize()){
+    if(MemoryBudget::getLimit() > prefdbr->getTotalDataSize()){
         flushSize = dbSize;
     }
 
+    // binary input entries are read in place, either as prefilter hits or as alignment records
+    const bool binaryInput = prefdbr->isBinary();
+    const bool binaryAlignmentInput = binaryInput && Parameters::isEqualDbtype(prefdbr->getDbtype(), Parameters::DBTYPE_ALIGNMENT_RES);
+
     size_t iterations = static_cast<size_t>(ceil(static_cast<double>(dbSize) / static_cast<double>(flushSize)));
+    QueryScheduler::Statistics schedulerStats;
     for (size_t i = 0; i < iterations; i++) {
         size_t start = dbFrom + (i * flushSize);
         size_t bucketSize = std::min(dbSize - (i * flushSize), flushSize);
         Debug::Progress progress(bucketSize);
 
-#pragma omp parallel num_threads(threads)
+        // the alignment time grows with the query length and the number of prefilter hits
+        QueryScheduler scheduler(start, bucketSize, threads);
+#pragma omp parallel for schedule(static) num_threads(threads)
+        for (size_t id = start; id < (start + bucketSize); id++) {
+            size_t queryLength = 1;
+            const size_t queryId = qdbr->getId(prefdbr->getDbKey(id));
+            if (queryId != UINT_MAX) {
+                queryLength = qdbr->getSeqLen(queryId);
+            }
+            scheduler.setCost(id, queryLength * prefdbr->getEntryLen(id));
+        }
+        scheduler.init();
+
+#pragma omp parallel num_threads(threads) reduction(+: alignmentsNum, totalPassedNum)
         {
             unsigned int thread_idx = 0;
 #ifdef OPENMP
@@ -291,174 +319,26 @@ void Alignment::run(const std::string &outDB, const std::string &outDBIndex,
 #endif
             std::string alnResultsOutString;
             alnResultsOutString.reserve(1024*1024);
-            char buffer[1024+32768];
-            Sequence qSeq(maxSeqLen, querySeqType, m, 0, false, compBiasCorrection);
-            Sequence dbSeq(maxSeqLen, targetSeqType, m, 0, false, compBiasCorrection);
-            Matcher matcher(querySeqType, maxSeqLen, m, &evaluer, compBiasCorrection, gapOpen, gapExtend);
-            Matcher *realigner = NULL;
-            if (realign ==  true && wrappedScoring == false) {
-                realigner = new Matcher(querySeqType, maxSeqLen, realign_m, &evaluer, compBiasCorrection, gapOpen, gapExtend);
-            }
-
-            std::vector<Matcher::result_t> swResults;
-            swResults.reserve(300);
-            std::vector<Matcher::result_t> swRealignResults;
-            swRealignResults.reserve(300);
-            std::vector<hit_t> shortResults;
-            shortResults.reserve(300);
+            Worker worker(*this, wrappedScoring);
 
-#pragma omp for schedule(dynamic, 5) reduction(+: alignmentsNum, totalPassedNum)
-            for (size_t id = start; id < (start + bucketSize); id++) {
+            size_t id;
+            while (scheduler.next(thread_idx, id)) {
                 progress.updateProgress();
 
+                // the entries of the next query are read while this one is aligned
+                size_t nextId;
+                if (scheduler.peek(thread_idx, nextId)) {
+                    prefdbr->readahead(nextId, thread_idx);
+                    qdbr->readahead(qdbr->getId(prefdbr->getDbKey(nextId)), thread_idx);
+                }
+
                 // get the prefiltering list
                 char *data = prefdbr->getData(id, thread_idx);
                 unsigned int queryDbKey = prefdbr->getDbKey(id);
-                size_t queryLen = -1, origQueryLen = -1;
-                std::string queryToWrap;
-                // only load query data if data != \0
-                if(*data != '\0'){
-                    size_t qId = qdbr->getId(queryDbKey);
-                    char *querySeqData = qdbr->getData(qId, thread_idx);
-                    if (querySeqData == NULL) {
-                        Debug(Debug::ERROR) << "Query sequence " << queryDbKey
-                                            << " is required in the prefiltering, but is not contained in the query sequence database.\nPlease check your database.\n";
-                        EXIT(EXIT_FAILURE);
-                    }
-                    queryLen = qdbr->getSeqLen(qId);
-                    origQueryLen = queryLen;
-                    if (wrappedScoring) {
-                        queryToWrap = std::string(querySeqData,queryLen);
-                        queryToWrap = queryToWrap + queryToWrap;
-                        querySeqData = (char*)(queryToWrap).c_str();
-                        queryLen = origQueryLen*2;
-                    }
-
-                    qSeq.mapSequence(qId, queryDbKey, querySeqData, queryLen);
-                    matcher.initQuery(&qSeq);
-                }
-
-                // parse the prefiltering list and calculate a Smith-Waterman alignment for each sequence in the list
-                size_t passedNum = 0;
-                unsigned int rejected = 0;
-                while (*data != '\0' && passedNum < maxAlnNum && rejected < maxRejected) {
-                    // DB key of the db sequence
-                    char dbKeyBuffer[255 + 1];
-                    const char* words[10];
-                    Util::parseKey(data, dbKeyBuffer);
-                    const unsigned int dbKey = (unsigned int) strtoul(dbKeyBuffer, NULL, 10);
-
-                    size_t elements = Util::getWordsOfLine(data, words, 10);
-                    short diagonal = 0;
-                    bool isReverse = false;
-                    // Prefilter result (need to make this better)
-                    if(elements == 3){
-                        hit_t hit = QueryMatcher::parsePrefilterHit(data);
-                        isReverse = (reversePrefilterResult) ?  (hit.prefScore < 0) ? true : false : false;
-                        diagonal = static_cast<short>(hit.diagonal);
-                    }
-                    size_t dbId = tdbr->getId(dbKey);
-                    char *dbSeqData = tdbr->getData(dbId, thread_idx);
-
-                    if (dbSeqData == NULL) {
-                        Debug(Debug::ERROR) << "Sequence " << dbKey <<" is required in the prefiltering, but is not contained in the target sequence database!\nPlease check your database.\n";
-                        EXIT(EXIT_FAILURE);
-                    }
-                    dbSeq.mapSequence(dbId, dbKey, dbSeqData, tdbr->getSeqLen(dbId));
-                    // check if the sequences could pass the coverage threshold
-                    if(Util::canBeCovered(canCovThr, covMode, static_cast<float>(origQueryLen), static_cast<float>(dbSeq.L)) == false) {
-                        rejected++;
-                        data = Util::skipLine(data);
-                        continue;
-                    }
-                    const bool isIdentity = (queryDbKey == dbKey && (includeIdentity || sameQTDB)) ? true : false;
-
-                    // calculate Smith-Waterman alignment
-                    Matcher::result_t res = matcher.getSWResult(&dbSeq, static_cast<int>(diagonal), isReverse, covMode, covThr, evalThr, swMode, seqIdMode, isIdentity, wrappedScoring);
-                    alignmentsNum++;
-
-                    //set coverage and seqid if identity
-                    if (isIdentity) {
-                        res.qcov = 1.0f;
-                        res.dbcov = 1.0f;
-                        res.seqId = 1.0f;
-                    }
-                    if(checkCriteria(res, isIdentity, evalThr, seqIdThr, alnLenThr, covMode, covThr)){
-
-                        swResults.emplace_back(res);
-                        passedNum++;
-                        totalPassedNum++;
-                        rejected = 0;
-                    }else{
-                        rejected++;
-                    }
-
-                    data = Util::skipLine(data);
-                }
-                if(altAlignment > 0 && realign == false && wrappedScoring == false){
-                    computeAlternativeAlignment(queryDbKey, dbSeq, swResults, matcher, evalThr, swMode, thread_idx);
-                }
-
-                if(wrappedScoring && shortResults.size() > 1)
-                    std::sort(shortResults.begin(), shortResults.end(), hit_t::compareHitsByScoreAndId);
-
-                // write the results
-                if(swResults.size() > 1)
-                    std::sort(swResults.begin(), swResults.end(), Matcher::compareHits);
-                if (realign == true) {
-                    realigner->initQuery(&qSeq);
-                    for (size_t result = 0; result < swResults.size(); result++) {
-                        size_t dbId = tdbr->getId(swResults[result].dbKey);
-                        char *dbSeqData = tdbr->getData(dbId, thread_idx);
-                        if (dbSeqData == NULL) {
-                            Debug(Debug::ERROR) << "Sequence " << swResults[result].dbKey <<" is required in the prefiltering, but is not contained in the target sequence database!\nPlease check your database.\n";
-                            EXIT(EXIT_FAILURE);
-                        }
-                        dbSeq.mapSequence(static_cast<size_t>(-1), swResults[result].dbKey, dbSeqData,
-                                          tdbr->getSeqLen(dbId));
-                        const bool isIdentity = (queryDbKey == swResults[result].dbKey && (includeIdentity || sameQTDB)) ? true : false;
-                        Matcher::result_t res = realigner->getSWResult(&dbSeq, INT_MAX, false, covMode, covThr, FLT_MAX,
-                                                                       Matcher::SCORE_COV_SEQID, seqIdMode, isIdentity);
-                        const bool covOK = Util::hasCoverage(realignCov, covMode, res.qcov, res.dbcov);
-                        if(covOK == true|| isIdentity){
-                            swResults[result].backtrace  = res.backtrace;
-                            swResults[result].qStartPos  = res.qStartPos;
-                            swResults[result].qEndPos    = res.qEndPos;
-                            swResults[result].dbStartPos = res.dbStartPos;
-                            swResults[result].dbEndPos   = res.dbEndPos;
-                            swResults[result].alnLength  = res.alnLength;
-                            swResults[result].seqId      = res.seqId;
-                            swResults[result].qcov       = res.qcov;
-                            swResults[result].dbcov      = res.dbcov;
-                            swRealignResults.push_back(swResults[result]);
-                        }
-                    }
-                    swResults = swRealignResults;
-                    if(altAlignment > 0){
-                        computeAlternativeAlignment(queryDbKey, dbSeq, swResults, matcher, FLT_MAX, Matcher::SCORE_COV_SEQID, thread_idx);
-                    }
-                }
-
-                // put the contents of the swResults list into a result DB
-                for (size_t result = 0; result < swResults.size(); result++) {
-                    size_t len = Matcher::resultToBuffer(buffer, swResults[result], addBacktrace);
-                    alnResultsOutString.append(buffer, len);
-                }
-
-                for (size_t result = 0; result < shortResults.size(); result++) {
-                    size_t len = snprintf(buffer, 100, "%u\t%d\t%d\n", shortResults[result].seqId, shortResults[result].prefScore,
-                                          shortResults[result].diagonal);
-                    alnResultsOutString.append(buffer, len);
-                }
-
+                alignQuery(queryDbKey, data, binaryInput, binaryAlignmentInput, maxAlnNum, maxRejected, wrappedScoring,
+                           worker, alnResultsOutString, alignmentsNum, totalPassedNum, thread_idx);
                 dbw.writeData(alnResultsOutString.c_str(), alnResultsOutString.length(), queryDbKey, thread_idx);
                 alnResultsOutString.clear();
-                swResults.clear();
-                swRealignResults.clear();
-                shortResults.clear();
-            }
-            if (realign == true) {
-                delete realigner;
             }
 #pragma omp barrier
             if (thread_idx == 0) {
@@ -466,12 +346,16 @@ void Alignment::run(const std::string &outDB, const std::string &outDBIndex,
             }
 #pragma omp barrier
         }
-
-
+        schedulerStats.add(scheduler.getStatistics());
     }
 
     dbw.close(merge);
 
+    printStatistics(alignmentsNum, totalPassedNum, dbSize);
+    schedulerStats.print();
+}
+
+void Alignment::printStatistics(size_t alignmentsNum, size_t totalPassedNum, size_t dbSize) {
     Debug(Debug::INFO) << "\n" << alignmentsNum << " alignments calculated.\n";
     Debug(Debug::INFO) << totalPassedNum << " sequence pairs passed the thresholds ("
                        << ((float) totalPassedNum / (float) alignmentsNum) << " of overall calculated).\n";
@@ -482,11 +366,310 @@ void Alignment::run(const std::string &outDB, const std::string &outDBIndex,
     Debug(Debug::INFO) << hits_f << " hits per query sequence.\n";
 }
 
+void Alignment::alignQuery(unsigned int queryDbKey, char *data, bool binaryInput, bool binaryAlignmentInput,
+                           const unsigned int maxAlnNum, const unsigned int maxRejected, bool wrappedScoring,
+                           Worker &worker, std::string &alnResultsOutString, size_t &alignmentsNum, size_t &totalPassedNum,
+                           unsigned int thread_idx) {
+    Sequence &qSeq = worker.qSeq;
+    Sequence &dbSeq = worker.dbSeq;
+    Matcher &matcher = worker.matcher;
+    Matcher *realigner = worker.realigner;
+    std::vector<Matcher::result_t> &swResults = worker.swResults;
+    std::vector<Matcher::result_t> &swRealignResults = worker.swRealignResults;
+    std::vector<hit_t> &shortResults = worker.shortResults;
+    std::vector<int> &batchSlots = worker.batchSlots;
+    char *buffer = worker.buffer;
+
+    // binary entries are not advanced like text lines, data keeps pointing to the entry
+    const size_t binaryCount = binaryInput ? BinaryResults::getCount(data) : 0;
+    size_t binaryPos = 0;
+    size_t queryLen = -1, origQueryLen = -1;
+    std::string queryToWrap;
+    // only load query data if data != \0
+    if (binaryInput ? (binaryCount > 0) : (*data != '\0')) {
+        size_t qId = qdbr->getId(queryDbKey);
+        char *querySeqData = qdbr->getData(qId, thread_idx);
+        if (querySeqData == NULL) {
+            Debug(Debug::ERROR) << "Query sequence " << queryDbKey
+                                << " is required in the prefiltering, but is not contained in the query sequence database.\nPlease check your database.\n";
+            EXIT(EXIT_FAILURE);
+        }
+        queryLen = qdbr->getSeqLen(qId);
+        origQueryLen = queryLen;
+        if (wrappedScoring) {
+            queryToWrap = std::string(querySeqData,queryLen);
+            queryToWrap = queryToWrap + queryToWrap;
+            querySeqData = (char*)(queryToWrap).c_str();
+            queryLen = origQueryLen*2;
+        }
+
+        qSeq.mapSequence(qId, queryDbKey, querySeqData, queryLen);
+        matcher.initQuery(&qSeq);
+    }
+
+    // the inter-sequence engine aligns the next entries of the list together, one target per SIMD lane.
+    // A batch spans several targets per lane so that lanes are refilled instead of idling at its end.
+    size_t batchSize = 0;
+    if (alignmentEngine == Parameters::ALIGNMENT_ENGINE_INTER_SEQUENCE
+        || (alignmentEngine == Parameters::ALIGNMENT_ENGINE_AUTO && queryLen <= static_cast<size_t>(Parameters::ALIGNMENT_ENGINE_INTER_SEQUENCE_MAX_LEN))) {
+        batchSize = 16 * matcher.getBatchSize();
+        batchSlots.resize(batchSize);
+    }
+    size_t listPos = 0;
+    size_t batchStart = 0;
+    size_t batchEnd = 0;
+
+    // the targets of the list are random accesses into the target database. Their ids are resolved a batch
+    // (or a few alignments) ahead, so that each target is prefetched before it is aligned. The scan may stop
+    // early at maxAlnNum or maxRejected, so the rest of the list is not resolved.
+    std::vector<size_t> &targetIds = worker.targetIds;
+    targetIds.clear();
+    const char *resolveLine = data;
+    size_t prefetchPos = 0;
+
+    // parse the prefiltering list and calculate a Smith-Waterman alignment for each sequence in the list
+    size_t passedNum = 0;
+    unsigned int rejected = 0;
+    while ((binaryInput ? (binaryPos < binaryCount) : (*data != '\0')) && passedNum < maxAlnNum && rejected < maxRejected) {
+        // DB key of the db sequence
+        unsigned int dbKey;
+        short diagonal = 0;
+        bool isReverse = false;
+        if (binaryAlignmentInput) {
+            dbKey = BinaryResults::getAlignment(data, binaryPos).dbKey;
+        } else if (binaryInput) {
+            const hit_t hit = BinaryResults::getHit(data, binaryPos);
+            dbKey = hit.seqId;
+            isReverse = (reversePrefilterResult) ?  (hit.prefScore < 0) ? true : false : false;
+            diagonal = static_cast<short>(hit.diagonal);
+        } else {
+            char dbKeyBuffer[255 + 1];
+            const char* words[10];
+            Util::parseKey(data, dbKeyBuffer);
+            dbKey = (unsigned int) strtoul(dbKeyBuffer, NULL, 10);
+
+            size_t elements = Util::getWordsOfLine(data, words, 10);
+            // Prefilter result (need to make this better)
+            if(elements == 3){
+                hit_t hit = QueryMatcher::parsePrefilterHit(data);
+                isReverse = (reversePrefilterResult) ?  (hit.prefScore < 0) ? true : false : false;
+                diagonal = static_cast<short>(hit.diagonal);
+            }
+        }
+        // every target of a batch is consumed: each alignment either passes or is rejected, so at least
+        // the smaller of the remaining accept and reject budgets is aligned before the scan stops
+        size_t batchLimit = 0;
+        if (batchSize > 0 && listPos == batchEnd) {
+            const size_t budget = std::min(static_cast<size_t>(maxAlnNum) - passedNum, static_cast<size_t>(maxRejected - rejected));
+            batchLimit = std::min(batchSize, budget);
+        }
+        const size_t resolveEnd = listPos + batchLimit + PREFETCH_DISTANCE;
+        while (targetIds.size() < resolveEnd && (binaryInput ? (targetIds.size() < binaryCount) : (*resolveLine != '\0'))) {
+            unsigned int resolveKey;
+            if (binaryAlignmentInput) {
+                resolveKey = BinaryResults::getAlignment(data, targetIds.size()).dbKey;
+            } else if (binaryInput) {
+                resolveKey = BinaryResults::getHit(data, targetIds.size()).seqId;
+            } else {
+                char dbKeyBuffer[255 + 1];
+                Util::parseKey(resolveLine, dbKeyBuffer);
+                resolveKey = (unsigned int) strtoul(dbKeyBuffer, NULL, 10);
+                resolveLine = Util::skipLine(resolveLine);
+            }
+            targetIds.push_back(tdbr->getId(resolveKey));
+        }
+        for (; prefetchPos < targetIds.size(); prefetchPos++) {
+            tdbr->prefetch(targetIds[prefetchPos], thread_idx);
+        }
+        if (batchLimit > 0) {
+            batchStart = listPos;
+            batchEnd = listPos + alignBatch(matcher, dbSeq, data, binaryInput, binaryAlignmentInput, binaryPos, binaryCount,
+                                            &targetIds[listPos], queryDbKey, origQueryLen, batchLimit, batchSlots, thread_idx);
+        }
+        const s_align *forward = NULL;
+        if (batchSize > 0 && batchSlots[listPos - batchStart] != -1) {
+            forward = matcher.getBatchResult(batchSlots[listPos - batchStart]);
+        }
+        size_t dbId = targetIds[listPos];
+        listPos++;
+
+        char *dbSeqData = tdbr->getData(dbId, thread_idx);
+
+        if (dbSeqData == NULL) {
+            Debug(Debug::ERROR) << "Sequence " << dbKey <<" is required in the prefiltering, but is not contained in the target sequence database!\nPlease check your database.\n";
+            EXIT(EXIT_FAILURE);
+        }
+        dbSeq.mapSequence(dbId, dbKey, dbSeqData, tdbr->getSeqLen(dbId));
+        // check if the sequences could pass the coverage threshold
+        if(Util::canBeCovered(canCovThr, covMode, static_cast<float>(origQueryLen), static_cast<float>(dbSeq.L)) == false) {
+            rejected++;
+            if (binaryInput) {
+                binaryPos++;
+            } else {
+                data = Util::skipLine(data);
+            }
+            continue;
+        }
+        const bool isIdentity = (queryDbKey == dbKey && (includeIdentity || sameQTDB)) ? true : false;
+
+        // calculate Smith-Waterman alignment
+        Matcher::result_t res = matcher.getSWResult(&dbSeq, static_cast<int>(diagonal), isReverse, covMode, covThr, evalThr, swMode, seqIdMode, isIdentity, wrappedScoring, forward);
+        alignmentsNum++;
+
+        //set coverage and seqid if identity
+        if (isIdentity) {
+            res.qcov = 1.0f;
+            res.dbcov = 1.0f;
+            res.seqId = 1.0f;
+        }
+        if(checkCriteria(res, isIdentity, evalThr, seqIdThr, alnLenThr, covMode, covThr)){
+
+            swResults.emplace_back(res);
+            passedNum++;
+            totalPassedNum++;
+            rejected = 0;
+        }else{
+            rejected++;
+        }
+
+        if (binaryInput) {
+            binaryPos++;
+        } else {
+            data = Util::skipLine(data);
+        }
+    }
+    if(altAlignment > 0 && realign == false && wrappedScoring == false){
+        computeAlternativeAlignment(queryDbKey, dbSeq, swResults, matcher, evalThr, swMode, thread_idx);
+    }
+
+    if(wrappedScoring && shortResults.size() > 1)
+        std::sort(shortResults.begin(), shortResults.end(), hit_t::compareHitsByScoreAndId);
+
+    // write the results
+    if(swResults.size() > 1)
+        std::sort(swResults.begin(), swResults.end(), Matcher::compareHits);
+    if (realign == true) {
+        realigner->initQuery(&qSeq);
+        for (size_t result = 0; result < swResults.size(); result++) {
+            size_t dbId = tdbr->getId(swResults[result].dbKey);
+            char *dbSeqData = tdbr->getData(dbId, thread_idx);
+            if (dbSeqData == NULL) {
+                Debug(Debug::ERROR) << "Sequence " << swResults[result].dbKey <<" is required in the prefiltering, but is not contained in the target sequence database!\nPlease check your database.\n";
+                EXIT(EXIT_FAILURE);
+            }
+            dbSeq.mapSequence(static_cast<size_t>(-1), swResults[result].dbKey, dbSeqData,
+                              tdbr->getSeqLen(dbId));
+            const bool isIdentity = (queryDbKey == swResults[result].dbKey && (includeIdentity || sameQTDB)) ? true : false;
+            Matcher::result_t res = realigner->getSWResult(&dbSeq, INT_MAX, false, covMode, covThr, FLT_MAX,
+                                                           Matcher::SCORE_COV_SEQID, seqIdMode, isIdentity);
+            const bool covOK = Util::hasCoverage(realignCov, covMode, res.qcov, res.dbcov);
+            if(covOK == true|| isIdentity){
+                swResults[result].backtrace  = res.backtrace;
+                swResults[result].qStartPos  = res.qStartPos;
+                swResults[result].qEndPos    = res.qEndPos;
+                swResults[result].dbStartPos = res.dbStartPos;
+                swResults[result].dbEndPos   = res.dbEndPos;
+                swResults[result].alnLength  = res.alnLength;
+                swResults[result].seqId      = res.seqId;
+                swResults[result].qcov       = res.qcov;
+                swResults[result].dbcov      = res.dbcov;
+                swRealignResults.push_back(swResults[result]);
+            }
+        }
+        swResults = swRealignResults;
+        if(altAlignment > 0){
+            computeAlternativeAlignment(queryDbKey, dbSeq, swResults, matcher, FLT_MAX, Matcher::SCORE_COV_SEQID, thread_idx);
+        }
+    }
+
+    // put the contents of the swResults list into a result DB
+    if (binaryResults) {
+        Matcher::resultsToBinary(alnResultsOutString, swResults, addBacktrace);
+    } else {
+        for (size_t result = 0; result < swResults.size(); result++) {
+            size_t len = Matcher::resultToBuffer(buffer, swResults[result], addBacktrace);
+            alnResultsOutString.append(buffer, len);
+        }
+    }
+
+    for (size_t result = 0; result < shortResults.size(); result++) {
+        size_t len = snprintf(buffer, 100, "%u\t%d\t%d\n", shortResults[result].seqId, shortResults[result].prefScore,
+                              shortResults[result].diagonal);
+        alnResultsOutString.append(buffer, len);
+    }
+    swResults.clear();
+    swRealignResults.clear();
+    shortResults.clear();
+}
+
+Alignment::Worker::Worker(const Alignment &aln, bool wrappedScoring) :
+        qSeq(aln.maxSeqLen, aln.querySeqType, aln.m, 0, false, aln.compBiasCorrection),
+        dbSeq(aln.maxSeqLen, aln.targetSeqType, aln.m, 0, false, aln.compBiasCorrection),
+        matcher(aln.querySeqType, aln.maxSeqLen, aln.m, aln.evaluer, aln.compBiasCorrection, aln.gapOpen, aln.gapExtend),
+        realigner(NULL) {
+    if (aln.realign == true && wrappedScoring == false) {
+        realigner = new Matcher(aln.querySeqType, aln.maxSeqLen, aln.realign_m, aln.evaluer, aln.compBiasCorrection, aln.gapOpen, aln.gapExtend);
+    }
+    swResults.reserve(300);
+    swRealignResults.reserve(300);
+    shortResults.reserve(300);
+}
+
+Alignment::Worker::~Worker() {
+    if (realigner != NULL) {
+        delete realigner;
+    }
+}
+
 size_t Alignment::estimateHDDMemoryConsumption(int dbSize, int maxSeqs) {
     return 2 * (dbSize * maxSeqs * 21 * 1.75);
 }
 
 
+size_t Alignment::alignBatch(Matcher &matcher, Sequence &dbSeq, const char *data, bool binaryInput,
+                             bool binaryAlignmentInput, size_t binaryPos, size_t binaryCount, const size_t *targetIds,
+                             unsigned int queryDbKey, size_t queryLen, size_t batchSize, std::vector<int> &batchSlots,
+                             unsigned int thread_idx) {
+    matcher.clearBatch();
+    size_t entries = 0;
+    size_t targets = 0;
+    while (entries < batchSize && (binaryInput ? (binaryPos + entries < binaryCount) : (*data != '\0'))) {
+        unsigned int dbKey;
+        if (binaryAlignmentInput) {
+            dbKey = BinaryResults::getAlignment(data, binaryPos + entries).dbKey;
+        } else if (binaryInput) {
+            dbKey = BinaryResults::getHit(data, binaryPos + entries).seqId;
+        } else {
+            char dbKeyBuffer[255 + 1];
+            Util::parseKey(data, dbKeyBuffer);
+            dbKey = (unsigned int) strtoul(dbKeyBuffer, NULL, 10);
+            data = Util::skipLine(data);
+        }
+        size_t dbId = targetIds[entries];
+        batchSlots[entries] = -1;
+        entries++;
+
+        char *dbSeqData = tdbr->getData(dbId, thread_idx);
+        const bool isIdentity = (queryDbKey == dbKey && (includeIdentity || sameQTDB));
+        if (dbSeqData == NULL || isIdentity) {
+            continue;
+        }
+        dbSeq.mapSequence(dbId, dbKey, dbSeqData, tdbr->getSeqLen(dbId));
+        if (Util::canBeCovered(canCovThr, covMode, static_cast<float>(queryLen), static_cast<float>(dbSeq.L)) == false) {
+            continue;
+        }
+        batchSlots[entries - 1] = static_cast<int>(matcher.addBatchTarget(&dbSeq));
+        targets++;
+    }
+    // a few targets leave most lanes idle, the striped engine is faster for them
+    if (alignmentEngine == Parameters::ALIGNMENT_ENGINE_AUTO && targets < 2 * matcher.getBatchSize()) {
+        std::fill(batchSlots.begin(), batchSlots.begin() + entries, -1);
+        return entries;
+    }
+    matcher.alignBatch();
+    return entries;
+}
+
 bool Alignment::checkCriteria(Matcher::result_t &res, bool isIdentity, double evalThr, double seqIdThr, int alnLenThr, int covMode, float covThr) {
     const bool evalOk = (res.eval <= evalThr); // -e
     const bool seqIdOK = (res.seqId >= seqIdThr); // --min-seq-id
@@ -10,6 +10,7 @@
 #include "Sequence.h"
 #include "SequenceLookup.h"
 #include "Matcher.h"
+#include "QueryMatcher.h"
 
 class Alignment {
 
@@ -37,6 +38,37 @@ public:
 
     static bool checkCriteria(Matcher::result_t &res, bool isIdentity, double evalThr, double seqIdThr, int alnLenThr, int covMode, float covThr);
 
+    // thread local sequences, aligners and result buffers, reused for every query of a thread
+    struct Worker {
+        Worker(const Alignment &aln, bool wrappedScoring);
+        ~Worker();
+
+        Sequence qSeq;
+        Sequence dbSeq;
+        Matcher matcher;
+        Matcher *realigner;
+        std::vector<Matcher::result_t> swResults;
+        std::vector<Matcher::result_t> swRealignResults;
+        std::vector<hit_t> shortResults;
+        std::vector<int> batchSlots;
+        std::vector<size_t> targetIds;
+        char buffer[1024+32768];
+    };
+
+    // aligns one prefilter entry (text, binary hits or binary alignment records) of the query and appends
+    // the alignment entry to alnResultsOutString. Adds the computed and accepted alignments to the counters.
+    void alignQuery(unsigned int queryDbKey, char *data, bool binaryInput, bool binaryAlignmentInput,
+                    const unsigned int maxAlnNum, const unsigned int maxRejected, bool wrappedScoring,
+                    Worker &worker, std::string &alnResultsOutString, size_t &alignmentsNum, size_t &totalPassedNum,
+                    unsigned int thread_idx);
+
+    static void printStatistics(size_t alignmentsNum, size_t totalPassedNum, size_t dbSize);
+
+    // alignment result dbtype, optionally flagged as binary
+    int getDbtype() const {
+        return binaryResults ? (Parameters::DBTYPE_ALIGNMENT_RES | Parameters::DBTYPE_EXTENDED_BINARY) : Parameters::DBTYPE_ALIGNMENT_RES;
+    }
+
 
 private:
     // sequence coverage threshold
@@ -78,7 +110,12 @@ private:
     // keeps state of the SW alignment mode (ALIGNMENT_MODE_SCORE_ONLY, ALIGNMENT_MODE_SCORE_COV or ALIGNMENT_MODE_SCORE_COV_SEQID)
     unsigned int swMode;
     unsigned int threads;
-    unsigned int compressed;
+    // DBWriter mode of --compressed, --compression-dict and --binary-index
+    const size_t writerMode;
+    // all threads write into one data file (WRITER_SHARED_MODE)
+    const bool sharedWriter;
+    // write fixed-width binary alignment records
+    const bool binaryResults;
 
     const std::string outDB;
     const std::string outDBIndex;
@@ -90,6 +127,12 @@ private:
 
     int altAlignment;
 
+    // ALIGNMENT_ENGINE_AUTO, ALIGNMENT_ENGINE_STRIPED or ALIGNMENT_ENGINE_INTER_SEQUENCE
+    const int alignmentEngine;
+
+    // number of list entries ahead of the current alignment whose target sequences are prefetched
+    static const size_t PREFETCH_DISTANCE = 16;
+
     BaseMatrix *m;
     // costs to open a gap
     int gapOpen;
@@ -100,6 +143,8 @@ private:
     // needed for realignment
     BaseMatrix *realign_m;
 
+    EvalueComputation *evaluer;
+
     DBReader<unsigned int> *qdbr;
     IndexReader * qDbrIdx;
 
@@ -114,6 +159,15 @@ private:
 
     static size_t estimateHDDMemoryConsumption(int dbSize, int maxSeqs);
 
+    // scores up to batchSize entries of the prefilter list, starting at the current one, with the inter-sequence
+    // engine of the matcher. batchSlots holds the batch result of each entry or -1 if the entry is not aligned
+    // by the batch (identity or coverage cannot be reached). targetIds are the resolved ids of the entries.
+    // Returns the number of entries covered.
+    size_t alignBatch(Matcher &matcher, Sequence &dbSeq, const char *data, bool binaryInput,
+                      bool binaryAlignmentInput, size_t binaryPos, size_t binaryCount, const size_t *targetIds,
+                      unsigned int queryDbKey, size_t queryLen, size_t batchSize, std::vector<int> &batchSlots,
+                      unsigned int thread_idx);
+
     void computeAlternativeAlignment(unsigned int queryDbKey, Sequence &dbSeq,
                                      std::vector<Matcher::result_t> &vector, Matcher &matcher,
                                      float evalThr, int swMode, int thread_idx);
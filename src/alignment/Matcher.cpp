@@ -57,10 +57,30 @@ void Matcher::initQuery(Sequence* query){
     }
 }
 
+size_t Matcher::addBatchTarget(const Sequence *dbSeq) {
+    batchTargets.insert(batchTargets.end(), dbSeq->numSequence, dbSeq->numSequence + dbSeq->L);
+    batchLengths.push_back(dbSeq->L);
+    return batchLengths.size() - 1;
+}
+
+void Matcher::alignBatch() {
+    const size_t count = batchLengths.size();
+    if (count == 0) {
+        return;
+    }
+    std::vector<const unsigned char *> sequences(count);
+    size_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        sequences[i] = batchTargets.data() + offset;
+        offset += batchLengths[i];
+    }
+    batchResults.resize(count);
+    aligner->ssw_align_batch(sequences.data(), batchLengths.data(), count, gapOpen, gapExtend, batchResults.data());
+}
 
 Matcher::result_t Matcher::getSWResult(Sequence* dbSeq, const int diagonal, bool isReverse, const int covMode, const float covThr,
                                        const double evalThr, unsigned int alignmentMode, unsigned int seqIdMode, bool isIdentity,
-                                       bool wrappedScoring){
+                                       bool wrappedScoring, const s_align *forward){
     // calculation of the score and traceback of the alignment
     int32_t maskLen = currentQuery->L / 2;
     int origQueryLen = wrappedScoring? currentQuery->L / 2 : currentQuery->L ;
@@ -88,7 +108,7 @@ Matcher::result_t Matcher::getSWResult(Sequence* dbSeq, const int diagonal, bool
         alignment = nuclaligner->align(dbSeq, diagonal, isReverse, backtrace, aaIds, evaluer, wrappedScoring);
         alignmentMode = Matcher::SCORE_COV_SEQID;
     }else{ if(isIdentity==false){
-            alignment = aligner->ssw_align(dbSeq->numSequence, dbSeq->L, gapOpen, gapExtend, alignmentMode, evalThr, evaluer, covMode, covThr, maskLen);
+            alignment = aligner->ssw_align(dbSeq->numSequence, dbSeq->L, gapOpen, gapExtend, alignmentMode, evalThr, evaluer, covMode, covThr, maskLen, forward);
         }else{
             alignment = aligner->scoreIdentical(dbSeq->numSequence, dbSeq->L, evaluer, alignmentMode);
         }
@@ -200,6 +220,76 @@ void Matcher::readAlignmentResults(std::vector<result_t> &result, char *data, bo
     }
 }
 
+void Matcher::readBinaryAlignmentResults(std::vector<result_t> &result, const char *data, bool readCompressed) {
+    if(data == NULL) {
+        return;
+    }
+
+    const size_t count = BinaryResults::getCount(data);
+    const char *backtraces = BinaryResults::getBacktraces(data, count);
+    result.reserve(result.size() + count);
+    for (size_t i = 0; i < count; i++) {
+        result.emplace_back(binaryToResult(BinaryResults::getAlignment(data, i), backtraces, readCompressed));
+    }
+}
+
+Matcher::result_t Matcher::binaryToResult(const result_bin_t &record, const char *backtraces, bool readCompressed) {
+    std::string backtrace;
+    if (record.backtraceLength > 0) {
+        backtrace.assign(backtraces + record.backtraceOffset, record.backtraceLength);
+        if (readCompressed == false) {
+            backtrace = uncompressAlignment(backtrace);
+        }
+    }
+    // the same values as parseAlignmentRecord reads from the text written by resultToBuffer:
+    // seqId with 3 decimals, the e-value with 4 digits and the coverages and alignment length from the positions
+    const float seqId = static_cast<float>(static_cast<int>(record.seqId * 1000) / 1000.0);
+    char evalBuffer[32];
+    snprintf(evalBuffer, sizeof(evalBuffer), "%.3E", record.eval);
+    const double eval = strtod(evalBuffer, NULL);
+    const int adjustQstart = (record.qStartPos == -1) ? 0 : record.qStartPos;
+    const int adjustDBstart = (record.dbStartPos == -1) ? 0 : record.dbStartPos;
+    const float qCov = SmithWaterman::computeCov(adjustQstart, record.qEndPos, record.qLen);
+    const float dbCov = SmithWaterman::computeCov(adjustDBstart, record.dbEndPos, record.dbLen);
+    const unsigned int alnLength = Matcher::computeAlnLength(adjustQstart, record.qEndPos, adjustDBstart, record.dbEndPos);
+    return Matcher::result_t(record.dbKey, record.score, qCov, dbCov, seqId, eval,
+                             alnLength, record.qStartPos, record.qEndPos, record.qLen,
+                             record.dbStartPos, record.dbEndPos, record.dbLen, backtrace);
+}
+
+void Matcher::resultsToBinary(std::string &out, const std::vector<result_t> &results, bool addBacktrace) {
+    const unsigned int count = static_cast<unsigned int>(results.size());
+    out.append(reinterpret_cast<const char *>(&count), sizeof(unsigned int));
+    const size_t recordStart = out.size();
+    out.resize(recordStart + count * sizeof(result_bin_t));
+    const size_t backtraceStart = out.size();
+    for (size_t i = 0; i < results.size(); i++) {
+        const result_t &res = results[i];
+        result_bin_t record;
+        record.eval = res.eval;
+        record.dbKey = res.dbKey;
+        record.score = res.score;
+        record.qcov = res.qcov;
+        record.dbcov = res.dbcov;
+        record.seqId = res.seqId;
+        record.alnLength = res.alnLength;
+        record.qStartPos = res.qStartPos;
+        record.qEndPos = res.qEndPos;
+        record.qLen = res.qLen;
+        record.dbStartPos = res.dbStartPos;
+        record.dbEndPos = res.dbEndPos;
+        record.dbLen = res.dbLen;
+        record.backtraceOffset = static_cast<unsigned int>(out.size() - backtraceStart);
+        record.backtraceLength = 0;
+        if (addBacktrace == true) {
+            std::string compressedCigar = Matcher::compressAlignment(res.backtrace);
+            record.backtraceLength = static_cast<unsigned int>(compressedCigar.size());
+            out.append(compressedCigar);
+        }
+        memcpy(&out[recordStart + i * sizeof(result_bin_t)], &record, sizeof(result_bin_t));
+    }
+}
+
 int Matcher::computeAlnLength(int qStart, int qEnd, int dbStart, int dbEnd) {
     return std::max(abs(qEnd - qStart), abs(dbEnd - dbStart)) + 1;
 }
@@ -17,6 +17,7 @@
 #include "StripedSmithWaterman.h"
 #include "EvalueComputation.h"
 #include "BandedNucleotideAligner.h"
+#include "BinaryResults.h"
 
 class Matcher{
 
@@ -113,6 +114,9 @@ public:
         }
     };
 
+    // fixed-width record of binary alignment entries, see BinaryResults.h
+    typedef ::result_bin_t result_bin_t;
+
     Matcher(int querySeqType, int maxSeqLen, BaseMatrix *m,
             EvalueComputation * evaluer, bool aaBiasCorrection,
             int gapOpen, int gapExtend);
@@ -121,7 +125,28 @@ public:
 
     // run SSE2 parallelized Smith-Waterman alignment calculation and traceback
     result_t getSWResult(Sequence* dbSeq, const int diagonal, bool isReverse, const int covMode, const float covThr, const double evalThr,
-                         unsigned int alignmentMode, unsigned int seqIdMode, bool isIdentical, bool wrappedScoring=false);
+                         unsigned int alignmentMode, unsigned int seqIdMode, bool isIdentical, bool wrappedScoring=false,
+                         const s_align *forward=NULL);
+
+    // inter-sequence alignment: targets collected with addBatchTarget are scored together by alignBatch,
+    // getSWResult continues from their batch results (see SmithWaterman::ssw_align_batch)
+    size_t getBatchSize() {
+        return (aligner != NULL) ? aligner->getBatchSize() : 0;
+    }
+
+    void clearBatch() {
+        batchTargets.clear();
+        batchLengths.clear();
+    }
+
+    // returns the index of the result of dbSeq
+    size_t addBatchTarget(const Sequence *dbSeq);
+
+    void alignBatch();
+
+    const s_align *getBatchResult(size_t idx) const {
+        return &batchResults[idx];
+    }
 
     // need for sorting the results
     static bool compareHits (const result_t &first, const result_t &second){
@@ -198,6 +223,12 @@ public:
 
     static void readAlignmentResults(std::vector<result_t> &result, char *data, bool readCompressed = false);
 
+    static void readBinaryAlignmentResults(std::vector<result_t> &result, const char *data, bool readCompressed = false);
+
+    static result_t binaryToResult(const result_bin_t &record, const char *backtraces, bool readCompressed = false);
+
+    static void resultsToBinary(std::string &out, const std::vector<result_t> &results, bool addBacktrace);
+
     static float estimateSeqIdByScorePerCol(uint16_t score, unsigned int qLen, unsigned int tLen);
 
     static std::string compressAlignment(const std::string &bt);
@@ -233,6 +264,11 @@ private:
     // set substituion matrix
     void setSubstitutionMatrix(BaseMatrix *m);
 
+    // concatenated target residues of the current batch
+    std::vector<unsigned char> batchTargets;
+    std::vector<int32_t> batchLengths;
+    std::vector<s_align> batchResults;
+
 };
 
 #endif
@@ -4,6 +4,7 @@
 #include "Sequence.h"
 #include "SubstitutionMatrix.h"
 #include "Util.h"
+#include "simd.h"
 
 MultipleAlignment::MultipleAlignment(size_t maxSeqLen, size_t maxSetSize, SubstitutionMatrix *subMat,
                                      Matcher *aligner) {
@@ -40,7 +40,7 @@
 #include <malloc.h>
 #endif
 
-#include "simd.h"
+#include "Util.h"
 #include "BaseMatrix.h"
 
 #include "Sequence.h"
@@ -74,20 +74,6 @@ public:
     SmithWaterman(size_t maxSequenceLength, int aaSize, bool aaBiasCorrection);
     ~SmithWaterman();
 
-    // prints a __m128 vector containing 8 signed shorts
-    static void printVector (__m128i v);
-
-    // prints a __m128 vector containing 8 unsigned shorts, added 32768
-    static void printVectorUS (__m128i v);
-
-    static unsigned short sse2_extract_epi16(__m128i v, int pos);
-
-    // The dynamic programming matrix entries for the query and database sequences are stored sequentially (the order see the Farrar paper).
-    // This function calculates the index within the dynamic programming matrices for the given query and database sequence position.
-    static inline int midx (int qpos, int dbpos, int iter){
-        return dbpos * (8 * iter) + (qpos % iter) * 8 + (qpos / iter);
-    }
-
     // @function	ssw alignment.
     /*!	@function	Do Striped Smith-Waterman alignment.
 
@@ -138,7 +124,25 @@ public:
                         const double filters,
                         EvalueComputation * filterd,
                         const int covMode, const float covThr,
-                        const int32_t maskLen);
+                        const int32_t maskLen,
+                        const s_align *forward = NULL);
+
+    /*!	@function	Inter-sequence engine: computes the score and the ending positions of count targets, getBatchSize()
+     of them at once in the 8 bit SIMD lanes.
+
+     @param	results	score1, dbEndPos1 and qEndPos1 are identical to the first pass of ssw_align, score2 is not computed.
+     A score1 of 255 means that the score does not fit into 8 bits. Each result can be passed as forward to ssw_align,
+     which then continues with the beginning position and cigar (or recomputes the score on overflow).
+     */
+    void ssw_align_batch(const unsigned char **db_sequences,
+                         const int32_t *db_lengths,
+                         size_t count,
+                         const uint8_t gap_open,
+                         const uint8_t gap_extend,
+                         s_align *results);
+
+    // number of lanes of ssw_align_batch, 0 if the alphabet of the query profile is too large for the engine
+    size_t getBatchSize();
 
 
     /*!	@function computed ungapped alignment score
@@ -194,108 +198,31 @@ public:
         }
     }
 
+    // implemented once per instruction set in StripedSmithWatermanKernel.cpp, see SimdDispatch.h
+    class Kernel {
+    public:
+        virtual ~Kernel() {}
 
-private:
+        virtual s_align ssw_align(const unsigned char *db_sequence, int32_t db_length,
+                                  const uint8_t gap_open, const uint8_t gap_extend, const uint8_t alignmentMode,
+                                  const double filters, EvalueComputation *filterd,
+                                  const int covMode, const float covThr, const int32_t maskLen,
+                                  const s_align *forward) = 0;
 
-    struct s_profile{
-        simd_int* profile_byte;	// 0: none
-        simd_int* profile_word;	// 0: none
-        simd_int* profile_rev_byte;	// 0: none
-        simd_int* profile_rev_word;	// 0: none
-        int8_t* query_sequence;
-        int8_t* query_rev_sequence;
-        int8_t* composition_bias;
-        int8_t* composition_bias_rev;
-        int8_t* mat;
-        // Memory layout of if mat + queryProfile is qL * AA
-        //    Query lenght
-        // A  -1  -3  -2  -1  -4  -2  -2  -3  -1  -3  -2  -2   7  -1  -2  -1  -1  -2  -5  -3
-        // C  -1  -4   2   5  -3  -2   0  -3   1  -3  -2   0  -1   2   0   0  -1  -3  -4  -2
-        // ...
-        // Y -1  -3  -2  -1  -4  -2  -2  -3  -1  -3  -2  -2   7  -1  -2  -1  -1  -2  -5  -3
-        // Memory layout of if mat + sub is AA * AA
-        //     A   C    ...                                                                Y
-        // A  -1  -3  -2  -1  -4  -2  -2  -3  -1  -3  -2  -2   7  -1  -2  -1  -1  -2  -5  -3
-        // C  -1  -4   2   5  -3  -2   0  -3   1  -3  -2   0  -1   2   0   0  -1  -3  -4  -2
-        // ...
-        // Y -1  -3  -2  -1  -4  -2  -2  -3  -1  -3  -2  -2   7  -1  -2  -1  -1  -2  -5  -3
-        int8_t* mat_rev; // needed for queryProfile
-        int32_t query_length;
-        int32_t sequence_type;
-        int32_t alphabetSize;
-        uint8_t bias;
-        short ** profile_word_linear;
-    };
-    simd_int* vHStore;
-    simd_int* vHLoad;
-    simd_int* vE;
-    simd_int* vHmax;
-    uint8_t * maxColumn;
-
-    typedef struct {
-        uint16_t score;
-        int32_t ref;	 //0-based position
-        int32_t read;    //alignment ending position on read, 0-based
-    } alignment_end;
-
-
-    typedef struct {
-        uint32_t* seq;
-        int32_t length;
-    } cigar;
-
-    /* Striped Smith-Waterman
-     Record the highest score of each reference position.
-     Return the alignment score and ending position of the best alignment, 2nd best alignment, etc.
-     Gap begin and gap extension are different.
-     wight_match > 0, all other weights < 0.
-     The returned positions are 0-based.
-     */
-    std::pair<alignment_end, alignment_end> sw_sse2_byte (const unsigned char*db_sequence,
-                                 int8_t ref_dir,	// 0: forward ref; 1: reverse ref
-                                 int32_t db_length,
-                                 int32_t query_length,
-                                 const uint8_t gap_open, /* will be used as - */
-                                 const uint8_t gap_extend, /* will be used as - */
-                                 const simd_int* query_profile_byte,
-                                 uint8_t terminate,	/* the best alignment score: used to terminate
-                                                     the matrix calculation when locating the
-                                                     alignment beginning point. If this score
-                                                     is set to 0, it will not be used */
-                                 uint8_t bias,  /* Shift 0 point to a positive value. */
-                                 int32_t maskLen);
-
-    std::pair<alignment_end, alignment_end> sw_sse2_word (const unsigned char* db_sequence,
-                                 int8_t ref_dir,	// 0: forward ref; 1: reverse ref
-                                 int32_t db_length,
-                                 int32_t query_lenght,
-                                 const uint8_t gap_open, /* will be used as - */
-                                 const uint8_t gap_extend, /* will be used as - */
-                                 const simd_int*query_profile_byte,
-                                 uint16_t terminate,
-                                 int32_t maskLen);
-
-    template <const unsigned int type>
-    SmithWaterman::cigar *banded_sw(const unsigned char *db_sequence, const int8_t *query_sequence, const int8_t * compositionBias, int32_t db_length, int32_t query_length, int32_t queryStart, int32_t score, const uint32_t gap_open, const uint32_t gap_extend, int32_t band_width, const int8_t *mat, int32_t n);
-
-    /*!	@function		Produce CIGAR 32-bit unsigned integer from CIGAR operation and CIGAR length
-     @param	length		length of CIGAR
-     @param	op_letter	CIGAR operation character ('M', 'I', etc)
-     @return			32-bit unsigned integer, representing encoded CIGAR operation and length
-     */
-    inline uint32_t to_cigar_int (uint32_t length, char op_letter);
+        virtual size_t getBatchSize() = 0;
 
-    s_profile* profile;
+        virtual void ssw_align_batch(const unsigned char **db_sequences, const int32_t *db_lengths, size_t count,
+                                     const uint8_t gap_open, const uint8_t gap_extend, s_align *results) = 0;
 
+        virtual int ungapped_alignment(const unsigned char *db_sequence, int32_t db_length) = 0;
 
-    const static unsigned int SUBSTITUTIONMATRIX = 1;
-    const static unsigned int PROFILE = 2;
+        virtual void ssw_init(const Sequence *q, const int8_t *mat, const BaseMatrix *m, const int32_t alphabetSize,
+                              const int8_t score_size) = 0;
 
-    template <typename T, size_t Elements, const unsigned int type>
-    void createQueryProfile(simd_int *profile, const int8_t *query_sequence, const int8_t * composition_bias, const int8_t *mat, const int32_t query_length, const int32_t aaSize, uint8_t bias, const int32_t offset, const int32_t entryLength);
+        virtual s_align scoreIdentical(unsigned char *dbSeq, int L, EvalueComputation *evaluer, int alignmentMode) = 0;
+    };
 
-    float *tmp_composition_bias;
-    short * profile_word_linear_data;
-    bool aaBiasCorrection;
+private:
+    Kernel *kernel;
 };
 #endif /* SMITH_WATERMAN_SSE2_H */
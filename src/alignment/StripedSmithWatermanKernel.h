@@ -0,0 +1,180 @@
+#ifndef MMSEQS_STRIPEDSMITHWATERMANKERNEL_H
+#define MMSEQS_STRIPEDSMITHWATERMANKERNEL_H
+
+#include "SimdKernel.h"
+#include "StripedSmithWaterman.h"
+
+#include <vector>
+
+SIMD_KERNEL_BEGIN
+namespace SIMD_NS {
+
+class SmithWatermanKernel : public SmithWaterman::Kernel {
+public:
+
+    SmithWatermanKernel(size_t maxSequenceLength, int aaSize, bool aaBiasCorrection);
+    ~SmithWatermanKernel();
+
+    // prints a __m128 vector containing 8 signed shorts
+    static void printVector (__m128i v);
+
+    // prints a __m128 vector containing 8 unsigned shorts, added 32768
+    static void printVectorUS (__m128i v);
+
+    static unsigned short sse2_extract_epi16(__m128i v, int pos);
+
+    // The dynamic programming matrix entries for the query and database sequences are stored sequentially (the order see the Farrar paper).
+    // This function calculates the index within the dynamic programming matrices for the given query and database sequence position.
+    static inline int midx (int qpos, int dbpos, int iter){
+        return dbpos * (8 * iter) + (qpos % iter) * 8 + (qpos / iter);
+    }
+
+    // see SmithWaterman for the documentation of the interface
+    s_align ssw_align(const unsigned char *db_sequence, int32_t db_length,
+                      const uint8_t gap_open, const uint8_t gap_extend, const uint8_t alignmentMode,
+                      const double filters, EvalueComputation *filterd,
+                      const int covMode, const float covThr, const int32_t maskLen,
+                      const s_align *forward);
+
+    size_t getBatchSize();
+
+    void ssw_align_batch(const unsigned char **db_sequences, const int32_t *db_lengths, size_t count,
+                         const uint8_t gap_open, const uint8_t gap_extend, s_align *results);
+
+    int ungapped_alignment(const unsigned char *db_sequence, int32_t db_length);
+
+    void ssw_init(const Sequence *q, const int8_t *mat, const BaseMatrix *m, const int32_t alphabetSize,
+                  const int8_t score_size);
+
+    s_align scoreIdentical(unsigned char *dbSeq, int L, EvalueComputation *evaluer, int alignmentMode);
+
+private:
+
+    struct s_profile{
+        simd_int* profile_byte;	// 0: none
+        simd_int* profile_word;	// 0: none
+        simd_int* profile_rev_byte;	// 0: none
+        simd_int* profile_rev_word;	// 0: none
+        int8_t* query_sequence;
+        int8_t* query_rev_sequence;
+        int8_t* composition_bias;
+        int8_t* composition_bias_rev;
+        int8_t* mat;
+        // Memory layout of if mat + queryProfile is qL * AA
+        //    Query lenght
+        // A  -1  -3  -2  -1  -4  -2  -2  -3  -1  -3  -2  -2   7  -1  -2  -1  -1  -2  -5  -3
+        // C  -1  -4   2   5  -3  -2   0  -3   1  -3  -2   0  -1   2   0   0  -1  -3  -4  -2
+        // ...
+        // Y -1  -3  -2  -1  -4  -2  -2  -3  -1  -3  -2  -2   7  -1  -2  -1  -1  -2  -5  -3
+        // Memory layout of if mat + sub is AA * AA
+        //     A   C    ...                                                                Y
+        // A  -1  -3  -2  -1  -4  -2  -2  -3  -1  -3  -2  -2   7  -1  -2  -1  -1  -2  -5  -3
+        // C  -1  -4   2   5  -3  -2   0  -3   1  -3  -2   0  -1   2   0   0  -1  -3  -4  -2
+        // ...
+        // Y -1  -3  -2  -1  -4  -2  -2  -3  -1  -3  -2  -2   7  -1  -2  -1  -1  -2  -5  -3
+        int8_t* mat_rev; // needed for queryProfile
+        int32_t query_length;
+        int32_t sequence_type;
+        int32_t alphabetSize;
+        uint8_t bias;
+        short ** profile_word_linear;
+    };
+    simd_int* vHStore;
+    simd_int* vHLoad;
+    simd_int* vE;
+    simd_int* vHmax;
+    uint8_t * maxColumn;
+
+    typedef struct {
+        uint16_t score;
+        int32_t ref;	 //0-based position
+        int32_t read;    //alignment ending position on read, 0-based
+    } alignment_end;
+
+
+    typedef struct {
+        uint32_t* seq;
+        int32_t length;
+    } cigar;
+
+    /* Striped Smith-Waterman
+     Record the highest score of each reference position.
+     Return the alignment score and ending position of the best alignment, 2nd best alignment, etc.
+     Gap begin and gap extension are different.
+     wight_match > 0, all other weights < 0.
+     The returned positions are 0-based.
+     */
+    std::pair<alignment_end, alignment_end> sw_sse2_byte (const unsigned char*db_sequence,
+                                 int8_t ref_dir,	// 0: forward ref; 1: reverse ref
+                                 int32_t db_length,
+                                 int32_t query_length,
+                                 const uint8_t gap_open, /* will be used as - */
+                                 const uint8_t gap_extend, /* will be used as - */
+                                 const simd_int* query_profile_byte,
+                                 uint8_t terminate,	/* the best alignment score: used to terminate
+                                                     the matrix calculation when locating the
+                                                     alignment beginning point. If this score
+                                                     is set to 0, it will not be used */
+                                 uint8_t bias,  /* Shift 0 point to a positive value. */
+                                 int32_t maskLen);
+
+    std::pair<alignment_end, alignment_end> sw_sse2_word (const unsigned char* db_sequence,
+                                 int8_t ref_dir,	// 0: forward ref; 1: reverse ref
+                                 int32_t db_length,
+                                 int32_t query_lenght,
+                                 const uint8_t gap_open, /* will be used as - */
+                                 const uint8_t gap_extend, /* will be used as - */
+                                 const simd_int*query_profile_byte,
+                                 uint16_t terminate,
+                                 int32_t maskLen);
+
+    template <const unsigned int type>
+    SmithWatermanKernel::cigar *banded_sw(const unsigned char *db_sequence, const int8_t *query_sequence, const int8_t * compositionBias, int32_t db_length, int32_t query_length, int32_t queryStart, int32_t score, const uint32_t gap_open, const uint32_t gap_extend, int32_t band_width, const int8_t *mat, int32_t n);
+
+    /*!	@function		Produce CIGAR 32-bit unsigned integer from CIGAR operation and CIGAR length
+     @param	length		length of CIGAR
+     @param	op_letter	CIGAR operation character ('M', 'I', etc)
+     @return			32-bit unsigned integer, representing encoded CIGAR operation and length
+     */
+    inline uint32_t to_cigar_int (uint32_t length, char op_letter);
+
+    s_profile* profile;
+
+
+    const static unsigned int SUBSTITUTIONMATRIX = 1;
+    const static unsigned int PROFILE = 2;
+
+    template <typename T, size_t Elements, const unsigned int type>
+    void createQueryProfile(simd_int *profile, const int8_t *query_sequence, const int8_t * composition_bias, const int8_t *mat, const int32_t query_length, const int32_t aaSize, uint8_t bias, const int32_t offset, const int32_t entryLength);
+
+    float *tmp_composition_bias;
+    short * profile_word_linear_data;
+    bool aaBiasCorrection;
+
+    // inter-sequence engine (ssw_align_batch), buffers grow with the query length
+    // residue code of idle lanes, scores -bias
+    const static uint8_t PADDING_RESIDUE = 31;
+    void createInterSequenceProfile();
+    // two vectors per query position holding the biased scores of residue 0-15 and 16-31,
+    // repeated for every 128 bit lane of the shuffle
+    simd_int *interProfile;
+    simd_int *interH;
+    simd_int *interE;
+    simd_int *interHmax;
+    int32_t interQueryCapacity;
+    bool interProfileReady;
+    // processing order of the targets of ssw_align_batch
+    std::vector<int32_t> interOrder;
+    struct CompareLength {
+        const int32_t *lengths;
+        CompareLength(const int32_t *lengths) : lengths(lengths) {}
+        bool operator()(int32_t a, int32_t b) const {
+            return lengths[a] > lengths[b];
+        }
+    };
+};
+
+}
+SIMD_KERNEL_END
+
+#endif
@@ -11,6 +11,7 @@
 #include "QueryMatcher.h"
 #include "NucleotideMatrix.h"
 #include "IndexReader.h"
+#include "MemoryBudget.h"
 
 #ifdef OPENMP
 #include <omp.h>
@@ -105,9 +106,8 @@ int doRescorediagonal(Parameters &par,
     bool reversePrefilterResult = (Parameters::isEqualDbtype(resultReader.getDbtype(), Parameters::DBTYPE_PREFILTER_REV_RES));
     EvalueComputation evaluer(tdbr->getAminoAcidDBSize(), subMat);
 
-    size_t totalMemory = Util::getTotalSystemMemory();
     size_t flushSize = 100000000;
-    if (totalMemory > resultReader.getTotalDataSize()) {
+    if (MemoryBudget::getLimit() > resultReader.getTotalDataSize()) {
         flushSize = resultReader.getSize();
     }
     size_t iterations = static_cast<int>(ceil(static_cast<double>(dbSize) / static_cast<double>(flushSize)));
@@ -401,7 +401,7 @@ int rescorediagonal(int argc, const char **argv, const Command &command) {
     std::string outfileIndex = par.db4Index;
     std::pair<std::string, std::string> tmpOutput = Util::createTmpFileNames(outfile, outfileIndex, MMseqsMPI::rank);
 
-    DBWriter resultWriter(tmpOutput.first.c_str(), tmpOutput.second.c_str(), par.threads, par.compressed, dbtype);
+    DBWriter resultWriter(tmpOutput.first.c_str(), tmpOutput.second.c_str(), par.threads, par.writerMode(par.compressed), dbtype);
     resultWriter.open();
     int status = doRescorediagonal(par, resultWriter, resultReader, dbFrom, dbSize);
     resultWriter.close(true);
@@ -413,10 +413,10 @@ int rescorediagonal(int argc, const char **argv, const Command &command) {
             std::pair<std::string, std::string> tmpFile = Util::createTmpFileNames(outfile, outfileIndex, proc);
             splitFiles.push_back(std::make_pair(tmpFile.first,  tmpFile.second));
         }
-        DBWriter::mergeResults(par.db4, par.db4Index, splitFiles);
+        DBWriter::mergeResults(par.db4, par.db4Index, splitFiles, par.binaryIndex);
     }
 #else
-    DBWriter resultWriter(par.db4.c_str(), par.db4Index.c_str(), par.threads, par.compressed, dbtype);
+    DBWriter resultWriter(par.db4.c_str(), par.db4Index.c_str(), par.threads, par.writerMode(par.compressed), dbtype);
     resultWriter.open();
     int status = doRescorediagonal(par, resultWriter, resultReader, 0, resultReader.getSize());
     resultWriter.close();
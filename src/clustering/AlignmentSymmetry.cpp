@@ -8,8 +8,11 @@
 #include "Parameters.h"
 #include "Util.h"
 #include "Debug.h"
+#include "Matcher.h"
+#include "QueryMatcher.h"
 
 #include <cmath>
+#include <cstddef>
 
 #ifdef OPENMP
 #include <omp.h>
@@ -17,10 +20,25 @@
 
 #define LEN(x, y) (x[y+1] - x[y])
 
+AlignmentSymmetry::BinaryKeyView::BinaryKeyView(const char *data, int dbtype) : keys(NULL), count(0), stride(0) {
+    if (data == NULL) {
+        return;
+    }
+    count = BinaryResults::getCount(data);
+    if (Parameters::isEqualDbtype(dbtype, Parameters::DBTYPE_ALIGNMENT_RES)) {
+        keys = data + sizeof(unsigned int) + offsetof(Matcher::result_bin_t, dbKey);
+        stride = sizeof(Matcher::result_bin_t);
+    } else {
+        keys = data + sizeof(unsigned int) + offsetof(hit_t, seqId);
+        stride = sizeof(hit_t);
+    }
+}
+
 void AlignmentSymmetry::readInData(DBReader<unsigned int>*alnDbr, DBReader<unsigned int>*seqDbr,
                                    unsigned int **elementLookupTable, unsigned short **elementScoreTable,
                                    int scoretype, size_t *offsets) {
     const int alnType = alnDbr->getDbtype();
+    const bool isBinary = alnDbr->isBinary();
     const size_t dbSize = seqDbr->getSize();
     const size_t flushSize = 1000000;
     size_t iterations = static_cast<int>(ceil(static_cast<double>(dbSize)/static_cast<double>(flushSize)));
@@ -42,6 +60,12 @@ void AlignmentSymmetry::readInData(DBReader<unsigned int>*alnDbr, DBReader<unsig
                 const unsigned int clusterId = seqDbr->getDbKey(i);
                 char *data = alnDbr->getDataByDBKey(clusterId, thread_idx);
 
+                if (isBinary) {
+                    readInBinaryData(data, alnType, seqDbr, elementLookupTable[i],
+                                     (elementScoreTable != NULL) ? elementScoreTable[i] : NULL,
+                                     scoretype, LEN(offsets, i), i);
+                    continue;
+                }
                 if (*data == '\0') { // check if file contains entry
                     Debug(Debug::ERROR) << "Sequence " << i
                                         << " does not contain any sequence for key " << clusterId
@@ -63,7 +87,7 @@ void AlignmentSymmetry::readInData(DBReader<unsigned int>*alnDbr, DBReader<unsig
                     const unsigned int key = (unsigned int) strtoul(dbKey, NULL, 10);
                     const size_t currElement = seqDbr->getId(key);
                     if (elementScoreTable != NULL) {
-                        if (alnType == Parameters::DBTYPE_ALIGNMENT_RES) {
+                        if (Parameters::isEqualDbtype(alnType, Parameters::DBTYPE_ALIGNMENT_RES)) {
                             if (scoretype == Parameters::APC_ALIGNMENTSCORE) {
                                 //column 1 = alignment score
                                 Util::parseByColumnNumber(data, similarity, 1);
@@ -74,7 +98,7 @@ void AlignmentSymmetry::readInData(DBReader<unsigned int>*alnDbr, DBReader<unsig
                                 elementScoreTable[i][writePos] = (unsigned short) (atof(similarity) * 1000.0f);
                             }
                         }
-                        else if (alnType == Parameters::DBTYPE_PREFILTER_RES) {
+                        else if (Parameters::isEqualDbtype(alnType, Parameters::DBTYPE_PREFILTER_RES)) {
                             //column 1 = alignment score or sequence identity [0-100]
                             Util::parseByColumnNumber(data, similarity, 1);
                             short sim = atoi(similarity);
@@ -101,6 +125,51 @@ void AlignmentSymmetry::readInData(DBReader<unsigned int>*alnDbr, DBReader<unsig
     }
 }
 
+void AlignmentSymmetry::readInBinaryData(const char *data, int alnType, DBReader<unsigned int> *seqDbr,
+                                         unsigned int *elements, unsigned short *scores, int scoretype,
+                                         size_t setSize, size_t setId) {
+    const bool isAlignment = Parameters::isEqualDbtype(alnType, Parameters::DBTYPE_ALIGNMENT_RES);
+    if (isAlignment == false && Parameters::isEqualDbtype(alnType, Parameters::DBTYPE_PREFILTER_RES) == false) {
+        Debug(Debug::ERROR) << "Alignment format is not supported!\n";
+        EXIT(EXIT_FAILURE);
+    }
+    size_t count = BinaryResults::getCount(data);
+    if (count == 0) {
+        Debug(Debug::ERROR) << "Sequence " << setId << " does not contain any sequence!\n";
+        return;
+    }
+    if (count > setSize) {
+        Debug(Debug::ERROR) << "Set " << setId << " has more elements than allocated (" << setSize << ")!\n";
+        count = setSize;
+    }
+    for (size_t j = 0; j < count; j++) {
+        unsigned int key;
+        if (isAlignment) {
+            const Matcher::result_bin_t record = BinaryResults::getAlignment(data, j);
+            key = record.dbKey;
+            if (scores != NULL) {
+                scores[j] = (scoretype == Parameters::APC_ALIGNMENTSCORE)
+                            ? static_cast<unsigned short>(record.score)
+                            : static_cast<unsigned short>(record.seqId * 1000.0f);
+            }
+        } else {
+            const hit_t hit = BinaryResults::getHit(data, j);
+            key = hit.seqId;
+            if (scores != NULL) {
+                const int sim = static_cast<short>(hit.prefScore);
+                scores[j] = static_cast<unsigned short>(sim > 0 ? sim : -sim);
+            }
+        }
+        const size_t currElement = seqDbr->getId(key);
+        if (currElement == UINT_MAX || currElement > seqDbr->getSize()) {
+            Debug(Debug::ERROR) << "Element " << key
+                                << " contained in some alignment list, but not contained in the sequence database!\n";
+            EXIT(EXIT_FAILURE);
+        }
+        elements[j] = currElement;
+    }
+}
+
 size_t AlignmentSymmetry::findMissingLinks(unsigned int ** elementLookupTable, size_t * offsetTable, size_t dbSize, int threads) {
     // init memory for parallel merge
     unsigned int * tmpSize = new(std::nothrow) unsigned int[threads * dbSize];
@@ -6,6 +6,7 @@
 #define MMSEQS_ALIGNMENTSYMMETRY_H
 #include <set>
 #include <list>
+#include <cstring>
 #include <Debug.h>
 #include <Util.h>
 
@@ -13,7 +14,31 @@
 
 class AlignmentSymmetry {
 public:
+    // zero-copy view on the target keys of a binary prefilter or alignment result entry
+    class BinaryKeyView {
+    public:
+        BinaryKeyView(const char *data, int dbtype);
+
+        size_t size() const {
+            return count;
+        }
+
+        unsigned int operator[](size_t i) const {
+            unsigned int key;
+            memcpy(&key, keys + i * stride, sizeof(unsigned int));
+            return key;
+        }
+
+    private:
+        // points to the key of the first record
+        const char *keys;
+        size_t count;
+        size_t stride;
+    };
+
     static void readInData(DBReader<unsigned int>*pReader, DBReader<unsigned int>*pDBReader, unsigned int **pInt,unsigned short**elementScoreTable, int scoretype, size_t *offsets);
+    static void readInBinaryData(const char *data, int alnType, DBReader<unsigned int> *seqDbr, unsigned int *elements,
+                                 unsigned short *scores, int scoretype, size_t setSize, size_t setId);
     template<typename T>
     static void computeOffsetFromCounts(T* elementSizes, size_t dbSize)  {
         size_t prevElementLength = elementSizes[0];
@@ -8,17 +8,17 @@
 Clustering::Clustering(const std::string &seqDB, const std::string &seqDBIndex,
                        const std::string &alnDB, const std::string &alnDBIndex,
                        const std::string &outDB, const std::string &outDBIndex,
-                       unsigned int maxIteration, int similarityScoreType, int threads, int compressed) : maxIteration(maxIteration),
+                       unsigned int maxIteration, int similarityScoreType, int threads, size_t writerMode) : maxIteration(maxIteration),
                                                                similarityScoreType(similarityScoreType),
                                                                threads(threads),
-                                                               compressed(compressed),
+                                                               writerMode(writerMode),
                                                                outDB(outDB),
                                                                outDBIndex(outDBIndex) {
 
     seqDbr = new DBReader<unsigned int>(seqDB.c_str(), seqDBIndex.c_str(), threads, DBReader<unsigned int>::USE_INDEX);
     seqDbr->open(DBReader<unsigned int>::SORT_BY_LENGTH);
 
-    alnDbr = new DBReader<unsigned int>(alnDB.c_str(), alnDBIndex.c_str(), threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
+    alnDbr = new DBReader<unsigned int>(alnDB.c_str(), alnDBIndex.c_str(), threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_BINARY);
     alnDbr->open(DBReader<unsigned int>::NOSORT);
 
 }
@@ -31,7 +31,7 @@ Clustering::~Clustering() {
 
 void Clustering::run(int mode) {
     Timer timer;
-    DBWriter *dbw = new DBWriter(outDB.c_str(), outDBIndex.c_str(), 1, compressed, Parameters::DBTYPE_CLUSTER_RES);
+    DBWriter *dbw = new DBWriter(outDB.c_str(), outDBIndex.c_str(), 1, writerMode, Parameters::DBTYPE_CLUSTER_RES);
     dbw->open();
 
     std::unordered_map<unsigned int, std::vector<unsigned int>> ret;
@@ -11,7 +11,7 @@ public:
     Clustering(const std::string &seqDB, const std::string &seqDBIndex,
                const std::string &alnResultsDB, const std::string &alnResultsDBIndex,
                const std::string &outDB, const std::string &outDBIndex,
-               unsigned int maxIteration, int similarityScoreType, int threads, int compressed);
+               unsigned int maxIteration, int similarityScoreType, int threads, size_t writerMode);
 
     void run(int mode);
 
@@ -30,7 +30,7 @@ private:
     int similarityScoreType;
 
     int threads;
-    int compressed;
+    size_t writerMode;
     std::string outDB;
     std::string outDBIndex;
 };
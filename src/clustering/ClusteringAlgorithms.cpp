@@ -55,8 +55,12 @@ std::unordered_map<unsigned int, std::vector<unsigned int>>  ClusteringAlgorithm
 #pragma omp for schedule(dynamic, 10)
             for (size_t i = 0; i < alnDbr->getSize(); i++) {
                 const char *data = alnDbr->getData(i, thread_idx);
-                const size_t dataSize = alnDbr->getEntryLen(i);
-                elementCount += Util::countLines(data, dataSize);
+                if (alnDbr->isBinary()) {
+                    elementCount += AlignmentSymmetry::BinaryKeyView(data, alnDbr->getDbtype()).size();
+                } else {
+                    const size_t dataSize = alnDbr->getEntryLen(i);
+                    elementCount += Util::countLines(data, dataSize);
+                }
             }
         }
         unsigned int * elements = new(std::nothrow) unsigned int[elementCount];
@@ -303,11 +307,20 @@ void ClusteringAlgorithms::greedyIncrementalLowMem( unsigned int *assignedcluste
 
             const size_t alnId = alnDbr->getId(clusterKey);
             char *data = alnDbr->getData(alnId, thread_idx);
-
-            while (*data != '\0') {
-                char dbKey[255 + 1];
-                Util::parseKey(data, dbKey);
-                const unsigned int key = (unsigned int) strtoul(dbKey, NULL, 10);
+            const bool isBinary = alnDbr->isBinary();
+            AlignmentSymmetry::BinaryKeyView binaryKeys(isBinary ? data : NULL, alnDbr->getDbtype());
+            size_t binaryPos = 0;
+
+            while (isBinary ? (binaryPos < binaryKeys.size()) : (*data != '\0')) {
+                unsigned int key;
+                if (isBinary) {
+                    key = binaryKeys[binaryPos++];
+                } else {
+                    char dbKey[255 + 1];
+                    Util::parseKey(data, dbKey);
+                    key = (unsigned int) strtoul(dbKey, NULL, 10);
+                    data = Util::skipLine(data);
+                }
                 unsigned int currElement = seqDbr->getId(key);
                 unsigned int targetId;
 
@@ -317,11 +330,10 @@ void ClusteringAlgorithms::greedyIncrementalLowMem( unsigned int *assignedcluste
                 } while (!__atomic_compare_exchange(&assignedcluster[currElement],  &targetId,  &clusterId , false,  __ATOMIC_RELAXED, __ATOMIC_RELAXED));
 
                 if (currElement == UINT_MAX || currElement > seqDbr->getSize()) {
-                    Debug(Debug::ERROR) << "Element " << dbKey
+                    Debug(Debug::ERROR) << "Element " << key
                                         << " contained in some alignment list, but not contained in the sequence database!\n";
                     EXIT(EXIT_FAILURE);
                 }
-                data = Util::skipLine(data);
             }
         }
     }
@@ -339,11 +351,20 @@ void ClusteringAlgorithms::greedyIncrementalLowMem( unsigned int *assignedcluste
 
             const size_t alnId = alnDbr->getId(clusterKey);
             char *data = alnDbr->getData(alnId, thread_idx);
-
-            while (*data != '\0') {
-                char dbKey[255 + 1];
-                Util::parseKey(data, dbKey);
-                const unsigned int key = (unsigned int) strtoul(dbKey, NULL, 10);
+            const bool isBinary = alnDbr->isBinary();
+            AlignmentSymmetry::BinaryKeyView binaryKeys(isBinary ? data : NULL, alnDbr->getDbtype());
+            size_t binaryPos = 0;
+
+            while (isBinary ? (binaryPos < binaryKeys.size()) : (*data != '\0')) {
+                unsigned int key;
+                if (isBinary) {
+                    key = binaryKeys[binaryPos++];
+                } else {
+                    char dbKey[255 + 1];
+                    Util::parseKey(data, dbKey);
+                    key = (unsigned int) strtoul(dbKey, NULL, 10);
+                    data = Util::skipLine(data);
+                }
                 unsigned int currElement = seqDbr->getId(key);
                 unsigned int targetId;
 
@@ -354,11 +375,10 @@ void ClusteringAlgorithms::greedyIncrementalLowMem( unsigned int *assignedcluste
                                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED));
 
                 if (currElement == UINT_MAX || currElement > seqDbr->getSize()) {
-                    Debug(Debug::ERROR) << "Element " << dbKey
+                    Debug(Debug::ERROR) << "Element " << key
                                         << " contained in some alignment list, but not contained in the sequence database!\n";
                     EXIT(EXIT_FAILURE);
                 }
-                data = Util::skipLine(data);
             }
         }
     }
@@ -410,8 +430,12 @@ void ClusteringAlgorithms::readInClusterData(unsigned int **elementLookupTable,
             const unsigned int clusterId = seqDbr->getDbKey(i);
             const size_t alnId = alnDbr->getId(clusterId);
             const char *data = alnDbr->getData(alnId, thread_idx);
-            const size_t dataSize = alnDbr->getEntryLen(alnId);
-            elementOffsets[i] = Util::countLines(data, dataSize);
+            if (alnDbr->isBinary()) {
+                elementOffsets[i] = AlignmentSymmetry::BinaryKeyView(data, alnDbr->getDbtype()).size();
+            } else {
+                const size_t dataSize = alnDbr->getEntryLen(alnId);
+                elementOffsets[i] = Util::countLines(data, dataSize);
+            }
         }
     }
 
@@ -30,7 +30,7 @@ void checkCpu() {
         Debug(Debug::ERROR) << "64-bit system is required to run MMseqs2.\n";
         EXIT(EXIT_FAILURE);
     }
-#ifdef SEE
+#ifdef SSE
     if(info.HW_SSE41 == false) {
         Debug(Debug::ERROR) << "SSE4.1 is required to run MMseqs2.\n";
         EXIT(EXIT_FAILURE);
@@ -0,0 +1,342 @@
+#include "AsyncIO.h"
+#include "Debug.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <unistd.h>
+
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+bool AsyncIO::enabled = false;
+
+#ifdef HAVE_IO_URING
+static int ioUringSetup(unsigned int entries, struct io_uring_params *params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int ioUringEnter(int fd, unsigned int toSubmit, unsigned int minComplete, unsigned int flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, NULL, 0));
+}
+
+static int ioUringRegister(int fd, unsigned int opcode, void *arg, unsigned int args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, args));
+}
+#endif
+
+static void writeFully(int fd, const char *buffer, size_t size, size_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t result = pwrite(fd, buffer + done, size - done, offset + done);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            Debug(Debug::ERROR) << "Could not write to file descriptor " << fd << ". Error " << errno << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        done += result;
+    }
+}
+
+void AsyncIO::setEnabled(bool requested) {
+    enabled = false;
+    if (requested == false) {
+        return;
+    }
+#ifdef HAVE_IO_URING
+    AsyncIO probe(2);
+    if (probe.ringFd == -1) {
+        Debug(Debug::WARNING) << "io_uring is not available, using regular I/O\n";
+        return;
+    }
+    // writes and madvise need Linux 5.6, older kernels do not know the probe either
+    const unsigned int probeOps = 256;
+    struct io_uring_probe *ops = static_cast<struct io_uring_probe *>(
+            calloc(1, sizeof(struct io_uring_probe) + probeOps * sizeof(struct io_uring_probe_op)));
+    Util::checkAllocation(ops, "Cannot allocate io_uring probe");
+    const bool supported = ioUringRegister(probe.ringFd, IORING_REGISTER_PROBE, ops, probeOps) == 0
+                           && ops->last_op >= IORING_OP_MADVISE
+                           && (ops->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED) != 0
+                           && (ops->ops[IORING_OP_MADVISE].flags & IO_URING_OP_SUPPORTED) != 0;
+    free(ops);
+    if (supported == false) {
+        Debug(Debug::WARNING) << "io_uring does not support writes and madvise, using regular I/O\n";
+        return;
+    }
+    enabled = true;
+#else
+    Debug(Debug::WARNING) << "MMseqs2 was compiled without io_uring support, using regular I/O\n";
+#endif
+}
+
+AsyncIO::AsyncIO(unsigned int depth)
+        : depth(std::max(depth, 1u)), ringFd(-1), sqRing(NULL), sqRingSize(0), cqRing(NULL), cqRingSize(0),
+          sqes(NULL), sqesSize(0), sqHead(NULL), sqTail(NULL), sqMask(NULL), sqArray(NULL),
+          cqHead(NULL), cqTail(NULL), cqMask(NULL), cqes(NULL), operations(this->depth), inFlight(0), allocatedBuffers(0) {
+    for (unsigned int i = this->depth; i > 0; i--) {
+        operations[i - 1].busy = false;
+        freeSlots.push_back(i - 1);
+    }
+#ifdef HAVE_IO_URING
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ringFd = ioUringSetup(this->depth, &params);
+    if (ringFd < 0) {
+        ringFd = -1;
+        return;
+    }
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMmap) {
+        sqRingSize = std::max(sqRingSize, cqRingSize);
+        cqRingSize = sqRingSize;
+    }
+    sqRing = mmap(NULL, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        sqRing = NULL;
+        closeRing();
+        return;
+    }
+    if (singleMmap) {
+        cqRing = sqRing;
+    } else {
+        cqRing = mmap(NULL, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            cqRing = NULL;
+            closeRing();
+            return;
+        }
+    }
+    sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes = mmap(NULL, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        sqes = NULL;
+        closeRing();
+        return;
+    }
+    char *sq = static_cast<char *>(sqRing);
+    sqHead = reinterpret_cast<unsigned int *>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned int *>(sq + params.sq_off.tail);
+    sqMask = reinterpret_cast<unsigned int *>(sq + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<unsigned int *>(sq + params.sq_off.array);
+    char *cq = static_cast<char *>(cqRing);
+    cqHead = reinterpret_cast<unsigned int *>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned int *>(cq + params.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned int *>(cq + params.cq_off.ring_mask);
+    cqes = cq + params.cq_off.cqes;
+#endif
+}
+
+AsyncIO::~AsyncIO() {
+    wait();
+    for (size_t i = 0; i < freeBuffers.size(); i++) {
+        free(freeBuffers[i].first);
+    }
+    closeRing();
+}
+
+void AsyncIO::closeRing() {
+#ifdef HAVE_IO_URING
+    if (sqes != NULL) {
+        munmap(sqes, sqesSize);
+        sqes = NULL;
+    }
+    if (cqRing != NULL && cqRing != sqRing) {
+        munmap(cqRing, cqRingSize);
+    }
+    cqRing = NULL;
+    if (sqRing != NULL) {
+        munmap(sqRing, sqRingSize);
+        sqRing = NULL;
+    }
+    if (ringFd != -1) {
+        ::close(ringFd);
+        ringFd = -1;
+    }
+#endif
+}
+
+bool AsyncIO::submit(unsigned int slot) {
+#ifdef HAVE_IO_URING
+    const Operation &op = operations[slot];
+    const unsigned int tail = *sqTail;
+    const unsigned int index = tail & *sqMask;
+    struct io_uring_sqe *sqe = static_cast<struct io_uring_sqe *>(sqes) + index;
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    if (op.isWrite) {
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = op.fd;
+        sqe->addr = reinterpret_cast<uintptr_t>(op.buffer + op.done);
+        // a single write transfers less than 2 GB, larger ones are submitted in chunks of 1 GB
+        sqe->len = static_cast<unsigned int>(std::min(op.size - op.done, static_cast<size_t>(1) << 30));
+        sqe->off = op.offset + op.done;
+    } else {
+        sqe->opcode = IORING_OP_MADVISE;
+        sqe->fd = -1;
+        sqe->addr = reinterpret_cast<uintptr_t>(op.buffer);
+        sqe->len = static_cast<unsigned int>(op.size);
+        sqe->fadvise_advice = MADV_WILLNEED;
+    }
+    sqe->user_data = slot;
+    sqArray[index] = index;
+    __sync_synchronize();
+    *sqTail = tail + 1;
+    __sync_synchronize();
+    int result;
+    do {
+        result = ioUringEnter(ringFd, 1, 0, 0);
+    } while (result < 0 && errno == EINTR);
+    if (result != 1) {
+        // the kernel did not consume the entry, it must not be submitted with the next one
+        *sqTail = tail;
+        __sync_synchronize();
+        return false;
+    }
+    return true;
+#else
+    (void) slot;
+    return false;
+#endif
+}
+
+void AsyncIO::reap(bool block) {
+#ifdef HAVE_IO_URING
+    if (block) {
+        int result;
+        do {
+            result = ioUringEnter(ringFd, 0, 1, IORING_ENTER_GETEVENTS);
+        } while (result < 0 && errno == EINTR);
+    }
+    unsigned int head = *cqHead;
+    __sync_synchronize();
+    while (head != *cqTail) {
+        const struct io_uring_cqe *cqe = static_cast<const struct io_uring_cqe *>(cqes) + (head & *cqMask);
+        const unsigned int slot = static_cast<unsigned int>(cqe->user_data);
+        const int result = cqe->res;
+        head++;
+        __sync_synchronize();
+        *cqHead = head;
+        complete(slot, result);
+        __sync_synchronize();
+    }
+#else
+    (void) block;
+#endif
+}
+
+void AsyncIO::complete(unsigned int slot, int result) {
+    Operation &op = operations[slot];
+    if (op.isWrite) {
+        if (result < 0 && result != -EINTR && result != -EAGAIN) {
+            Debug(Debug::ERROR) << "Could not write to file descriptor " << op.fd << ". Error " << -result << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        if (result == 0) {
+            Debug(Debug::ERROR) << "Could not write to file descriptor " << op.fd << ", no space left\n";
+            EXIT(EXIT_FAILURE);
+        }
+        if (result > 0) {
+            op.done += result;
+        }
+        // short write, the rest is queued again
+        if (op.done < op.size) {
+            if (submit(slot)) {
+                return;
+            }
+            writeFully(op.fd, op.buffer + op.done, op.size - op.done, op.offset + op.done);
+        }
+        freeBuffers.push_back(std::make_pair(op.buffer, op.capacity));
+    }
+    release(slot);
+}
+
+void AsyncIO::release(unsigned int slot) {
+    operations[slot].busy = false;
+    freeSlots.push_back(slot);
+    inFlight--;
+}
+
+void AsyncIO::write(int fd, char *buffer, size_t capacity, size_t size, size_t offset) {
+    if (ringFd == -1) {
+        writeFully(fd, buffer, size, offset);
+        freeBuffers.push_back(std::make_pair(buffer, capacity));
+        return;
+    }
+    while (freeSlots.empty()) {
+        reap(true);
+    }
+    const unsigned int slot = freeSlots.back();
+    freeSlots.pop_back();
+    Operation &op = operations[slot];
+    op.buffer = buffer;
+    op.capacity = capacity;
+    op.size = size;
+    op.done = 0;
+    op.offset = offset;
+    op.fd = fd;
+    op.isWrite = true;
+    op.busy = true;
+    inFlight++;
+    if (submit(slot) == false) {
+        writeFully(fd, buffer, size, offset);
+        freeBuffers.push_back(std::make_pair(buffer, capacity));
+        release(slot);
+    }
+    reap(false);
+}
+
+char *AsyncIO::takeBuffer(size_t &capacity) {
+    if (freeBuffers.empty() && allocatedBuffers < depth) {
+        allocatedBuffers++;
+        return NULL;
+    }
+    while (freeBuffers.empty()) {
+        reap(true);
+    }
+    std::pair<char *, size_t> buffer = freeBuffers.back();
+    freeBuffers.pop_back();
+    capacity = buffer.second;
+    return buffer.first;
+}
+
+void AsyncIO::adviseWillNeed(const void *addr, size_t size) {
+    if (ringFd == -1 || size == 0) {
+        return;
+    }
+    reap(false);
+    if (freeSlots.empty()) {
+        return;
+    }
+    const uintptr_t pageMask = static_cast<uintptr_t>(Util::getPageSize()) - 1;
+    const uintptr_t start = reinterpret_cast<uintptr_t>(addr) & ~pageMask;
+    const unsigned int slot = freeSlots.back();
+    freeSlots.pop_back();
+    Operation &op = operations[slot];
+    op.buffer = reinterpret_cast<char *>(start);
+    op.capacity = 0;
+    op.size = reinterpret_cast<uintptr_t>(addr) + size - start;
+    op.done = 0;
+    op.offset = 0;
+    op.fd = -1;
+    op.isWrite = false;
+    op.busy = true;
+    inFlight++;
+    if (submit(slot) == false) {
+        release(slot);
+    }
+}
+
+void AsyncIO::wait() {
+    while (inFlight > 0) {
+        reap(true);
+    }
+}
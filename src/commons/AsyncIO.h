@@ -0,0 +1,86 @@
+#ifndef MMSEQS_ASYNCIO_H
+#define MMSEQS_ASYNCIO_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Queue of asynchronous writes and readahead requests on top of an io_uring, set up with the raw system calls.
+// A queue belongs to a single thread. Written buffers are owned by the queue until their write completed,
+// they are handed out again by takeBuffer so that a writer cycles through a fixed number of buffers.
+// If the kernel or the build does not support io_uring, setEnabled leaves it disabled and the callers keep
+// their regular stdio and mmap code paths.
+class AsyncIO {
+public:
+    // warns and stays disabled if no io_uring with write and madvise support can be set up
+    static void setEnabled(bool requested);
+
+    static bool isEnabled() {
+        return enabled;
+    }
+
+    explicit AsyncIO(unsigned int depth);
+
+    // waits for the queued operations and frees the buffers
+    ~AsyncIO();
+
+    // queues a write of size bytes of the malloc'ed buffer to offset in fd
+    void write(int fd, char *buffer, size_t capacity, size_t size, size_t offset);
+
+    // buffer of a completed write, waits if all depth operations are in flight,
+    // NULL if fewer buffers were queued so far and the caller should allocate a new one
+    char *takeBuffer(size_t &capacity);
+
+    // asks the kernel to read the pages of the (file backed) mapping ahead, dropped if the queue is full
+    void adviseWillNeed(const void *addr, size_t size);
+
+    // waits for all queued operations, exits on a failed write
+    void wait();
+
+private:
+    struct Operation {
+        char *buffer;
+        size_t capacity;
+        size_t size;
+        size_t done;
+        size_t offset;
+        int fd;
+        bool isWrite;
+        bool busy;
+    };
+
+    bool submit(unsigned int slot);
+    // processes completions, waits for at least one if block is set
+    void reap(bool block);
+    void complete(unsigned int slot, int result);
+    void release(unsigned int slot);
+    void closeRing();
+
+    static bool enabled;
+
+    const unsigned int depth;
+    int ringFd;
+    void *sqRing;
+    size_t sqRingSize;
+    void *cqRing;
+    size_t cqRingSize;
+    void *sqes;
+    size_t sqesSize;
+
+    unsigned int *sqHead;
+    unsigned int *sqTail;
+    unsigned int *sqMask;
+    unsigned int *sqArray;
+    unsigned int *cqHead;
+    unsigned int *cqTail;
+    unsigned int *cqMask;
+    void *cqes;
+
+    std::vector<Operation> operations;
+    std::vector<unsigned int> freeSlots;
+    std::vector<std::pair<char *, size_t> > freeBuffers;
+    unsigned int inFlight;
+    unsigned int allocatedBuffers;
+};
+
+#endif
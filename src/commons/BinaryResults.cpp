@@ -0,0 +1,51 @@
+#include "BinaryResults.h"
+#include "Util.h"
+#include "itoa.h"
+
+#include <cstdio>
+
+size_t BinaryResults::hitToBuffer(char *buffer, const hit_t &hit) {
+    char *basePos = buffer;
+    char *tmpBuff = Itoa::u32toa_sse2((uint32_t) hit.seqId, buffer);
+    *(tmpBuff-1) = '\t';
+    tmpBuff = Itoa::i32toa_sse2(hit.prefScore, tmpBuff);
+    *(tmpBuff-1) = '\t';
+    int32_t diagonal = static_cast<short>(hit.diagonal);
+    tmpBuff = Itoa::i32toa_sse2(diagonal, tmpBuff);
+    *(tmpBuff-1) = '\n';
+    *(tmpBuff) = '\0';
+    return tmpBuff - basePos;
+}
+
+size_t BinaryResults::alignmentToBuffer(char *buffer, const result_bin_t &record, const char *backtraces) {
+    char *basePos = buffer;
+    char *tmpBuff = Itoa::u32toa_sse2((uint32_t) record.dbKey, buffer);
+    *(tmpBuff-1) = '\t';
+    tmpBuff = Itoa::i32toa_sse2(record.score, tmpBuff);
+    *(tmpBuff-1) = '\t';
+    tmpBuff = Util::fastSeqIdToBuffer(record.seqId, tmpBuff);
+    *(tmpBuff-1) = '\t';
+    tmpBuff += sprintf(tmpBuff, "%.3E", record.eval);
+    tmpBuff++;
+    *(tmpBuff-1) = '\t';
+    tmpBuff = Itoa::i32toa_sse2(record.qStartPos, tmpBuff);
+    *(tmpBuff-1) = '\t';
+    tmpBuff = Itoa::i32toa_sse2(record.qEndPos, tmpBuff);
+    *(tmpBuff-1) = '\t';
+    tmpBuff = Itoa::i32toa_sse2(record.qLen, tmpBuff);
+    *(tmpBuff-1) = '\t';
+    tmpBuff = Itoa::i32toa_sse2(record.dbStartPos, tmpBuff);
+    *(tmpBuff-1) = '\t';
+    tmpBuff = Itoa::i32toa_sse2(record.dbEndPos, tmpBuff);
+    *(tmpBuff-1) = '\t';
+    tmpBuff = Itoa::i32toa_sse2(record.dbLen, tmpBuff);
+    if (record.backtraceLength > 0) {
+        // backtraces are stored compressed, as the text format writes them
+        *(tmpBuff-1) = '\t';
+        memcpy(tmpBuff, backtraces + record.backtraceOffset, record.backtraceLength);
+        tmpBuff += record.backtraceLength + 1;
+    }
+    *(tmpBuff-1) = '\n';
+    *(tmpBuff) = '\0';
+    return tmpBuff - basePos;
+}
@@ -0,0 +1,79 @@
+#ifndef MMSEQS_BINARYRESULTS_H
+#define MMSEQS_BINARYRESULTS_H
+
+// Layout of binary prefilter and alignment result entries.
+// Prefilter entries are [unsigned int count][hit_t * count],
+// alignment entries are [unsigned int count][result_bin_t * count][compressed backtraces].
+// Records are packed back to back behind the count and are not aligned to their natural alignment,
+// always copy them out with getHit/getAlignment instead of dereferencing pointers into the entry.
+
+#include <cstddef>
+#include <cstring>
+
+struct hit_t {
+    unsigned int seqId;
+    int prefScore;
+    unsigned short diagonal;
+
+    static bool compareHitsByScoreAndId(hit_t first, hit_t second){
+        if(first.prefScore > second.prefScore )
+            return true;
+        if(second.prefScore > first.prefScore )
+            return false;
+        if(first.seqId < second.seqId )
+            return true;
+        if(second.seqId < first.seqId )
+            return false;
+        return false;
+    }
+};
+
+struct result_bin_t {
+    double eval;
+    unsigned int dbKey;
+    int score;
+    float qcov;
+    float dbcov;
+    float seqId;
+    unsigned int alnLength;
+    int qStartPos;
+    int qEndPos;
+    unsigned int qLen;
+    int dbStartPos;
+    int dbEndPos;
+    unsigned int dbLen;
+    // relative to the end of the record array
+    unsigned int backtraceOffset;
+    unsigned int backtraceLength;
+};
+
+class BinaryResults {
+public:
+    static size_t getCount(const char *data) {
+        unsigned int count;
+        memcpy(&count, data, sizeof(unsigned int));
+        return count;
+    }
+
+    static hit_t getHit(const char *data, size_t i) {
+        hit_t hit;
+        memcpy(&hit, data + sizeof(unsigned int) + i * sizeof(hit_t), sizeof(hit_t));
+        return hit;
+    }
+
+    static result_bin_t getAlignment(const char *data, size_t i) {
+        result_bin_t record;
+        memcpy(&record, data + sizeof(unsigned int) + i * sizeof(result_bin_t), sizeof(result_bin_t));
+        return record;
+    }
+
+    static const char *getBacktraces(const char *data, size_t count) {
+        return data + sizeof(unsigned int) + count * sizeof(result_bin_t);
+    }
+
+    // same columns as the text prefilter and alignment formats
+    static size_t hitToBuffer(char *buffer, const hit_t &hit);
+    static size_t alignmentToBuffer(char *buffer, const result_bin_t &record, const char *backtraces);
+};
+
+#endif
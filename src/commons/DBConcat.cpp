@@ -15,7 +15,7 @@
 DBConcat::DBConcat(const std::string &dataFileNameA, const std::string &indexFileNameA,
                    const std::string &dataFileNameB, const std::string &indexFileNameB,
                    const std::string &dataFileNameC, const std::string &indexFileNameC,
-                   unsigned int threads, int dataMode, bool write, bool preserveKeysA, bool preserveKeysB, bool takeLargerEntry)
+                   unsigned int threads, int dataMode, bool write, bool preserveKeysA, bool preserveKeysB, bool takeLargerEntry, bool binaryIndex)
         : DBReader((dataFileNameA == dataFileNameB ? dataFileNameA : dataFileNameC).c_str(), (indexFileNameA == indexFileNameB ? indexFileNameA : indexFileNameC).c_str(), threads, dataMode) {
     sameDatabase = dataFileNameA == dataFileNameB;
     if (sameDatabase) {
@@ -39,7 +39,7 @@ DBConcat::DBConcat(const std::string &dataFileNameA, const std::string &indexFil
     bool shouldConcatLookup = false;
     bool shouldConcatSource = false;
     if (write) {
-        concatWriter = new DBWriter(dataFileNameC.c_str(), indexFileNameC.c_str(), threads, Parameters::WRITER_ASCII_MODE, dbA.getDbtype());
+        concatWriter = new DBWriter(dataFileNameC.c_str(), indexFileNameC.c_str(), threads, binaryIndex ? Parameters::WRITER_BINARY_INDEX_MODE : Parameters::WRITER_ASCII_MODE, dbA.getDbtype());
         concatWriter->open();
 
         if (FileUtil::fileExists((dataFileNameA + "_mapping").c_str()) && FileUtil::fileExists((dataFileNameB + "_mapping").c_str())) {
@@ -74,11 +74,15 @@ DBConcat::DBConcat(const std::string &dataFileNameA, const std::string &indexFil
             }
 
             if (write) {
-                char *data = dbA.getData(id, thread_idx);
-                size_t dataSizeA = dbA.getEntryLen(id) - 1;
+                // binary results are decoded, the written length is the one of the decoded entry
+                size_t dataSizeA;
+                char *data = dbA.getData(id, thread_idx, &dataSizeA);
+                dataSizeA -= 1;
                 if(takeLargerEntry == true) {
                     size_t idB = dbB.getId(newKey);
-                    size_t dataSizeB = dbB.getEntryLen(idB)-1;
+                    size_t dataSizeB;
+                    dbB.getData(idB, thread_idx, &dataSizeB);
+                    dataSizeB -= 1;
                     if(dataSizeA >= dataSizeB){
                         concatWriter->writeData(data, dataSizeA, newKey, thread_idx);
                     }
@@ -112,11 +116,14 @@ DBConcat::DBConcat(const std::string &dataFileNameA, const std::string &indexFil
             }
 
             if (write) {
-                char *data = dbB.getData(id, thread_idx);
-                size_t dataSizeB = dbB.getEntryLen(id) - 1;
+                size_t dataSizeB;
+                char *data = dbB.getData(id, thread_idx, &dataSizeB);
+                dataSizeB -= 1;
                 if(takeLargerEntry){
                     size_t idB = dbA.getId(newKey);
-                    size_t dataSizeA = dbA.getEntryLen(idB)-1;
+                    size_t dataSizeA;
+                    dbA.getData(idB, thread_idx, &dataSizeA);
+                    dataSizeA -= 1;
                     if(dataSizeB > dataSizeA) {
                         concatWriter->writeData(data, dataSizeB, newKey, thread_idx);
                     }
@@ -371,7 +378,7 @@ int concatdbs(int argc, const char **argv, const Command& command) {
     DBConcat outDB(par.db1.c_str(), par.db1Index.c_str(),
                    par.db2.c_str(), par.db2Index.c_str(),
                    par.db3.c_str(), par.db3Index.c_str(),
-                   static_cast<unsigned int>(par.threads), datamode, true, true, par.preserveKeysB, par.takeLargerEntry);
+                   static_cast<unsigned int>(par.threads), datamode, true, true, par.preserveKeysB, par.takeLargerEntry, par.binaryIndex);
 
 
     return EXIT_SUCCESS;
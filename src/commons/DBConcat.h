@@ -10,7 +10,7 @@ public:
              const std::string &dataFileNameB, const std::string &indexFileNameB,
              const std::string &dataFileNameC, const std::string &indexFileNameC,
              unsigned int threads, int dataMode = USE_DATA | USE_INDEX | USE_LOOKUP, bool write = true,
-             bool preserveKeysA = false, bool preserveKeysB = false, bool takeLargerEntry = false);
+             bool preserveKeysA = false, bool preserveKeysB = false, bool takeLargerEntry = false, bool binaryIndex = false);
 
     ~DBConcat();
 
@@ -15,15 +15,18 @@
 #include "Debug.h"
 #include "Util.h"
 #include "FileUtil.h"
+#include "HugePages.h"
+#include "AsyncIO.h"
 #include "itoa.h"
+#include "BinaryResults.h"
 
 template <typename T>
 DBReader<T>::DBReader(const char* dataFileName_, const char* indexFileName_, int threads, int dataMode) :
 threads(threads), dataMode(dataMode), dataFileName(strdup(dataFileName_)),
         indexFileName(strdup(indexFileName_)), size(0), dataFiles(NULL), dataSizeOffset(NULL), dataFileCnt(0),
         totalDataSize(0), dataSize(0), lastKey(T()), closed(1), dbtype(Parameters::DBTYPE_GENERIC_DB),
-        compressedBuffers(NULL), compressedBufferSizes(NULL), index(NULL), id2local(NULL), local2id(NULL),
-        dataMapped(false), accessType(0), externalData(false), didMlock(false)
+        compressedBuffers(NULL), compressedBufferSizes(NULL), ddict(NULL), decodeBinary(false), binaryBuffers(NULL), index(NULL), binaryIndexData(NULL), binaryIndexDataSize(0), id2local(NULL), local2id(NULL),
+        keyToId(NULL), keyBits(NULL), keyRanks(NULL), keyBase(0), keyRange(0), dataMapped(false), readaheadQueues(NULL), accessType(0), externalData(false), didMlock(false)
 {}
 
 template <typename T>
@@ -31,8 +34,9 @@ DBReader<T>::DBReader(DBReader<T>::Index *index, size_t size, size_t dataSize, T
         int dbType, unsigned int maxSeqLen, int threads) :
         threads(threads), dataMode(USE_INDEX), dataFileName(NULL), indexFileName(NULL),
         size(size), dataFiles(NULL), dataSizeOffset(NULL), dataFileCnt(0), totalDataSize(0), dataSize(dataSize), lastKey(lastKey),
-        maxSeqLen(maxSeqLen), closed(1), dbtype(dbType), compressedBuffers(NULL), compressedBufferSizes(NULL), index(index), sortedByOffset(true),
-        id2local(NULL), local2id(NULL), dataMapped(false), accessType(NOSORT), externalData(true), didMlock(false)
+        maxSeqLen(maxSeqLen), closed(1), dbtype(dbType), compressedBuffers(NULL), compressedBufferSizes(NULL), ddict(NULL), decodeBinary(false), binaryBuffers(NULL), index(index), binaryIndexData(NULL), binaryIndexDataSize(0), sortedByOffset(true),
+        id2local(NULL), local2id(NULL), keyToId(NULL), keyBits(NULL), keyRanks(NULL), keyBase(0), keyRange(0),
+        dataMapped(false), readaheadQueues(NULL), accessType(NOSORT), externalData(true), didMlock(false)
 {}
 
 template <typename T>
@@ -128,6 +132,10 @@ template <typename T> bool DBReader<T>::open(int accessType){
         if (accessType == LINEAR_ACCCESS || accessType == SORT_BY_OFFSET) {
             setSequentialAdvice();
         }
+        if (AsyncIO::isEnabled() && (dataMode & USE_FREAD) == 0) {
+            readaheadQueues = new AsyncIO*[threads];
+            std::fill(readaheadQueues, readaheadQueues + threads, static_cast<AsyncIO *>(NULL));
+        }
     }
     if (dataMode & USE_LOOKUP || dataMode & USE_LOOKUP_REV) {
         std::string lookupFilename = (std::string(dataFileName) + ".lookup");
@@ -149,7 +157,10 @@ template <typename T> bool DBReader<T>::open(int accessType){
         indexData.close();
     }
     bool isSortedById = false;
-    if (externalData == false) {
+    if (externalData == false && openBinaryIndex(isSortedById)) {
+        // sortIndex reorders the copy-on-write mapping, the stored offset order does not hold after it
+        sortIndex(isSortedById);
+    } else if (externalData == false) {
         if(FileUtil::fileExists(indexFileName)==false){
             Debug(Debug::ERROR) << "Can not open index file " << indexFileName << "!\n";
             EXIT(EXIT_FAILURE);
@@ -171,7 +182,8 @@ template <typename T> bool DBReader<T>::open(int accessType){
 
         // sortIndex also handles access modes that don't require sorting
         sortIndex(isSortedById);
-
+    }
+    if (externalData == false) {
         size_t prevOffset = 0; // makes 0 or empty string
         sortedByOffset = true;
         for (size_t i = 0; i < size; i++) {
@@ -199,8 +211,27 @@ template <typename T> bool DBReader<T>::open(int accessType){
                 EXIT(EXIT_FAILURE);
             }
         }
+        if (dataFileName != NULL && (dataMode & USE_DATA)) {
+            std::string dictionaryFile = dictionaryFileName(dataFileName);
+            if (FileUtil::fileExists(dictionaryFile.c_str())) {
+                MemoryMapped dictionaryData(dictionaryFile, MemoryMapped::WholeFile, MemoryMapped::SequentialScan);
+                if (!dictionaryData.isValid()) {
+                    Debug(Debug::ERROR) << "Can not open dictionary " << dictionaryFile << "\n";
+                    EXIT(EXIT_FAILURE);
+                }
+                setDictionary((const char *) dictionaryData.getData(), dictionaryData.size());
+                dictionaryData.close();
+            }
+        }
+    }
+
+    decodeBinary = Parameters::isBinaryDbtype(dbtype) && (dataMode & USE_BINARY) == 0;
+    if (decodeBinary) {
+        binaryBuffers = new std::string[threads];
     }
 
+    buildKeyTable();
+
     closed = 0;
     return isSortedById;
 }
@@ -209,6 +240,148 @@ template<typename T>
 void DBReader<T>::sortIndex(bool) {
 }
 
+template<typename T>
+void DBReader<T>::buildKeyTable() {
+}
+
+template<typename T>
+void DBReader<T>::setDictionary(const char *data, size_t size) {
+    if (compression != COMPRESSED) {
+        return;
+    }
+    dictionary.assign(data, size);
+    if (ddict != NULL) {
+        ZSTD_freeDDict(ddict);
+    }
+    ddict = ZSTD_createDDict(dictionary.c_str(), dictionary.size());
+    if (ddict == NULL) {
+        Debug(Debug::ERROR) << "Invalid compression dictionary for " << (dataFileName != NULL ? dataFileName : "index") << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    // the dictionary stays referenced by the stream for all following frames
+    for (int i = 0; i < threads; i++) {
+        size_t result = ZSTD_initDStream_usingDDict(dstream[i], ddict);
+        if (ZSTD_isError(result)) {
+            Debug(Debug::ERROR) << "ZSTD_initDStream_usingDDict() error " << ZSTD_getErrorName(result) << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+    }
+}
+
+template<>
+void DBReader<unsigned int>::buildKeyTable() {
+    // these modes are not used for random access
+    if (size == 0 || accessType == HARDNOSORT || accessType == SORT_BY_OFFSET || accessType == LINEAR_ACCCESS) {
+        return;
+    }
+    bool hasDuplicates = false;
+    for (size_t i = 1; i < size; i++) {
+        if (index[i - 1].id > index[i].id) {
+            // getId falls back to the binary search
+            return;
+        }
+        hasDuplicates = hasDuplicates || index[i - 1].id == index[i].id;
+    }
+    keyBase = index[0].id;
+    keyRange = static_cast<size_t>(index[size - 1].id) - keyBase + 1;
+    if (keyRange <= 2 * size) {
+        // at most 8 bytes per entry
+        keyToId = new unsigned int[keyRange];
+        std::fill(keyToId, keyToId + keyRange, UINT_MAX);
+        // backwards, so that duplicate keys are mapped to their first entry like in the binary search
+        for (size_t i = size; i > 0; i--) {
+            keyToId[index[i - 1].id - keyBase] = i - 1;
+        }
+    } else if (keyRange <= 64 * size && hasDuplicates == false) {
+        // 1.5 bits per key of the range, one bitmap bit and a 32 bit rank per 64 keys, at most 12 bytes per entry
+        const size_t words = keyRange / 64 + 1;
+        keyBits = new uint64_t[words];
+        keyRanks = new unsigned int[words];
+        std::fill(keyBits, keyBits + words, 0);
+        for (size_t i = 0; i < size; i++) {
+            const size_t key = index[i].id - keyBase;
+            keyBits[key / 64] |= static_cast<uint64_t>(1) << (key % 64);
+        }
+        unsigned int rank = 0;
+        for (size_t i = 0; i < words; i++) {
+            keyRanks[i] = rank;
+            rank += __builtin_popcountll(keyBits[i]);
+        }
+    } else {
+        keyRange = 0;
+    }
+}
+
+template<typename T>
+bool DBReader<T>::getTextIndexStamp(const char *indexFileName, BinaryIndexHeader &header) {
+    struct stat sb;
+    if (stat(indexFileName, &sb) < 0) {
+        return false;
+    }
+    header.textIndexSize = sb.st_size;
+#ifdef __APPLE__
+    header.textIndexSec = sb.st_mtimespec.tv_sec;
+    header.textIndexNsec = sb.st_mtimespec.tv_nsec;
+#else
+    header.textIndexSec = sb.st_mtim.tv_sec;
+    header.textIndexNsec = sb.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+template<>
+bool DBReader<std::string>::openBinaryIndex(bool &) {
+    return false;
+}
+
+template<>
+bool DBReader<unsigned int>::openBinaryIndex(bool &isSortedById) {
+    std::string binaryIndexFile = binaryIndexFileName(indexFileName);
+    FILE *file = fopen(binaryIndexFile.c_str(), "r");
+    if (file == NULL) {
+        return false;
+    }
+    BinaryIndexHeader header;
+    if (fread(&header, sizeof(BinaryIndexHeader), 1, file) != 1
+        || memcmp(header.magic, "MMSIDX\0\0", 8) != 0 || header.version != BINARY_INDEX_VERSION
+        || header.entrySize != sizeof(Index)) {
+        Debug(Debug::WARNING) << "Ignoring invalid binary index " << binaryIndexFile << "\n";
+        fclose(file);
+        return false;
+    }
+    // without a text index the sidecar is used as is
+    BinaryIndexHeader text;
+    if (getTextIndexStamp(indexFileName, text)
+        && (text.textIndexSize != header.textIndexSize || text.textIndexSec != header.textIndexSec
+            || text.textIndexNsec != header.textIndexNsec)) {
+        Debug(Debug::WARNING) << "Ignoring binary index " << binaryIndexFile << ", it is older than " << indexFileName << "\n";
+        fclose(file);
+        return false;
+    }
+    struct stat sb;
+    if (fstat(fileno(file), &sb) < 0 || static_cast<size_t>(sb.st_size) != sizeof(BinaryIndexHeader) + header.size * sizeof(Index)) {
+        Debug(Debug::WARNING) << "Ignoring truncated binary index " << binaryIndexFile << "\n";
+        fclose(file);
+        return false;
+    }
+    // private writable mapping, so that the index can be reordered in place without touching the file
+    binaryIndexDataSize = sb.st_size;
+    binaryIndexData = static_cast<char *>(mmap(NULL, binaryIndexDataSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(file), 0));
+    fclose(file);
+    if (binaryIndexData == MAP_FAILED) {
+        int errsv = errno;
+        Debug(Debug::ERROR) << "Failed to mmap binary index " << binaryIndexFile << ". Error " << errsv << ".\n";
+        EXIT(EXIT_FAILURE);
+    }
+    index = reinterpret_cast<Index *>(binaryIndexData + sizeof(BinaryIndexHeader));
+    size = header.size;
+    dataSize = header.dataSize;
+    maxSeqLen = header.maxSeqLen;
+    lastKey = header.lastKey;
+    isSortedById = (header.flags & BINARY_INDEX_SORTED_BY_ID) != 0;
+    return true;
+}
+
 template<typename T>
 bool DBReader<T>::isSortedByOffset(){
     return sortedByOffset;
@@ -411,8 +584,12 @@ template <typename T> char* DBReader<T>::mmapData(FILE * file, size_t *dataSize)
                 Debug(Debug::ERROR) << "Failed to mmap memory dataSize=" << *dataSize <<" File=" << dataFileName << ". Error " << errsv << ".\n";
                 EXIT(EXIT_FAILURE);
             }
+            // only file systems with huge page support (hugetlbfs, read-only THP for files) follow the advice
+            if (HugePages::getMode() != HugePages::MODE_OFF && HugePages::adviseMapping(ret, *dataSize, fd) == false) {
+                Debug(Debug::WARNING) << "Could not request huge pages for " << dataFileName << "\n";
+            }
         } else {
-            ret = static_cast<char*>(malloc(*dataSize));
+            ret = static_cast<char*>(HugePages::allocate(*dataSize));
             Util::checkAllocation(ret, "Not enough system memory to read in the whole data file.");
             size_t result = fread(ret, 1, *dataSize, file);
             if (result != *dataSize) {
@@ -448,6 +625,13 @@ template <typename T> void DBReader<T>::close(){
     if(dataMode & USE_DATA){
         unmapData();
     }
+    if (readaheadQueues != NULL) {
+        for (int i = 0; i < threads; i++) {
+            delete readaheadQueues[i];
+        }
+        delete[] readaheadQueues;
+        readaheadQueues = NULL;
+    }
 
     if (id2local != NULL) {
         delete[] id2local;
@@ -455,6 +639,16 @@ template <typename T> void DBReader<T>::close(){
     if (local2id != NULL) {
         delete[] local2id;
     }
+    if (keyToId != NULL) {
+        delete[] keyToId;
+        keyToId = NULL;
+    }
+    if (keyBits != NULL) {
+        delete[] keyBits;
+        delete[] keyRanks;
+        keyBits = NULL;
+        keyRanks = NULL;
+    }
 
     if(compressedBuffers){
         for(int i = 0; i < threads; i++){
@@ -465,8 +659,21 @@ template <typename T> void DBReader<T>::close(){
         delete [] compressedBufferSizes;
         delete [] dstream;
     }
+    if (ddict != NULL) {
+        ZSTD_freeDDict(ddict);
+        ddict = NULL;
+        dictionary.clear();
+    }
+
+    if (binaryBuffers != NULL) {
+        delete [] binaryBuffers;
+        binaryBuffers = NULL;
+    }
 
-    if(externalData == false) {
+    if (binaryIndexData != NULL) {
+        munmap(binaryIndexData, binaryIndexDataSize);
+        binaryIndexData = NULL;
+    } else if(externalData == false) {
         delete[] index;
     }
     closed = 1;
@@ -520,11 +727,45 @@ template <typename T> size_t DBReader<T>::getAminoAcidDBSize() {
 }
 
 template <typename T> char* DBReader<T>::getData(size_t id, int thrIdx){
+    char *data;
     if(compression == COMPRESSED){
-        return getDataCompressed(id, thrIdx);
+        data = getDataCompressed(id, thrIdx);
     }else{
-        return getDataUncompressed(id);
+        data = getDataUncompressed(id);
     }
+    if (decodeBinary) {
+        return decodeBinaryEntry(data, thrIdx);
+    }
+    return data;
+}
+
+template <typename T> char* DBReader<T>::getData(size_t id, int thrIdx, size_t *entryLen) {
+    char *data = getData(id, thrIdx);
+    *entryLen = decodeBinary ? (binaryBuffers[thrIdx].size() + 1) : getEntryLen(id);
+    return data;
+}
+
+template <typename T> char* DBReader<T>::decodeBinaryEntry(const char *data, int thrIdx) {
+    std::string &out = binaryBuffers[thrIdx];
+    out.clear();
+    const size_t count = BinaryResults::getCount(data);
+    if (Parameters::isEqualDbtype(dbtype, Parameters::DBTYPE_ALIGNMENT_RES)) {
+        const char *backtraces = BinaryResults::getBacktraces(data, count);
+        for (size_t i = 0; i < count; i++) {
+            const result_bin_t record = BinaryResults::getAlignment(data, i);
+            size_t pos = out.size();
+            out.resize(pos + 1024 + record.backtraceLength);
+            size_t len = BinaryResults::alignmentToBuffer(&out[pos], record, backtraces);
+            out.resize(pos + len);
+        }
+    } else {
+        char buffer[128];
+        for (size_t i = 0; i < count; i++) {
+            size_t len = BinaryResults::hitToBuffer(buffer, BinaryResults::getHit(data, i));
+            out.append(buffer, len);
+        }
+    }
+    return &out[0];
 }
 
 template <typename T> char* DBReader<T>::getDataUncompressed(size_t id){
@@ -562,6 +803,56 @@ template <typename T> char* DBReader<T>::getDataByOffset(size_t offset) {
     return dataFiles[cnt]+fileOffset;
 }
 
+template <typename T>
+const char *DBReader<T>::getMappedEntry(size_t id, size_t &length) {
+    if (dataMapped == false || id >= size) {
+        return NULL;
+    }
+    const size_t localId = (local2id != NULL) ? local2id[id] : id;
+    const size_t offset = index[localId].offset;
+    if (offset >= totalDataSize) {
+        return NULL;
+    }
+    // compressed entries are shorter than their length in the index, a few bytes too many are covered
+    size_t cnt = 0;
+    while ((offset >= dataSizeOffset[cnt] && offset < dataSizeOffset[cnt + 1]) == false) {
+        cnt++;
+    }
+    length = std::min(static_cast<size_t>(index[localId].length), dataSizeOffset[cnt + 1] - offset);
+    return dataFiles[cnt] + (offset - dataSizeOffset[cnt]);
+}
+
+template <typename T>
+void DBReader<T>::readahead(size_t id, int thrIdx) {
+    if (readaheadQueues == NULL) {
+        return;
+    }
+    size_t length;
+    const char *data = getMappedEntry(id, length);
+    if (data == NULL) {
+        return;
+    }
+    if (readaheadQueues[thrIdx] == NULL) {
+        readaheadQueues[thrIdx] = new AsyncIO(READAHEAD_DEPTH);
+    }
+    readaheadQueues[thrIdx]->adviseWillNeed(data, length);
+}
+
+template <typename T>
+void DBReader<T>::prefetch(size_t id, int thrIdx) {
+    readahead(id, thrIdx);
+    size_t length;
+    const char *data = getMappedEntry(id, length);
+    if (data == NULL) {
+        return;
+    }
+    // a prefetch of a page that is not resident is dropped without faulting
+    length = std::min(length, PREFETCH_BYTES);
+    for (size_t pos = 0; pos < length; pos += 64) {
+        __builtin_prefetch(data + pos);
+    }
+}
+
 template <typename T>
 void DBReader<T>::touchData(size_t id) {
     if((dataMode & USE_DATA) && (dataMode & USE_FREAD) == 0) {
@@ -575,11 +866,19 @@ void DBReader<T>::touchData(size_t id) {
 
 template <typename T> char* DBReader<T>::getDataByDBKey(T dbKey, int thrIdx) {
     size_t id = getId(dbKey);
+    if (id == UINT_MAX) {
+        return NULL;
+    }
+    char *data;
     if(compression == COMPRESSED ){
-        return (id != UINT_MAX) ? getDataCompressed(id, thrIdx) : NULL;
+        data = getDataCompressed(id, thrIdx);
     }else{
-        return (id != UINT_MAX) ? getDataByOffset(index[id].offset) : NULL;
+        data = getDataByOffset(index[id].offset);
+    }
+    if (decodeBinary) {
+        return decodeBinaryEntry(data, thrIdx);
     }
+    return data;
 }
 
 template <typename T> size_t DBReader<T>::getLookupSize(){
@@ -697,10 +996,50 @@ template <typename T> size_t DBReader<T>::getId (T dbKey){
     return (id < size && index[id].id == dbKey ) ? id : UINT_MAX;
 }
 
+template <> size_t DBReader<unsigned int>::getId (unsigned int dbKey){
+    size_t id;
+    if (keyToId != NULL) {
+        // keys below keyBase wrap around to large values
+        const size_t key = static_cast<size_t>(dbKey) - keyBase;
+        if (key >= keyRange || keyToId[key] == UINT_MAX) {
+            return UINT_MAX;
+        }
+        id = keyToId[key];
+    } else if (keyBits != NULL) {
+        const size_t key = static_cast<size_t>(dbKey) - keyBase;
+        if (key >= keyRange) {
+            return UINT_MAX;
+        }
+        const uint64_t word = keyBits[key / 64];
+        const uint64_t bit = static_cast<uint64_t>(1) << (key % 64);
+        if ((word & bit) == 0) {
+            return UINT_MAX;
+        }
+        id = keyRanks[key / 64] + __builtin_popcountll(word & (bit - 1));
+    } else {
+        id = bsearch(index, size, dbKey);
+        if (id >= size || index[id].id != dbKey) {
+            return UINT_MAX;
+        }
+    }
+    return (id2local != NULL) ? id2local[id] : id;
+}
+
 template <typename T> size_t DBReader<T>::maxCount(char c) {
     checkClosed();
 
     size_t max = 0;
+    if (Parameters::isBinaryDbtype(dbtype) && c == '\n') {
+        // each binary record corresponds to one line, the record count leads every entry
+        for (size_t id = 0; id < getSize(); id++) {
+            const char *data = (compression == COMPRESSED) ? getDataCompressed(id, 0) : getDataUncompressed(id);
+            unsigned int count;
+            memcpy(&count, data, sizeof(unsigned int));
+            max = std::max(max, static_cast<size_t>(count));
+        }
+        return max;
+    }
+
     if (compression == COMPRESSED) {
         size_t entries = getSize();
 #ifdef OPENMP
@@ -800,6 +1139,13 @@ void DBReader<unsigned int>::readIndexId(unsigned int* id, char*, const char** c
 }
 
 template <typename T> void DBReader<T>::unmapData() {
+    if (readaheadQueues != NULL) {
+        for (int i = 0; i < threads; i++) {
+            if (readaheadQueues[i] != NULL) {
+                readaheadQueues[i]->wait();
+            }
+        }
+    }
     if (dataMapped == true) {
         for(size_t fileIdx = 0; fileIdx < dataFileNames.size(); fileIdx++) {
             size_t fileSize = dataSizeOffset[fileIdx+1] -dataSizeOffset[fileIdx];
@@ -814,7 +1160,7 @@ template <typename T> void DBReader<T>::unmapData() {
                         EXIT(EXIT_FAILURE);
                     }
                 } else {
-                    free(dataFiles[fileIdx]);
+                    HugePages::release(dataFiles[fileIdx]);
                 }
             }
         }
@@ -897,6 +1243,26 @@ void DBReader<T>::setData(char *data, size_t dataSize) {
     }
 }
 
+template<typename T>
+void DBReader<T>::addData(char *data, size_t dataSize) {
+    if (dataFiles == NULL) {
+        setData(data, dataSize);
+        return;
+    }
+    char **newDataFiles = new char*[dataFileCnt + 1];
+    size_t *newDataSizeOffset = new size_t[dataFileCnt + 2];
+    memcpy(newDataFiles, dataFiles, dataFileCnt * sizeof(char*));
+    memcpy(newDataSizeOffset, dataSizeOffset, (dataFileCnt + 1) * sizeof(size_t));
+    newDataFiles[dataFileCnt] = data;
+    newDataSizeOffset[dataFileCnt + 1] = totalDataSize + dataSize;
+    delete[] dataFiles;
+    delete[] dataSizeOffset;
+    dataFiles = newDataFiles;
+    dataSizeOffset = newDataSizeOffset;
+    totalDataSize += dataSize;
+    dataFileCnt++;
+}
+
 template<typename T>
 void DBReader<T>::setMode(const int mode) {
     this->dataMode = mode;
@@ -999,9 +1365,15 @@ void DBReader<T>::moveDb(const std::string &srcDbName, const std::string &dstDbN
     if (FileUtil::fileExists((srcDbName + ".index").c_str())) {
         FileUtil::move((srcDbName + ".index").c_str(), (dstDbName + ".index").c_str());
     }
+    if (FileUtil::fileExists((srcDbName + ".index.bin").c_str())) {
+        FileUtil::move((srcDbName + ".index.bin").c_str(), (dstDbName + ".index.bin").c_str());
+    }
     if (FileUtil::fileExists((srcDbName + ".dbtype").c_str())) {
         FileUtil::move((srcDbName + ".dbtype").c_str(), (dstDbName + ".dbtype").c_str());
     }
+    if (FileUtil::fileExists(dictionaryFileName(srcDbName).c_str())) {
+        FileUtil::move(dictionaryFileName(srcDbName).c_str(), dictionaryFileName(dstDbName).c_str());
+    }
     if (FileUtil::fileExists((srcDbName + ".lookup").c_str())) {
         FileUtil::move((srcDbName + ".lookup").c_str(), (dstDbName + ".lookup").c_str());
     }
@@ -1017,10 +1389,18 @@ void DBReader<T>::removeDb(const std::string &databaseName){
     if (FileUtil::fileExists(index.c_str())) {
         FileUtil::remove(index.c_str());
     }
+    std::string binaryIndex = binaryIndexFileName(index);
+    if (FileUtil::fileExists(binaryIndex.c_str())) {
+        FileUtil::remove(binaryIndex.c_str());
+    }
     std::string dbTypeFile = databaseName + ".dbtype";
     if (FileUtil::fileExists(dbTypeFile.c_str())) {
         FileUtil::remove(dbTypeFile.c_str());
     }
+    std::string dictionaryFile = dictionaryFileName(databaseName);
+    if (FileUtil::fileExists(dictionaryFile.c_str())) {
+        FileUtil::remove(dictionaryFile.c_str());
+    }
     std::string sourceFile = databaseName + ".source";
     if (FileUtil::fileExists(sourceFile.c_str())) {
         FileUtil::remove(sourceFile.c_str());
@@ -1060,10 +1440,14 @@ void DBReader<T>::softlinkDb(const std::string &databaseName, const std::string
 
     const DBSuffix suffices[] = {
         { DBFiles::DATA_INDEX,    ".index"            },
+        { DBFiles::DATA_INDEX,    ".index.bin"        },
         { DBFiles::DATA_DBTYPE,   ".dbtype"           },
+        { DBFiles::DATA,          ".zdict"            },
         { DBFiles::HEADER,        "_h"                },
         { DBFiles::HEADER_INDEX,  "_h.index"          },
+        { DBFiles::HEADER_INDEX,  "_h.index.bin"      },
         { DBFiles::HEADER_DBTYPE, "_h.dbtype"         },
+        { DBFiles::HEADER,        "_h.zdict"          },
         { DBFiles::LOOKUP,        ".lookup"           },
         { DBFiles::SOURCE,        ".source"           },
         { DBFiles::TAX_MAPPING,   "_mapping"          },
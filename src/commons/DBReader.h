@@ -10,6 +10,7 @@
 #include <utility>
 #include <vector>
 #include <string>
+#include <stdint.h>
 #include "Sequence.h"
 #include "Parameters.h"
 #include "FileUtil.h"
@@ -18,6 +19,8 @@
 #define ZSTD_STATIC_LINKING_ONLY // ZSTD_findDecompressedSize
 #include <zstd.h>
 
+class AsyncIO;
+
 struct DBFiles {
     enum Files {
         DATA              = (1ull << 0),
@@ -98,6 +101,24 @@ public:
         }
     };
 
+    // header of the binary index sidecar (<index>.bin), it is followed by the Index array in memory layout.
+    // The size and modification time of the text index are recorded to detect a sidecar that is out of date
+    struct BinaryIndexHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t entrySize;
+        uint64_t size;
+        uint64_t dataSize;
+        uint32_t maxSeqLen;
+        uint32_t lastKey;
+        uint32_t flags;
+        uint32_t padding;
+        uint64_t textIndexSize;
+        int64_t textIndexSec;
+        int64_t textIndexNsec;
+        char reserved[56];
+    };
+
     struct LookupEntry {
         T id;
         std::string entryName;
@@ -155,6 +176,10 @@ public:
 
     char* getData(size_t id, int thrIdx);
 
+    // entryLen is the length including the null byte like getEntryLen, but of the returned data.
+    // They differ for binary entries, which getData decodes to text
+    char* getData(size_t id, int thrIdx, size_t *entryLen);
+
     char* getDataCompressed(size_t id, int thrIdx);
 
     char* getDataUncompressed(size_t id);
@@ -212,10 +237,16 @@ public:
 
     void remapData();
 
+    // with --io-uring the pages of the entry are read ahead asynchronously, does nothing otherwise
+    void readahead(size_t id, int thrIdx);
+
+    // pulls the start of the entry into the cache ahead of its use and reads its pages ahead like readahead
+    void prefetch(size_t id, int thrIdx);
+
     size_t bsearch(const Index * index, size_t size, T value);
 
-    // does a binary search in the index and returns index of the entry with dbKey
-    // returns UINT_MAX if the key is not contained in index
+    // returns index of the entry with dbKey, UINT_MAX if the key is not contained in index
+    // uses the key table built by open if there is one and a binary search in the index otherwise
     size_t getId (T dbKey);
 
     // does a binary search in the lookup and returns index of the entry
@@ -245,12 +276,18 @@ public:
     static const unsigned int USE_FREAD      = 4;
     static const unsigned int USE_LOOKUP     = 8;
     static const unsigned int USE_LOOKUP_REV = 16;
+    // caller reads binary result entries directly, otherwise getData converts them to text
+    static const unsigned int USE_BINARY     = 32;
 
 
     // compressed
     static const int UNCOMPRESSED    = 0;
     static const int COMPRESSED     = 1;
 
+    static const uint32_t BINARY_INDEX_VERSION = 1;
+    static const uint32_t BINARY_INDEX_SORTED_BY_ID = 1;
+    static const uint32_t BINARY_INDEX_SORTED_BY_OFFSET = 2;
+
     char * getDataForFile(size_t fileIdx){
         return dataFiles[fileIdx];
     }
@@ -279,6 +316,25 @@ public:
 
     static void softlinkDb(const std::string &databaseName, const std::string &outDb, DBFiles::Files dbFilesFlags = DBFiles::ALL);
 
+    static std::string binaryIndexFileName(const std::string &indexFileName) {
+        return indexFileName + ".bin";
+    }
+
+    // size and modification time of the text index, stored in the binary index to detect changes
+    static bool getTextIndexStamp(const char *indexFileName, BinaryIndexHeader &header);
+
+    // zstd dictionary of a compressed database, see --compression-dict
+    static std::string dictionaryFileName(const std::string &dataFileName) {
+        return dataFileName + ".zdict";
+    }
+
+    // decompresses all entries with the given dictionary, open loads the .zdict of the data file already
+    void setDictionary(const char *data, size_t size);
+
+    const std::string &getDictionary() {
+        return dictionary;
+    }
+
     char *mmapData(FILE *file, size_t *dataSize);
 
     bool readIndex(char *data, size_t indexDataSize, Index *index, size_t & dataSize);
@@ -322,7 +378,11 @@ public:
     static DBReader<unsigned int> *unserialize(const char* data, int threads);
 
     int getDbtype(){
-        return dbtype;
+        return decodeBinary ? (dbtype & ~Parameters::DBTYPE_EXTENDED_BINARY) : dbtype;
+    }
+
+    bool isBinary(){
+        return Parameters::isBinaryDbtype(dbtype) && decodeBinary == false;
     }
 
     const char* getDbTypeName() const {
@@ -381,6 +441,9 @@ public:
 
     void setData(char *data, size_t dataSize);
 
+    // appends a further block of external data, its offsets continue after the blocks that were set before
+    void addData(char *data, size_t dataSize);
+
     void setMode(const int mode);
 
     size_t getOffset(size_t id);
@@ -401,6 +464,14 @@ private:
 
     void checkClosed();
 
+    // maps the binary index sidecar instead of parsing the text index, false if there is no usable sidecar
+    bool openBinaryIndex(bool &isSortedById);
+
+    char* decodeBinaryEntry(const char *data, int thrIdx);
+
+    // builds keyToId or keyBits/keyRanks for getId if the index is sorted by key
+    void buildKeyTable();
+
     int threads;
 
     int dataMode;
@@ -433,8 +504,16 @@ private:
     char ** compressedBuffers;
     size_t * compressedBufferSizes;
     ZSTD_DStream ** dstream;
+    std::string dictionary;
+    ZSTD_DDict * ddict;
+    // binary result entries are converted to text for callers without USE_BINARY
+    bool decodeBinary;
+    std::string * binaryBuffers;
 
     Index * index;
+    // set if index points into the mapping of the binary index
+    char * binaryIndexData;
+    size_t binaryIndexDataSize;
     size_t lookupSize;
     LookupEntry * lookup;
     bool sortedByOffset;
@@ -442,7 +521,22 @@ private:
     unsigned int * id2local;
     unsigned int * local2id;
 
+    // key table of getId over the keys [keyBase, keyBase + keyRange). Dense keys are mapped directly
+    // to their id, for sparse keys the id is the rank of the key in a bitmap of all keys
+    unsigned int * keyToId;
+    uint64_t * keyBits;
+    unsigned int * keyRanks;
+    size_t keyBase;
+    size_t keyRange;
+
     bool dataMapped;
+    // mapped data of the entry and its length clipped to its data file, NULL if the data is not mapped
+    const char *getMappedEntry(size_t id, size_t &length);
+    // bytes of an entry that prefetch pulls into the cache, the hardware prefetcher takes over from there
+    static const size_t PREFETCH_BYTES = 256;
+    // one queue per thread, created on the first readahead of the thread
+    static const unsigned int READAHEAD_DEPTH = 32;
+    AsyncIO ** readaheadQueues;
     int accessType;
 
     bool externalData;
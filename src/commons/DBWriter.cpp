@@ -7,20 +7,59 @@
 #include "itoa.h"
 #include "Timer.h"
 #include "Parameters.h"
+#include "AsyncIO.h"
+#include "ByteParser.h"
+#include "ExternalSort.h"
+#include "MemoryBudget.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <cstdlib>
 #include <cstdio>
+#include <functional>
+#include <queue>
 #include <sstream>
+#include <fcntl.h>
 #include <unistd.h>
 
+#include <dictBuilder/zdict.h>
+
 #ifdef OPENMP
 #include <omp.h>
 #endif
 
+static bool useDictionary(size_t mode) {
+    return (mode & Parameters::WRITER_COMPRESSED_MODE) != 0 && (mode & Parameters::WRITER_LEXICOGRAPHIC_MODE) == 0
+           && (mode & Parameters::WRITER_DICTIONARY_MODE) == 0 && (mode & Parameters::WRITER_TRAIN_DICTIONARY_MODE) != 0;
+}
+
 DBWriter::DBWriter(const char *dataFileName_, const char *indexFileName_, unsigned int threads, size_t mode, int dbtype)
-        : threads(threads), mode(mode), dbtype(dbtype) {
+        : threads(threads), trainDictionary(useDictionary(mode)),
+          shared((mode & Parameters::WRITER_SHARED_MODE) != 0 && (mode & Parameters::WRITER_LEXICOGRAPHIC_MODE) == 0),
+          mode(mode), dbtype(dbtype) {
     dataFileName = strdup(dataFileName_);
     indexFileName = strdup(indexFileName_);
+    cdict = NULL;
+    holding = NULL;
+    heldData = NULL;
+    heldStart = NULL;
+    heldEntries = NULL;
+    dictionaryReady = false;
+    if (trainDictionary) {
+        holding = new bool[threads];
+        heldData = new std::string[threads];
+        heldStart = new size_t[threads];
+        heldEntries = new std::vector<HeldEntry>[threads];
+    }
+    extents = NULL;
+    extentSize = 0;
+    sharedFd = -1;
+    sharedSize = 0;
+    asyncIO = NULL;
+    indexSort = NULL;
+    if (shared || AsyncIO::isEnabled()) {
+        extents = new Extent[threads];
+    }
 
     dataFiles = new FILE *[threads];
     dataFilesBuffer = new char *[threads];
@@ -31,7 +70,7 @@ DBWriter::DBWriter(const char *dataFileName_, const char *indexFileName_, unsign
     indexFileNames = new char *[threads];
     compressedBuffers=NULL;
     compressedBufferSizes=NULL;
-    if((mode & Parameters::WRITER_COMPRESSED_MODE) != 0){
+    if((this->mode & Parameters::WRITER_COMPRESSED_MODE) != 0){
         compressedBuffers = new char*[threads];
         compressedBufferSizes = new size_t[threads];
         cstream = new ZSTD_CStream*[threads];
@@ -45,7 +84,7 @@ DBWriter::DBWriter(const char *dataFileName_, const char *indexFileName_, unsign
     std::fill(starts, starts + threads, 0);
     offsets = new size_t[threads];
     std::fill(offsets, offsets + threads, 0);
-    if((mode & Parameters::WRITER_COMPRESSED_MODE) != 0 ){
+    if((this->mode & Parameters::WRITER_COMPRESSED_MODE) != 0 ){
         datafileMode = "wb+";
     } else {
         datafileMode = "wb";
@@ -81,6 +120,12 @@ DBWriter::~DBWriter() {
     delete[] dataFiles;
     free(indexFileName);
     free(dataFileName);
+    delete[] extents;
+    delete indexSort;
+    delete[] holding;
+    delete[] heldData;
+    delete[] heldStart;
+    delete[] heldEntries;
     if(compressedBuffers){
         delete [] threadBuffer;
         delete [] threadBufferSize;
@@ -92,22 +137,52 @@ DBWriter::~DBWriter() {
     }
 }
 
-void DBWriter::sortDatafileByIdOrder(DBReader<unsigned int> &dbr) {
+void DBWriter::sortDatafileByIdOrder(DBReader<unsigned int> &dbr, size_t memoryLimit) {
+    if (dbr.getDataSize() <= memoryLimit) {
+        dbr.readMmapedDataInMemory();
 #pragma omp parallel
-    {
-        int thread_idx = 0;
+        {
+            int thread_idx = 0;
 #ifdef OPENMP
-        thread_idx = omp_get_thread_num();
+            thread_idx = omp_get_thread_num();
 #endif
 
 #pragma omp for schedule(static)
-        for (size_t id = 0; id < dbr.getSize(); id++) {
-            char *data = dbr.getData(id, thread_idx);
-            size_t length = dbr.getEntryLen(id);
-            writeData(data, (length == 0 ? 0 : length - 1), dbr.getDbKey(id), thread_idx);
-        }
-    };
+            for (size_t id = 0; id < dbr.getSize(); id++) {
+                size_t length;
+                char *data = dbr.getData(id, thread_idx, &length);
+                writeData(data, (length == 0 ? 0 : length - 1), dbr.getDbKey(id), thread_idx);
+            }
+        };
+        return;
+    }
 
+    // the data is read once in file order and sorted by id in runs on disk
+    Debug(Debug::INFO) << "Data of " << FileUtil::baseName(dataFileName) << " exceeds the memory limit of "
+                       << ByteParser::format(memoryLimit) << ", sorting it on disk\n";
+    std::vector<std::pair<size_t, size_t> > offsetIds(dbr.getSize());
+    for (size_t id = 0; id < dbr.getSize(); id++) {
+        offsetIds[id] = std::make_pair(dbr.getOffset(id), id);
+    }
+    std::sort(offsetIds.begin(), offsetIds.end());
+    dbr.setSequentialAdvice();
+
+    ExternalSort sorter(std::string(dataFileName) + "_sort", memoryLimit);
+    for (size_t i = 0; i < offsetIds.size(); i++) {
+        const size_t id = offsetIds[i].second;
+        size_t length;
+        char *data = dbr.getData(id, 0, &length);
+        sorter.add(static_cast<unsigned int>(id), data, (length == 0 ? 0 : length - 1));
+    }
+    std::vector<std::pair<size_t, size_t> >().swap(offsetIds);
+    sorter.finish();
+
+    unsigned int id;
+    const char *data;
+    size_t length;
+    while (sorter.next(id, data, length)) {
+        writeData(data, length, dbr.getDbKey(id), 0);
+    }
 }
 
 void DBWriter::mergeFiles(DBReader<unsigned int> &qdbr,
@@ -160,57 +235,116 @@ char* makeResultFilename(const char* name, size_t split) {
     return strdup(s.c_str());
 }
 
+size_t DBWriter::getDefaultBufferSize() {
+    if (MemoryBudget::getAvailable() < (8ull * 1024 * 1024 * 1024)) {
+        // reduce this buffer if our system does not have much memory
+        // createdb runs into trouble since it creates 2x32 splits with 64MB each (=4GB)
+        // 8MB should be enough
+        return 8ull * 1024 * 1024;
+    }
+    return 64ull * 1024 * 1024;
+}
+
 void DBWriter::open(size_t bufferSize) {
     if (bufferSize == SIZE_MAX) {
-        if (Util::getTotalSystemMemory() < (8ull * 1024 * 1024 * 1024)) {
-            // reduce this buffer if our system does not have much memory
-            // createdb runs into trouble since it creates 2x32 splits with 64MB each (=4GB)
-            // 8MB should be enough
-            bufferSize = 8ull * 1024 * 1024;
-        } else {
-            bufferSize = 64ull * 1024 * 1024;
+        bufferSize = getDefaultBufferSize();
+    }
+    // the dictionary of an older database at this path does not fit the new entries
+    std::string dictionaryFile = DBReader<unsigned int>::dictionaryFileName(dataFileName);
+    if (FileUtil::fileExists(dictionaryFile.c_str())) {
+        FileUtil::remove(dictionaryFile.c_str());
+    }
+    if (shared) {
+        // data files of an earlier split run would be found before the shared data file
+        std::vector<std::string> stale = FileUtil::findDatafiles(dataFileName);
+        for (size_t i = 0; i < stale.size(); i++) {
+            FileUtil::remove(stale[i].c_str());
+        }
+        sharedFd = ::open(dataFileName, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        if (sharedFd == -1) {
+            perror(dataFileName);
+            EXIT(EXIT_FAILURE);
         }
+        sharedSize = 0;
+        delete indexSort;
+        indexSort = new ExternalSort(std::string(indexFileName) + "_sort", bufferSize, threads);
+    }
+    extentSize = bufferSize;
+    if (extents != NULL && AsyncIO::isEnabled()) {
+        // the buffers of a thread together use as much memory as the stdio buffer
+        extentSize = bufferSize / ASYNC_BUFFERS;
+        asyncIO = new AsyncIO*[threads];
     }
     for (unsigned int i = 0; i < threads; i++) {
         dataFileNames[i] = makeResultFilename(dataFileName, i);
         indexFileNames[i] = makeResultFilename(indexFileName, i);
 
-        dataFiles[i] = FileUtil::openAndDelete(dataFileNames[i], datafileMode.c_str());
-        int fd = fileno(dataFiles[i]);
-        int flags;
-        if ((flags = fcntl(fd, F_GETFL, 0)) < 0 || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1) {
-            Debug(Debug::ERROR) << "Can not set mode for " << dataFileNames[i] << "!\n";
-            EXIT(EXIT_FAILURE);
-        }
+        if (shared) {
+            dataFiles[i] = NULL;
+            dataFilesBuffer[i] = NULL;
+            indexFiles[i] = NULL;
+        } else {
+            dataFiles[i] = FileUtil::openAndDelete(dataFileNames[i], datafileMode.c_str());
+            int fd = fileno(dataFiles[i]);
+            int flags;
+            if ((flags = fcntl(fd, F_GETFL, 0)) < 0 || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1) {
+                Debug(Debug::ERROR) << "Can not set mode for " << dataFileNames[i] << "!\n";
+                EXIT(EXIT_FAILURE);
+            }
 
-        dataFilesBuffer[i] = new(std::nothrow) char[bufferSize];
-        Util::checkAllocation(dataFilesBuffer[i], "Cannot allocate buffer for DBWriter");
-        this->bufferSize = bufferSize;
+            // the extents replace the stdio buffer
+            dataFilesBuffer[i] = NULL;
+            if (extents == NULL) {
+                dataFilesBuffer[i] = new(std::nothrow) char[bufferSize];
+                Util::checkAllocation(dataFilesBuffer[i], "Cannot allocate buffer for DBWriter");
 
-        // set buffer to 64
-        if (setvbuf(dataFiles[i], dataFilesBuffer[i], _IOFBF, bufferSize) != 0) {
-            Debug(Debug::WARNING) << "Write buffer could not be allocated (bufferSize=" << bufferSize << ")\n";
-        }
+                // set buffer to 64
+                if (setvbuf(dataFiles[i], dataFilesBuffer[i], _IOFBF, bufferSize) != 0) {
+                    Debug(Debug::WARNING) << "Write buffer could not be allocated (bufferSize=" << bufferSize << ")\n";
+                }
+            }
 
-        indexFiles[i] =  FileUtil::openAndDelete(indexFileNames[i], "w");
-        fd = fileno(indexFiles[i]);
-        if ((flags = fcntl(fd, F_GETFL, 0)) < 0 || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1) {
-            Debug(Debug::ERROR) << "Can not set mode for " << indexFileNames[i] << "!\n";
-            EXIT(EXIT_FAILURE);
-        }
+            indexFiles[i] =  FileUtil::openAndDelete(indexFileNames[i], "w");
+            fd = fileno(indexFiles[i]);
+            if ((flags = fcntl(fd, F_GETFL, 0)) < 0 || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1) {
+                Debug(Debug::ERROR) << "Can not set mode for " << indexFileNames[i] << "!\n";
+                EXIT(EXIT_FAILURE);
+            }
+
+            if (setvbuf(indexFiles[i], NULL, _IOFBF, bufferSize) != 0) {
+                Debug(Debug::WARNING) << "Write buffer could not be allocated (bufferSize=" << bufferSize << ")\n";
+            }
 
-        if (setvbuf(indexFiles[i], NULL, _IOFBF, bufferSize) != 0) {
-            Debug(Debug::WARNING) << "Write buffer could not be allocated (bufferSize=" << bufferSize << ")\n";
+            if (dataFiles[i] == NULL) {
+                perror(dataFileNames[i]);
+                EXIT(EXIT_FAILURE);
+            }
+
+            if (indexFiles[i] == NULL) {
+                perror(indexFileNames[i]);
+                EXIT(EXIT_FAILURE);
+            }
         }
+        this->bufferSize = bufferSize;
 
-        if (dataFiles[i] == NULL) {
-            perror(dataFileNames[i]);
-            EXIT(EXIT_FAILURE);
+        if (extents != NULL) {
+            if (asyncIO != NULL) {
+                asyncIO[i] = new AsyncIO(ASYNC_BUFFERS);
+            }
+            Extent &extent = extents[i];
+            extent.buffer = (char *) malloc(extentSize);
+            Util::checkAllocation(extent.buffer, "Cannot allocate buffer for DBWriter");
+            extent.size = 0;
+            extent.capacity = extentSize;
+            extent.start = 0;
+            extent.entries.clear();
         }
 
-        if (indexFiles[i] == NULL) {
-            perror(indexFileNames[i]);
-            EXIT(EXIT_FAILURE);
+        if (trainDictionary) {
+            holding[i] = true;
+            heldData[i].clear();
+            heldStart[i] = 0;
+            heldEntries[i].clear();
         }
 
         if((mode & Parameters::WRITER_COMPRESSED_MODE) != 0){
@@ -223,6 +357,12 @@ void DBWriter::open(size_t bufferSize) {
         }
     }
 
+    if (trainDictionary) {
+        samples.clear();
+        sampleSizes.clear();
+        dictionary.clear();
+        dictionaryReady = false;
+    }
     closed = false;
 }
 
@@ -244,10 +384,44 @@ void DBWriter::writeDbtypeFile(const char* path, int dbtype, bool isCompressed)
 
 
 void DBWriter::close(bool merge) {
-    // close all datafiles
-    for (unsigned int i = 0; i < threads; i++) {
-        fclose(dataFiles[i]);
-        fclose(indexFiles[i]);
+    if (trainDictionary) {
+        // too few entries were written to complete the sample, all of them are held and are sampled in slot
+        // order, so that the dictionary does not depend on which thread reached the sample first
+        if (dictionaryReady == false) {
+            samples.clear();
+            sampleSizes.clear();
+            for (unsigned int i = 0; i < threads; i++) {
+                size_t start = 0;
+                for (size_t j = 0; j < heldEntries[i].size(); j++) {
+                    const size_t size = heldEntries[i][j].size;
+                    if (size > 0) {
+                        samples.append(heldData[i], start, size);
+                        sampleSizes.push_back(size);
+                    }
+                    start += size;
+                }
+            }
+            createDictionary();
+        }
+#pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+        for (unsigned int i = 0; i < threads; i++) {
+            if (holding[i]) {
+                releaseHeldEntries(i);
+            }
+        }
+    }
+
+    if (shared) {
+        closeShared();
+    } else {
+        if (extents != NULL) {
+            finishExtents();
+        }
+        // close all datafiles
+        for (unsigned int i = 0; i < threads; i++) {
+            fclose(dataFiles[i]);
+            fclose(indexFiles[i]);
+        }
     }
 
     if(compressedBuffers){
@@ -258,8 +432,12 @@ void DBWriter::close(bool merge) {
         }
     }
 
-    mergeResults(dataFileName, indexFileName, (const char **) dataFileNames, (const char **) indexFileNames,
-                 threads, merge, ((mode & Parameters::WRITER_LEXICOGRAPHIC_MODE) != 0));
+    if (shared == false && merge && threads > 1 && (mode & Parameters::WRITER_KEY_ORDER_MODE) != 0) {
+        mergeInKeyOrder();
+    } else if (shared == false) {
+        mergeResults(dataFileName, indexFileName, (const char **) dataFileNames, (const char **) indexFileNames,
+                     threads, merge, ((mode & Parameters::WRITER_LEXICOGRAPHIC_MODE) != 0), writesBinaryIndex());
+    }
 
     writeDbtypeFile(dataFileName, dbtype, (mode & Parameters::WRITER_COMPRESSED_MODE) != 0);
 
@@ -268,21 +446,209 @@ void DBWriter::close(bool merge) {
         free(dataFileNames[i]);
         free(indexFileNames[i]);
     }
+
+    if (trainDictionary) {
+        std::string dictionaryFile = DBReader<unsigned int>::dictionaryFileName(dataFileName);
+        if (dictionary.empty() == false) {
+            FILE *file = FileUtil::openAndDelete(dictionaryFile.c_str(), "wb");
+            if (fwrite(dictionary.c_str(), sizeof(char), dictionary.size(), file) != dictionary.size()) {
+                Debug(Debug::ERROR) << "Can not write to dictionary file " << dictionaryFile << "\n";
+                EXIT(EXIT_FAILURE);
+            }
+            fclose(file);
+        }
+        if (cdict != NULL) {
+            ZSTD_freeCDict(cdict);
+            cdict = NULL;
+        }
+        std::string().swap(dictionary);
+    }
     closed = true;
 }
 
+void DBWriter::holdEntry(unsigned int key, unsigned int thrIdx, bool addNullByte, bool addIndexEntry) {
+    const size_t size = heldData[thrIdx].size() - heldStart[thrIdx];
+    HeldEntry entry = { key, size, addNullByte, addIndexEntry };
+    heldEntries[thrIdx].push_back(entry);
+#pragma omp critical(DBWriterDictionary)
+    {
+        if (dictionaryReady == false && size > 0) {
+            samples.append(heldData[thrIdx], heldStart[thrIdx], size);
+            sampleSizes.push_back(size);
+            if (samples.size() >= DICTIONARY_SAMPLE_SIZE) {
+                createDictionary();
+            }
+        }
+    }
+}
+
+void DBWriter::createDictionary() {
+    dictionary = buildDictionary(samples, sampleSizes, dataFileName);
+    if (dictionary.empty() == false) {
+        cdict = ZSTD_createCDict(dictionary.c_str(), dictionary.size(), 3);
+        if (cdict == NULL) {
+            Debug(Debug::ERROR) << "Can not create compression dictionary for " << dataFileName << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+    }
+    std::string().swap(samples);
+    std::vector<size_t>().swap(sampleSizes);
+    // the other threads pick up the dictionary with their next entry
+    __atomic_store_n(&dictionaryReady, true, __ATOMIC_RELEASE);
+}
+
+void DBWriter::releaseHeldEntries(unsigned int thrIdx) {
+    holding[thrIdx] = false;
+    const char *data = heldData[thrIdx].c_str();
+    for (size_t i = 0; i < heldEntries[thrIdx].size(); i++) {
+        const HeldEntry &entry = heldEntries[thrIdx][i];
+        writeStart(thrIdx);
+        writeAdd(data, entry.size, thrIdx);
+        writeEnd(entry.key, thrIdx, entry.addNullByte, entry.addIndexEntry);
+        data += entry.size;
+    }
+    std::string().swap(heldData[thrIdx]);
+    std::vector<HeldEntry>().swap(heldEntries[thrIdx]);
+}
+
+std::string DBWriter::buildDictionary(const std::string &samples, const std::vector<size_t> &sampleSizes, const char *dataFileName) {
+    std::string dictionary;
+    size_t dictionarySize = 0;
+    if (sampleSizes.size() >= 8) {
+        dictionary.resize(DICTIONARY_CAPACITY);
+        dictionarySize = ZDICT_trainFromBuffer(&dictionary[0], DICTIONARY_CAPACITY, samples.data(), &sampleSizes[0], sampleSizes.size());
+    }
+    if (dictionarySize == 0 || ZDICT_isError(dictionarySize)) {
+        Debug(Debug::INFO) << "Not enough entries to train a compression dictionary for " << FileUtil::baseName(dataFileName) << "\n";
+        dictionary.clear();
+    } else {
+        dictionary.resize(dictionarySize);
+    }
+    return dictionary;
+}
+
+void DBWriter::recompress(const char *dataFileName, const char *indexFileName, int dbtype, bool compressedInput, bool withDictionary, bool binaryIndex) {
+    Timer timer;
+    unsigned int threads = 1;
+#ifdef OPENMP
+    threads = static_cast<unsigned int>(omp_get_max_threads());
+#endif
+    // raw entries, binary results are not decoded
+    DBReader<unsigned int> reader(dataFileName, indexFileName, threads,
+                                  DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA | DBReader<unsigned int>::USE_BINARY);
+    reader.open(DBReader<unsigned int>::NOSORT);
+
+    // about 100 times the dictionary size of evenly spaced entries, as recommended by zstd
+    std::string dictionary;
+    if (withDictionary) {
+        const size_t step = std::max(static_cast<size_t>(1), reader.getDataSize() / DICTIONARY_SAMPLE_SIZE);
+        std::string samples;
+        std::vector<size_t> sampleSizes;
+        for (size_t id = 0; id < reader.getSize(); id += step) {
+            const size_t length = reader.getEntryLen(id);
+            if (length <= 1) {
+                continue;
+            }
+            const char *data = compressedInput ? reader.getData(id, 0) : reader.getDataUncompressed(id);
+            samples.append(data, length - 1);
+            sampleSizes.push_back(length - 1);
+        }
+        dictionary = buildDictionary(samples, sampleSizes, dataFileName);
+    }
+
+    std::string tmpData = std::string(dataFileName) + "_recompress";
+    std::string tmpIndex = tmpData + ".index";
+    size_t mode = withDictionary ? (Parameters::WRITER_COMPRESSED_MODE | Parameters::WRITER_DICTIONARY_MODE) : Parameters::WRITER_ASCII_MODE;
+    if (binaryIndex) {
+        mode |= Parameters::WRITER_BINARY_INDEX_MODE;
+    }
+    DBWriter writer(tmpData.c_str(), tmpIndex.c_str(), threads, mode, dbtype);
+    writer.open();
+    if (dictionary.empty() == false) {
+        writer.cdict = ZSTD_createCDict(dictionary.c_str(), dictionary.size(), 3);
+        if (writer.cdict == NULL) {
+            Debug(Debug::ERROR) << "Can not create compression dictionary for " << dataFileName << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+    }
+    // the entries keep their order in the data file, createdb derives the final keys from it
+    std::vector<std::pair<size_t, size_t> > order(reader.getSize());
+    for (size_t id = 0; id < reader.getSize(); id++) {
+        order[id] = std::make_pair(reader.getOffset(id), id);
+    }
+    std::sort(order.begin(), order.end());
+#pragma omp parallel num_threads(threads)
+    {
+        unsigned int thread_idx = 0;
+#ifdef OPENMP
+        thread_idx = static_cast<unsigned int>(omp_get_thread_num());
+#endif
+
+#pragma omp for schedule(static)
+        for (size_t i = 0; i < order.size(); i++) {
+            const size_t id = order[i].second;
+            const size_t length = reader.getEntryLen(id);
+            const char *data = compressedInput ? reader.getData(id, thread_idx) : reader.getDataUncompressed(id);
+            writer.writeData(data, (length == 0 ? 0 : length - 1), reader.getDbKey(id), thread_idx);
+        }
+    }
+    writer.close(true);
+    if (writer.cdict != NULL) {
+        ZSTD_freeCDict(writer.cdict);
+    }
+    reader.close();
+
+    std::vector<std::string> files = FileUtil::findDatafiles(dataFileName);
+    for (size_t i = 0; i < files.size(); i++) {
+        FileUtil::remove(files[i].c_str());
+    }
+    DBReader<unsigned int>::moveDatafiles(FileUtil::findDatafiles(tmpData.c_str()), dataFileName);
+    FileUtil::move(tmpIndex.c_str(), indexFileName);
+    std::string binaryIndexFile = DBReader<unsigned int>::binaryIndexFileName(indexFileName);
+    if (FileUtil::fileExists(binaryIndexFile.c_str())) {
+        FileUtil::remove(binaryIndexFile.c_str());
+    }
+    std::string tmpBinaryIndex = DBReader<unsigned int>::binaryIndexFileName(tmpIndex);
+    if (FileUtil::fileExists(tmpBinaryIndex.c_str())) {
+        FileUtil::move(tmpBinaryIndex.c_str(), binaryIndexFile.c_str());
+    }
+    if (FileUtil::fileExists((tmpData + ".dbtype").c_str())) {
+        FileUtil::move((tmpData + ".dbtype").c_str(), (std::string(dataFileName) + ".dbtype").c_str());
+    }
+    std::string dictionaryFile = DBReader<unsigned int>::dictionaryFileName(dataFileName);
+    if (dictionary.empty() == false) {
+        FILE *file = FileUtil::openAndDelete(dictionaryFile.c_str(), "wb");
+        if (fwrite(dictionary.c_str(), sizeof(char), dictionary.size(), file) != dictionary.size()) {
+            Debug(Debug::ERROR) << "Can not write to dictionary file " << dictionaryFile << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        fclose(file);
+    } else if (FileUtil::fileExists(dictionaryFile.c_str())) {
+        FileUtil::remove(dictionaryFile.c_str());
+    }
+    Debug(Debug::INFO) << "Time for " << (withDictionary ? "compressing " : "decompressing ") << FileUtil::baseName(dataFileName) << ": " << timer.lap() << "\n";
+}
+
 void DBWriter::writeStart(unsigned int thrIdx) {
     checkClosed();
     if (thrIdx >= threads) {
         Debug(Debug::ERROR) << "Thread index " << thrIdx << " > maximum thread number " << threads << "\n";
         EXIT(EXIT_FAILURE);
     }
+    if (trainDictionary && holding[thrIdx]) {
+        if (__atomic_load_n(&dictionaryReady, __ATOMIC_ACQUIRE) == false) {
+            heldStart[thrIdx] = heldData[thrIdx].size();
+            return;
+        }
+        releaseHeldEntries(thrIdx);
+    }
     starts[thrIdx] = offsets[thrIdx];
     if((mode & Parameters::WRITER_COMPRESSED_MODE) != 0){
         state[thrIdx] = INIT_STATE;
         threadBufferOffset[thrIdx]=0;
         int cLevel = 3;
-        size_t const initResult = ZSTD_initCStream(cstream[thrIdx], cLevel);
+        size_t const initResult = (cdict != NULL) ? ZSTD_initCStream_usingCDict(cstream[thrIdx], cdict)
+                                                  : ZSTD_initCStream(cstream[thrIdx], cLevel);
         if (ZSTD_isError(initResult)) {
             Debug(Debug::ERROR) << "ZSTD_initCStream() error in thread " << thrIdx << ". Error "
                                 << ZSTD_getErrorName(initResult) << "\n";
@@ -297,6 +663,10 @@ size_t DBWriter::writeAdd(const char* data, size_t dataSize, unsigned int thrIdx
         Debug(Debug::ERROR) << "Thread index " << thrIdx << " > maximum thread number " << threads << "\n";
         EXIT(EXIT_FAILURE);
     }
+    if (trainDictionary && holding[thrIdx]) {
+        heldData[thrIdx].append(data, dataSize);
+        return 0;
+    }
     bool isCompressedDB = (mode & Parameters::WRITER_COMPRESSED_MODE) != 0;
     if(isCompressedDB && state[thrIdx] == INIT_STATE && dataSize < 60){
         state[thrIdx] = NOTCOMPRESSED;
@@ -327,7 +697,7 @@ size_t DBWriter::writeAdd(const char* data, size_t dataSize, unsigned int thrIdx
         if(isCompressedDB){
             written = addToThreadBuffer(data, sizeof(char), dataSize,  thrIdx);
         }else{
-            written = fwrite(data, sizeof(char), dataSize, dataFiles[thrIdx]);
+            written = writeToDataFile(data, dataSize, thrIdx);
         }
         if (written != dataSize) {
             Debug(Debug::ERROR) << "Can not write to data file " << dataFileNames[thrIdx] << "\n";
@@ -340,6 +710,10 @@ size_t DBWriter::writeAdd(const char* data, size_t dataSize, unsigned int thrIdx
 }
 
 void DBWriter::writeEnd(unsigned int key, unsigned int thrIdx, bool addNullByte, bool addIndexEntry) {
+    if (trainDictionary && holding[thrIdx]) {
+        holdEntry(key, thrIdx, addNullByte, addIndexEntry);
+        return;
+    }
     // close stream
     bool isCompressedDB = (mode & Parameters::WRITER_COMPRESSED_MODE) != 0;
     if(isCompressedDB) {
@@ -369,8 +743,8 @@ void DBWriter::writeEnd(unsigned int key, unsigned int thrIdx, bool addNullByte,
             compressedLength = offsets[thrIdx] - starts[thrIdx];
         }
         unsigned int compressedLengthInt = static_cast<unsigned int>(compressedLength);
-        size_t written2 = fwrite(&compressedLengthInt, sizeof(unsigned int), 1, dataFiles[thrIdx]);
-        if (written2 != 1) {
+        size_t written2 = writeToDataFile(&compressedLengthInt, sizeof(unsigned int), thrIdx);
+        if (written2 != sizeof(unsigned int)) {
             Debug(Debug::ERROR) << "Can not write entry length to data file " << dataFileNames[thrIdx] << "\n";
             EXIT(EXIT_FAILURE);
         }
@@ -386,7 +760,7 @@ void DBWriter::writeEnd(unsigned int key, unsigned int thrIdx, bool addNullByte,
         if(isCompressedDB && state[thrIdx]==NOTCOMPRESSED){
             nullByte = static_cast<char>(0xFF);
         }
-        const size_t written = fwrite(&nullByte, sizeof(char), 1, dataFiles[thrIdx]);
+        const size_t written = writeToDataFile(&nullByte, sizeof(char), thrIdx);
         if (written != 1) {
             Debug(Debug::ERROR) << "Can not write to data file " << dataFileNames[thrIdx] << "\n";
             EXIT(EXIT_FAILURE);
@@ -406,10 +780,26 @@ void DBWriter::writeEnd(unsigned int key, unsigned int thrIdx, bool addNullByte,
             length -= sizeof(unsigned int);
         }
         writeIndexEntry(key, starts[thrIdx], length, thrIdx);
+        // extents end with a complete entry
+        if (shared && extents[thrIdx].size >= extentSize / 2) {
+            flushExtent(thrIdx);
+        }
     }
 }
 
 void DBWriter::writeIndexEntry(unsigned int key, size_t offset, size_t length, unsigned int thrIdx){
+    if (shared) {
+        if (offset < extents[thrIdx].start) {
+            Debug(Debug::ERROR) << "Index entry " << key << " points to data that was already written to " << dataFileName << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        DBReader<unsigned int>::Index entry;
+        entry.id = key;
+        entry.offset = offset;
+        entry.length = length;
+        extents[thrIdx].entries.push_back(entry);
+        return;
+    }
     char buffer[1024];
     size_t len = indexToBuffer(buffer, key, offset, length );
     size_t written = fwrite(buffer, sizeof(char), len, indexFiles[thrIdx]);
@@ -444,7 +834,7 @@ void DBWriter::alignToPageSize(int thrIdx) {
     size_t newOffset = ((pageSize - 1) & currentOffset) ? ((currentOffset + pageSize) & ~(pageSize - 1)) : currentOffset;
     char nullByte = '\0';
     for (size_t i = currentOffset; i < newOffset; ++i) {
-        size_t written = fwrite(&nullByte, sizeof(char), 1, dataFiles[thrIdx]);
+        size_t written = writeToDataFile(&nullByte, sizeof(char), thrIdx);
         if (written != 1) {
             Debug(Debug::ERROR) << "Can not write to data file " << dataFileNames[thrIdx] << "\n";
             EXIT(EXIT_FAILURE);
@@ -454,6 +844,10 @@ void DBWriter::alignToPageSize(int thrIdx) {
 }
 
 
+bool DBWriter::writesBinaryIndex() const {
+    return (mode & Parameters::WRITER_BINARY_INDEX_MODE) != 0 && dbtype != Parameters::DBTYPE_OMIT_FILE;
+}
+
 void DBWriter::checkClosed() {
     if (closed == true) {
         Debug(Debug::ERROR) << "Trying to read a closed database. Datafile=" << dataFileName  << "\n";
@@ -463,14 +857,28 @@ void DBWriter::checkClosed() {
 
 void DBWriter::mergeResults(const std::string &outFileName, const std::string &outFileNameIndex,
                             const std::vector<std::pair<std::string, std::string >> &files,
-                            const bool lexicographicOrder) {
+                            bool binaryIndex, const bool lexicographicOrder) {
+    // splits with their own dictionary can not be concatenated, they are merged uncompressed and compressed again
+    bool hasDictionary = false;
+    for (size_t i = 0; i < files.size(); i++) {
+        hasDictionary = hasDictionary || FileUtil::fileExists(DBReader<unsigned int>::dictionaryFileName(files[i].first).c_str());
+    }
+    hasDictionary = hasDictionary && lexicographicOrder == false;
+    if (hasDictionary) {
+        for (size_t i = 0; i < files.size(); i++) {
+            const bool hasType = FileUtil::fileExists((files[i].first + ".dbtype").c_str());
+            recompress(files[i].first.c_str(), files[i].second.c_str(),
+                       hasType ? FileUtil::parseDbType(files[i].first.c_str()) : Parameters::DBTYPE_OMIT_FILE, true, false, false);
+        }
+    }
+
     const char **datafilesNames = new const char *[files.size()];
     const char **indexFilesNames = new const char *[files.size()];
     for (size_t i = 0; i < files.size(); i++) {
         datafilesNames[i] = files[i].first.c_str();
         indexFilesNames[i] = files[i].second.c_str();
     }
-    mergeResults(outFileName.c_str(), outFileNameIndex.c_str(), datafilesNames, indexFilesNames, files.size(), true, lexicographicOrder);
+    mergeResults(outFileName.c_str(), outFileNameIndex.c_str(), datafilesNames, indexFilesNames, files.size(), true, lexicographicOrder, binaryIndex);
     delete[] datafilesNames;
     delete[] indexFilesNames;
 
@@ -488,6 +896,12 @@ void DBWriter::mergeResults(const std::string &outFileName, const std::string &o
             }
         }
     }
+
+    if (hasDictionary) {
+        const bool hasType = FileUtil::fileExists((outFileName + ".dbtype").c_str());
+        recompress(outFileName.c_str(), outFileNameIndex.c_str(),
+                   hasType ? FileUtil::parseDbType(outFileName.c_str()) : Parameters::DBTYPE_OMIT_FILE, false, true, binaryIndex);
+    }
 }
 
 template <>
@@ -539,9 +953,201 @@ void DBWriter::writeIndex(FILE *outFile, size_t indexSize, DBReader<std::string>
 }
 
 
+void DBWriter::closeShared() {
+    Timer timer;
+    finishExtents();
+    if (::close(sharedFd) != 0) {
+        Debug(Debug::ERROR) << "Can not close data file " << dataFileName << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    sharedFd = -1;
+
+    indexSort->finish();
+    FILE *indexFile = FileUtil::openAndDelete(indexFileName, "w");
+    char buffer[1024];
+    unsigned int key;
+    const char *data;
+    size_t size;
+    while (indexSort->next(key, data, size)) {
+        size_t entry[2];
+        memcpy(entry, data, sizeof(entry));
+        size_t len = indexToBuffer(buffer, key, entry[0], entry[1]);
+        if (fwrite(buffer, sizeof(char), len, indexFile) != len) {
+            Debug(Debug::ERROR) << "Can not write to index file " << indexFileName << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+    }
+    if (fclose(indexFile) != 0) {
+        Debug(Debug::ERROR) << "Can not write to index file " << indexFileName << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    delete indexSort;
+    indexSort = NULL;
+
+    updateBinaryIndex(indexFileName, writesBinaryIndex());
+    Debug(Debug::INFO) << "Time for merging to " << FileUtil::baseName(dataFileName) << ": " << timer.lap() << "\n";
+}
+
+void DBWriter::mergeInKeyOrder() {
+    Timer timer;
+    // the entries of a thread are in key order and follow each other in its data file
+    std::vector<std::vector<DBReader<unsigned int>::Index> > entries(threads);
+    std::vector<std::vector<size_t> > sizes(threads);
+    std::vector<FILE *> inputs(threads);
+    std::priority_queue<std::pair<unsigned int, size_t>, std::vector<std::pair<unsigned int, size_t> >, std::greater<std::pair<unsigned int, size_t> > > queue;
+    for (unsigned int i = 0; i < threads; i++) {
+        DBReader<unsigned int> reader(indexFileNames[i], indexFileNames[i], 1, DBReader<unsigned int>::USE_INDEX);
+        reader.open(DBReader<unsigned int>::HARDNOSORT);
+        entries[i].assign(reader.getIndex(), reader.getIndex() + reader.getSize());
+        reader.close();
+
+        inputs[i] = fopen(dataFileNames[i], "r");
+        if (inputs[i] == NULL) {
+            Debug(Debug::ERROR) << "Can not open result file " << dataFileNames[i] << "!\n";
+            EXIT(EXIT_FAILURE);
+        }
+        struct stat sb;
+        if (fstat(fileno(inputs[i]), &sb) < 0) {
+            Debug(Debug::ERROR) << "Failed to fstat file " << dataFileNames[i] << ". Error " << errno << ".\n";
+            EXIT(EXIT_FAILURE);
+        }
+        sizes[i].resize(entries[i].size());
+        for (size_t j = 0; j < entries[i].size(); j++) {
+            const size_t end = (j + 1 < entries[i].size()) ? entries[i][j + 1].offset : static_cast<size_t>(sb.st_size);
+            sizes[i][j] = end - entries[i][j].offset;
+        }
+        if (entries[i].empty() == false) {
+            queue.push(std::make_pair(entries[i][0].id, static_cast<size_t>(i)));
+        }
+    }
+
+    FILE *dataFile = FileUtil::openAndDelete(dataFileName, "w");
+    FILE *indexFile = FileUtil::openAndDelete(indexFileName, "w");
+    std::vector<size_t> positions(threads, 0);
+    std::vector<char> buffer(1024 * 1024);
+    char indexBuffer[1024];
+    size_t offset = 0;
+    while (queue.empty() == false) {
+        const size_t thread = queue.top().second;
+        queue.pop();
+        DBReader<unsigned int>::Index &entry = entries[thread][positions[thread]];
+        size_t remaining = sizes[thread][positions[thread]];
+        while (remaining > 0) {
+            const size_t chunk = std::min(remaining, buffer.size());
+            if (fread(&buffer[0], sizeof(char), chunk, inputs[thread]) != chunk
+                || fwrite(&buffer[0], sizeof(char), chunk, dataFile) != chunk) {
+                Debug(Debug::ERROR) << "Can not merge " << dataFileNames[thread] << " into " << dataFileName << "\n";
+                EXIT(EXIT_FAILURE);
+            }
+            remaining -= chunk;
+        }
+        entry.offset = offset;
+        offset += sizes[thread][positions[thread]];
+        writeIndexEntryToFile(indexFile, indexBuffer, entry);
+        positions[thread]++;
+        if (positions[thread] < entries[thread].size()) {
+            queue.push(std::make_pair(entries[thread][positions[thread]].id, thread));
+        }
+    }
+    if (fclose(dataFile) != 0 || fclose(indexFile) != 0) {
+        Debug(Debug::ERROR) << "Can not write to data file " << dataFileName << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    for (unsigned int i = 0; i < threads; i++) {
+        fclose(inputs[i]);
+        FileUtil::remove(dataFileNames[i]);
+        FileUtil::remove(indexFileNames[i]);
+    }
+
+    updateBinaryIndex(indexFileName, writesBinaryIndex());
+    Debug(Debug::INFO) << "Time for merging to " << FileUtil::baseName(dataFileName) << ": " << timer.lap() << "\n";
+}
+
+void DBWriter::finishExtents() {
+    for (unsigned int i = 0; i < threads; i++) {
+        flushExtent(i);
+        if (asyncIO != NULL) {
+            // waits for the queued writes
+            delete asyncIO[i];
+        }
+        free(extents[i].buffer);
+        extents[i].buffer = NULL;
+    }
+    delete[] asyncIO;
+    asyncIO = NULL;
+}
+
+void DBWriter::flushExtent(unsigned int thrIdx) {
+    Extent &extent = extents[thrIdx];
+    if (extent.size == 0) {
+        return;
+    }
+    size_t fileOffset = extent.start;
+    int fd = -1;
+    if (shared) {
+        fileOffset = __sync_fetch_and_add(&sharedSize, extent.size);
+        fd = sharedFd;
+#ifdef __linux__
+        // only a hint to allocate the extent in one piece, pwrite allocates it otherwise
+        fallocate(sharedFd, 0, fileOffset, extent.size);
+#endif
+    } else {
+        fd = fileno(dataFiles[thrIdx]);
+    }
+    if (asyncIO != NULL) {
+        asyncIO[thrIdx]->write(fd, extent.buffer, extent.capacity, extent.size, fileOffset);
+        extent.buffer = asyncIO[thrIdx]->takeBuffer(extent.capacity);
+        if (extent.buffer == NULL) {
+            extent.capacity = extentSize;
+            extent.buffer = (char *) malloc(extent.capacity);
+            Util::checkAllocation(extent.buffer, "Cannot allocate buffer for DBWriter");
+        }
+    } else {
+        size_t written = 0;
+        while (written < extent.size) {
+            ssize_t result = pwrite(fd, extent.buffer + written, extent.size - written, fileOffset + written);
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result <= 0) {
+                Debug(Debug::ERROR) << "Can not write to data file " << dataFileName << "\n";
+                EXIT(EXIT_FAILURE);
+            }
+            written += result;
+        }
+    }
+    for (size_t i = 0; i < extent.entries.size(); i++) {
+        const size_t entry[2] = { fileOffset + (extent.entries[i].offset - extent.start), extent.entries[i].length };
+        indexSort->add(extent.entries[i].id, reinterpret_cast<const char *>(entry), sizeof(entry), thrIdx);
+    }
+    extent.entries.clear();
+    extent.start += extent.size;
+    extent.size = 0;
+}
+
+size_t DBWriter::writeToDataFile(const void *data, size_t dataSize, unsigned int thrIdx) {
+    if (extents == NULL) {
+        return fwrite(data, sizeof(char), dataSize, dataFiles[thrIdx]);
+    }
+    Extent &extent = extents[thrIdx];
+    // the data file of a thread continues at the end of the last extent
+    if (shared == false && extent.size + dataSize > extent.capacity) {
+        flushExtent(thrIdx);
+    }
+    if (extent.size + dataSize > extent.capacity) {
+        // an entry can not be split between shared extents
+        extent.capacity = std::max(extent.capacity * 2, extent.size + dataSize);
+        extent.buffer = (char *) realloc(extent.buffer, extent.capacity);
+        Util::checkAllocation(extent.buffer, "Cannot allocate buffer for DBWriter");
+    }
+    memcpy(extent.buffer + extent.size, data, dataSize);
+    extent.size += dataSize;
+    return dataSize;
+}
+
 void DBWriter::mergeResults(const char *outFileName, const char *outFileNameIndex,
                             const char **dataFileNames, const char **indexFileNames,
-                            unsigned long fileCount, bool mergeDatafiles, bool lexicographicOrder) {
+                            unsigned long fileCount, bool mergeDatafiles, bool lexicographicOrder, bool binaryIndex) {
     Timer timer;
     std::vector<std::vector<std::string>> dataFilenames;
     for (unsigned int i = 0; i < fileCount; ++i) {
@@ -605,7 +1211,7 @@ void DBWriter::mergeResults(const char *outFileName, const char *outFileNameInde
         }
     }
 
-    DBWriter::sortIndex(indexFileNames[0], outFileNameIndex, lexicographicOrder);
+    DBWriter::sortIndex(indexFileNames[0], outFileNameIndex, lexicographicOrder, binaryIndex);
     FileUtil::remove(indexFileNames[0]);
     Debug(Debug::INFO) << "Time for merging to " << FileUtil::baseName(outFileName) << ": " << timer.lap() << "\n";
 }
@@ -636,7 +1242,11 @@ void DBWriter::mergeIndex(const char** indexFilenames, unsigned int fileCount, c
     fclose(index_file);
 }
 
-void DBWriter::sortIndex(const char *inFileNameIndex, const char *outFileNameIndex, const bool lexicographicOrder){
+void DBWriter::sortIndex(const char *inFileNameIndex, const char *outFileNameIndex, const bool lexicographicOrder, const bool binaryIndex){
+    std::string binaryIndexFile = DBReader<unsigned int>::binaryIndexFileName(outFileNameIndex);
+    if (FileUtil::fileExists(binaryIndexFile.c_str())) {
+        FileUtil::remove(binaryIndexFile.c_str());
+    }
     if (lexicographicOrder == false) {
         // sort the index
         DBReader<unsigned int> indexReader(inFileNameIndex, inFileNameIndex, 1, DBReader<unsigned int>::USE_INDEX);
@@ -645,6 +1255,9 @@ void DBWriter::sortIndex(const char *inFileNameIndex, const char *outFileNameInd
         FILE *index_file  = FileUtil::openAndDelete(outFileNameIndex, "w");
         writeIndex(index_file, indexReader.getSize(), index);
         fclose(index_file);
+        if (binaryIndex) {
+            writeBinaryIndex(outFileNameIndex, indexReader);
+        }
         indexReader.close();
 
     } else {
@@ -658,15 +1271,80 @@ void DBWriter::sortIndex(const char *inFileNameIndex, const char *outFileNameInd
     }
 }
 
+void DBWriter::writeBinaryIndex(const char *indexFileName, DBReader<unsigned int> &reader) {
+    typedef DBReader<unsigned int>::Index Index;
+    DBReader<unsigned int>::BinaryIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "MMSIDX\0\0", 8);
+    header.version = DBReader<unsigned int>::BINARY_INDEX_VERSION;
+    header.entrySize = sizeof(Index);
+    header.size = reader.getSize();
+    header.dataSize = reader.getDataSize();
+    header.maxSeqLen = reader.getMaxSeqLen();
+    header.lastKey = reader.getLastKey();
+
+    Index *index = reader.getIndex();
+    bool sortedById = true;
+    bool sortedByOffset = true;
+    for (size_t i = 1; i < header.size; i++) {
+        sortedById = sortedById && index[i - 1].id <= index[i].id;
+        sortedByOffset = sortedByOffset && index[i - 1].offset <= index[i].offset;
+    }
+    header.flags = (sortedById ? DBReader<unsigned int>::BINARY_INDEX_SORTED_BY_ID : 0)
+                   | (sortedByOffset ? DBReader<unsigned int>::BINARY_INDEX_SORTED_BY_OFFSET : 0);
+    if (DBReader<unsigned int>::getTextIndexStamp(indexFileName, header) == false) {
+        Debug(Debug::ERROR) << "Can not stat index file " << indexFileName << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+
+    // written next to the old binary index and renamed, the index might be a mapping of the old one
+    std::string binaryIndexFile = DBReader<unsigned int>::binaryIndexFileName(indexFileName);
+    std::string binaryIndexTmp = binaryIndexFile + "_tmp";
+    FILE *file = FileUtil::openAndDelete(binaryIndexTmp.c_str(), "w");
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    // copied in blocks to write zeroed padding bytes
+    const size_t blockSize = 4096;
+    Index *block = new Index[blockSize];
+    memset(block, 0, blockSize * sizeof(Index));
+    for (size_t start = 0; start < header.size; start += blockSize) {
+        const size_t count = std::min(blockSize, header.size - start);
+        for (size_t i = 0; i < count; i++) {
+            block[i].id = index[start + i].id;
+            block[i].offset = index[start + i].offset;
+            block[i].length = index[start + i].length;
+        }
+        written = written && fwrite(block, sizeof(Index), count, file) == count;
+    }
+    delete[] block;
+    if (fclose(file) != 0 || written == false) {
+        Debug(Debug::ERROR) << "Could not write binary index " << binaryIndexFile << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    std::rename(binaryIndexTmp.c_str(), binaryIndexFile.c_str());
+}
+
+void DBWriter::updateBinaryIndex(const char *indexFileName, bool binaryIndex) {
+    std::string binaryIndexFile = DBReader<unsigned int>::binaryIndexFileName(indexFileName);
+    if (FileUtil::fileExists(binaryIndexFile.c_str())) {
+        FileUtil::remove(binaryIndexFile.c_str());
+    }
+    if (binaryIndex) {
+        DBReader<unsigned int> reader(indexFileName, indexFileName, 1, DBReader<unsigned int>::USE_INDEX);
+        reader.open(DBReader<unsigned int>::HARDNOSORT);
+        writeBinaryIndex(indexFileName, reader);
+        reader.close();
+    }
+}
+
 void DBWriter::writeThreadBuffer(unsigned int idx, size_t dataSize) {
-    size_t written = fwrite(threadBuffer[idx], 1, dataSize, dataFiles[idx]);
+    size_t written = writeToDataFile(threadBuffer[idx], dataSize, idx);
     if (written != dataSize) {
         Debug(Debug::ERROR) << "writeThreadBuffer: Could not write to data file " << dataFileNames[idx] << "\n";
         EXIT(EXIT_FAILURE);
     }
 }
 
-void DBWriter::createRenumberedDB(const std::string& dataFile, const std::string& indexFile, const std::string& origData, const std::string& origIndex, int sortMode) {
+void DBWriter::createRenumberedDB(const std::string& dataFile, const std::string& indexFile, const std::string& origData, const std::string& origIndex, bool binaryIndex, int sortMode) {
     DBReader<unsigned int>* lookupReader = NULL;
     FILE *sLookup = NULL;
     if (origData.empty() == false && origIndex.empty() == false) {
@@ -709,6 +1387,7 @@ void DBWriter::createRenumberedDB(const std::string& dataFile, const std::string
     fclose(sIndex);
     reader.close();
     std::rename(indexTmp.c_str(), indexFile.c_str());
+    updateBinaryIndex(indexFile.c_str(), binaryIndex);
 
     if (lookupReader != NULL) {
         fclose(sLookup);
@@ -2,12 +2,18 @@
 #define DBWRITER_H
 // For parallel write access, one each thread creates its own DB
 // After the parallel calculation are done, all DBs are merged into single DB
+// In shared mode the threads write directly into the final data file and only the index is merged
+// In key order mode the entries of all threads are interleaved by key while merging
+// With --io-uring the data is buffered in extents that are written asynchronously
 
 #include <string>
 #include <vector>
 
 #include "DBReader.h"
 
+class AsyncIO;
+class ExternalSort;
+
 template <typename T> class DBReader;
 
 class DBWriter {
@@ -18,6 +24,9 @@ public:
 
     void open(size_t bufferSize = SIZE_MAX);
 
+    // per thread buffer size of open, smaller if the MemoryBudget has less than 8 GB available
+    static size_t getDefaultBufferSize();
+
     void close(bool merge = false);
 
     char* getDataFileName() { return dataFileName; }
@@ -38,16 +47,24 @@ public:
                     const std::vector<std::pair<std::string, std::string> >& files,
                     const std::vector<std::string>& prefixes);
 
-    void sortDatafileByIdOrder(DBReader<unsigned int>& qdbr);
+    // rewrites the entries of dbr in id order, reads the data into memory if it fits into memoryLimit
+    // and sorts it on disk with ExternalSort otherwise
+    void sortDatafileByIdOrder(DBReader<unsigned int>& qdbr, size_t memoryLimit);
 
     static void mergeResults(const std::string &outFileName, const std::string &outFileNameIndex,
                              const std::vector<std::pair<std::string, std::string>> &files,
-                             bool lexicographicOrder = false);
+                             bool binaryIndex, bool lexicographicOrder = false);
 
     void writeIndexEntry(unsigned int key, size_t offset, size_t length, unsigned int thrIdx);
 
     static void writeDbtypeFile(const char* path, int dbtype, bool isCompressed);
 
+    // writes the binary index sidecar of the text index that the reader was opened from
+    static void writeBinaryIndex(const char *indexFileName, DBReader<unsigned int> &reader);
+
+    // the text index was replaced, writes a new binary index if binaryIndex is set or removes the old one
+    static void updateBinaryIndex(const char *indexFileName, bool binaryIndex);
+
     size_t getStart(unsigned int threadIdx){
         return starts[threadIdx];
     }
@@ -62,7 +79,7 @@ public:
     template <typename T>
     static void writeIndexEntryToFile(FILE *outFile, char *buff1, T &index);
 
-    static void createRenumberedDB(const std::string& dataFile, const std::string& indexFile, const std::string& origData, const std::string& origIndex, int sortMode = DBReader<unsigned int>::SORT_BY_ID_OFFSET);
+    static void createRenumberedDB(const std::string& dataFile, const std::string& indexFile, const std::string& origData, const std::string& origIndex, bool binaryIndex, int sortMode = DBReader<unsigned int>::SORT_BY_ID_OFFSET);
 
     bool isClosed(){
         return closed;
@@ -71,15 +88,50 @@ private:
     size_t addToThreadBuffer(const void *data, size_t itmesize, size_t nitems, int threadIdx);
     void writeThreadBuffer(unsigned int idx, size_t dataSize);
 
+    // fwrite to the data file of the thread or append to its extent buffer in shared mode
+    size_t writeToDataFile(const void *data, size_t dataSize, unsigned int thrIdx);
+
+    // reserves an extent at the end of the shared data file and writes the buffered entries into it,
+    // the data file of a thread is continued at its end
+    void flushExtent(unsigned int thrIdx);
+
+    // flushes the extents of all threads and waits until they are written
+    void finishExtents();
+
+    // merges the sorted index runs of all threads into the index file
+    void closeShared();
+
+    // interleaves the entries of the thread data files by key, the entries are copied without recompression
+    void mergeInKeyOrder();
+
     void checkClosed();
 
+    // files that are not a database do not get a binary index
+    bool writesBinaryIndex() const;
+
     static void mergeResults(const char *outFileName, const char *outFileNameIndex,
                              const char **dataFileNames, const char **indexFileNames,
-                             unsigned long fileCount, bool mergeDatafiles, bool lexicographicOrder = false);
+                             unsigned long fileCount, bool mergeDatafiles, bool lexicographicOrder,
+                             bool binaryIndex);
 
     static void mergeIndex(const char** indexFilenames, unsigned int fileCount, const std::vector<size_t> &dataSizes);
 
-    static void sortIndex(const char *inFileNameIndex, const char *outFileNameIndex, const bool lexicographicOrder);
+    static void sortIndex(const char *inFileNameIndex, const char *outFileNameIndex, const bool lexicographicOrder, const bool binaryIndex);
+
+    // rewrites all entries of a database, compressed with a dictionary trained on a sample of them or uncompressed
+    static void recompress(const char *dataFileName, const char *indexFileName, int dbtype, bool compressedInput, bool withDictionary, bool binaryIndex);
+
+    // zstd dictionary of the samples, empty if there are too few of them
+    static std::string buildDictionary(const std::string &samples, const std::vector<size_t> &sampleSizes, const char *dataFileName);
+
+    // keeps the current entry of a thread uncompressed and adds it to the dictionary samples
+    void holdEntry(unsigned int key, unsigned int thrIdx, bool addNullByte, bool addIndexEntry);
+
+    // trains the dictionary on the samples, called by the thread whose entry completes the sample
+    void createDictionary();
+
+    // compresses the held entries of a thread with the dictionary
+    void releaseHeldEntries(unsigned int thrIdx);
 
     char* dataFileName;
     char* indexFileName;
@@ -105,8 +157,52 @@ private:
     static const int COMPRESSED=2;
 
     ZSTD_CStream** cstream;
+    ZSTD_CDict* cdict;
+
+    // with a dictionary to train the threads keep their first entries uncompressed until the dictionary was
+    // trained on a sample of DICTIONARY_SAMPLE_SIZE bytes, afterwards they compress them and all further entries
+    static const size_t DICTIONARY_CAPACITY = 112640;
+    static const size_t DICTIONARY_SAMPLE_SIZE = 100 * DICTIONARY_CAPACITY;
+    struct HeldEntry {
+        unsigned int key;
+        size_t size;
+        bool addNullByte;
+        bool addIndexEntry;
+    };
+    bool *holding;
+    std::string *heldData;
+    size_t *heldStart;
+    std::vector<HeldEntry> *heldEntries;
+    std::string samples;
+    std::vector<size_t> sampleSizes;
+    std::string dictionary;
+    bool dictionaryReady;
+
+    // offsets of a thread count from the start of its own output, the entries of an extent are moved
+    // to their position in the file and handed to indexSort when the extent is flushed
+    struct Extent {
+        char *buffer;
+        size_t size;
+        size_t capacity;
+        size_t start;
+        std::vector<DBReader<unsigned int>::Index> entries;
+        char padding[64];
+    };
+    Extent *extents;
+    size_t extentSize;
+    int sharedFd;
+    size_t sharedSize;
+    // buffers per thread that are written asynchronously
+    static const unsigned int ASYNC_BUFFERS = 4;
+    AsyncIO **asyncIO;
+    // index entries of the flushed shared extents, a thread spills a sorted run once its entries
+    // use as much memory as its write buffer
+    ExternalSort *indexSort;
 
     const unsigned int threads;
+    // compressed entries use a dictionary that is trained while writing
+    const bool trainDictionary;
+    const bool shared;
     const size_t mode;
     int dbtype;
 
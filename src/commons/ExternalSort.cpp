@@ -0,0 +1,156 @@
+#include "ExternalSort.h"
+#include "Debug.h"
+#include "FileUtil.h"
+#include "Util.h"
+
+#include "omptl/omptl_algorithm"
+
+#include <algorithm>
+#include <climits>
+
+ExternalSort::ExternalSort(const std::string &tmpPrefix, size_t memoryBudget, unsigned int threads) :
+        tmpPrefix(tmpPrefix), memoryBudget(memoryBudget / std::max(threads, 1u)), buffers(std::max(threads, 1u)),
+        nextRecord(0), currentRun(SIZE_MAX) {}
+
+ExternalSort::~ExternalSort() {
+    for (size_t i = 0; i < runs.size(); ++i) {
+        if (runs[i].file != NULL) {
+            fclose(runs[i].file);
+        }
+    }
+    for (size_t i = 0; i < runFileNames.size(); ++i) {
+        if (FileUtil::fileExists(runFileNames[i].c_str())) {
+            FileUtil::remove(runFileNames[i].c_str());
+        }
+    }
+}
+
+void ExternalSort::add(unsigned int key, const char *data, size_t size, unsigned int thread) {
+    Buffer &current = buffers[thread];
+    const size_t needed = current.data.size() + size + (current.records.size() + 1) * sizeof(Record);
+    if (current.records.empty() == false && needed > memoryBudget) {
+        writeRun(thread);
+    }
+    // grow the buffer geometrically, but not beyond the budget
+    std::vector<char> &buffer = current.data;
+    if (buffer.size() + size > buffer.capacity()) {
+        size_t capacity = std::max(buffer.capacity() * 2, buffer.size() + size);
+        capacity = std::max(std::min(capacity, memoryBudget), buffer.size() + size);
+        buffer.reserve(capacity);
+    }
+    Record record;
+    record.key = key;
+    record.thread = thread;
+    record.offset = buffer.size();
+    record.size = size;
+    current.records.push_back(record);
+    buffer.insert(buffer.end(), data, data + size);
+}
+
+void ExternalSort::writeRun(unsigned int thread) {
+    Buffer &current = buffers[thread];
+    omptl::sort(current.records.begin(), current.records.end(), compareRecord);
+    // the runs of a thread are numbered in the order they are written, the merge keeps equal keys in that order
+    std::string name;
+#pragma omp critical(ExternalSortRun)
+    {
+        name = tmpPrefix + ".run." + SSTR(runFileNames.size());
+        runFileNames.push_back(name);
+    }
+    FILE *file = FileUtil::openAndDelete(name.c_str(), "w");
+    for (size_t i = 0; i < current.records.size(); ++i) {
+        const Record &record = current.records[i];
+        if (fwrite(&record.key, sizeof(unsigned int), 1, file) != 1
+            || fwrite(&record.size, sizeof(size_t), 1, file) != 1
+            || fwrite(current.data.data() + record.offset, sizeof(char), record.size, file) != record.size) {
+            Debug(Debug::ERROR) << "Could not write to sort run " << name << "!\n";
+            EXIT(EXIT_FAILURE);
+        }
+    }
+    if (fclose(file) != 0) {
+        Debug(Debug::ERROR) << "Could not close sort run " << name << "!\n";
+        EXIT(EXIT_FAILURE);
+    }
+    current.data.clear();
+    current.records.clear();
+}
+
+bool ExternalSort::readRecord(size_t run) {
+    Run &current = runs[run];
+    size_t size;
+    if (fread(&current.key, sizeof(unsigned int), 1, current.file) != 1) {
+        return false;
+    }
+    if (fread(&size, sizeof(size_t), 1, current.file) != 1) {
+        Debug(Debug::ERROR) << "Sort run " << runFileNames[run] << " is truncated!\n";
+        EXIT(EXIT_FAILURE);
+    }
+    current.data.resize(size);
+    if (size > 0 && fread(&current.data[0], sizeof(char), size, current.file) != size) {
+        Debug(Debug::ERROR) << "Sort run " << runFileNames[run] << " is truncated!\n";
+        EXIT(EXIT_FAILURE);
+    }
+    return true;
+}
+
+void ExternalSort::finish() {
+    if (runFileNames.empty()) {
+        // all records are still in the buffers, they are sorted together
+        size_t count = 0;
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            count += buffers[i].records.size();
+        }
+        records.reserve(count);
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            records.insert(records.end(), buffers[i].records.begin(), buffers[i].records.end());
+            std::vector<Record>().swap(buffers[i].records);
+        }
+        omptl::sort(records.begin(), records.end(), compareRecord);
+        nextRecord = 0;
+        return;
+    }
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        if (buffers[i].records.empty() == false) {
+            writeRun(static_cast<unsigned int>(i));
+        }
+    }
+    std::vector<Buffer>().swap(buffers);
+
+    Debug(Debug::INFO) << "Merging " << runFileNames.size() << " sorted runs\n";
+    runs.resize(runFileNames.size());
+    for (size_t i = 0; i < runFileNames.size(); ++i) {
+        runs[i].file = FileUtil::openFileOrDie(runFileNames[i].c_str(), "r", true);
+        // the open file stays readable until it is closed
+        FileUtil::remove(runFileNames[i].c_str());
+        if (readRecord(i)) {
+            queue.push(std::make_pair(runs[i].key, i));
+        }
+    }
+}
+
+bool ExternalSort::next(unsigned int &key, const char *&data, size_t &size) {
+    if (runs.empty()) {
+        if (nextRecord >= records.size()) {
+            return false;
+        }
+        const Record &record = records[nextRecord++];
+        key = record.key;
+        data = buffers[record.thread].data.data() + record.offset;
+        size = record.size;
+        return true;
+    }
+    // the record of the run returned last is replaced only now, the caller was still using its data
+    if (currentRun != SIZE_MAX && readRecord(currentRun)) {
+        queue.push(std::make_pair(runs[currentRun].key, currentRun));
+    }
+    currentRun = SIZE_MAX;
+    if (queue.empty()) {
+        return false;
+    }
+    currentRun = queue.top().second;
+    queue.pop();
+    key = runs[currentRun].key;
+    data = runs[currentRun].data.data();
+    size = runs[currentRun].data.size();
+    return true;
+}
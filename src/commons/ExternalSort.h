@@ -0,0 +1,88 @@
+#ifndef MMSEQS_EXTERNALSORT_H
+#define MMSEQS_EXTERNALSORT_H
+
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Sorts (key, payload) records by key within a memory budget.
+// Every thread buffers its records until its share of the budget is used up, then its buffer is sorted and
+// written to a run file, without waiting for the other threads.
+// After finish, next returns the records in key order from a multi-way merge of the runs,
+// records with the same key that were added by the same thread in the order they were added.
+// If all records fit into the budget, no run file is written and the buffers are returned directly.
+class ExternalSort {
+public:
+    // run files are named tmpPrefix.run.N
+    ExternalSort(const std::string &tmpPrefix, size_t memoryBudget, unsigned int threads = 1);
+
+    // removes the run files
+    ~ExternalSort();
+
+    // can be called in parallel with different thread indices
+    void add(unsigned int key, const char *data, size_t size, unsigned int thread = 0);
+
+    // sorts the buffered records and starts the merge
+    void finish();
+
+    // false after the last record, data stays valid until the next call
+    bool next(unsigned int &key, const char *&data, size_t &size);
+
+    size_t getRunCount() const {
+        return runFileNames.size();
+    }
+
+private:
+    struct Record {
+        unsigned int key;
+        unsigned int thread;
+        size_t offset;
+        size_t size;
+    };
+
+    static bool compareRecord(const Record &first, const Record &second) {
+        if (first.key != second.key) {
+            return first.key < second.key;
+        }
+        if (first.thread != second.thread) {
+            return first.thread < second.thread;
+        }
+        return first.offset < second.offset;
+    }
+
+    struct Buffer {
+        std::vector<char> data;
+        std::vector<Record> records;
+    };
+
+    struct Run {
+        FILE *file;
+        unsigned int key;
+        std::string data;
+    };
+
+    void writeRun(unsigned int thread);
+    bool readRecord(size_t run);
+
+    const std::string tmpPrefix;
+    // per thread
+    const size_t memoryBudget;
+
+    std::vector<Buffer> buffers;
+    // records of all buffers, if nothing was written to a run
+    std::vector<Record> records;
+    size_t nextRecord;
+
+    std::vector<std::string> runFileNames;
+    std::vector<Run> runs;
+    // smallest key of the runs first, ties go to the earlier run
+    std::priority_queue<std::pair<unsigned int, size_t>, std::vector<std::pair<unsigned int, size_t> >,
+                        std::greater<std::pair<unsigned int, size_t> > > queue;
+    size_t currentRun;
+};
+
+#endif
@@ -0,0 +1,229 @@
+#include "HugePages.h"
+#include "ByteParser.h"
+#include "Debug.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <stdint.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/vfs.h>
+#endif
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+int HugePages::mode = HugePages::MODE_OFF;
+
+enum {
+    BACKING_REGULAR = 0,
+    BACKING_TRANSPARENT,
+    BACKING_HUGETLB_2M,
+    BACKING_HUGETLB_1G,
+    BACKING_COUNT
+};
+
+static const char *backingNames[BACKING_COUNT] = {
+    "regular pages", "transparent huge pages", "2 MB hugetlb pages", "1 GB hugetlb pages"
+};
+
+static size_t allocatedBytes[BACKING_COUNT] = {0, 0, 0, 0};
+static int fallbackReported[BACKING_COUNT] = {0, 0, 0, 0};
+// madvise succeeds even if transparent huge pages are disabled system wide
+static bool transparentEnabled = true;
+
+static const size_t HUGE_PAGE_2M = 2 * 1024 * 1024;
+static const size_t HUGE_PAGE_1G = 1024 * 1024 * 1024;
+
+// stored in front of every allocation, padded to keep the memory behind it 64 byte aligned
+struct AllocationHeader {
+    void *base;
+    size_t mapSize;
+    int backing;
+};
+static const size_t HEADER_SIZE = 64;
+
+static size_t roundUp(size_t size, size_t alignment) {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+static void reportFallback(int backing, size_t size) {
+    if (__sync_bool_compare_and_swap(&fallbackReported[backing], 0, 1) == false) {
+        return;
+    }
+    if (backing == BACKING_TRANSPARENT) {
+        Debug(Debug::WARNING) << "Could not use transparent huge pages, falling back to regular pages\n";
+    } else {
+        Debug(Debug::WARNING) << "Could not map " << ByteParser::format(size) << " from the pool of " << backingNames[backing]
+                              << ", falling back to smaller pages. Reserve more pages with /proc/sys/vm/nr_hugepages\n";
+    }
+}
+
+#ifdef __linux__
+static void *mapHugetlb(size_t mapSize, int pageShift) {
+#ifdef MAP_HUGETLB
+    void *base = mmap(NULL, mapSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (pageShift << MAP_HUGE_SHIFT), -1, 0);
+    return (base == MAP_FAILED) ? NULL : base;
+#else
+    (void) mapSize;
+    (void) pageShift;
+    return NULL;
+#endif
+}
+
+static void *mapTransparent(size_t mapSize) {
+#ifdef MADV_HUGEPAGE
+    // over-allocate and trim, khugepaged can only use 2 MB aligned ranges
+    const size_t reserveSize = mapSize + HUGE_PAGE_2M;
+    char *reserved = static_cast<char *>(mmap(NULL, reserveSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (reserved == MAP_FAILED) {
+        return NULL;
+    }
+    char *base = reinterpret_cast<char *>(roundUp(reinterpret_cast<uintptr_t>(reserved), HUGE_PAGE_2M));
+    if (base > reserved) {
+        munmap(reserved, base - reserved);
+    }
+    const size_t tail = (reserved + reserveSize) - (base + mapSize);
+    if (tail > 0) {
+        munmap(base + mapSize, tail);
+    }
+    if (madvise(base, mapSize, MADV_HUGEPAGE) != 0) {
+        munmap(base, mapSize);
+        return NULL;
+    }
+    return base;
+#else
+    (void) mapSize;
+    return NULL;
+#endif
+}
+
+static std::string readFirstLine(const char *path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+#endif
+
+void HugePages::setMode(int requested) {
+    mode = requested;
+    if (mode == MODE_OFF) {
+        return;
+    }
+#ifdef __linux__
+    transparentEnabled = readFirstLine("/sys/kernel/mm/transparent_hugepage/enabled").find("[never]") == std::string::npos;
+    if (transparentEnabled == false) {
+        Debug(Debug::WARNING) << "Transparent huge pages are disabled in /sys/kernel/mm/transparent_hugepage/enabled\n";
+    }
+    if (mode == MODE_TRANSPARENT) {
+        return;
+    }
+    const char *freePages = (mode == MODE_HUGETLB_1G) ? "/sys/kernel/mm/hugepages/hugepages-1048576kB/free_hugepages"
+                                                      : "/sys/kernel/mm/hugepages/hugepages-2048kB/free_hugepages";
+    if (atol(readFirstLine(freePages).c_str()) == 0) {
+        Debug(Debug::WARNING) << "No free " << backingNames[mode] << " are reserved, "
+                              << "smaller pages are used instead. Reserve pages with /proc/sys/vm/nr_hugepages\n";
+    }
+#else
+    Debug(Debug::WARNING) << "Huge pages are only supported on Linux, regular pages are used\n";
+    mode = MODE_OFF;
+#endif
+}
+
+void *HugePages::allocate(size_t size) {
+    const size_t totalSize = size + HEADER_SIZE;
+    void *base = NULL;
+    size_t mapSize = totalSize;
+    int backing = BACKING_REGULAR;
+#ifdef __linux__
+    // a 1 GB page is only used if at most half of it is wasted
+    if (mode == MODE_HUGETLB_1G && totalSize >= HUGE_PAGE_1G / 2) {
+        mapSize = roundUp(totalSize, HUGE_PAGE_1G);
+        base = mapHugetlb(mapSize, 30);
+        if (base != NULL) {
+            backing = BACKING_HUGETLB_1G;
+        } else {
+            reportFallback(BACKING_HUGETLB_1G, mapSize);
+        }
+    }
+    if (base == NULL && mode >= MODE_HUGETLB_2M) {
+        mapSize = roundUp(totalSize, HUGE_PAGE_2M);
+        base = mapHugetlb(mapSize, 21);
+        if (base != NULL) {
+            backing = BACKING_HUGETLB_2M;
+        } else {
+            reportFallback(BACKING_HUGETLB_2M, mapSize);
+        }
+    }
+    // smaller allocations can not fill a transparent huge page
+    if (base == NULL && mode != MODE_OFF && transparentEnabled && totalSize >= HUGE_PAGE_2M) {
+        mapSize = roundUp(totalSize, HUGE_PAGE_2M);
+        base = mapTransparent(mapSize);
+        if (base != NULL) {
+            backing = BACKING_TRANSPARENT;
+        } else {
+            reportFallback(BACKING_TRANSPARENT, mapSize);
+        }
+    }
+#endif
+    if (base == NULL) {
+        mapSize = totalSize;
+        if (posix_memalign(&base, HEADER_SIZE, totalSize) != 0) {
+            return NULL;
+        }
+        backing = BACKING_REGULAR;
+    }
+    AllocationHeader *header = static_cast<AllocationHeader *>(base);
+    header->base = base;
+    header->mapSize = mapSize;
+    header->backing = backing;
+    __sync_fetch_and_add(&allocatedBytes[backing], mapSize);
+    return static_cast<char *>(base) + HEADER_SIZE;
+}
+
+void HugePages::release(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    AllocationHeader *header = reinterpret_cast<AllocationHeader *>(static_cast<char *>(ptr) - HEADER_SIZE);
+    const int backing = header->backing;
+    const size_t mapSize = header->mapSize;
+    __sync_fetch_and_sub(&allocatedBytes[backing], mapSize);
+    if (backing == BACKING_REGULAR) {
+        free(header->base);
+    } else {
+#ifdef __linux__
+        munmap(header->base, mapSize);
+#endif
+    }
+}
+
+bool HugePages::adviseMapping(void *addr, size_t size, int fd) {
+#ifdef __linux__
+    // HUGETLBFS_MAGIC from linux/magic.h
+    struct statfs fileSystem;
+    if (fstatfs(fd, &fileSystem) == 0 && static_cast<unsigned long>(fileSystem.f_type) == 0x958458f6UL) {
+        return true;
+    }
+#ifdef MADV_HUGEPAGE
+    return madvise(addr, size, MADV_HUGEPAGE) == 0;
+#endif
+#endif
+    (void) addr;
+    (void) size;
+    (void) fd;
+    return false;
+}
+
+void HugePages::printStatistics() {
+    for (int i = BACKING_COUNT - 1; i >= BACKING_REGULAR; i--) {
+        if (allocatedBytes[i] > 0) {
+            Debug(Debug::INFO) << "Huge pages: " << ByteParser::format(allocatedBytes[i]) << " on " << backingNames[i] << "\n";
+        }
+    }
+}
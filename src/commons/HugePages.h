@@ -0,0 +1,41 @@
+#ifndef MMSEQS_HUGEPAGES_H
+#define MMSEQS_HUGEPAGES_H
+
+#include <cstddef>
+
+// Huge page backing for large arrays with random access (index tables, diagonal bins).
+// MODE_TRANSPARENT maps allocations of at least one huge page 2 MB aligned and marks them with
+// madvise(MADV_HUGEPAGE), the hugetlb modes map them from the pool reserved in /proc/sys/vm/nr_hugepages.
+// Every backing falls back to the next smaller one if it fails, down to regular pages from the heap.
+// Memory from allocate has to be returned by release.
+class HugePages {
+public:
+    static const int MODE_OFF = 0;
+    static const int MODE_TRANSPARENT = 1;
+    static const int MODE_HUGETLB_2M = 2;
+    static const int MODE_HUGETLB_1G = 3;
+
+    // warns if the kernel does not support the requested mode
+    static void setMode(int requested);
+
+    static int getMode() {
+        return mode;
+    }
+
+    // 64 byte aligned memory, NULL if no backing could provide it
+    static void *allocate(size_t size);
+
+    static void release(void *ptr);
+
+    // marks an existing mapping (of a file) for transparent huge pages, a file on a hugetlbfs mount
+    // is backed by huge pages already. Returns false if the kernel did not accept the advice
+    static bool adviseMapping(void *addr, size_t size, int fd);
+
+    // bytes that are currently allocated per backing
+    static void printStatistics();
+
+private:
+    static int mode;
+};
+
+#endif
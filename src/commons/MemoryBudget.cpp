@@ -0,0 +1,143 @@
+#include "MemoryBudget.h"
+#include "ByteParser.h"
+#include "Debug.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <stdint.h>
+#include <sys/resource.h>
+
+size_t MemoryBudget::limit = 0;
+std::vector<std::pair<std::string, size_t> > MemoryBudget::components;
+bool MemoryBudget::exceededReported = false;
+
+#ifdef __linux__
+// SIZE_MAX if the file does not exist or contains "max"
+static size_t readLimitFile(const std::string &path) {
+    std::ifstream file(path.c_str());
+    std::string value;
+    if (!(file >> value) || value == "max") {
+        return SIZE_MAX;
+    }
+    char *end;
+    const unsigned long long bytes = strtoull(value.c_str(), &end, 10);
+    if (*end != '\0') {
+        return SIZE_MAX;
+    }
+    return static_cast<size_t>(bytes);
+}
+
+// smallest memory limit of the cgroup of the process and its parents, SIZE_MAX without a limit
+static size_t getCgroupLimit() {
+    std::ifstream cgroups("/proc/self/cgroup");
+    std::string line;
+    size_t cgroupLimit = SIZE_MAX;
+    while (std::getline(cgroups, line)) {
+        // hierarchy-id:controllers:path, the unified v2 hierarchy has no controllers listed
+        const size_t first = line.find(':');
+        const size_t second = (first == std::string::npos) ? std::string::npos : line.find(':', first + 1);
+        if (second == std::string::npos) {
+            continue;
+        }
+        const std::string controllers = line.substr(first + 1, second - first - 1);
+        std::string path = line.substr(second + 1);
+        std::string base;
+        std::string fileName;
+        if (controllers.empty()) {
+            base = "/sys/fs/cgroup";
+            fileName = "/memory.max";
+        } else if (("," + controllers + ",").find(",memory,") != std::string::npos) {
+            base = "/sys/fs/cgroup/memory";
+            fileName = "/memory.limit_in_bytes";
+        } else {
+            continue;
+        }
+        // limits of parent cgroups apply as well, inside a container the path is usually only /
+        while (true) {
+            cgroupLimit = std::min(cgroupLimit, readLimitFile(base + (path == "/" ? "" : path) + fileName));
+            const size_t slash = path.rfind('/');
+            if (slash == std::string::npos || path == "/") {
+                break;
+            }
+            path = (slash == 0) ? "/" : path.substr(0, slash);
+        }
+    }
+    return cgroupLimit;
+}
+#endif
+
+void MemoryBudget::setLimit(size_t splitMemoryLimit) {
+    limit = splitMemoryLimit;
+}
+
+size_t MemoryBudget::getAvailable() {
+    static size_t available = 0;
+    if (available == 0) {
+        size_t memory = Util::getTotalSystemMemory();
+#ifdef __linux__
+        memory = std::min(memory, getCgroupLimit());
+#endif
+        struct rlimit addressSpace;
+        if (getrlimit(RLIMIT_AS, &addressSpace) == 0 && addressSpace.rlim_cur != RLIM_INFINITY) {
+            memory = std::min(memory, static_cast<size_t>(addressSpace.rlim_cur));
+        }
+        available = memory;
+    }
+    return available;
+}
+
+size_t MemoryBudget::getLimit() {
+    if (limit > 0) {
+        return limit;
+    }
+    return static_cast<size_t>(getAvailable() * 0.9);
+}
+
+void MemoryBudget::reserve(const std::string &component, size_t bytes) {
+    size_t total = 0;
+    bool found = false;
+    for (size_t i = 0; i < components.size(); ++i) {
+        if (components[i].first == component) {
+            components[i].second = bytes;
+            found = true;
+        }
+        total += components[i].second;
+    }
+    if (found == false) {
+        components.push_back(std::make_pair(component, bytes));
+        total += bytes;
+    }
+    if (total > getLimit() && exceededReported == false) {
+        exceededReported = true;
+        Debug(Debug::WARNING) << "Estimated memory of " << ByteParser::format(total) << " exceeds the memory limit of "
+                              << ByteParser::format(getLimit()) << "\n";
+    }
+}
+
+void MemoryBudget::release(const std::string &component) {
+    for (size_t i = 0; i < components.size(); ++i) {
+        if (components[i].first == component) {
+            components.erase(components.begin() + i);
+            return;
+        }
+    }
+}
+
+size_t MemoryBudget::getRemaining() {
+    size_t total = 0;
+    for (size_t i = 0; i < components.size(); ++i) {
+        total += components[i].second;
+    }
+    return (total < getLimit()) ? (getLimit() - total) : 0;
+}
+
+void MemoryBudget::printEstimates() {
+    Debug(Debug::INFO) << "Memory limit " << ByteParser::format(getLimit()) << " of "
+                       << ByteParser::format(getAvailable()) << " available memory\n";
+    for (size_t i = 0; i < components.size(); ++i) {
+        Debug(Debug::INFO) << "  " << components[i].first << ": " << ByteParser::format(components[i].second) << "\n";
+    }
+    Debug(Debug::INFO) << "  remaining: " << ByteParser::format(getRemaining()) << "\n";
+}
@@ -0,0 +1,42 @@
+#ifndef MMSEQS_MEMORYBUDGET_H
+#define MMSEQS_MEMORYBUDGET_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Memory that the process plans its splits, buffers and flush sizes with.
+// The available memory is the physical memory lowered by the memory limit of the cgroup (v2 memory.max or
+// v1 memory.limit_in_bytes) the process runs in and by RLIMIT_AS. The limit is --split-memory-limit if set,
+// 90% of the available memory otherwise.
+// Modules reserve the estimated size of their large components (index table, diagonal bins, writer and
+// merge buffers) before they allocate them, printEstimates lists them against the limit.
+class MemoryBudget {
+public:
+    // splitMemoryLimit of 0 uses 90% of the available memory
+    static void setLimit(size_t splitMemoryLimit);
+
+    static size_t getLimit();
+
+    // physical memory lowered by the cgroup memory limit and RLIMIT_AS
+    static size_t getAvailable();
+
+    // records the estimate of a component, reserving a component again replaces its estimate.
+    // Warns once if the estimates exceed the limit
+    static void reserve(const std::string &component, size_t bytes);
+
+    static void release(const std::string &component);
+
+    // limit minus the reserved estimates, 0 if they exceed the limit
+    static size_t getRemaining();
+
+    static void printEstimates();
+
+private:
+    static size_t limit;
+    static std::vector<std::pair<std::string, size_t> > components;
+    static bool exceededReported;
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include "Numa.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <stdint.h>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef __linux__
+static bool compareNodeById(const Numa::Node &first, const Numa::Node &second) {
+    return first.id < second.id;
+}
+
+// parses lists like 0-15,32-47
+static std::vector<int> parseCpuList(const std::string &list) {
+    std::vector<int> cpus;
+    std::vector<std::string> ranges = Util::split(list, ",");
+    for (size_t i = 0; i < ranges.size(); i++) {
+        std::vector<std::string> bounds = Util::split(ranges[i], "-");
+        if (bounds.empty()) {
+            continue;
+        }
+        int from = atoi(bounds[0].c_str());
+        int to = (bounds.size() > 1) ? atoi(bounds[1].c_str()) : from;
+        for (int cpu = from; cpu <= to; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+#endif
+
+std::vector<Numa::Node> Numa::getNodes() {
+    std::vector<Node> nodes;
+#ifdef __linux__
+    const char *path = "/sys/devices/system/node";
+    DIR *dir = opendir(path);
+    if (dir == NULL) {
+        return nodes;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        std::string name(entry->d_name);
+        if (name.compare(0, 4, "node") != 0 || name.size() == 4
+            || name.find_first_not_of("0123456789", 4) != std::string::npos) {
+            continue;
+        }
+        std::ifstream cpuList((std::string(path) + "/" + name + "/cpulist").c_str());
+        std::string line;
+        if (!std::getline(cpuList, line)) {
+            continue;
+        }
+        Node node;
+        node.id = atoi(name.c_str() + 4);
+        node.cpus = parseCpuList(line);
+        if (node.cpus.empty() == false) {
+            nodes.push_back(node);
+        }
+    }
+    closedir(dir);
+    std::sort(nodes.begin(), nodes.end(), compareNodeById);
+#endif
+    return nodes;
+}
+
+bool Numa::getThreadAffinity(std::vector<int> &cpus) {
+    cpus.clear();
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &set) != 0) {
+        return false;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set)) {
+            cpus.push_back(cpu);
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Numa::setThreadAffinity(const std::vector<int> &cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t i = 0; i < cpus.size(); i++) {
+        if (cpus[i] < CPU_SETSIZE) {
+            CPU_SET(cpus[i], &set);
+        }
+    }
+    // pid 0 is the calling thread
+    return sched_setaffinity(0, sizeof(cpu_set_t), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+bool Numa::interleave(void *addr, size_t size, const std::vector<Node> &nodes) {
+#if defined(__linux__) && defined(SYS_mbind)
+    if (addr == NULL || size == 0 || nodes.empty()) {
+        return false;
+    }
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t start = reinterpret_cast<uintptr_t>(addr) & ~(pageSize - 1);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(addr) + size;
+
+    // pages that were never touched would not be moved
+    volatile char sink = 0;
+    for (uintptr_t page = reinterpret_cast<uintptr_t>(addr); page < end; page += pageSize) {
+        sink += *reinterpret_cast<volatile char *>(page);
+    }
+    (void) sink;
+
+    const size_t bitsPerLong = sizeof(unsigned long) * 8;
+    int maxNode = 0;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        maxNode = std::max(maxNode, nodes[i].id);
+    }
+    std::vector<unsigned long> mask(maxNode / bitsPerLong + 1, 0);
+    for (size_t i = 0; i < nodes.size(); i++) {
+        mask[nodes[i].id / bitsPerLong] |= 1UL << (nodes[i].id % bitsPerLong);
+    }
+    // values of MPOL_INTERLEAVE and MPOL_MF_MOVE from linux/mempolicy.h
+    const int interleavePolicy = 3;
+    const unsigned int moveFlag = 1 << 1;
+    // the kernel reads maxnode - 1 bits of the mask
+    long status = syscall(SYS_mbind, start, end - start, interleavePolicy, mask.data(),
+                          mask.size() * bitsPerLong + 1, moveFlag);
+    return status == 0;
+#else
+    (void) addr;
+    (void) size;
+    (void) nodes;
+    return false;
+#endif
+}
@@ -0,0 +1,28 @@
+#ifndef MMSEQS_NUMA_H
+#define MMSEQS_NUMA_H
+
+#include <vector>
+#include <cstddef>
+
+// NUMA placement without libnuma: the topology is read from /sys/devices/system/node, threads are
+// pinned with sched_setaffinity and pages are moved with the mbind syscall.
+// On other platforms getNodes returns no nodes and all other functions fail.
+class Numa {
+public:
+    struct Node {
+        int id;
+        std::vector<int> cpus;
+    };
+
+    // nodes with at least one cpu, ordered by id
+    static std::vector<Node> getNodes();
+
+    static bool getThreadAffinity(std::vector<int> &cpus);
+
+    static bool setThreadAffinity(const std::vector<int> &cpus);
+
+    // faults in the pages of [addr, addr + size) and moves them interleaved onto the nodes
+    static bool interleave(void *addr, size_t size, const std::vector<Node> &nodes);
+};
+
+#endif
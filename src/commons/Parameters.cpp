@@ -5,6 +5,10 @@
 #include "CommandCaller.h"
 #include "ByteParser.h"
 #include "FileUtil.h"
+#include "SimdDispatch.h"
+#include "HugePages.h"
+#include "AsyncIO.h"
+#include "MemoryBudget.h"
 
 #include <map>
 #include <iomanip>
@@ -31,6 +35,12 @@ Parameters::Parameters():
         PARAM_K(PARAM_K_ID, "-k", "k-mer length", "k-mer length (0: automatically set to optimum)", typeid(int), (void *) &kmerSize, "^[0-9]{1}[0-9]*$", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_CLUSTLINEAR | MMseqsParameter::COMMAND_EXPERT),
         PARAM_THREADS(PARAM_THREADS_ID, "--threads", "Threads", "Number of CPU-cores used (all by default)", typeid(int), (void *) &threads, "^[1-9]{1}[0-9]*$", MMseqsParameter::COMMAND_COMMON),
         PARAM_COMPRESSED(PARAM_COMPRESSED_ID, "--compressed", "Compressed", "Write compressed output", typeid(int), (void *) &compressed, "^[0-1]{1}$", MMseqsParameter::COMMAND_COMMON),
+        PARAM_COMPRESSION_DICT(PARAM_COMPRESSION_DICT_ID, "--compression-dict", "Compression dictionary", "Train a zstd dictionary on a sample of the entries of compressed output (--compressed 1) and store it in .zdict", typeid(bool), (void *) &compressionDict, "", MMseqsParameter::COMMAND_MISC | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_BINARY_INDEX(PARAM_BINARY_INDEX_ID, "--binary-index", "Binary index", "Write a binary copy of every .index (.index.bin) that is memory mapped instead of parsed when the DB is opened", typeid(bool), (void *) &binaryIndex, "", MMseqsParameter::COMMAND_MISC | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_IO_URING(PARAM_IO_URING_ID, "--io-uring", "io_uring", "Write results and read ahead database entries asynchronously with io_uring (Linux 5.6+), falls back to regular I/O if unavailable", typeid(bool), (void *) &ioUring, "", MMseqsParameter::COMMAND_MISC | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_SHARED_WRITER(PARAM_SHARED_WRITER_ID, "--shared-writer", "Shared writer", "Write the alignment and prefilter results of all threads into one data file instead of merging one data file per thread", typeid(bool), (void *) &sharedWriter, "", MMseqsParameter::COMMAND_MISC | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_SIMD_LEVEL(PARAM_SIMD_LEVEL_ID, "--simd-level", "SIMD level", "SIMD instruction set of the alignment kernels (0: auto, up to AVX2, 1: SSE4.1, 2: AVX2, 3: AVX-512BW)", typeid(int), (void *) &simdLevel, "^[0-3]{1}$", MMseqsParameter::COMMAND_MISC | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_BINARY_RESULTS(PARAM_BINARY_RESULTS_ID, "--binary-results", "Binary results", "Write prefilter and alignment results as fixed-width binary records (0: text, 1: binary)", typeid(int), (void *) &binaryResults, "^[0-1]{1}$", MMseqsParameter::COMMAND_MISC | MMseqsParameter::COMMAND_EXPERT),
         PARAM_ALPH_SIZE(PARAM_ALPH_SIZE_ID, "--alph-size", "Alphabet size", "Alphabet size (range 2-21)", typeid(int), (void *) &alphabetSize, "^[1-9]{1}[0-9]*$", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_CLUSTLINEAR | MMseqsParameter::COMMAND_EXPERT),
         PARAM_MAX_SEQ_LEN(PARAM_MAX_SEQ_LEN_ID, "--max-seq-len", "Max sequence length", "Maximum sequence length", typeid(int), (void *) &maxSeqLen, "^[0-9]{1}[0-9]*", MMseqsParameter::COMMAND_COMMON | MMseqsParameter::COMMAND_EXPERT),
         PARAM_DIAGONAL_SCORING(PARAM_DIAGONAL_SCORING_ID, "--diag-score", "Diagonal scoring", "Use ungapped diagonal scoring during prefilter", typeid(bool), (void *) &diagonalScoring, "", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_EXPERT),
@@ -42,7 +52,7 @@ Parameters::Parameters():
         PARAM_MAX_SEQS(PARAM_MAX_SEQS_ID, "--max-seqs", "Max results per query", "Maximum results per query sequence allowed to pass the prefilter (affects sensitivity)", typeid(int), (void *) &maxResListLen, "^[1-9]{1}[0-9]*$", MMseqsParameter::COMMAND_PREFILTER),
         PARAM_SPLIT(PARAM_SPLIT_ID, "--split", "Split database", "Split input into N equally distributed chunks. 0: set the best split automatically", typeid(int), (void *) &split, "^[0-9]{1}[0-9]*$", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_EXPERT),
         PARAM_SPLIT_MODE(PARAM_SPLIT_MODE_ID, "--split-mode", "Split mode", "0: split target db; 1: split query db; 2: auto, depending on main memory", typeid(int), (void *) &splitMode, "^[0-2]{1}$", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_EXPERT),
-        PARAM_SPLIT_MEMORY_LIMIT(PARAM_SPLIT_MEMORY_LIMIT_ID, "--split-memory-limit", "Split memory limit", "Set max memory per split. E.g. 800B, 5K, 10M, 1G. Default (0) to all available system memory", typeid(ByteParser), (void *) &splitMemoryLimit, "^(0|[1-9]{1}[0-9]*(B|K|M|G|T)?)$", MMseqsParameter::COMMAND_COMMON | MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_SPLIT_MEMORY_LIMIT(PARAM_SPLIT_MEMORY_LIMIT_ID, "--split-memory-limit", "Split memory limit", "Set max memory per split. E.g. 800B, 5K, 10M, 1G. Default (0) to all memory available under the cgroup and address space limits", typeid(ByteParser), (void *) &splitMemoryLimit, "^(0|[1-9]{1}[0-9]*(B|K|M|G|T)?)$", MMseqsParameter::COMMAND_COMMON | MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_EXPERT),
         PARAM_DISK_SPACE_LIMIT(PARAM_DISK_SPACE_LIMIT_ID, "--disk-space-limit", "Disk space limit", "Set max disk space to use for reverse profile searches. E.g. 800B, 5K, 10M, 1G. Default (0) to all available disk space in the temp folder", typeid(ByteParser), (void *) &diskSpaceLimit, "^(0|[1-9]{1}[0-9]*(B|K|M|G|T)?)$", MMseqsParameter::COMMAND_COMMON | MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_EXPERT),
         PARAM_SPLIT_AMINOACID(PARAM_SPLIT_AMINOACID_ID, "--split-aa", "Split by amino acid", "Try to find the best split boundaries by entry lengths", typeid(bool), (void *) &splitAA, "$", MMseqsParameter::COMMAND_EXPERT),
         PARAM_SUB_MAT(PARAM_SUB_MAT_ID, "--sub-mat", "Substitution matrix", "Substitution matrix file", typeid(ScoreMatrixFile), (void *) &scoringMatrixFile, "", MMseqsParameter::COMMAND_COMMON | MMseqsParameter::COMMAND_EXPERT),
@@ -52,6 +62,10 @@ Parameters::Parameters():
         PARAM_REMOVE_TMP_FILES(PARAM_REMOVE_TMP_FILES_ID, "--remove-tmp-files", "Remove temporary files", "Delete temporary files", typeid(bool), (void *) &removeTmpFiles, "", MMseqsParameter::COMMAND_COMMON | MMseqsParameter::COMMAND_EXPERT),
         PARAM_INCLUDE_IDENTITY(PARAM_INCLUDE_IDENTITY_ID, "--add-self-matches", "Include identical seq. id.", "Artificially add entries of queries with themselves (for clustering)", typeid(bool), (void *) &includeIdentity, "", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_ALIGN | MMseqsParameter::COMMAND_EXPERT),
         PARAM_PRELOAD_MODE(PARAM_PRELOAD_MODE_ID, "--db-load-mode", "Preload mode", "Database preload mode 0: auto, 1: fread, 2: mmap, 3: mmap+touch", typeid(int), (void *) &preloadMode, "[0-3]{1}", MMseqsParameter::COMMAND_COMMON | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_NUMA_MODE(PARAM_NUMA_MODE_ID, "--numa-mode", "NUMA mode", "Prefilter index placement on NUMA systems 0: off, 1: interleave pages over the nodes, 2: replicate per node (needs one index copy per node). Threads are pinned round robin to the nodes", typeid(int), (void *) &numaMode, "^[0-2]{1}$", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_PREFILTER_BATCH(PARAM_PREFILTER_BATCH_ID, "--prefilter-batch", "Prefilter batch", "Match the k-mers of this many queries of a thread together, each index table k-mer list is read once per batch. Results do not change, 1: match queries one by one", typeid(int), (void *) &prefilterBatch, "^[1-9]{1}[0-9]*$", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_KMER_CACHE(PARAM_KMER_CACHE_ID, "--kmer-cache", "Similar k-mer cache", "Memory per thread for caching the similar k-mer lists of repeated query k-mers. E.g. 800B, 5K, 10M, 1G. 0: no cache", typeid(ByteParser), (void *) &kmerCache, "^(0|[1-9]{1}[0-9]*(B|K|M|G|T)?)$", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_HUGE_PAGES(PARAM_HUGE_PAGES_ID, "--huge-pages", "Huge pages", "Huge page backing of the index table and prefilter buffers 0: off, 1: transparent huge pages, 2: 2 MB hugetlb pages, 3: 1 GB hugetlb pages. Falls back to smaller pages if unavailable", typeid(int), (void *) &hugePages, "^[0-3]{1}$", MMseqsParameter::COMMAND_MISC | MMseqsParameter::COMMAND_EXPERT),
         PARAM_SPACED_KMER_PATTERN(PARAM_SPACED_KMER_PATTERN_ID, "--spaced-kmer-pattern", "Spaced k-mer pattern", "User-specified spaced k-mer pattern", typeid(std::string), (void *) &spacedKmerPattern, "^1[01]*1$", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_EXPERT),
         PARAM_LOCAL_TMP(PARAM_LOCAL_TMP_ID, "--local-tmp", "Local temporary path", "Path where some of the temporary files will be created", typeid(std::string), (void *) &localTmp, "", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_EXPERT),
         // alignment
@@ -68,6 +82,7 @@ Parameters::Parameters():
         PARAM_MIN_ALN_LEN(PARAM_MIN_ALN_LEN_ID, "--min-aln-len", "Min alignment length", "Minimum alignment length (range 0-INT_MAX)", typeid(int), (void *) &alnLenThr, "^[0-9]{1}[0-9]*$", MMseqsParameter::COMMAND_ALIGN),
         PARAM_SCORE_BIAS(PARAM_SCORE_BIAS_ID, "--score-bias", "Score bias", "Score bias when computing SW alignment (in bits)", typeid(float), (void *) &scoreBias, "^-?[0-9]*(\\.[0-9]+)?$", MMseqsParameter::COMMAND_ALIGN | MMseqsParameter::COMMAND_EXPERT),
         PARAM_ALT_ALIGNMENT(PARAM_ALT_ALIGNMENT_ID, "--alt-ali", "Alternative alignments", "Show up to this many alternative alignments", typeid(int), (void *) &altAlignment, "^[0-9]{1}[0-9]*$", MMseqsParameter::COMMAND_ALIGN),
+        PARAM_ALIGNMENT_ENGINE(PARAM_ALIGNMENT_ENGINE_ID, "--alignment-engine", "Alignment engine", "Smith-Waterman implementation: 0: auto (inter-sequence for queries up to 256 residues); 1: striped; 2: inter-sequence, aligns one target per SIMD lane", typeid(int), (void *) &alignmentEngine, "^[0-2]{1}$", MMseqsParameter::COMMAND_ALIGN | MMseqsParameter::COMMAND_EXPERT),
         PARAM_GAP_OPEN(PARAM_GAP_OPEN_ID, "--gap-open", "Gap open cost", "Gap open cost", typeid(int), (void *) &gapOpen, "^[0-9]{1}[0-9]*$", MMseqsParameter::COMMAND_ALIGN | MMseqsParameter::COMMAND_EXPERT),
         PARAM_GAP_EXTEND(PARAM_GAP_EXTEND_ID, "--gap-extend", "Gap extension cost", "Gap extension cost", typeid(int), (void *) &gapExtend, "^[0-9]{1}[0-9]*$", MMseqsParameter::COMMAND_ALIGN | MMseqsParameter::COMMAND_EXPERT),
         // clustering
@@ -141,6 +156,8 @@ Parameters::Parameters():
         PARAM_START_SENS(PARAM_START_SENS_ID, "--start-sens", "Start sensitivity", "Start sensitivity", typeid(float), (void *) &startSens, "^[0-9]*(\\.[0-9]+)?$"),
         PARAM_SENS_STEPS(PARAM_SENS_STEPS_ID, "--sens-steps", "Search steps", "Number of search steps performed from --start-sens to -s", typeid(int), (void *) &sensSteps, "^[1-9]{1}$"),
         PARAM_SLICE_SEARCH(PARAM_SLICE_SEARCH_ID, "--slice-search", "Slice search mode", "For bigger profile DB, run iteratively the search by greedily swapping the search results", typeid(bool), (void *) &sliceSearch, "", MMseqsParameter::COMMAND_PROFILE | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_STREAM_ALIGNMENT(PARAM_STREAM_ALIGNMENT_ID, "--stream-alignment", "Stream alignment", "Align the hits of each query right after its prefilter instead of writing a prefilter database (single search step only)", typeid(bool), (void *) &streamAlignment, "", MMseqsParameter::COMMAND_ALIGN | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_PREFILTER_DB(PARAM_PREFILTER_DB_ID, "--prefilter-db", "Prefilter database", "Additionally write the prefilter result to this database", typeid(std::string), (void *) &prefilterDb, "", MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_EXPERT),
         PARAM_STRAND(PARAM_STRAND_ID, "--strand", "Strand selection", "Strand selection only works for DNA/DNA search 0: reverse, 1: forward, 2: both", typeid(int), (void *) &strand, "^[0-2]{1}$", MMseqsParameter::COMMAND_EXPERT),
         // easysearch
         PARAM_GREEDY_BEST_HITS(PARAM_GREEDY_BEST_HITS_ID, "--greedy-best-hits", "Greedy best hits", "Choose the best hits greedily to cover the query", typeid(bool), (void *) &greedyBestHits, ""),
@@ -159,6 +176,9 @@ Parameters::Parameters():
         // indexdb
         PARAM_CHECK_COMPATIBLE(PARAM_CHECK_COMPATIBLE_ID, "--check-compatible", "Check compatible", "0: Always recreate index, 1: Check if recreating index is needed, 2: Fail if index is incompatible", typeid(int), (void *) &checkCompatible, "^[0-2]{1}$", MMseqsParameter::COMMAND_MISC),
         PARAM_SEARCH_TYPE(PARAM_SEARCH_TYPE_ID, "--search-type", "Search type", "Search type 0: auto 1: amino acid, 2: translated, 3: nucleotide, 4: translated nucleotide alignment", typeid(int), (void *) &searchType, "^[0-4]{1}"),
+        PARAM_INDEX_COMPRESSION(PARAM_INDEX_COMPRESSION_ID, "--index-compression", "Index compression", "0: Uncompressed k-mer index, 1: Bit-packed seq. id deltas and positions per k-mer (smaller index, fewer splits)", typeid(int), (void *) &indexCompression, "^[0-1]{1}$", MMseqsParameter::COMMAND_MISC | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_INDEX_APPEND(PARAM_INDEX_APPEND_ID, "--append", "Append to index", "Index only the sequences that were added to the database as a further split of the existing index. Needs a database created with --shuffle 0, which keeps the keys of the indexed sequences. Every appended split is searched in its own prefilter step, the fifth one is merged with the others", typeid(bool), (void *) &indexAppend, "", MMseqsParameter::COMMAND_MISC | MMseqsParameter::COMMAND_EXPERT),
+        PARAM_INDEX_COMPACT(PARAM_INDEX_COMPACT_ID, "--compact", "Compact index", "Merge the appended splits of the index into its last split", typeid(bool), (void *) &indexCompact, "", MMseqsParameter::COMMAND_MISC | MMseqsParameter::COMMAND_EXPERT),
         // createdb
         PARAM_USE_HEADER(PARAM_USE_HEADER_ID, "--use-fasta-header", "Use fasta header", "Use the id parsed from the fasta header as the index key instead of using incrementing numeric identifiers", typeid(bool), (void *) &useHeader, ""),
         PARAM_ID_OFFSET(PARAM_ID_OFFSET_ID, "--id-offset", "Offset of numeric ids", "Numeric ids in index file are offset by this value", typeid(int), (void *) &identifierOffset, "^(0|[1-9]{1}[0-9]*)$"),
@@ -266,6 +286,9 @@ Parameters::Parameters():
 
     // verbandcompression
     verbandcompression.push_back(&PARAM_COMPRESSED);
+    verbandcompression.push_back(&PARAM_COMPRESSION_DICT);
+    verbandcompression.push_back(&PARAM_BINARY_INDEX);
+    verbandcompression.push_back(&PARAM_IO_URING);
     verbandcompression.push_back(&PARAM_V);
 
     // onlythreads
@@ -275,6 +298,9 @@ Parameters::Parameters():
     // threadsandcompression
     threadsandcompression.push_back(&PARAM_THREADS);
     threadsandcompression.push_back(&PARAM_COMPRESSED);
+    threadsandcompression.push_back(&PARAM_COMPRESSION_DICT);
+    threadsandcompression.push_back(&PARAM_BINARY_INDEX);
+    threadsandcompression.push_back(&PARAM_IO_URING);
     threadsandcompression.push_back(&PARAM_V);
 
     // alignment
@@ -287,6 +313,7 @@ Parameters::Parameters():
     align.push_back(&PARAM_MIN_ALN_LEN);
     align.push_back(&PARAM_SEQ_ID_MODE);
     align.push_back(&PARAM_ALT_ALIGNMENT);
+    align.push_back(&PARAM_ALIGNMENT_ENGINE);
     align.push_back(&PARAM_C);
     align.push_back(&PARAM_COV_MODE);
     align.push_back(&PARAM_MAX_SEQ_LEN);
@@ -302,7 +329,13 @@ Parameters::Parameters():
     align.push_back(&PARAM_GAP_OPEN);
     align.push_back(&PARAM_GAP_EXTEND);
     align.push_back(&PARAM_THREADS);
+    align.push_back(&PARAM_SIMD_LEVEL);
     align.push_back(&PARAM_COMPRESSED);
+    align.push_back(&PARAM_COMPRESSION_DICT);
+    align.push_back(&PARAM_BINARY_INDEX);
+    align.push_back(&PARAM_IO_URING);
+    align.push_back(&PARAM_SHARED_WRITER);
+    align.push_back(&PARAM_BINARY_RESULTS);
     align.push_back(&PARAM_V);
 
     // prefilter
@@ -328,12 +361,22 @@ Parameters::Parameters():
     prefilter.push_back(&PARAM_INCLUDE_IDENTITY);
     prefilter.push_back(&PARAM_SPACED_KMER_MODE);
     prefilter.push_back(&PARAM_PRELOAD_MODE);
+    prefilter.push_back(&PARAM_NUMA_MODE);
+    prefilter.push_back(&PARAM_PREFILTER_BATCH);
+    prefilter.push_back(&PARAM_KMER_CACHE);
+    prefilter.push_back(&PARAM_HUGE_PAGES);
     prefilter.push_back(&PARAM_PCA);
     prefilter.push_back(&PARAM_PCB);
     prefilter.push_back(&PARAM_SPACED_KMER_PATTERN);
     prefilter.push_back(&PARAM_LOCAL_TMP);
     prefilter.push_back(&PARAM_THREADS);
+    prefilter.push_back(&PARAM_SIMD_LEVEL);
     prefilter.push_back(&PARAM_COMPRESSED);
+    prefilter.push_back(&PARAM_COMPRESSION_DICT);
+    prefilter.push_back(&PARAM_BINARY_INDEX);
+    prefilter.push_back(&PARAM_IO_URING);
+    prefilter.push_back(&PARAM_SHARED_WRITER);
+    prefilter.push_back(&PARAM_BINARY_RESULTS);
     prefilter.push_back(&PARAM_V);
 
     // ungappedprefilter
@@ -344,7 +387,12 @@ Parameters::Parameters():
     ungappedprefilter.push_back(&PARAM_NO_COMP_BIAS_CORR);
     ungappedprefilter.push_back(&PARAM_MIN_DIAG_SCORE);
     ungappedprefilter.push_back(&PARAM_THREADS);
+    ungappedprefilter.push_back(&PARAM_SIMD_LEVEL);
+    ungappedprefilter.push_back(&PARAM_HUGE_PAGES);
     ungappedprefilter.push_back(&PARAM_COMPRESSED);
+    ungappedprefilter.push_back(&PARAM_COMPRESSION_DICT);
+    ungappedprefilter.push_back(&PARAM_BINARY_INDEX);
+    ungappedprefilter.push_back(&PARAM_IO_URING);
     ungappedprefilter.push_back(&PARAM_V);
 
     // clustering
@@ -353,6 +401,9 @@ Parameters::Parameters():
     clust.push_back(&PARAM_SIMILARITYSCORE);
     clust.push_back(&PARAM_THREADS);
     clust.push_back(&PARAM_COMPRESSED);
+    clust.push_back(&PARAM_COMPRESSION_DICT);
+    clust.push_back(&PARAM_BINARY_INDEX);
+    clust.push_back(&PARAM_IO_URING);
     clust.push_back(&PARAM_V);
 
     // rescorediagonal
@@ -372,6 +423,9 @@ Parameters::Parameters():
     rescorediagonal.push_back(&PARAM_PRELOAD_MODE);
     rescorediagonal.push_back(&PARAM_THREADS);
     rescorediagonal.push_back(&PARAM_COMPRESSED);
+    rescorediagonal.push_back(&PARAM_COMPRESSION_DICT);
+    rescorediagonal.push_back(&PARAM_BINARY_INDEX);
+    rescorediagonal.push_back(&PARAM_IO_URING);
     rescorediagonal.push_back(&PARAM_V);
 
     // alignbykmer
@@ -391,12 +445,18 @@ Parameters::Parameters():
     alignbykmer.push_back(&PARAM_GAP_EXTEND);
     alignbykmer.push_back(&PARAM_THREADS);
     alignbykmer.push_back(&PARAM_COMPRESSED);
+    alignbykmer.push_back(&PARAM_COMPRESSION_DICT);
+    alignbykmer.push_back(&PARAM_BINARY_INDEX);
+    alignbykmer.push_back(&PARAM_IO_URING);
     alignbykmer.push_back(&PARAM_V);
 
     // convertprofiledb
     convertprofiledb.push_back(&PARAM_SUB_MAT);
     convertprofiledb.push_back(&PARAM_THREADS);
     convertprofiledb.push_back(&PARAM_COMPRESSED);
+    convertprofiledb.push_back(&PARAM_COMPRESSION_DICT);
+    convertprofiledb.push_back(&PARAM_BINARY_INDEX);
+    convertprofiledb.push_back(&PARAM_IO_URING);
     convertprofiledb.push_back(&PARAM_V);
 
 
@@ -408,6 +468,9 @@ Parameters::Parameters():
     sequence2profile.push_back(&PARAM_THREADS);
     sequence2profile.push_back(&PARAM_SUB_MAT);
     sequence2profile.push_back(&PARAM_COMPRESSED);
+    sequence2profile.push_back(&PARAM_COMPRESSION_DICT);
+    sequence2profile.push_back(&PARAM_BINARY_INDEX);
+    sequence2profile.push_back(&PARAM_IO_URING);
     sequence2profile.push_back(&PARAM_V);
 
     // create fasta
@@ -435,6 +498,9 @@ Parameters::Parameters():
     result2profile.push_back(&PARAM_GAP_EXTEND);
     result2profile.push_back(&PARAM_THREADS);
     result2profile.push_back(&PARAM_COMPRESSED);
+    result2profile.push_back(&PARAM_COMPRESSION_DICT);
+    result2profile.push_back(&PARAM_BINARY_INDEX);
+    result2profile.push_back(&PARAM_IO_URING);
     result2profile.push_back(&PARAM_V);
 
     // result2pp
@@ -455,6 +521,9 @@ Parameters::Parameters():
     result2pp.push_back(&PARAM_PRELOAD_MODE);
     result2pp.push_back(&PARAM_THREADS);
     result2pp.push_back(&PARAM_COMPRESSED);
+    result2pp.push_back(&PARAM_COMPRESSION_DICT);
+    result2pp.push_back(&PARAM_BINARY_INDEX);
+    result2pp.push_back(&PARAM_IO_URING);
     result2pp.push_back(&PARAM_V);
 
     // createtsv
@@ -465,12 +534,18 @@ Parameters::Parameters():
     createtsv.push_back(&PARAM_DB_OUTPUT);
     createtsv.push_back(&PARAM_THREADS);
     createtsv.push_back(&PARAM_COMPRESSED);
+    createtsv.push_back(&PARAM_COMPRESSION_DICT);
+    createtsv.push_back(&PARAM_BINARY_INDEX);
+    createtsv.push_back(&PARAM_IO_URING);
     createtsv.push_back(&PARAM_V);
 
     //result2stats
     result2stats.push_back(&PARAM_STAT);
     result2stats.push_back(&PARAM_TSV);
     result2stats.push_back(&PARAM_COMPRESSED);
+    result2stats.push_back(&PARAM_COMPRESSION_DICT);
+    result2stats.push_back(&PARAM_BINARY_INDEX);
+    result2stats.push_back(&PARAM_IO_URING);
     result2stats.push_back(&PARAM_THREADS);
     result2stats.push_back(&PARAM_V);
 
@@ -486,6 +561,9 @@ Parameters::Parameters():
     convertalignments.push_back(&PARAM_SEARCH_TYPE);
     convertalignments.push_back(&PARAM_THREADS);
     convertalignments.push_back(&PARAM_COMPRESSED);
+    convertalignments.push_back(&PARAM_COMPRESSION_DICT);
+    convertalignments.push_back(&PARAM_BINARY_INDEX);
+    convertalignments.push_back(&PARAM_IO_URING);
     convertalignments.push_back(&PARAM_V);
 
     // result2msa
@@ -509,12 +587,18 @@ Parameters::Parameters():
     result2msa.push_back(&PARAM_GAP_OPEN);
     result2msa.push_back(&PARAM_GAP_EXTEND);
     result2msa.push_back(&PARAM_COMPRESSED);
+    result2msa.push_back(&PARAM_COMPRESSION_DICT);
+    result2msa.push_back(&PARAM_BINARY_INDEX);
+    result2msa.push_back(&PARAM_IO_URING);
     //result2msa.push_back(&PARAM_FIRST_SEQ_REP_SEQ);
     result2msa.push_back(&PARAM_V);
 
     // convertmsa
     convertmsa.push_back(&PARAM_IDENTIFIER_FIELD);
     convertmsa.push_back(&PARAM_COMPRESSED);
+    convertmsa.push_back(&PARAM_COMPRESSION_DICT);
+    convertmsa.push_back(&PARAM_BINARY_INDEX);
+    convertmsa.push_back(&PARAM_IO_URING);
     convertmsa.push_back(&PARAM_V);
 
     // msa2profile
@@ -536,6 +620,9 @@ Parameters::Parameters():
     msa2profile.push_back(&PARAM_GAP_EXTEND);
     msa2profile.push_back(&PARAM_THREADS);
     msa2profile.push_back(&PARAM_COMPRESSED);
+    msa2profile.push_back(&PARAM_COMPRESSION_DICT);
+    msa2profile.push_back(&PARAM_BINARY_INDEX);
+    msa2profile.push_back(&PARAM_IO_URING);
     msa2profile.push_back(&PARAM_V);
 
     // profile2pssm
@@ -545,6 +632,9 @@ Parameters::Parameters():
     profile2pssm.push_back(&PARAM_DB_OUTPUT);
     profile2pssm.push_back(&PARAM_THREADS);
     profile2pssm.push_back(&PARAM_COMPRESSED);
+    profile2pssm.push_back(&PARAM_COMPRESSION_DICT);
+    profile2pssm.push_back(&PARAM_BINARY_INDEX);
+    profile2pssm.push_back(&PARAM_IO_URING);
     profile2pssm.push_back(&PARAM_V);
 
     // profile2seq (profile2consensus + profile2repseq)
@@ -552,6 +642,9 @@ Parameters::Parameters():
     profile2seq.push_back(&PARAM_MAX_SEQ_LEN);
     profile2seq.push_back(&PARAM_THREADS);
     profile2seq.push_back(&PARAM_COMPRESSED);
+    profile2seq.push_back(&PARAM_COMPRESSION_DICT);
+    profile2seq.push_back(&PARAM_BINARY_INDEX);
+    profile2seq.push_back(&PARAM_IO_URING);
     profile2seq.push_back(&PARAM_V);
 
     // profile2cs
@@ -561,6 +654,9 @@ Parameters::Parameters():
     profile2cs.push_back(&PARAM_PCB);
     profile2cs.push_back(&PARAM_THREADS);
     profile2cs.push_back(&PARAM_COMPRESSED);
+    profile2cs.push_back(&PARAM_COMPRESSION_DICT);
+    profile2cs.push_back(&PARAM_BINARY_INDEX);
+    profile2cs.push_back(&PARAM_IO_URING);
     profile2cs.push_back(&PARAM_V);
 
     // extract orf
@@ -579,6 +675,9 @@ Parameters::Parameters():
     extractorfs.push_back(&PARAM_CREATE_LOOKUP);
     extractorfs.push_back(&PARAM_THREADS);
     extractorfs.push_back(&PARAM_COMPRESSED);
+    extractorfs.push_back(&PARAM_COMPRESSION_DICT);
+    extractorfs.push_back(&PARAM_BINARY_INDEX);
+    extractorfs.push_back(&PARAM_IO_URING);
     extractorfs.push_back(&PARAM_V);
 
     // extract frames
@@ -587,16 +686,25 @@ Parameters::Parameters():
     extractframes.push_back(&PARAM_CREATE_LOOKUP);
     extractframes.push_back(&PARAM_THREADS);
     extractframes.push_back(&PARAM_COMPRESSED);
+    extractframes.push_back(&PARAM_COMPRESSION_DICT);
+    extractframes.push_back(&PARAM_BINARY_INDEX);
+    extractframes.push_back(&PARAM_IO_URING);
     extractframes.push_back(&PARAM_V);
 
     // orf to contig
     orftocontig.push_back(&PARAM_THREADS);
     orftocontig.push_back(&PARAM_COMPRESSED);
+    orftocontig.push_back(&PARAM_COMPRESSION_DICT);
+    orftocontig.push_back(&PARAM_BINARY_INDEX);
+    orftocontig.push_back(&PARAM_IO_URING);
     orftocontig.push_back(&PARAM_V);
 
     // orf to contig
     reverseseq.push_back(&PARAM_THREADS);
     reverseseq.push_back(&PARAM_COMPRESSED);
+    reverseseq.push_back(&PARAM_COMPRESSION_DICT);
+    reverseseq.push_back(&PARAM_BINARY_INDEX);
+    reverseseq.push_back(&PARAM_IO_URING);
     reverseseq.push_back(&PARAM_V);
 
     // splitsequence
@@ -606,12 +714,18 @@ Parameters::Parameters():
     splitsequence.push_back(&PARAM_CREATE_LOOKUP);
     splitsequence.push_back(&PARAM_THREADS);
     splitsequence.push_back(&PARAM_COMPRESSED);
+    splitsequence.push_back(&PARAM_COMPRESSION_DICT);
+    splitsequence.push_back(&PARAM_BINARY_INDEX);
+    splitsequence.push_back(&PARAM_IO_URING);
     splitsequence.push_back(&PARAM_V);
 
     // splitdb
     splitdb.push_back(&PARAM_SPLIT);
     splitdb.push_back(&PARAM_SPLIT_AMINOACID);
     splitdb.push_back(&PARAM_COMPRESSED);
+    splitdb.push_back(&PARAM_COMPRESSION_DICT);
+    splitdb.push_back(&PARAM_BINARY_INDEX);
+    splitdb.push_back(&PARAM_IO_URING);
     splitdb.push_back(&PARAM_V);
 
     // create index
@@ -628,6 +742,10 @@ Parameters::Parameters():
     indexdb.push_back(&PARAM_S);
     indexdb.push_back(&PARAM_K_SCORE);
     indexdb.push_back(&PARAM_CHECK_COMPATIBLE);
+    indexdb.push_back(&PARAM_INDEX_COMPRESSION);
+    indexdb.push_back(&PARAM_INDEX_APPEND);
+    indexdb.push_back(&PARAM_INDEX_COMPACT);
+    indexdb.push_back(&PARAM_HUGE_PAGES);
     indexdb.push_back(&PARAM_SEARCH_TYPE);
     indexdb.push_back(&PARAM_SPLIT);
     indexdb.push_back(&PARAM_SPLIT_MEMORY_LIMIT);
@@ -661,6 +779,10 @@ Parameters::Parameters():
     createdb.push_back(&PARAM_CREATEDB_MODE);
     createdb.push_back(&PARAM_ID_OFFSET);
     createdb.push_back(&PARAM_COMPRESSED);
+    createdb.push_back(&PARAM_COMPRESSION_DICT);
+    createdb.push_back(&PARAM_BINARY_INDEX);
+    createdb.push_back(&PARAM_IO_URING);
+    createdb.push_back(&PARAM_THREADS);
     createdb.push_back(&PARAM_V);
 
     // convert2fasta
@@ -682,6 +804,9 @@ Parameters::Parameters():
     translatenucs.push_back(&PARAM_ADD_ORF_STOP);
     translatenucs.push_back(&PARAM_V);
     translatenucs.push_back(&PARAM_COMPRESSED);
+    translatenucs.push_back(&PARAM_COMPRESSION_DICT);
+    translatenucs.push_back(&PARAM_BINARY_INDEX);
+    translatenucs.push_back(&PARAM_IO_URING);
     translatenucs.push_back(&PARAM_THREADS);
 
     // createseqfiledb
@@ -691,6 +816,9 @@ Parameters::Parameters():
     createseqfiledb.push_back(&PARAM_PRELOAD_MODE);
     createseqfiledb.push_back(&PARAM_THREADS);
     createseqfiledb.push_back(&PARAM_COMPRESSED);
+    createseqfiledb.push_back(&PARAM_COMPRESSION_DICT);
+    createseqfiledb.push_back(&PARAM_BINARY_INDEX);
+    createseqfiledb.push_back(&PARAM_IO_URING);
     createseqfiledb.push_back(&PARAM_V);
 
     // filterDb
@@ -711,12 +839,18 @@ Parameters::Parameters():
     filterDb.push_back(&PARAM_JOIN_DB);
     filterDb.push_back(&PARAM_THREADS);
     filterDb.push_back(&PARAM_COMPRESSED);
+    filterDb.push_back(&PARAM_COMPRESSION_DICT);
+    filterDb.push_back(&PARAM_BINARY_INDEX);
+    filterDb.push_back(&PARAM_IO_URING);
     filterDb.push_back(&PARAM_V);
 
     // besthitperset
     besthitbyset.push_back(&PARAM_SIMPLE_BEST_HIT);
     besthitbyset.push_back(&PARAM_THREADS);
     besthitbyset.push_back(&PARAM_COMPRESSED);
+    besthitbyset.push_back(&PARAM_COMPRESSION_DICT);
+    besthitbyset.push_back(&PARAM_BINARY_INDEX);
+    besthitbyset.push_back(&PARAM_IO_URING);
     besthitbyset.push_back(&PARAM_V);
 
 
@@ -726,6 +860,9 @@ Parameters::Parameters():
 //    combinepvalperset.push_back(&PARAM_SHORT_OUTPUT);
     combinepvalbyset.push_back(&PARAM_THREADS);
     combinepvalbyset.push_back(&PARAM_COMPRESSED);
+    combinepvalbyset.push_back(&PARAM_COMPRESSION_DICT);
+    combinepvalbyset.push_back(&PARAM_BINARY_INDEX);
+    combinepvalbyset.push_back(&PARAM_IO_URING);
     combinepvalbyset.push_back(&PARAM_V);
 
 
@@ -735,6 +872,9 @@ Parameters::Parameters():
     offsetalignment.push_back(&PARAM_SEARCH_TYPE);
     offsetalignment.push_back(&PARAM_THREADS);
     offsetalignment.push_back(&PARAM_COMPRESSED);
+    offsetalignment.push_back(&PARAM_COMPRESSION_DICT);
+    offsetalignment.push_back(&PARAM_BINARY_INDEX);
+    offsetalignment.push_back(&PARAM_IO_URING);
     offsetalignment.push_back(&PARAM_PRELOAD_MODE);
     offsetalignment.push_back(&PARAM_V);
 
@@ -742,6 +882,9 @@ Parameters::Parameters():
     tsv2db.push_back(&PARAM_INCLUDE_IDENTITY);
     tsv2db.push_back(&PARAM_OUTPUT_DBTYPE);
     tsv2db.push_back(&PARAM_COMPRESSED);
+    tsv2db.push_back(&PARAM_COMPRESSION_DICT);
+    tsv2db.push_back(&PARAM_BINARY_INDEX);
+    tsv2db.push_back(&PARAM_IO_URING);
     tsv2db.push_back(&PARAM_V);
 
     // swap results
@@ -752,6 +895,9 @@ Parameters::Parameters():
     swapresult.push_back(&PARAM_GAP_EXTEND);
     swapresult.push_back(&PARAM_THREADS);
     swapresult.push_back(&PARAM_COMPRESSED);
+    swapresult.push_back(&PARAM_COMPRESSION_DICT);
+    swapresult.push_back(&PARAM_BINARY_INDEX);
+    swapresult.push_back(&PARAM_IO_URING);
     swapresult.push_back(&PARAM_PRELOAD_MODE);
     swapresult.push_back(&PARAM_V);
 
@@ -759,6 +905,9 @@ Parameters::Parameters():
     swapdb.push_back(&PARAM_SPLIT_MEMORY_LIMIT);
     swapdb.push_back(&PARAM_THREADS);
     swapdb.push_back(&PARAM_COMPRESSED);
+    swapdb.push_back(&PARAM_COMPRESSION_DICT);
+    swapdb.push_back(&PARAM_BINARY_INDEX);
+    swapdb.push_back(&PARAM_IO_URING);
     swapdb.push_back(&PARAM_V);
 
     // subtractdbs
@@ -766,6 +915,9 @@ Parameters::Parameters():
     subtractdbs.push_back(&PARAM_E_PROFILE);
     subtractdbs.push_back(&PARAM_E);
     subtractdbs.push_back(&PARAM_COMPRESSED);
+    subtractdbs.push_back(&PARAM_COMPRESSION_DICT);
+    subtractdbs.push_back(&PARAM_BINARY_INDEX);
+    subtractdbs.push_back(&PARAM_IO_URING);
     subtractdbs.push_back(&PARAM_V);
 
     // clusthash
@@ -776,6 +928,9 @@ Parameters::Parameters():
     clusthash.push_back(&PARAM_PRELOAD_MODE);
     clusthash.push_back(&PARAM_THREADS);
     clusthash.push_back(&PARAM_COMPRESSED);
+    clusthash.push_back(&PARAM_COMPRESSION_DICT);
+    clusthash.push_back(&PARAM_BINARY_INDEX);
+    clusthash.push_back(&PARAM_IO_URING);
     clusthash.push_back(&PARAM_V);
 
     // kmermatcher
@@ -798,6 +953,9 @@ Parameters::Parameters():
     kmermatcher.push_back(&PARAM_IGNORE_MULTI_KMER);
     kmermatcher.push_back(&PARAM_THREADS);
     kmermatcher.push_back(&PARAM_COMPRESSED);
+    kmermatcher.push_back(&PARAM_COMPRESSION_DICT);
+    kmermatcher.push_back(&PARAM_BINARY_INDEX);
+    kmermatcher.push_back(&PARAM_IO_URING);
     kmermatcher.push_back(&PARAM_V);
 
     // kmermatcher
@@ -812,6 +970,9 @@ Parameters::Parameters():
     kmersearch.push_back(&PARAM_SPLIT_MEMORY_LIMIT);
     kmersearch.push_back(&PARAM_THREADS);
     kmersearch.push_back(&PARAM_COMPRESSED);
+    kmersearch.push_back(&PARAM_COMPRESSION_DICT);
+    kmersearch.push_back(&PARAM_BINARY_INDEX);
+    kmersearch.push_back(&PARAM_IO_URING);
     kmersearch.push_back(&PARAM_V);
 
     // countkmer
@@ -824,6 +985,9 @@ Parameters::Parameters():
     // mergedbs
     mergedbs.push_back(&PARAM_MERGE_PREFIXES);
     mergedbs.push_back(&PARAM_COMPRESSED);
+    mergedbs.push_back(&PARAM_COMPRESSION_DICT);
+    mergedbs.push_back(&PARAM_BINARY_INDEX);
+    mergedbs.push_back(&PARAM_IO_URING);
     mergedbs.push_back(&PARAM_V);
 
     // summarize
@@ -831,12 +995,18 @@ Parameters::Parameters():
     summarizeheaders.push_back(&PARAM_HEADER_TYPE);
     summarizeheaders.push_back(&PARAM_THREADS);
     summarizeheaders.push_back(&PARAM_COMPRESSED);
+    summarizeheaders.push_back(&PARAM_COMPRESSION_DICT);
+    summarizeheaders.push_back(&PARAM_BINARY_INDEX);
+    summarizeheaders.push_back(&PARAM_IO_URING);
     summarizeheaders.push_back(&PARAM_V);
 
     // diff
     diff.push_back(&PARAM_USESEQID);
     diff.push_back(&PARAM_THREADS);
     diff.push_back(&PARAM_COMPRESSED);
+    diff.push_back(&PARAM_COMPRESSION_DICT);
+    diff.push_back(&PARAM_BINARY_INDEX);
+    diff.push_back(&PARAM_IO_URING);
     diff.push_back(&PARAM_V);
 
     // prefixid
@@ -845,6 +1015,9 @@ Parameters::Parameters():
     prefixid.push_back(&PARAM_TSV);
     prefixid.push_back(&PARAM_THREADS);
     prefixid.push_back(&PARAM_COMPRESSED);
+    prefixid.push_back(&PARAM_COMPRESSION_DICT);
+    prefixid.push_back(&PARAM_BINARY_INDEX);
+    prefixid.push_back(&PARAM_IO_URING);
     prefixid.push_back(&PARAM_V);
 
     // summarizeresult
@@ -853,6 +1026,9 @@ Parameters::Parameters():
     summarizeresult.push_back(&PARAM_C);
     summarizeresult.push_back(&PARAM_THREADS);
     summarizeresult.push_back(&PARAM_COMPRESSED);
+    summarizeresult.push_back(&PARAM_COMPRESSION_DICT);
+    summarizeresult.push_back(&PARAM_BINARY_INDEX);
+    summarizeresult.push_back(&PARAM_IO_URING);
     summarizeresult.push_back(&PARAM_V);
 
     // summarizetabs
@@ -861,6 +1037,9 @@ Parameters::Parameters():
     summarizetabs.push_back(&PARAM_C);
     summarizetabs.push_back(&PARAM_THREADS);
     summarizetabs.push_back(&PARAM_COMPRESSED);
+    summarizetabs.push_back(&PARAM_COMPRESSION_DICT);
+    summarizetabs.push_back(&PARAM_BINARY_INDEX);
+    summarizetabs.push_back(&PARAM_IO_URING);
     summarizetabs.push_back(&PARAM_V);
 
     // annoate
@@ -870,10 +1049,16 @@ Parameters::Parameters():
     extractdomains.push_back(&PARAM_C);
     extractdomains.push_back(&PARAM_THREADS);
     extractdomains.push_back(&PARAM_COMPRESSED);
+    extractdomains.push_back(&PARAM_COMPRESSION_DICT);
+    extractdomains.push_back(&PARAM_BINARY_INDEX);
+    extractdomains.push_back(&PARAM_IO_URING);
     extractdomains.push_back(&PARAM_V);
 
     // concatdbs
     concatdbs.push_back(&PARAM_COMPRESSED);
+    concatdbs.push_back(&PARAM_COMPRESSION_DICT);
+    concatdbs.push_back(&PARAM_BINARY_INDEX);
+    concatdbs.push_back(&PARAM_IO_URING);
     concatdbs.push_back(&PARAM_PRESERVEKEYS);
     concatdbs.push_back(&PARAM_TAKE_LARGER_ENTRY);
     concatdbs.push_back(&PARAM_THREADS);
@@ -881,6 +1066,9 @@ Parameters::Parameters():
 
     // extractalignedregion
     extractalignedregion.push_back(&PARAM_COMPRESSED);
+    extractalignedregion.push_back(&PARAM_COMPRESSION_DICT);
+    extractalignedregion.push_back(&PARAM_BINARY_INDEX);
+    extractalignedregion.push_back(&PARAM_IO_URING);
     extractalignedregion.push_back(&PARAM_EXTRACT_MODE);
     extractalignedregion.push_back(&PARAM_PRELOAD_MODE);
     extractalignedregion.push_back(&PARAM_THREADS);
@@ -888,18 +1076,27 @@ Parameters::Parameters():
 
     // convertkb
     convertkb.push_back(&PARAM_COMPRESSED);
+    convertkb.push_back(&PARAM_COMPRESSION_DICT);
+    convertkb.push_back(&PARAM_BINARY_INDEX);
+    convertkb.push_back(&PARAM_IO_URING);
     convertkb.push_back(&PARAM_MAPPING_FILE);
     convertkb.push_back(&PARAM_KB_COLUMNS);
     convertkb.push_back(&PARAM_V);
 
     // filtertaxdb
     filtertaxdb.push_back(&PARAM_COMPRESSED);
+    filtertaxdb.push_back(&PARAM_COMPRESSION_DICT);
+    filtertaxdb.push_back(&PARAM_BINARY_INDEX);
+    filtertaxdb.push_back(&PARAM_IO_URING);
     filtertaxdb.push_back(&PARAM_TAXON_LIST);
     filtertaxdb.push_back(&PARAM_THREADS);
     filtertaxdb.push_back(&PARAM_V);
 
     // filtertaxseqdb
     filtertaxseqdb.push_back(&PARAM_COMPRESSED);
+    filtertaxseqdb.push_back(&PARAM_COMPRESSION_DICT);
+    filtertaxseqdb.push_back(&PARAM_BINARY_INDEX);
+    filtertaxseqdb.push_back(&PARAM_IO_URING);
     filtertaxseqdb.push_back(&PARAM_TAXON_LIST);
     filtertaxseqdb.push_back(&PARAM_SUBDB_MODE);
     filtertaxseqdb.push_back(&PARAM_THREADS);
@@ -907,6 +1104,9 @@ Parameters::Parameters():
 
     // aggregatetax
     aggregatetax.push_back(&PARAM_COMPRESSED);
+    aggregatetax.push_back(&PARAM_COMPRESSION_DICT);
+    aggregatetax.push_back(&PARAM_BINARY_INDEX);
+    aggregatetax.push_back(&PARAM_IO_URING);
     aggregatetax.push_back(&PARAM_MAJORITY);
     aggregatetax.push_back(&PARAM_LCA_RANKS);
     // TODO should we add this in the future?
@@ -917,6 +1117,9 @@ Parameters::Parameters():
 
     // lca
     lca.push_back(&PARAM_COMPRESSED);
+    lca.push_back(&PARAM_COMPRESSION_DICT);
+    lca.push_back(&PARAM_BINARY_INDEX);
+    lca.push_back(&PARAM_IO_URING);
     lca.push_back(&PARAM_LCA_RANKS);
     lca.push_back(&PARAM_BLACKLIST);
     lca.push_back(&PARAM_TAXON_ADD_LINEAGE);
@@ -938,6 +1141,9 @@ Parameters::Parameters():
     addtaxonomy.push_back(&PARAM_LCA_RANKS);
     addtaxonomy.push_back(&PARAM_PICK_ID_FROM);
     addtaxonomy.push_back(&PARAM_COMPRESSED);
+    addtaxonomy.push_back(&PARAM_COMPRESSION_DICT);
+    addtaxonomy.push_back(&PARAM_BINARY_INDEX);
+    addtaxonomy.push_back(&PARAM_IO_URING);
     addtaxonomy.push_back(&PARAM_THREADS);
     addtaxonomy.push_back(&PARAM_V);
 
@@ -953,6 +1159,9 @@ Parameters::Parameters():
 
     // exapandaln
     expandaln.push_back(&PARAM_COMPRESSED);
+    expandaln.push_back(&PARAM_COMPRESSION_DICT);
+    expandaln.push_back(&PARAM_BINARY_INDEX);
+    expandaln.push_back(&PARAM_IO_URING);
     expandaln.push_back(&PARAM_EXPANSION_MODE);
     expandaln.push_back(&PARAM_SUB_MAT);
     expandaln.push_back(&PARAM_GAP_OPEN);
@@ -971,9 +1180,19 @@ Parameters::Parameters():
     expandaln.push_back(&PARAM_V);
 
     sortresult.push_back(&PARAM_COMPRESSED);
+    sortresult.push_back(&PARAM_COMPRESSION_DICT);
+    sortresult.push_back(&PARAM_BINARY_INDEX);
+    sortresult.push_back(&PARAM_IO_URING);
     sortresult.push_back(&PARAM_THREADS);
     sortresult.push_back(&PARAM_V);
 
+    // server
+    server = combineList(prefilter, align);
+
+    // prefilteralign
+    prefilteralign = combineList(prefilter, align);
+    prefilteralign.push_back(&PARAM_PREFILTER_DB);
+
     // WORKFLOWS
     searchworkflow = combineList(align, prefilter);
     searchworkflow = combineList(searchworkflow, rescorediagonal);
@@ -987,6 +1206,7 @@ Parameters::Parameters():
     searchworkflow.push_back(&PARAM_START_SENS);
     searchworkflow.push_back(&PARAM_SENS_STEPS);
     searchworkflow.push_back(&PARAM_SLICE_SEARCH);
+    searchworkflow.push_back(&PARAM_STREAM_ALIGNMENT);
     searchworkflow.push_back(&PARAM_STRAND);
     searchworkflow.push_back(&PARAM_DISK_SPACE_LIMIT);
     searchworkflow.push_back(&PARAM_RUNNER);
@@ -1097,6 +1317,9 @@ Parameters::Parameters():
     databases.push_back(&PARAM_REUSELATEST);
     databases.push_back(&PARAM_REMOVE_TMP_FILES);
     databases.push_back(&PARAM_COMPRESSED);
+    databases.push_back(&PARAM_COMPRESSION_DICT);
+    databases.push_back(&PARAM_BINARY_INDEX);
+    databases.push_back(&PARAM_IO_URING);
     databases.push_back(&PARAM_THREADS);
     databases.push_back(&PARAM_V);
 
@@ -1105,6 +1328,9 @@ Parameters::Parameters():
     tar2db.push_back(&PARAM_TAR_INCLUDE);
     tar2db.push_back(&PARAM_TAR_EXCLUDE);
     tar2db.push_back(&PARAM_COMPRESSED);
+    tar2db.push_back(&PARAM_COMPRESSION_DICT);
+    tar2db.push_back(&PARAM_BINARY_INDEX);
+    tar2db.push_back(&PARAM_IO_URING);
     tar2db.push_back(&PARAM_V);
 
     //checkSaneEnvironment();
@@ -1488,6 +1714,10 @@ void Parameters::parseParameters(int argc, const char *pargv[], const Command &c
 #ifndef OPENMP
     threads = 1;
 #endif
+    SimdDispatch::setLevel(simdLevel);
+    HugePages::setMode(hugePages);
+    AsyncIO::setEnabled(ioUring);
+    MemoryBudget::setLimit(splitMemoryLimit);
 
 
     bool ignorePathCountChecks = command.databases.empty() == false && command.databases[0].specialType & DbType::ZERO_OR_ALL && filenames.size() == 0;
@@ -1836,12 +2066,16 @@ void Parameters::setDefaults() {
     startSens = 4;
     sensSteps = 1;
     sliceSearch = false;
+    streamAlignment = false;
+    prefilterDb = "";
     strand = 1;
 
     greedyBestHits = false;
 
     threads = 1;
     compressed = WRITER_ASCII_MODE;
+    binaryResults = 0;
+    simdLevel = SimdDispatch::LEVEL_AUTO;
 #ifdef OPENMP
     char * threadEnv = getenv("MMSEQS_NUM_THREADS");
     if (threadEnv != NULL) {
@@ -1874,6 +2108,7 @@ void Parameters::setDefaults() {
     seqIdThr = 0.0;
     alnLenThr = 0;
     altAlignment = 0;
+    alignmentEngine = ALIGNMENT_ENGINE_AUTO;
     gapOpen = 11;
     gapExtend = 1;
     addBacktrace = false;
@@ -1883,6 +2118,14 @@ void Parameters::setDefaults() {
     clusterReassignment = 0;
     clusterSteps = 3;
     preloadMode = 0;
+    numaMode = NUMA_MODE_OFF;
+    prefilterBatch = 1;
+    kmerCache = 0;
+    hugePages = HugePages::MODE_OFF;
+    binaryIndex = false;
+    compressionDict = false;
+    ioUring = false;
+    sharedWriter = false;
     scoreBias = 0.0;
 
     // affinity clustering
@@ -1903,6 +2146,9 @@ void Parameters::setDefaults() {
     // indexdb
     checkCompatible = 0;
     searchType = SEARCH_TYPE_AUTO;
+    indexCompression = 0;
+    indexAppend = false;
+    indexCompact = false;
 
     // createdb
     createdbMode = SEQUENCE_SPLIT_MODE_HARD;
@@ -79,6 +79,9 @@ public:
     static const int DBTYPE_SEQTAXDB = 18; // needed for verification
     static const int DBTYPE_STDIN = 19; // needed for verification
 
+    // flag on top of the dbtype: entries are fixed-width binary records instead of text
+    static const int DBTYPE_EXTENDED_BINARY = 1 << 30;
+
 
     // don't forget to add new database types to DBReader::getDbTypeName and Parameters::PARAM_OUTPUT_DBTYPE
 
@@ -103,9 +106,29 @@ public:
     static const unsigned int ALIGNMENT_MODE_SCORE_COV_SEQID = 3;
     static const unsigned int ALIGNMENT_MODE_UNGAPPED = 4;
 
+    static const int ALIGNMENT_ENGINE_AUTO = 0;
+    static const int ALIGNMENT_ENGINE_STRIPED = 1;
+    static const int ALIGNMENT_ENGINE_INTER_SEQUENCE = 2;
+    // auto uses the inter-sequence engine up to this query length
+    static const int ALIGNMENT_ENGINE_INTER_SEQUENCE_MAX_LEN = 256;
+
+    static const int NUMA_MODE_OFF = 0;
+    static const int NUMA_MODE_INTERLEAVE = 1;
+    static const int NUMA_MODE_REPLICATE = 2;
+
     static const unsigned int WRITER_ASCII_MODE = 0;
     static const unsigned int WRITER_COMPRESSED_MODE = 1;
     static const unsigned int WRITER_LEXICOGRAPHIC_MODE = 2;
+    // compressed entries use the dictionary the writer was given, no dictionary is trained on close
+    static const unsigned int WRITER_DICTIONARY_MODE = 4;
+    // all threads write into extents of the final data file, entries may only be indexed by writeEnd
+    static const unsigned int WRITER_SHARED_MODE = 8;
+    // every thread writes ascending keys, the data files are merged in key order instead of thread order
+    static const unsigned int WRITER_KEY_ORDER_MODE = 16;
+    // compressed entries use a dictionary that is trained on the first entries and stored in .zdict
+    static const unsigned int WRITER_TRAIN_DICTIONARY_MODE = 32;
+    // a binary copy of the index (.index.bin) is written on close
+    static const unsigned int WRITER_BINARY_INDEX_MODE = 64;
 
     // convertalis alignment
     static const int FORMAT_ALIGNMENT_BLAST_TAB = 0;
@@ -316,6 +339,8 @@ public:
     int    verbosity;                    // log level
     int    threads;                      // Amounts of threads
     int    compressed;                   // compressed writer
+    int    binaryResults;                // binary prefilter and alignment results
+    int    simdLevel;                    // instruction set of the SIMD kernels
     bool   removeTmpFiles;               // Do not delete temp files
     bool   includeIdentity;              // include identical ids as hit
 
@@ -338,6 +363,14 @@ public:
     size_t diskSpaceLimit;               // Maximum disk space in bytes for sliced reverse profile search
     bool   splitAA;                      // Split database by amino acid count instead
     int    preloadMode;                  // Preload mode of database
+    int    numaMode;                     // placement of the prefilter index on NUMA nodes
+    int    prefilterBatch;               // queries matched together against the index table
+    size_t kmerCache;                    // memory per thread for the cache of similar k-mer lists
+    int    hugePages;                    // huge page backing of the index and prefilter buffers
+    bool   binaryIndex;                  // write a binary index sidecar next to every .index
+    bool   compressionDict;              // train a zstd dictionary for compressed output
+    bool   ioUring;                      // asynchronous writes and readahead through io_uring
+    bool   sharedWriter;                 // align and prefilter threads write into one data file
     float  scoreBias;                    // Add this bias to the score when computing the alignements
     std::string spacedKmerPattern;       // User-specified kmer pattern
     std::string localTmp;                // Local temporary path
@@ -353,6 +386,7 @@ public:
     int    maxRejected;                  // after n sequences that are above eval stop
     int    maxAccept;                    // after n accepted sequences stop
     int    altAlignment;                 // show up to this many alternative alignments
+    int    alignmentEngine;              // striped or inter-sequence Smith-Waterman
     float  seqIdThr;                     // sequence identity threshold for acceptance
     int    alnLenThr;                    // min. alignment length
     bool   addBacktrace;                 // store backtrace string (M=Match, D=deletion, I=insertion)
@@ -375,6 +409,8 @@ public:
     float startSens;
     int sensSteps;
     bool sliceSearch;
+    bool streamAlignment;
+    std::string prefilterDb;
     int strand;
 
     // easysearch
@@ -463,6 +499,9 @@ public:
     // indexdb
     int checkCompatible;
     int searchType;
+    int indexCompression;
+    bool indexAppend;
+    bool indexCompact;
 
     // createdb
     int identifierOffset;
@@ -620,6 +659,12 @@ public:
     PARAMETER(PARAM_K)
     PARAMETER(PARAM_THREADS)
     PARAMETER(PARAM_COMPRESSED)
+    PARAMETER(PARAM_COMPRESSION_DICT)
+    PARAMETER(PARAM_BINARY_INDEX)
+    PARAMETER(PARAM_IO_URING)
+    PARAMETER(PARAM_SHARED_WRITER)
+    PARAMETER(PARAM_SIMD_LEVEL)
+    PARAMETER(PARAM_BINARY_RESULTS)
     PARAMETER(PARAM_ALPH_SIZE)
     PARAMETER(PARAM_MAX_SEQ_LEN)
     PARAMETER(PARAM_DIAGONAL_SCORING)
@@ -642,6 +687,10 @@ public:
     PARAMETER(PARAM_REMOVE_TMP_FILES)
     PARAMETER(PARAM_INCLUDE_IDENTITY)
     PARAMETER(PARAM_PRELOAD_MODE)
+    PARAMETER(PARAM_NUMA_MODE)
+    PARAMETER(PARAM_PREFILTER_BATCH)
+    PARAMETER(PARAM_KMER_CACHE)
+    PARAMETER(PARAM_HUGE_PAGES)
     PARAMETER(PARAM_SPACED_KMER_PATTERN)
     PARAMETER(PARAM_LOCAL_TMP)
     std::vector<MMseqsParameter*> prefilter;
@@ -661,6 +710,7 @@ public:
     PARAMETER(PARAM_MIN_ALN_LEN)
     PARAMETER(PARAM_SCORE_BIAS)
     PARAMETER(PARAM_ALT_ALIGNMENT)
+    PARAMETER(PARAM_ALIGNMENT_ENGINE)
     PARAMETER(PARAM_GAP_OPEN)
     PARAMETER(PARAM_GAP_EXTEND)
     std::vector<MMseqsParameter*> align;
@@ -750,6 +800,8 @@ public:
     PARAMETER(PARAM_START_SENS)
     PARAMETER(PARAM_SENS_STEPS)
     PARAMETER(PARAM_SLICE_SEARCH)
+    PARAMETER(PARAM_STREAM_ALIGNMENT)
+    PARAMETER(PARAM_PREFILTER_DB)
     PARAMETER(PARAM_STRAND)
 
 
@@ -772,6 +824,9 @@ public:
     // indexdb
     PARAMETER(PARAM_CHECK_COMPATIBLE)
     PARAMETER(PARAM_SEARCH_TYPE)
+    PARAMETER(PARAM_INDEX_COMPRESSION)
+    PARAMETER(PARAM_INDEX_APPEND)
+    PARAMETER(PARAM_INDEX_COMPACT)
 
     // createdb
     PARAMETER(PARAM_USE_HEADER) // also used by extractorfs
@@ -993,6 +1048,8 @@ public:
     std::vector<MMseqsParameter*> enrichworkflow;
     std::vector<MMseqsParameter*> databases;
     std::vector<MMseqsParameter*> tar2db;
+    std::vector<MMseqsParameter*> server;
+    std::vector<MMseqsParameter*> prefilteralign;
 
     std::vector<MMseqsParameter*> combineList(const std::vector<MMseqsParameter*> &par1,
                                              const std::vector<MMseqsParameter*> &par2);
@@ -1005,12 +1062,28 @@ public:
 
     static void checkIfTaxDbIsComplete(std::string & filename);
 
+    // DBWriter mode of a module output with --compression-dict and --binary-index
+    size_t writerMode(bool compress) const {
+        size_t mode = compress ? WRITER_COMPRESSED_MODE : WRITER_ASCII_MODE;
+        if (compressionDict) {
+            mode |= WRITER_TRAIN_DICTIONARY_MODE;
+        }
+        if (binaryIndex) {
+            mode |= WRITER_BINARY_INDEX_MODE;
+        }
+        return mode;
+    }
+
     static bool isEqualDbtype(const int type1, const int type2) {
         return ((type1 & 0x3FFFFFFF) == (type2 & 0x3FFFFFFF));
     }
 
+    static bool isBinaryDbtype(const int dbtype) {
+        return (dbtype & DBTYPE_EXTENDED_BINARY) != 0;
+    }
+
     static const char* getDbTypeName(int dbtype) {
-        switch (dbtype & 0x7FFFFFFF) {
+        switch (dbtype & 0x3FFFFFFF) {
             case DBTYPE_AMINO_ACIDS: return "Aminoacid";
             case DBTYPE_NUCLEOTIDES: return "Nucleotide";
             case DBTYPE_HMM_PROFILE: return "Profile";
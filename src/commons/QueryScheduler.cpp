@@ -0,0 +1,128 @@
+#include "QueryScheduler.h"
+#include "Debug.h"
+
+#include <algorithm>
+
+QueryScheduler::QueryScheduler(size_t from, size_t size, unsigned int threads)
+        : from(from), size(size), threads(std::max(threads, 1u)), costs(size, 0), queues(this->threads) {}
+
+bool QueryScheduler::compareCost(const std::pair<size_t, size_t> &first, const std::pair<size_t, size_t> &second) {
+    if (first.first != second.first) {
+        return first.first > second.first;
+    }
+    return first.second < second.second;
+}
+
+void QueryScheduler::init() {
+    std::vector<std::pair<size_t, size_t> > order(size);
+    for (size_t i = 0; i < size; i++) {
+        order[i] = std::make_pair(costs[i], from + i);
+    }
+    std::sort(order.begin(), order.end(), compareCost);
+
+    for (unsigned int thread = 0; thread < threads; thread++) {
+        Queue &queue = queues[thread];
+        queue.ids.clear();
+        queue.ids.reserve(size / threads + 1);
+        queue.lock = 0;
+        queue.taken = 0;
+        queue.stolen = 0;
+        queue.busy = 0.0;
+        queue.lastStart = -1.0;
+        queue.finished = 0.0;
+    }
+    for (size_t i = 0; i < size; i++) {
+        queues[i % threads].ids.push_back(order[i].second);
+    }
+    for (unsigned int thread = 0; thread < threads; thread++) {
+        queues[thread].head = 0;
+        queues[thread].tail = queues[thread].ids.size();
+    }
+    timer.reset();
+}
+
+bool QueryScheduler::pop(Queue &queue, bool front, size_t &id) {
+    while (__sync_lock_test_and_set(&queue.lock, 1)) {
+        // spin, the lock is only held for a few instructions
+    }
+    const bool found = queue.head < queue.tail;
+    if (found) {
+        id = front ? queue.ids[queue.head++] : queue.ids[--queue.tail];
+    }
+    __sync_lock_release(&queue.lock);
+    return found;
+}
+
+bool QueryScheduler::next(unsigned int thread, size_t &id) {
+    Queue &own = queues[thread % threads];
+    const double now = timer.getTimediff();
+    if (own.lastStart >= 0.0) {
+        own.busy += now - own.lastStart;
+    }
+    own.lastStart = now;
+    if (pop(own, true, id)) {
+        own.taken++;
+        return true;
+    }
+    // the other queues are visited in a different order by every thread
+    for (unsigned int i = 1; i < threads; i++) {
+        if (pop(queues[(thread + i) % threads], false, id)) {
+            own.taken++;
+            own.stolen++;
+            return true;
+        }
+    }
+    own.lastStart = -1.0;
+    own.finished = now;
+    return false;
+}
+
+bool QueryScheduler::peek(unsigned int thread, size_t &id) {
+    Queue &own = queues[thread % threads];
+    while (__sync_lock_test_and_set(&own.lock, 1)) {
+        // spin, the lock is only held for a few instructions
+    }
+    const bool found = own.head < own.tail;
+    if (found) {
+        id = own.ids[own.head];
+    }
+    __sync_lock_release(&own.lock);
+    return found;
+}
+
+QueryScheduler::Statistics QueryScheduler::getStatistics() const {
+    Statistics stats;
+    stats.busy.resize(threads);
+    for (unsigned int thread = 0; thread < threads; thread++) {
+        const Queue &queue = queues[thread];
+        stats.end = std::max(stats.end, queue.finished);
+        stats.busy[thread] = queue.busy;
+        stats.stolen += queue.stolen;
+    }
+    return stats;
+}
+
+void QueryScheduler::Statistics::add(const Statistics &other) {
+    busy.resize(std::max(busy.size(), other.busy.size()), 0.0);
+    for (size_t thread = 0; thread < other.busy.size(); thread++) {
+        busy[thread] += other.busy[thread];
+    }
+    end += other.end;
+    stolen += other.stolen;
+}
+
+void QueryScheduler::Statistics::print() const {
+    if (busy.empty()) {
+        return;
+    }
+    double minBusy = end;
+    double maxBusy = 0.0;
+    double sumBusy = 0.0;
+    for (size_t thread = 0; thread < busy.size(); thread++) {
+        minBusy = std::min(minBusy, busy[thread]);
+        maxBusy = std::max(maxBusy, busy[thread]);
+        sumBusy += busy[thread];
+    }
+    Debug(Debug::INFO) << "Thread busy time min/avg/max: " << minBusy << "s/" << (sumBusy / busy.size()) << "s/" << maxBusy
+                       << "s of " << end << "s, " << stolen << " queries stolen\n";
+}
@@ -0,0 +1,75 @@
+#ifndef MMSEQS_QUERYSCHEDULER_H
+#define MMSEQS_QUERYSCHEDULER_H
+
+#include "Timer.h"
+
+#include <cstddef>
+#include <vector>
+
+// Hands out the ids [from, from + size) of a parallel loop in order of decreasing estimated cost, so that
+// long queries do not end up at the tail of the loop and leave the other threads idle.
+// The ids are dealt round robin to one queue per thread. A thread takes the most expensive id of its own
+// queue and steals the cheapest id of another queue once its own queue is empty.
+class QueryScheduler {
+public:
+    QueryScheduler(size_t from, size_t size, unsigned int threads);
+
+    // costs have to be set before init, ids without a cost are scheduled last
+    void setCost(size_t id, size_t cost) {
+        costs[id - from] = cost;
+    }
+
+    void init();
+
+    // next id for the calling thread, false if all queues are empty
+    bool next(unsigned int thread, size_t &id);
+
+    // id the thread takes next from its own queue, it might still be stolen. Used to read entries ahead
+    bool peek(unsigned int thread, size_t &id);
+
+    // busy time of the threads since init, the statistics of several schedulers can be summed up with add
+    struct Statistics {
+        std::vector<double> busy;
+        double end;
+        size_t stolen;
+
+        Statistics() : end(0.0), stolen(0) {}
+        void add(const Statistics &other);
+        // a single line with the min/avg/max busy time of the threads
+        void print() const;
+    };
+
+    Statistics getStatistics() const;
+
+    void printStatistics() const {
+        getStatistics().print();
+    }
+
+private:
+    // padded so that the queues of different threads do not share a cache line
+    struct Queue {
+        std::vector<size_t> ids;
+        size_t head;
+        size_t tail;
+        int lock;
+        size_t taken;
+        size_t stolen;
+        double busy;
+        double lastStart;
+        double finished;
+        char padding[64];
+    };
+
+    bool pop(Queue &queue, bool front, size_t &id);
+
+    static bool compareCost(const std::pair<size_t, size_t> &first, const std::pair<size_t, size_t> &second);
+
+    const size_t from;
+    const size_t size;
+    const unsigned int threads;
+    std::vector<size_t> costs;
+    std::vector<Queue> queues;
+    Timer timer;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "SimdDispatch.h"
+#include "Debug.h"
+#include "Util.h"
+
+#ifndef NEON
+#include "CpuInfo.h"
+#endif
+
+int SimdDispatch::level = SimdDispatch::getBestLevel();
+
+const char *SimdDispatch::getLevelName(int level) {
+    switch (level) {
+        case LEVEL_AUTO:
+            return "auto";
+        case LEVEL_SSE41:
+#ifdef NEON
+            return "NEON";
+#else
+            return "SSE4.1";
+#endif
+        case LEVEL_AVX2:
+            return "AVX2";
+        case LEVEL_AVX512BW:
+            return "AVX-512BW";
+        default:
+            return "unknown";
+    }
+}
+
+bool SimdDispatch::isAvailable(int level) {
+#ifdef SIMD_DISPATCH
+    if (level < LEVEL_SSE41 || level > LEVEL_AVX512BW) {
+        return false;
+    }
+#elif defined(AVX2)
+    if (level != LEVEL_AVX2) {
+        return false;
+    }
+#else
+    if (level != LEVEL_SSE41) {
+        return false;
+    }
+#endif
+
+#ifdef NEON
+    return true;
+#else
+    CpuInfo info;
+    switch (level) {
+        case LEVEL_SSE41:
+            return info.HW_SSE41;
+        case LEVEL_AVX2:
+            return info.HW_AVX2 && info.OS_AVX;
+        case LEVEL_AVX512BW:
+            return info.HW_AVX512F && info.HW_AVX512BW && info.OS_AVX512;
+        default:
+            return false;
+    }
+#endif
+}
+
+int SimdDispatch::getBestLevel() {
+    // AVX-512BW has to be requested explicitly, the 64 byte vectors did not outperform AVX2 in
+    // TestAlignmentPerformance and TestDiagonalScoringPerformance on the CPUs we benchmarked
+    for (int i = LEVEL_AVX2; i > LEVEL_SSE41; i--) {
+        if (isAvailable(i)) {
+            return i;
+        }
+    }
+    // checkCpu reports machines below the minimum requirements
+#if defined(AVX2) && !defined(SIMD_DISPATCH)
+    return LEVEL_AVX2;
+#else
+    return LEVEL_SSE41;
+#endif
+}
+
+void SimdDispatch::setLevel(int requested) {
+    if (requested == LEVEL_AUTO) {
+        level = getBestLevel();
+        return;
+    }
+    if (isAvailable(requested) == false) {
+        Debug(Debug::ERROR) << "SIMD level " << getLevelName(requested) << " is not supported by this binary or CPU\n";
+        EXIT(EXIT_FAILURE);
+    }
+    level = requested;
+}
@@ -0,0 +1,49 @@
+#ifndef MMSEQS_SIMDDISPATCH_H
+#define MMSEQS_SIMDDISPATCH_H
+
+// The SIMD kernels (StripedSmithWatermanKernel.cpp, UngappedAlignmentKernel.cpp, CacheFriendlyOperationsKernel.cpp)
+// are compiled once per instruction set into the namespaces simd_sse41, simd_avx2 and simd_avx512bw if MMseqs2
+// is built with HAVE_SIMD_DISPATCH (the default on x86-64, see src/CMakeLists.txt). Otherwise they are compiled once for the instruction set
+// of the build into simd_native. SimdDispatch decides at runtime which of them is used.
+class SimdDispatch {
+public:
+    static const int LEVEL_AUTO = 0;
+    static const int LEVEL_SSE41 = 1;
+    static const int LEVEL_AVX2 = 2;
+    static const int LEVEL_AVX512BW = 3;
+
+    // LEVEL_AUTO selects the best level that is available, AVX-512BW is only used if requested
+    static void setLevel(int requested);
+
+    static int getLevel() {
+        return level;
+    }
+
+    static const char *getLevelName(int level);
+
+    // level is compiled into this binary and supported by the CPU and OS
+    static bool isAvailable(int level);
+
+    static int getBestLevel();
+
+private:
+    static int level;
+};
+
+// declares a kernel factory in the namespace of every compiled instruction set
+// and calls the one of the selected level
+#ifdef SIMD_DISPATCH
+#define SIMD_DISPATCH_DECLARE(decl) \
+    namespace simd_sse41 { decl; } \
+    namespace simd_avx2 { decl; } \
+    namespace simd_avx512bw { decl; }
+#define SIMD_DISPATCH_CALL(call) \
+    ((SimdDispatch::getLevel() == SimdDispatch::LEVEL_AVX512BW) ? simd_avx512bw::call : \
+     (SimdDispatch::getLevel() == SimdDispatch::LEVEL_AVX2) ? simd_avx2::call : simd_sse41::call)
+#else
+#define SIMD_DISPATCH_DECLARE(decl) \
+    namespace simd_native { decl; }
+#define SIMD_DISPATCH_CALL(call) (simd_native::call)
+#endif
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef MMSEQS_SIMDKERNEL_H
+#define MMSEQS_SIMDKERNEL_H
+
+// Has to be the first include of a translation unit that is compiled once per instruction set.
+// simd.h is placed in the namespace of the instruction set, since the bodies of its inline
+// helpers differ between the builds and must not be merged by the linker.
+#ifndef SIMD_NS
+#define SIMD_NS simd_native
+#endif
+
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+#include <iostream>
+#ifdef NEON
+#include "sse2neon.h"
+#else
+#include <immintrin.h>
+#endif
+
+// The instruction set of a kernel is only enabled between SIMD_KERNEL_BEGIN and SIMD_KERNEL_END, around
+// its namespace. The file itself is compiled with the flags of the baseline, so that the inline functions
+// of shared headers (STL, Debug.h, ...) emitted in it are identical to the copies of all other objects.
+#if defined(SIMD_DISPATCH) && defined(AVX512)
+#define SIMD_TARGET "avx512bw"
+#elif defined(SIMD_DISPATCH) && defined(AVX2)
+#define SIMD_TARGET "avx2"
+#endif
+
+// the pragma argument is expanded before it is turned into a string
+#define SIMD_KERNEL_PRAGMA_STRING(x) _Pragma(#x)
+#define SIMD_KERNEL_PRAGMA(x) SIMD_KERNEL_PRAGMA_STRING(x)
+#if !defined(SIMD_TARGET)
+#define SIMD_KERNEL_BEGIN
+#define SIMD_KERNEL_END
+#elif defined(__clang__)
+#define SIMD_KERNEL_BEGIN SIMD_KERNEL_PRAGMA(clang attribute push(__attribute__((target(SIMD_TARGET))), apply_to = function))
+#define SIMD_KERNEL_END SIMD_KERNEL_PRAGMA(clang attribute pop)
+#else
+#define SIMD_KERNEL_BEGIN SIMD_KERNEL_PRAGMA(GCC push_options) SIMD_KERNEL_PRAGMA(GCC target(SIMD_TARGET))
+#define SIMD_KERNEL_END SIMD_KERNEL_PRAGMA(GCC pop_options)
+#endif
+
+SIMD_KERNEL_BEGIN
+namespace SIMD_NS {
+#include "simd.h"
+}
+SIMD_KERNEL_END
+// instruction set independent helper used by common headers
+using SIMD_NS::mem_align;
+
+#endif
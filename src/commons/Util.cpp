@@ -16,6 +16,7 @@
 
 #include "simd.h"
 #include "MemoryMapped.h"
+#include "MemoryBudget.h"
 #include <algorithm>
 #include <sys/mman.h>
 #include <fstream>      // std::ifstream
@@ -357,15 +358,12 @@ size_t Util::getTotalMemoryPages() {
     return phys_pages;
 }
 
-// in bytes
+// physical memory in bytes, MemoryBudget::getAvailable also applies cgroup and rlimit limits
 size_t Util::getTotalSystemMemory() {
     // check for real physical memory
     long pages = getTotalMemoryPages();
     long page_size = getPageSize();
     uint64_t sysMemory = pages * page_size;
-    // check for ulimit
-//    struct rlimit limit;
-//    getrlimit(RLIMIT_MEMLOCK, &limit);
     return sysMemory;
 }
 
@@ -392,7 +390,7 @@ char Util::touchMemory(const char *memory, size_t size) {
         Debug(Debug::ERROR) << "posix_madvise returned an error (touchMemory)\n";
     }
 #endif
-    if(size > Util::getTotalSystemMemory()){
+    if(size > MemoryBudget::getAvailable()){
         Debug(Debug::WARNING) << "Can not touch " << size << " into main memory\n";
         return 0;
     }
@@ -157,6 +157,11 @@ public:
         return (data+1);
     }
 
+    static inline const char * skipLine(const char * data){
+        while( *data !='\n' ) { data++; }
+        return (data+1);
+    }
+
     static inline char * seekToNextEntry(char * data){
         while( *data !='\0' ) { data++; }
         return (data+1);
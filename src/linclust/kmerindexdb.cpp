@@ -8,6 +8,7 @@
 #include "ReducedMatrix.h"
 #include "KmerIndex.h"
 #include "kmersearch.h"
+#include "MemoryBudget.h"
 
 #ifndef SIZE_T_MAX
 #define SIZE_T_MAX ((size_t) -1)
@@ -74,12 +75,7 @@ int kmerindexdb(int argc, const char **argv, const Command &command) {
     size_t chooseTopKmer = par.kmersPerSequence;
 
     // memoryLimit in bytes
-    size_t memoryLimit;
-    if (par.splitMemoryLimit > 0) {
-        memoryLimit = par.splitMemoryLimit;
-    } else {
-        memoryLimit = static_cast<size_t>(Util::getTotalSystemMemory() * 0.9);
-    }
+    size_t memoryLimit = MemoryBudget::getLimit();
     Debug(Debug::INFO) << "\n";
     size_t totalKmers = computeKmerCount(seqDbr, KMER_SIZE, chooseTopKmer);
     totalKmers *= par.pickNbest;
@@ -167,7 +163,7 @@ int kmerindexdb(int argc, const char **argv, const Command &command) {
 #endif
     if(mpiRank == 0){
         // write result
-        DBWriter dbw(indexDB.c_str(), (indexDB+".index").c_str(), 1, par.compressed, Parameters::DBTYPE_INDEX_DB );
+        DBWriter dbw(indexDB.c_str(), (indexDB+".index").c_str(), 1, par.writerMode(par.compressed), Parameters::DBTYPE_INDEX_DB );
         dbw.open();
 
         Debug(Debug::INFO) << "Write VERSION (" << PrefilteringIndexReader::VERSION << ")\n";
@@ -19,6 +19,7 @@
 #include "ExtendedSubstitutionMatrix.h"
 #include "KmerGenerator.h"
 #include "MarkovKmerScore.h"
+#include "MemoryBudget.h"
 #include "xxhash.h"
 #include <limits>
 #include <string>
@@ -593,12 +594,7 @@ int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr) {
     //seqDbr.readMmapedDataInMemory();
 
     // memoryLimit in bytes
-    size_t memoryLimit;
-    if (par.splitMemoryLimit > 0) {
-        memoryLimit = par.splitMemoryLimit;
-    } else {
-        memoryLimit = static_cast<size_t>(Util::getTotalSystemMemory() * 0.9);
-    }
+    size_t memoryLimit = MemoryBudget::getLimit();
     Debug(Debug::INFO) << "\n";
     size_t totalKmers = computeKmerCount(seqDbr, par.kmerSize, par.kmersPerSequence, par.kmersPerSequenceScale);
     size_t totalSizeNeeded = computeMemoryNeededLinearfilter<T>(totalKmers);
@@ -663,7 +659,7 @@ int kmermatcherInner(Parameters& par, DBReader<unsigned int>& seqDbr) {
         std::vector<char> repSequence(seqDbr.getLastKey()+1);
         std::fill(repSequence.begin(), repSequence.end(), false);
         // write result
-        DBWriter dbw(par.db2.c_str(), par.db2Index.c_str(), 1, par.compressed,
+        DBWriter dbw(par.db2.c_str(), par.db2Index.c_str(), 1, par.writerMode(par.compressed),
                      (Parameters::isEqualDbtype(seqDbr.getDbtype(), Parameters::DBTYPE_NUCLEOTIDES)) ? Parameters::DBTYPE_PREFILTER_REV_RES : Parameters::DBTYPE_PREFILTER_RES );
         dbw.open();
 
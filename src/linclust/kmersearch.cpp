@@ -14,6 +14,7 @@
 #include "Timer.h"
 #include "KmerIndex.h"
 #include "FileUtil.h"
+#include "MemoryBudget.h"
 
 #include "omptl/omptl_algorithm"
 
@@ -193,12 +194,7 @@ int kmersearch(int argc, const char **argv, const Command &command) {
     size_t chooseTopKmer = par.kmersPerSequence;
 
     // memoryLimit in bytes
-    size_t memoryLimit;
-    if (par.splitMemoryLimit > 0) {
-        memoryLimit = par.splitMemoryLimit;
-    } else {
-        memoryLimit = static_cast<size_t>(Util::getTotalSystemMemory() * 0.9);
-    }
+    size_t memoryLimit = MemoryBudget::getLimit();
 
     size_t totalKmers = computeKmerCount(queryDbr, KMER_SIZE, chooseTopKmer);
     size_t totalSizeNeeded = computeMemoryNeededLinearfilter<short>(totalKmers);
@@ -257,7 +253,7 @@ int kmersearch(int argc, const char **argv, const Command &command) {
             KmerPosition<short> *kmers = result.first;
             size_t kmerCount = result.second;
             if (splits == 1) {
-                DBWriter dbw(tmpFiles.first.c_str(), tmpFiles.second.c_str(), 1, par.compressed, outDbType);
+                DBWriter dbw(tmpFiles.first.c_str(), tmpFiles.second.c_str(), 1, par.writerMode(par.compressed), outDbType);
                 dbw.open();
                 if (Parameters::isEqualDbtype(queryDbr.getDbtype(), Parameters::DBTYPE_NUCLEOTIDES)) {
                     KmerSearch::writeResult<Parameters::DBTYPE_NUCLEOTIDES>(dbw, kmers, kmerCount);
@@ -280,7 +276,7 @@ int kmersearch(int argc, const char **argv, const Command &command) {
     tidxdbr.close();
     queryDbr.close();
     if(splitFiles.size()>1){
-        DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), 1, par.compressed, outDbType);
+        DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), 1, par.writerMode(par.compressed), outDbType);
         writer.open(); // 1 GB buffer
         std::vector<char> empty;
         if(Parameters::isEqualDbtype(querySeqType, Parameters::DBTYPE_NUCLEOTIDES)) {
@@ -7,8 +7,8 @@
 #endif
 
 Aggregation::Aggregation(const std::string &targetDbName, const std::string &resultDbName,
-                         const std::string &outputDbName, unsigned int threads, unsigned int compressed)
-        : resultDbName(resultDbName), outputDbName(outputDbName), threads(threads), compressed(compressed) {
+                         const std::string &outputDbName, unsigned int threads, size_t writerMode)
+        : resultDbName(resultDbName), outputDbName(outputDbName), threads(threads), writerMode(writerMode) {
     std::string sizeDbName = targetDbName + "_member_to_set";
     std::string sizeDbIndex = targetDbName + "_member_to_set.index";
     targetSetReader = new DBReader<unsigned int>(sizeDbName.c_str(), sizeDbIndex.c_str(), threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
@@ -50,7 +50,7 @@ int Aggregation::run() {
     reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
     std::string outputDBIndex = outputDbName + ".index";
-    DBWriter writer(outputDbName.c_str(), outputDBIndex.c_str(), threads, compressed, Parameters::DBTYPE_ALIGNMENT_RES);
+    DBWriter writer(outputDbName.c_str(), outputDBIndex.c_str(), threads, writerMode, Parameters::DBTYPE_ALIGNMENT_RES);
     writer.open();
     Debug::Progress progress(reader.getSize());
 
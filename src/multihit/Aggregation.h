@@ -10,7 +10,7 @@
 class Aggregation {
 public:
     Aggregation(const std::string &targetDbName, const std::string &resultDbName, const std::string &outputDbName,
-                unsigned int threads, unsigned int compressed);
+                unsigned int threads, size_t writerMode);
 
     virtual ~Aggregation();
 
@@ -23,7 +23,7 @@ protected:
     std::string outputDbName;
     DBReader<unsigned int> *targetSetReader;
     unsigned int threads;
-    unsigned int compressed;
+    size_t writerMode;
 
     void buildMap(char *data, int thread_idx, std::map<unsigned int, std::vector<std::vector<std::string>>> &dataToAggregate);
 };
@@ -10,8 +10,8 @@
 class BestHitBySetFilter : public Aggregation {
 public :
     BestHitBySetFilter(const std::string &targetDbName, const std::string &resultDbName,
-                       const std::string &outputDbName, bool simpleBestHitMode, unsigned int threads, unsigned int compressed) :
-            Aggregation(targetDbName, resultDbName, outputDbName, threads, compressed), simpleBestHitMode(simpleBestHitMode) {
+                       const std::string &outputDbName, bool simpleBestHitMode, unsigned int threads, size_t writerMode) :
+            Aggregation(targetDbName, resultDbName, outputDbName, threads, writerMode), simpleBestHitMode(simpleBestHitMode) {
         std::string sizeDbName = targetDbName + "_set_size";
         std::string sizeDbIndex = targetDbName + "_set_size.index";
         targetSizeReader = new DBReader<unsigned int>(sizeDbName.c_str(), sizeDbIndex.c_str(), threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
@@ -124,6 +124,6 @@ int besthitperset(int argc, const char **argv, const Command &command) {
     Parameters &par = Parameters::getInstance();
     par.parseParameters(argc, argv, command, true, 0, 0);
 
-    BestHitBySetFilter aggregation(par.db2, par.db3, par.db4, par.simpleBestHit, (unsigned int) par.threads, par.compressed);
+    BestHitBySetFilter aggregation(par.db2, par.db3, par.db4, par.simpleBestHit, (unsigned int) par.threads, par.writerMode(par.compressed));
     return aggregation.run();
 }
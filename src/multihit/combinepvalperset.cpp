@@ -29,8 +29,8 @@ void precomputeLogB(const unsigned int orfCount, const double pvalThreshold, dou
 class PvalueAggregator : public Aggregation {
 public:
     PvalueAggregator(std::string queryDbName, std::string targetDbName, const std::string &resultDbName,
-                     const std::string &outputDbName, float alpha, unsigned int threads, unsigned int compressed, int aggregationMode) :
-            Aggregation(targetDbName, resultDbName, outputDbName, threads, compressed), alpha(alpha), aggregationMode(aggregationMode) {
+                     const std::string &outputDbName, float alpha, unsigned int threads, size_t writerMode, int aggregationMode) :
+            Aggregation(targetDbName, resultDbName, outputDbName, threads, writerMode), alpha(alpha), aggregationMode(aggregationMode) {
 
         std::string sizeDBName = queryDbName + "_set_size";
         std::string sizeDBIndex = queryDbName + "_set_size.index";
@@ -204,6 +204,6 @@ int combinepvalperset(int argc, const char **argv, const Command &command) {
     Parameters &par = Parameters::getInstance();
     par.parseParameters(argc, argv, command, true, 0, 0);
 
-    PvalueAggregator aggregation(par.db1, par.db2, par.db3, par.db4, par.alpha, (unsigned int) par.threads, par.compressed, par.aggregationMode);
+    PvalueAggregator aggregation(par.db1, par.db2, par.db3, par.db4, par.alpha, (unsigned int) par.threads, par.writerMode(par.compressed), par.aggregationMode);
     return aggregation.run();
 }
@@ -55,8 +55,8 @@ class SetSummaryAggregator : public Aggregation {
 public:
     SetSummaryAggregator(const std::string &queryDbName, const std::string &targetDbName,
                          const std::string &resultDbName, const std::string &outputDbName, bool shortOutput,
-                         float alpha, unsigned int threads, unsigned int compressed)
-            : Aggregation(targetDbName, resultDbName, outputDbName, threads, compressed), alpha(alpha), shortOutput(shortOutput) {
+                         float alpha, unsigned int threads, size_t writerMode)
+            : Aggregation(targetDbName, resultDbName, outputDbName, threads, writerMode), alpha(alpha), shortOutput(shortOutput) {
         std::string data = queryDbName + "_set_size";
         std::string index = queryDbName + "_set_size.index";
         querySizeReader = new DBReader<unsigned int>(data.c_str(), index.c_str(), threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
@@ -215,6 +215,6 @@ int resultsbyset(int argc, const char **argv, const Command &command) {
     Parameters &par = Parameters::getInstance();
     par.parseParameters(argc, argv, command, true, 0, 0);
 
-    SetSummaryAggregator aggregation(par.db1, par.db2, par.db3, par.db4, par.shortOutput, par.alpha, (unsigned int) par.threads, par.compressed);
+    SetSummaryAggregator aggregation(par.db1, par.db2, par.db3, par.db4, par.shortOutput, par.alpha, (unsigned int) par.threads, par.writerMode(par.compressed));
     return aggregation.run();
 }
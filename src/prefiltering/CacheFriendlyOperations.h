@@ -52,6 +52,25 @@ struct  __attribute__((__packed__))  CounterResult {
     unsigned char count;
 };
 
+// bins and buffers of a CacheFriendlyOperations, the binning kernels that work on them are
+// compiled once per instruction set in CacheFriendlyOperationsKernel.cpp, see SimdDispatch.h
+struct CacheFriendlyBins {
+    struct  __attribute__((__packed__))  TmpResult {
+        unsigned int  id;
+        unsigned short diagonal;
+        unsigned char score;
+    };
+    // pointer for hashing
+    CounterResult ** bins;
+    unsigned int binCount;
+    // array to keep the bin elements
+    CounterResult * binDataFrame;
+    size_t binSize;
+    unsigned char * duplicateBitArray;
+    size_t duplicateBitArraySize;
+    TmpResult *tmpElementBuffer;
+};
+
 template<unsigned int BINSIZE> class CacheFriendlyOperations{
 public:
     // 00000000000000000000000111111111
@@ -65,6 +84,15 @@ public:
 
     size_t countElements(IndexEntryLocal **input, CounterResult *output,
                          size_t outputSize, unsigned short indexFrom, unsigned short indexTo, bool computeTotalScore);
+
+    // counts k-mer lists that are hashed one by one straight from the IndexTable instead of from a copy
+    // call startHashing, hashEntries for each list and findHashedDuplicates at the end
+    void startHashing();
+    void hashEntries(unsigned short position_i, const IndexEntryLocal *input, size_t N) {
+        hashIndexEntry(position_i, input, N, this->bins, (binDataFrame + BINCOUNT * binSize) - 1);
+    }
+    // false if a bin overflowed, the bins were enlarged and all lists have to be hashed again
+    bool findHashedDuplicates(CounterResult *output, size_t outputSize, bool computeTotalScore, size_t &resultSize);
     // merge elements in CounterResult
     // assumption is that each element (diagonalMatcher.id) exists maximal two times
     size_t mergeElementsByScore(CounterResult *inputOutputArray, const size_t N);
@@ -86,13 +114,15 @@ private:
     CounterResult * binDataFrame;
 
 
-    struct  __attribute__((__packed__))  TmpResult {
-        unsigned int  id;
-        unsigned short diagonal;
-        unsigned char score;
-    };
+    typedef CacheFriendlyBins::TmpResult TmpResult;
     // needed to temporary keep ids
     TmpResult *tmpElementBuffer;
+
+    CacheFriendlyBins getBins() {
+        CacheFriendlyBins result = { bins, BINCOUNT, binDataFrame, binSize, duplicateBitArray, duplicateBitArraySize, tmpElementBuffer };
+        return result;
+    }
+
     // detect if overflow occurs
     bool checkForOverflowAndResizeArray(CounterResult **bins,
                                         const unsigned int binCount,
@@ -105,24 +135,18 @@ private:
     void setupBinPointer(CounterResult **bins, const unsigned int binCount,
                          CounterResult *binDataFrame, const size_t binSize);
 
-    // hash input array based on MASK_0_5
-    void hashElements(CounterResult *inputArray, size_t N, CounterResult **hashBins);
-
-    // hash index entry and compute diagonal
-    void hashIndexEntry(unsigned short position_i, IndexEntryLocal *inputArray,
-                        size_t N, CounterResult **hashBins, CounterResult * lastPosition);
-
-    // detect duplicates in diagonal
-    size_t findDuplicates(CounterResult **bins, unsigned int binCount,
-                          CounterResult * output, size_t outputSize, bool findDuplicates);
-
-    // merge by id and combine score
-    size_t mergeDuplicates(CounterResult **bins, unsigned int binCount, CounterResult *output);
-
-    //
-    size_t mergeDiagonalDuplicates(CounterResult **bins, unsigned int binCount, CounterResult *output);
-
-    size_t keepMaxElement(CounterResult **pResult, const unsigned int bincount, CounterResult *pCounterResult);
+    // hash index entry and compute diagonal, inlined into the direct hashing of the QueryMatcher
+    void hashIndexEntry(unsigned short position_i, const IndexEntryLocal *inputArray,
+                        size_t N, CounterResult **hashBins, CounterResult * lastPosition) {
+        for(size_t n = 0; n < N; n++) {
+            const IndexEntryLocal element = inputArray[n];
+            const unsigned int bin_id = (element.seqId & MASK_0_5);
+            hashBins[bin_id]->id    = element.seqId;
+            hashBins[bin_id]->diagonal = position_i - element.position_j;
+            // do not write over boundary of the data frame
+            hashBins[bin_id] += (hashBins[bin_id] >= lastPosition) ? 0 : 1;
+        }
+    }
 };
 
 #undef BITS_TO_REPRESENT
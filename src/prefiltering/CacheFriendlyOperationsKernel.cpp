@@ -0,0 +1,243 @@
+// Binning kernels of CacheFriendlyOperations, compiled once per instruction set (see SimdDispatch.h).
+// They are plain loops over the bins that the compiler vectorizes for the instruction set of the namespace.
+
+#include "SimdKernel.h"
+#include "CacheFriendlyOperations.h"
+#include "Util.h"
+
+SIMD_KERNEL_BEGIN
+namespace SIMD_NS {
+
+template<unsigned int BINSIZE>
+void hashElements(const CacheFriendlyBins &data, CounterResult *inputArray, size_t N) {
+    typedef CacheFriendlyOperations<BINSIZE> Operations;
+    CounterResult * lastPosition = (data.binDataFrame + data.binCount * data.binSize) - 1;
+    for(size_t n = 0; n < N; n++) {
+        const CounterResult element = inputArray[n];
+        const unsigned int bin_id  = (element.id & Operations::MASK_0_5);
+        data.bins[bin_id]->id       = element.id;
+        data.bins[bin_id]->diagonal = element.diagonal;
+        data.bins[bin_id]->count    = element.count;
+
+        // do not write over boundary of the data frame
+        data.bins[bin_id] += (data.bins[bin_id] >= lastPosition) ? 0 : 1;
+    }
+}
+
+template<unsigned int BINSIZE>
+size_t findDuplicates(const CacheFriendlyBins &data, CounterResult *output, size_t outputSize, bool computeTotalScore) {
+    typedef CacheFriendlyOperations<BINSIZE> Operations;
+    size_t doubleElementCount = 0;
+    const CounterResult * bin_ref_pointer = data.binDataFrame;
+    for (size_t bin = 0; bin < data.binCount; bin++) {
+        const CounterResult *binStartPos = (bin_ref_pointer + bin * data.binSize);
+        const size_t currBinSize = (data.bins[bin] - binStartPos);
+        size_t elementCount = 0;
+        // find duplicates
+        for (size_t n = 0; n < currBinSize; n++) {
+            const CounterResult element = binStartPos[n];
+            const unsigned int hashBinElement = element.id >> (Operations::MASK_0_5_BIT);
+            //const unsigned int byteArrayPos = hashBinElement >> 3; // equal to  hashBinElement / 8
+            //const unsigned char bitPosMask = 1 << (hashBinElement & 7);  // 7 = 00000111
+            // check if duplicate element was found before
+            const unsigned char currDiagonal = element.diagonal;
+            //currDiagonal = (currDiagonal == 0) ? 200 : currDiagonal;
+            const unsigned char prevDiagonal = data.duplicateBitArray[hashBinElement];
+            data.tmpElementBuffer[elementCount].id = element.id;
+            data.tmpElementBuffer[elementCount].diagonal = element.diagonal;
+            elementCount += (UNLIKELY(currDiagonal == prevDiagonal)) ? 1 : 0;
+            // set element corresponding bit in byte
+            data.duplicateBitArray[hashBinElement] = currDiagonal;
+        }
+        // check for overflow
+        if(doubleElementCount + elementCount >= outputSize){
+            return doubleElementCount;
+        }
+//        // set memory to zero
+        if(computeTotalScore){
+            for (size_t n = 0; n < elementCount; n++) {
+                const unsigned int element = data.tmpElementBuffer[n].id >> (Operations::MASK_0_5_BIT);
+                data.duplicateBitArray[element] = 0;
+            }
+            // sum up score
+            for (size_t n = 0; n < elementCount; n++) {
+                const unsigned int element = data.tmpElementBuffer[n].id >> (Operations::MASK_0_5_BIT);
+                data.duplicateBitArray[element] += (data.duplicateBitArray[element] < 255) ? 1 : 0;
+            }
+            // extract results
+            for (size_t n = 0; n < elementCount; n++) {
+                const unsigned int element = data.tmpElementBuffer[n].id;
+                const unsigned int hashBinElement = element >> (Operations::MASK_0_5_BIT);
+                output[doubleElementCount].id    = element;
+                output[doubleElementCount].count = data.duplicateBitArray[hashBinElement];
+                output[doubleElementCount].diagonal = data.tmpElementBuffer[n].diagonal;
+
+                // memory overflow can not happen since input array = output array
+                doubleElementCount += (data.duplicateBitArray[hashBinElement] != 0) ? 1 : 0;
+                data.duplicateBitArray[hashBinElement] = 0;
+            }
+        }else{
+            // set duplicate bit array to first diagonal + 1
+            // so (data.duplicateBitArray[hashBinElement] != data.tmpElementBuffer[n].diagonal) is true
+            size_t n = elementCount - 1;
+            while ( n != static_cast<size_t>(-1) )
+            {
+                const unsigned int element = data.tmpElementBuffer[n].id >> (Operations::MASK_0_5_BIT);
+                data.duplicateBitArray[element] = static_cast<unsigned char>(data.tmpElementBuffer[n].diagonal) + 1;
+                --n;
+            }
+
+            // extract results
+            for (size_t n = 0; n < elementCount; n++) {
+                const unsigned int element = data.tmpElementBuffer[n].id;
+                const unsigned int hashBinElement = element >> (Operations::MASK_0_5_BIT);
+                output[doubleElementCount].id    = element;
+                output[doubleElementCount].count = data.tmpElementBuffer[n].score;
+                output[doubleElementCount].diagonal = data.tmpElementBuffer[n].diagonal;
+    //            const unsigned char diagonal = static_cast<unsigned char>(data.tmpElementBuffer[n].diagonal);
+                // memory overflow can not happen since input array = output array
+    //            if(data.duplicateBitArray[hashBinElement] != data.tmpElementBuffer[n].diagonal){
+    //                std::cout << "seq="<< output[doubleElementCount].id << "\tDiag=" << (int) output[doubleElementCount].diagonal
+    //                <<  " dup.Array=" << (int)data.duplicateBitArray[hashBinElement] << " tmp.Arr="<< (int)data.tmpElementBuffer[n].diagonal << std::endl;
+    //            }
+                doubleElementCount += (data.duplicateBitArray[hashBinElement] != static_cast<unsigned char>(data.tmpElementBuffer[n].diagonal)) ? 1 : 0;
+
+                data.duplicateBitArray[hashBinElement] = static_cast<unsigned char>(data.tmpElementBuffer[n].diagonal);
+            }
+        }
+        // clean memory faster if current bin size is smaller data.duplicateBitArraySize
+        if(currBinSize < data.duplicateBitArraySize/16){
+            for (size_t n = 0; n < currBinSize; n++) {
+                const unsigned int byteArrayPos = binStartPos[n].id >> (Operations::MASK_0_5_BIT);
+                data.duplicateBitArray[byteArrayPos] = 0;
+            }
+        }else{
+            memset(data.duplicateBitArray, 0, data.duplicateBitArraySize * sizeof(unsigned char));
+        }
+    }
+    return doubleElementCount;
+}
+
+template<unsigned int BINSIZE>
+size_t mergeDuplicates(const CacheFriendlyBins &data, CounterResult *output) {
+    typedef CacheFriendlyOperations<BINSIZE> Operations;
+    size_t doubleElementCount = 0;
+    const CounterResult *bin_ref_pointer = data.binDataFrame;
+    memset(data.duplicateBitArray, 0, data.duplicateBitArraySize * sizeof(unsigned char));
+
+    for (size_t bin = 0; bin < data.binCount; bin++) {
+        const CounterResult *binStartPos = (bin_ref_pointer + bin * data.binSize);
+        const size_t currBinSize = (data.bins[bin] - binStartPos);
+        // merge double hits
+        for (size_t n = 0; n < currBinSize; n++) {
+            const CounterResult element = binStartPos[n];
+            const unsigned int hashBinElement = element.id >> (Operations::MASK_0_5_BIT);
+            const unsigned char currScore = element.count;
+            const unsigned char dbScore = data.duplicateBitArray[hashBinElement];
+            const unsigned char newScore = (currScore > 0xFF - dbScore) ? 0xFF : dbScore + currScore;
+            data.duplicateBitArray[hashBinElement] = newScore;
+        }
+        // extract final scores and set dubplicateBitArray to 0
+        for (size_t n = 0; n < currBinSize; n++) {
+            const CounterResult element = binStartPos[n];
+            const unsigned int hashBinElement = element.id >> (Operations::MASK_0_5_BIT);
+            output[doubleElementCount].id    = element.id;
+            output[doubleElementCount].count = data.duplicateBitArray[hashBinElement];
+            output[doubleElementCount].diagonal = element.diagonal;
+            // memory overflow can not happen since input array = output array
+            doubleElementCount += (UNLIKELY(data.duplicateBitArray[hashBinElement] != 0  ) ) ? 1 : 0;
+            data.duplicateBitArray[hashBinElement] = static_cast<unsigned char>(data.tmpElementBuffer[n].diagonal);
+        }
+    }
+    return doubleElementCount;
+}
+
+template<unsigned int BINSIZE>
+size_t mergeDiagonalDuplicates(const CacheFriendlyBins &data, CounterResult *output) {
+    typedef CacheFriendlyOperations<BINSIZE> Operations;
+    size_t doubleElementCount = 0;
+    const CounterResult *bin_ref_pointer = data.binDataFrame;
+
+    for (size_t bin = 0; bin < data.binCount; bin++) {
+        const CounterResult *binStartPos = (bin_ref_pointer + bin * data.binSize);
+        const size_t currBinSize = (data.bins[bin] - binStartPos);
+        size_t n = currBinSize - 1;
+        // write diagonals + 1 in reverse order in the byte array
+        while ( n != static_cast<size_t>(-1) )
+        {
+            const unsigned int element = binStartPos[n].id >> (Operations::MASK_0_5_BIT);
+            data.duplicateBitArray[element] = static_cast<unsigned char>(data.tmpElementBuffer[n].diagonal) + 1;
+            --n;
+        }
+        // combine diagonals
+        for (size_t n = 0; n < currBinSize; n++) {
+            const CounterResult element = binStartPos[n];
+            const unsigned int hashBinElement = element.id >> (Operations::MASK_0_5_BIT);
+            output[doubleElementCount].id    = element.id;
+            output[doubleElementCount].count = element.count;
+            output[doubleElementCount].diagonal = element.diagonal;
+//            std::cout << output[doubleElementCount].id << " " << (int)output[doubleElementCount].count << " " << (int)static_cast<unsigned char>(output[doubleElementCount].diagonal) << std::endl;
+            // memory overflow can not happen since input array = output array
+            doubleElementCount += (data.duplicateBitArray[hashBinElement] != static_cast<unsigned char>(data.tmpElementBuffer[n].diagonal)) ? 1 : 0;
+
+            data.duplicateBitArray[hashBinElement] = static_cast<unsigned char>(element.diagonal);
+        }
+    }
+    return doubleElementCount;
+}
+
+template<unsigned int BINSIZE>
+size_t keepMaxElement(const CacheFriendlyBins &data, CounterResult *output) {
+    typedef CacheFriendlyOperations<BINSIZE> Operations;
+    size_t doubleElementCount = 0;
+    const CounterResult *bin_ref_pointer = data.binDataFrame;
+    memset(data.duplicateBitArray, 0, data.duplicateBitArraySize * sizeof(unsigned char));
+    for (size_t bin = 0; bin < data.binCount; bin++) {
+        const CounterResult *binStartPos = (bin_ref_pointer + bin * data.binSize);
+        const size_t currBinSize = (data.bins[bin] - binStartPos);
+        // found max element and store it in data.duplicateBitArray
+        for (size_t n = 0; n < currBinSize; n++) {
+            const CounterResult element = binStartPos[n];
+            const unsigned int hashBinElement = element.id >> (Operations::MASK_0_5_BIT);
+            const unsigned char currScore = element.count;
+            const unsigned char dbScore = data.duplicateBitArray[hashBinElement];
+            const unsigned char maxScore = (currScore > dbScore) ? currScore : dbScore;
+            data.duplicateBitArray[hashBinElement] = maxScore;
+        }
+        // extract final scores and set dubplicateBitArray to 0
+        for (size_t n = 0; n < currBinSize; n++) {
+            const CounterResult element = binStartPos[n];
+            const unsigned int hashBinElement = element.id >> (Operations::MASK_0_5_BIT);
+            output[doubleElementCount].id = element.id;
+            output[doubleElementCount].count = element.count;
+            output[doubleElementCount].diagonal = element.diagonal;
+            // memory overflow can not happen since input array = output array
+            bool found = (UNLIKELY(data.duplicateBitArray[hashBinElement] == element.count)) ? 1 : 0;
+            doubleElementCount += found;
+            data.duplicateBitArray[hashBinElement] = data.duplicateBitArray[hashBinElement] * (1 - found);
+        }
+    }
+    return doubleElementCount;
+}
+
+#define INSTANTIATE_KERNELS(x) \
+    template void hashElements<x>(const CacheFriendlyBins &data, CounterResult *inputArray, size_t N); \
+    template size_t findDuplicates<x>(const CacheFriendlyBins &data, CounterResult *output, size_t outputSize, bool computeTotalScore); \
+    template size_t mergeDuplicates<x>(const CacheFriendlyBins &data, CounterResult *output); \
+    template size_t mergeDiagonalDuplicates<x>(const CacheFriendlyBins &data, CounterResult *output); \
+    template size_t keepMaxElement<x>(const CacheFriendlyBins &data, CounterResult *output);
+INSTANTIATE_KERNELS(2048)
+INSTANTIATE_KERNELS(1024)
+INSTANTIATE_KERNELS(512)
+INSTANTIATE_KERNELS(256)
+INSTANTIATE_KERNELS(128)
+INSTANTIATE_KERNELS(64)
+INSTANTIATE_KERNELS(32)
+INSTANTIATE_KERNELS(16)
+INSTANTIATE_KERNELS(8)
+INSTANTIATE_KERNELS(4)
+INSTANTIATE_KERNELS(2)
+#undef INSTANTIATE_KERNELS
+
+}
+SIMD_KERNEL_END
@@ -1,5 +1,9 @@
 #include "IndexBuilder.h"
 #include "tantan.h"
+#include "ByteParser.h"
+#include "Timer.h"
+
+#include <vector>
 
 #ifdef OPENMP
 #include <omp.h>
@@ -49,19 +53,167 @@ public:
     size_t *sequenceOffsets;
 };
 
+// Radix partitioned construction of the k-mer lists. The k-mers are partitioned into buckets of consecutive k-mers.
+// Every part of the database counts its k-mers per bucket, so each part fills its own range of every bucket without
+// atomics. Each bucket is then sorted by a counting sort over its k-mers, whose counts fit into the cache.
+// The parts consist of consecutive sequences, so the lists come out sorted by sequence id.
+class KmerBuckets {
+public:
+    KmerBuckets(size_t tableSize, size_t partCount) : tableSize(tableSize), partCount(partCount), maxBucketSize(0), kmerInBucket(NULL) {
+        // at most 2^16 k-mers per bucket, so the k-mer within its bucket fits into an unsigned short
+        bucketBits = 12;
+        while (bucketBits < 16 && (tableSize >> bucketBits) > MAX_BUCKETS) {
+            bucketBits++;
+        }
+        bucketKmers = static_cast<size_t>(1) << bucketBits;
+        bucketCount = (tableSize + bucketKmers - 1) >> bucketBits;
+        positions = new size_t[partCount * bucketCount];
+        memset(positions, 0, partCount * bucketCount * sizeof(size_t));
+        bucketOffsets = new size_t[bucketCount + 1];
+    }
+
+    ~KmerBuckets() {
+        delete[] positions;
+        delete[] bucketOffsets;
+        if (kmerInBucket != NULL) {
+            HugePages::release(kmerInBucket);
+        }
+    }
+
+    void count(size_t part, const IndexEntryLocalTmp *kmers, size_t kmerCount) {
+        size_t *partCounts = positions + part * bucketCount;
+        for (size_t i = 0; i < kmerCount; i++) {
+            partCounts[kmers[i].kmer >> bucketBits]++;
+        }
+    }
+
+    // turns the counts into the positions where each part writes its entries of a bucket, returns the number of entries
+    size_t initPositions() {
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < bucketCount; bucket++) {
+            bucketOffsets[bucket] = offset;
+            for (size_t part = 0; part < partCount; part++) {
+                const size_t count = positions[part * bucketCount + bucket];
+                positions[part * bucketCount + bucket] = offset;
+                offset += count;
+            }
+            maxBucketSize = std::max(maxBucketSize, offset - bucketOffsets[bucket]);
+        }
+        bucketOffsets[bucketCount] = offset;
+        kmerInBucket = static_cast<unsigned short *>(HugePages::allocate(offset * sizeof(unsigned short)));
+        Util::checkAllocation(kmerInBucket, "Can not allocate k-mer bucket memory in IndexBuilder");
+        return offset;
+    }
+
+    void fill(size_t part, const IndexEntryLocalTmp *kmers, size_t kmerCount, IndexEntryLocal *entries) {
+        size_t *partPositions = positions + part * bucketCount;
+        for (size_t i = 0; i < kmerCount; i++) {
+            const unsigned int kmer = kmers[i].kmer;
+            const size_t pos = partPositions[kmer >> bucketBits]++;
+            entries[pos].seqId = kmers[i].seqId;
+            entries[pos].position_j = kmers[i].position_j;
+            kmerInBucket[pos] = static_cast<unsigned short>(kmer & (bucketKmers - 1));
+        }
+    }
+
+    // sorts the entries of every bucket by k-mer and sets the offsets of the k-mer lists
+    void sort(IndexEntryLocal *entries, size_t *offsets) {
+        #pragma omp parallel
+        {
+            IndexEntryLocal *sorted = new IndexEntryLocal[std::max(maxBucketSize, static_cast<size_t>(1))];
+            size_t *kmerPositions = new size_t[bucketKmers];
+
+            #pragma omp for schedule(dynamic, 1)
+            for (size_t bucket = 0; bucket < bucketCount; bucket++) {
+                const size_t from = bucketOffsets[bucket];
+                const size_t to = bucketOffsets[bucket + 1];
+                const size_t kmerFrom = bucket << bucketBits;
+                const size_t kmers = std::min(bucketKmers, tableSize - kmerFrom);
+                memset(kmerPositions, 0, kmers * sizeof(size_t));
+                for (size_t i = from; i < to; i++) {
+                    kmerPositions[kmerInBucket[i]]++;
+                }
+                size_t offset = 0;
+                for (size_t kmer = 0; kmer < kmers; kmer++) {
+                    const size_t count = kmerPositions[kmer];
+                    offsets[kmerFrom + kmer] = from + offset;
+                    kmerPositions[kmer] = offset;
+                    offset += count;
+                }
+                // stable, the entries of a k-mer keep their order by sequence id
+                for (size_t i = from; i < to; i++) {
+                    sorted[kmerPositions[kmerInBucket[i]]++] = entries[i];
+                }
+                memcpy(entries + from, sorted, (to - from) * sizeof(IndexEntryLocal));
+            }
+
+            delete[] kmerPositions;
+            delete[] sorted;
+        }
+        offsets[tableSize] = bucketOffsets[bucketCount];
+    }
+
+    // memory of the partitioning, including the sort buffers of all threads
+    size_t getMemorySize(unsigned int threads) {
+        return (partCount * bucketCount + bucketCount + 1) * sizeof(size_t)
+               + bucketOffsets[bucketCount] * sizeof(unsigned short)
+               + threads * (maxBucketSize * sizeof(IndexEntryLocal) + bucketKmers * sizeof(size_t));
+    }
+
+private:
+    static const size_t MAX_BUCKETS = 65536;
+
+    const size_t tableSize;
+    const size_t partCount;
+    unsigned int bucketBits;
+    size_t bucketKmers;
+    size_t bucketCount;
+    size_t maxBucketSize;
+
+    // position of the next entry of a part in a bucket, the counts before initPositions
+    size_t *positions;
+    size_t *bucketOffsets;
+    unsigned short *kmerInBucket;
+};
+
 
 void IndexBuilder::fillDatabase(IndexTable *indexTable, SequenceLookup **maskedLookup,
                                 SequenceLookup **unmaskedLookup,BaseMatrix &subMat, Sequence *seq,
                                 DBReader<unsigned int> *dbr, size_t dbFrom, size_t dbTo, int kmerThr,
-                                bool mask, bool maskLowerCaseMode) {
+                                bool mask, bool maskLowerCaseMode, bool radixBuild) {
     Debug(Debug::INFO) << "Index table: counting k-mers\n";
+    Timer timer;
 
     const bool isProfile = Parameters::isEqualDbtype(seq->getSeqType(), Parameters::DBTYPE_HMM_PROFILE);
+    radixBuild = radixBuild && isProfile == false;
 
     dbTo = std::min(dbTo, dbr->getSize());
     size_t dbSize = dbTo - dbFrom;
     DbInfo* info = new DbInfo(dbFrom, dbTo, seq->getEffectiveKmerSize(), *dbr);
 
+    unsigned int threads = 1;
+#ifdef OPENMP
+    threads = static_cast<unsigned int>(omp_get_max_threads());
+#endif
+    // every part is processed by one thread in order of the sequence ids. The atomic counts use parts of 100 sequences,
+    // the buckets a few parts per thread of the same number of residues, since every part needs its own bucket counts
+    std::vector<size_t> partOffsets;
+    if (radixBuild) {
+        const size_t partCount = std::min(dbSize, static_cast<size_t>(threads) * 4);
+        for (size_t part = 0; part < partCount; part++) {
+            const size_t residues = (info->aaDbSize * part) / partCount;
+            partOffsets.push_back(dbFrom + (std::lower_bound(info->sequenceOffsets, info->sequenceOffsets + dbSize, residues) - info->sequenceOffsets));
+        }
+    } else {
+        for (size_t id = dbFrom; id < dbTo; id += 100) {
+            partOffsets.push_back(id);
+        }
+    }
+    partOffsets.push_back(dbTo);
+    const size_t partCount = partOffsets.size() - 1;
+    KmerBuckets *buckets = radixBuild ? new KmerBuckets(indexTable->getTableSize(), partCount) : NULL;
+    const size_t lookupMemory = ((maskedLookup != NULL) + (unmaskedLookup != NULL)) * (info->aaDbSize + (dbSize + 1) * sizeof(size_t));
+
     SequenceLookup *sequenceLookup;
     if (unmaskedLookup != NULL && maskedLookup == NULL) {
         *unmaskedLookup = new SequenceLookup(dbSize, info->aaDbSize);
@@ -110,59 +262,71 @@ void IndexBuilder::fillDatabase(IndexTable *indexTable, SequenceLookup **maskedL
         }
 
         unsigned int *buffer = new unsigned int[seq->getMaxLen()];
-        #pragma omp for schedule(dynamic, 100) reduction(+:totalKmerCount, maskedResidues)
-        for (size_t id = dbFrom; id < dbTo; id++) {
-            progress.updateProgress();
-
-            s.resetCurrPos();
-            char *seqData = dbr->getData(id, thread_idx);
-            unsigned int qKey = dbr->getDbKey(id);
-
-            s.mapSequence(id - dbFrom, qKey, seqData, dbr->getSeqLen(id));
-
-            // count similar or exact k-mers based on sequence type
-            if (isProfile) {
-                // Find out if we should also mask profiles
-                totalKmerCount += indexTable->addSimilarKmerCount(&s, generator);
-                (*unmaskedLookup)->addSequence(s.numConsensusSequence, s.L, id - dbFrom, info->sequenceOffsets[id - dbFrom]);
-            } else {
-                // Do not mask if column state sequences are used
-                if (unmaskedLookup != NULL) {
-                    (*unmaskedLookup)->addSequence(s.numSequence, s.L, id - dbFrom, info->sequenceOffsets[id - dbFrom]);
-                }
-                if (mask == true) {
-                    // s.print();
-                    maskedResidues += tantan::maskSequences((char*)s.numSequence,
-                                                            (char*)(s.numSequence + s.L),
-                                                            50 /*options.maxCycleLength*/,
-                                                            probMatrix->probMatrixPointers,
-                                                            0.005 /*options.repeatProb*/,
-                                                            0.05 /*options.repeatEndProb*/,
-                                                            0.9 /*options.repeatOffsetProbDecay*/,
-                                                            0, 0,
-                                                            0.9 /*options.minMaskProb*/,
-                                                            probMatrix->hardMaskTable);
-                }
+        IndexEntryLocalTmp *kmerBuffer = radixBuild ? new IndexEntryLocalTmp[seq->getMaxLen()] : NULL;
+        #pragma omp for schedule(dynamic, 1) reduction(+:totalKmerCount, maskedResidues)
+        for (size_t part = 0; part < partCount; part++) {
+            for (size_t id = partOffsets[part]; id < partOffsets[part + 1]; id++) {
+                progress.updateProgress();
+
+                s.resetCurrPos();
+                char *seqData = dbr->getData(id, thread_idx);
+                unsigned int qKey = dbr->getDbKey(id);
+
+                s.mapSequence(id - dbFrom, qKey, seqData, dbr->getSeqLen(id));
+
+                // count similar or exact k-mers based on sequence type
+                if (isProfile) {
+                    // Find out if we should also mask profiles
+                    totalKmerCount += indexTable->addSimilarKmerCount(&s, generator);
+                    (*unmaskedLookup)->addSequence(s.numConsensusSequence, s.L, id - dbFrom, info->sequenceOffsets[id - dbFrom]);
+                } else {
+                    // Do not mask if column state sequences are used
+                    if (unmaskedLookup != NULL) {
+                        (*unmaskedLookup)->addSequence(s.numSequence, s.L, id - dbFrom, info->sequenceOffsets[id - dbFrom]);
+                    }
+                    if (mask == true) {
+                        // s.print();
+                        maskedResidues += tantan::maskSequences((char*)s.numSequence,
+                                                                (char*)(s.numSequence + s.L),
+                                                                50 /*options.maxCycleLength*/,
+                                                                probMatrix->probMatrixPointers,
+                                                                0.005 /*options.repeatProb*/,
+                                                                0.05 /*options.repeatEndProb*/,
+                                                                0.9 /*options.repeatOffsetProbDecay*/,
+                                                                0, 0,
+                                                                0.9 /*options.minMaskProb*/,
+                                                                probMatrix->hardMaskTable);
+                    }
 
-                if(maskLowerCaseMode == true && (Parameters::isEqualDbtype(s.getSequenceType(), Parameters::DBTYPE_AMINO_ACIDS) ||
-                                                  Parameters::isEqualDbtype(s.getSequenceType(), Parameters::DBTYPE_NUCLEOTIDES))) {
-                    const char * charSeq = s.getSeqData();
-                    unsigned char maskLetter = subMat.aa2num[static_cast<int>('X')];
-                    for (int i = 0; i < s.L; i++) {
-                        bool isLowerCase = (islower(charSeq[i]));
-                        maskedResidues += isLowerCase;
-                        s.numSequence[i] = isLowerCase ? maskLetter : s.numSequence[i];
+                    if(maskLowerCaseMode == true && (Parameters::isEqualDbtype(s.getSequenceType(), Parameters::DBTYPE_AMINO_ACIDS) ||
+                                                      Parameters::isEqualDbtype(s.getSequenceType(), Parameters::DBTYPE_NUCLEOTIDES))) {
+                        const char * charSeq = s.getSeqData();
+                        unsigned char maskLetter = subMat.aa2num[static_cast<int>('X')];
+                        for (int i = 0; i < s.L; i++) {
+                            bool isLowerCase = (islower(charSeq[i]));
+                            maskedResidues += isLowerCase;
+                            s.numSequence[i] = isLowerCase ? maskLetter : s.numSequence[i];
+                        }
+                    }
+                    if(maskedLookup != NULL){
+                        (*maskedLookup)->addSequence(s.numSequence, s.L, id - dbFrom, info->sequenceOffsets[id - dbFrom]);
                     }
-                }
-                if(maskedLookup != NULL){
-                    (*maskedLookup)->addSequence(s.numSequence, s.L, id - dbFrom, info->sequenceOffsets[id - dbFrom]);
-                }
 
-                totalKmerCount += indexTable->addKmerCount(&s, &idxer, buffer, kmerThr, idScoreLookup);
+                    if (buckets != NULL) {
+                        const size_t kmerCount = indexTable->extractKmers(&s, &idxer, kmerBuffer, kmerThr, idScoreLookup);
+                        buckets->count(part, kmerBuffer, kmerCount);
+                        totalKmerCount += kmerCount;
+                    } else {
+                        totalKmerCount += indexTable->addKmerCount(&s, &idxer, buffer, kmerThr, idScoreLookup);
+                    }
+                }
             }
         }
 
         delete[] buffer;
+        if (kmerBuffer != NULL) {
+            delete[] kmerBuffer;
+        }
 
         if (generator != NULL) {
             delete generator;
@@ -200,8 +364,12 @@ void IndexBuilder::fillDatabase(IndexTable *indexTable, SequenceLookup **maskedL
 //    Debug(Debug::INFO) << "Index table: Remove "<< lowSelectiveResidues <<" none selective residues\n";
 //    Debug(Debug::INFO) << "Index table: init... from "<< dbFrom << " to "<< dbTo << "\n";
 
-    indexTable->initMemory(info->tableSize);
-    indexTable->init();
+    if (buckets != NULL) {
+        indexTable->initMemory(info->tableSize, buckets->initPositions());
+    } else {
+        indexTable->initMemory(info->tableSize);
+        indexTable->init();
+    }
 
     delete info;
     Debug::Progress progress2(dbTo-dbFrom);
@@ -223,18 +391,24 @@ void IndexBuilder::fillDatabase(IndexTable *indexTable, SequenceLookup **maskedL
             generator->setDivideStrategy(s.profile_matrix);
         }
 
-        #pragma omp for schedule(dynamic, 100)
-        for (size_t id = dbFrom; id < dbTo; id++) {
-            s.resetCurrPos();
-            progress2.updateProgress();
-
-            unsigned int qKey = dbr->getDbKey(id);
-            if (isProfile) {
-                s.mapSequence(id - dbFrom, qKey, dbr->getData(id, thread_idx), dbr->getSeqLen(id));
-                indexTable->addSimilarSequence(&s, generator, &idxer);
-            } else {
-                s.mapSequence(id - dbFrom, qKey, sequenceLookup->getSequence(id - dbFrom));
-                indexTable->addSequence(&s, &idxer, buffer, kmerThr, idScoreLookup);
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t part = 0; part < partCount; part++) {
+            for (size_t id = partOffsets[part]; id < partOffsets[part + 1]; id++) {
+                s.resetCurrPos();
+                progress2.updateProgress();
+
+                unsigned int qKey = dbr->getDbKey(id);
+                if (isProfile) {
+                    s.mapSequence(id - dbFrom, qKey, dbr->getData(id, thread_idx), dbr->getSeqLen(id));
+                    indexTable->addSimilarSequence(&s, generator, &idxer);
+                } else if (buckets != NULL) {
+                    s.mapSequence(id - dbFrom, qKey, sequenceLookup->getSequence(id - dbFrom));
+                    const size_t kmerCount = indexTable->extractKmers(&s, &idxer, buffer, kmerThr, idScoreLookup);
+                    buckets->fill(part, buffer, kmerCount, indexTable->getEntries());
+                } else {
+                    s.mapSequence(id - dbFrom, qKey, sequenceLookup->getSequence(id - dbFrom));
+                    indexTable->addSequence(&s, &idxer, buffer, kmerThr, idScoreLookup);
+                }
             }
         }
 
@@ -247,6 +421,15 @@ void IndexBuilder::fillDatabase(IndexTable *indexTable, SequenceLookup **maskedL
     if(idScoreLookup!=NULL){
         delete[] idScoreLookup;
     }
-    indexTable->revertPointer();
-    indexTable->sortDBSeqLists();
+    size_t peakMemory = lookupMemory + indexTable->getMemorySize();
+    if (buckets != NULL) {
+        Debug(Debug::INFO) << "Index table: sort\n";
+        buckets->sort(indexTable->getEntries(), indexTable->getOffsets());
+        peakMemory += buckets->getMemorySize(threads);
+        delete buckets;
+    } else {
+        indexTable->revertPointer();
+        indexTable->sortDBSeqLists();
+    }
+    Debug(Debug::INFO) << "Index table: built in " << timer.lap() << " with a peak memory of " << ByteParser::format(peakMemory) << "\n";
 }
@@ -5,9 +5,12 @@
 
 class IndexBuilder {
 public:
+    // radixBuild partitions the k-mers of sequence databases into buckets instead of counting them with atomics,
+    // profile databases are always built with the atomic counts
     static void fillDatabase(IndexTable *indexTable, SequenceLookup **maskedLookup, SequenceLookup **unmaskedLookup,
                              BaseMatrix &subMat, Sequence *seq,
-                             DBReader<unsigned int> *dbr, size_t dbFrom, size_t dbTo, int kmerThr, bool mask, bool maskLowerCaseMode);
+                             DBReader<unsigned int> *dbr, size_t dbFrom, size_t dbTo, int kmerThr, bool mask, bool maskLowerCaseMode,
+                             bool radixBuild = true);
 };
 
 #endif
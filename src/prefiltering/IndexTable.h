@@ -16,6 +16,7 @@
 #include "MathUtil.h"
 #include "KmerGenerator.h"
 #include "Parameters.h"
+#include "HugePages.h"
 
 #include <algorithm>
 
@@ -66,9 +67,10 @@ public:
     IndexTable(int alphabetSize, int kmerSize, bool externalData)
             : tableSize(MathUtil::ipow<size_t>(alphabetSize, kmerSize)), alphabetSize(alphabetSize),
               kmerSize(kmerSize), externalData(externalData), tableEntriesNum(0), size(0),
-              indexer(new Indexer(alphabetSize, kmerSize)), entries(NULL), offsets(NULL) {
+              indexer(new Indexer(alphabetSize, kmerSize)), entries(NULL), offsets(NULL),
+              compressedEntries(NULL), compressedSize(0), kmerOffsets(NULL), blockOffsets(NULL) {
         if (externalData == false) {
-            offsets = new(std::nothrow) size_t[tableSize + 1];
+            offsets = static_cast<size_t *>(HugePages::allocate((tableSize + 1) * sizeof(size_t)));
             Util::checkAllocation(offsets, "Can not allocate entries memory in IndexTable");
             memset(offsets, 0, (tableSize + 1) * sizeof(size_t));
         }
@@ -82,13 +84,25 @@ public:
     void deleteEntries() {
         if (externalData == false) {
             if (entries != NULL) {
-                delete[] entries;
+                HugePages::release(entries);
                 entries = NULL;
             }
             if (offsets != NULL) {
-                delete[] offsets;
+                HugePages::release(offsets);
                 offsets = NULL;
             }
+            if (compressedEntries != NULL) {
+                HugePages::release(compressedEntries);
+                compressedEntries = NULL;
+            }
+            if (kmerOffsets != NULL) {
+                HugePages::release(kmerOffsets);
+                kmerOffsets = NULL;
+            }
+            if (blockOffsets != NULL) {
+                HugePages::release(blockOffsets);
+                blockOffsets = NULL;
+            }
         }
     }
 
@@ -182,6 +196,100 @@ public:
         return (entries + offsets[kmer]);
     }
 
+    bool isCompressed() {
+        return compressedEntries != NULL;
+    }
+
+    // get the encoded list of DB sequences containing this k-mer, it is read by decodeDBSeqList
+    inline const unsigned char *getCompressedDBSeqList(size_t kmer, size_t *matchedListSize) {
+        const unsigned char *list = compressedEntries + blockOffsets[kmer / COMPRESSED_BLOCK_KMERS] + kmerOffsets[kmer];
+        const unsigned char *next = compressedEntries + blockOffsets[(kmer + 1) / COMPRESSED_BLOCK_KMERS] + kmerOffsets[kmer + 1];
+        if (list == next) {
+            *matchedListSize = 0;
+            return list;
+        }
+        *matchedListSize = readVarint(list);
+        return list;
+    }
+
+    // unpacks the (seqId delta, position) pairs, the entries array has at least 8 bytes padding
+    // so every pair can be read with one unaligned 64 bit load
+    static inline void decodeDBSeqList(const unsigned char *list, size_t listSize, IndexEntryLocal *out) {
+        unsigned int seqId = static_cast<unsigned int>(readVarint(list));
+        const unsigned int idBits = list[0];
+        const unsigned int posBits = list[1];
+        list += 2;
+        const uint64_t idMask = (UINT64_C(1) << idBits) - 1;
+        const uint64_t posMask = (UINT64_C(1) << posBits) - 1;
+        const unsigned int entryBits = idBits + posBits;
+        size_t bitPos = 0;
+        for (size_t i = 0; i < listSize; i++) {
+            uint64_t word;
+            memcpy(&word, list + (bitPos >> 3), sizeof(uint64_t));
+            word >>= (bitPos & 7);
+            seqId += static_cast<unsigned int>(word & idMask);
+            out[i].seqId = seqId;
+            out[i].position_j = static_cast<unsigned short>((word >> idBits) & posMask);
+            bitPos += entryBits;
+        }
+    }
+
+    // replaces entries and offsets by the compressed layout
+    void compressEntries() {
+        const size_t blockCount = tableSize / COMPRESSED_BLOCK_KMERS + 1;
+        kmerOffsets = static_cast<uint32_t *>(HugePages::allocate((tableSize + 1) * sizeof(uint32_t)));
+        Util::checkAllocation(kmerOffsets, "Can not allocate kmerOffsets memory in IndexTable::compressEntries");
+        blockOffsets = static_cast<size_t *>(HugePages::allocate(blockCount * sizeof(size_t)));
+        Util::checkAllocation(blockOffsets, "Can not allocate blockOffsets memory in IndexTable::compressEntries");
+
+        // offsets of the lists relative to their block, the block sizes are summed up afterwards
+        bool blockOverflow = false;
+        #pragma omp parallel for schedule(dynamic, 1) reduction(||:blockOverflow)
+        for (size_t block = 0; block < blockCount; block++) {
+            const size_t from = block * COMPRESSED_BLOCK_KMERS;
+            const size_t to = std::min(from + COMPRESSED_BLOCK_KMERS, tableSize + 1);
+            size_t blockSize = 0;
+            for (size_t kmer = from; kmer < to; kmer++) {
+                if (blockSize > UINT32_MAX) {
+                    blockOverflow = true;
+                }
+                kmerOffsets[kmer] = static_cast<uint32_t>(blockSize);
+                if (kmer < tableSize) {
+                    size_t entrySize;
+                    IndexEntryLocal *list = getDBSeqList(kmer, &entrySize);
+                    blockSize += encodeDBSeqList(list, entrySize, NULL);
+                }
+            }
+            blockOffsets[block] = blockSize;
+        }
+        if (blockOverflow) {
+            Debug(Debug::ERROR) << "K-mer lists are too large to be compressed. Please create the index with more splits.\n";
+            EXIT(EXIT_FAILURE);
+        }
+        size_t offset = 0;
+        for (size_t block = 0; block < blockCount; block++) {
+            const size_t blockSize = blockOffsets[block];
+            blockOffsets[block] = offset;
+            offset += blockSize;
+        }
+
+        compressedSize = offset + sizeof(uint64_t);
+        compressedEntries = static_cast<unsigned char *>(HugePages::allocate(compressedSize));
+        Util::checkAllocation(compressedEntries, "Can not allocate " + SSTR(compressedSize) + " bytes for compressed entries in IndexTable::compressEntries");
+        memset(compressedEntries, 0, compressedSize);
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (size_t kmer = 0; kmer < tableSize; kmer++) {
+            size_t entrySize;
+            IndexEntryLocal *list = getDBSeqList(kmer, &entrySize);
+            encodeDBSeqList(list, entrySize, compressedEntries + blockOffsets[kmer / COMPRESSED_BLOCK_KMERS] + kmerOffsets[kmer]);
+        }
+
+        HugePages::release(entries);
+        entries = NULL;
+        HugePages::release(offsets);
+        offsets = NULL;
+    }
+
     void sortDBSeqLists() {
         #pragma omp parallel for
         for (size_t i = 0; i < tableSize; i++) {
@@ -210,12 +318,16 @@ public:
         for (size_t i = 0; i < getTableSize(); i++) {
             tableEntriesNum += getOffset(i);
         }
+        initMemory(dbSize, tableEntriesNum);
+    }
 
+    // init the arrays for tableEntriesNum entries, the offsets are set by the caller
+    void initMemory(size_t dbSize, size_t tableEntriesNum) {
         this->tableEntriesNum = tableEntriesNum;
         this->size = dbSize; // amount of sequences added
 
         // allocate memory for the sequence id lists
-        entries = new(std::nothrow) IndexEntryLocal[tableEntriesNum];
+        entries = static_cast<IndexEntryLocal *>(HugePages::allocate(tableEntriesNum * sizeof(IndexEntryLocal)));
         Util::checkAllocation(entries, "Can not allocate entries memory in IndexTable::initMemory");
     }
 
@@ -244,13 +356,68 @@ public:
         this->tableEntriesNum = tableEntriesNum;
         this->size = sequenceCount;
 
-        this->entries = new(std::nothrow) IndexEntryLocal[tableEntriesNum];
+        this->entries = static_cast<IndexEntryLocal *>(HugePages::allocate(tableEntriesNum * sizeof(IndexEntryLocal)));
         Util::checkAllocation(entries, "Can not allocate " + SSTR(tableEntriesNum * sizeof(IndexEntryLocal)) + " bytes for entries in IndexTable::initMemory");
         memcpy(this->entries, entries, tableEntriesNum * sizeof(IndexEntryLocal));
 
         memcpy(this->offsets, entryOffsets, (tableSize + 1) * sizeof(size_t));
     }
 
+    // init compressed index table with external data (needed for index readin)
+    void initCompressedTableByExternalData(size_t sequenceCount, size_t tableEntriesNum, unsigned char *compressedEntries,
+                                           uint32_t *kmerOffsets, size_t *blockOffsets) {
+        this->tableEntriesNum = tableEntriesNum;
+        this->size = sequenceCount;
+
+        this->compressedEntries = compressedEntries;
+        this->kmerOffsets = kmerOffsets;
+        this->blockOffsets = blockOffsets;
+        this->compressedSize = getCompressedSize(kmerOffsets, blockOffsets);
+    }
+
+    void initCompressedTableByExternalDataCopy(size_t sequenceCount, size_t tableEntriesNum, unsigned char *compressedEntries,
+                                               uint32_t *kmerOffsets, size_t *blockOffsets) {
+        this->tableEntriesNum = tableEntriesNum;
+        this->size = sequenceCount;
+
+        // the uncompressed offsets are not needed
+        HugePages::release(offsets);
+        offsets = NULL;
+
+        compressedSize = getCompressedSize(kmerOffsets, blockOffsets);
+        this->compressedEntries = static_cast<unsigned char *>(HugePages::allocate(compressedSize));
+        Util::checkAllocation(this->compressedEntries, "Can not allocate " + SSTR(compressedSize) + " bytes for compressed entries in IndexTable");
+        memcpy(this->compressedEntries, compressedEntries, compressedSize);
+
+        this->kmerOffsets = static_cast<uint32_t *>(HugePages::allocate((tableSize + 1) * sizeof(uint32_t)));
+        Util::checkAllocation(this->kmerOffsets, "Can not allocate kmerOffsets memory in IndexTable");
+        memcpy(this->kmerOffsets, kmerOffsets, (tableSize + 1) * sizeof(uint32_t));
+
+        const size_t blockCount = tableSize / COMPRESSED_BLOCK_KMERS + 1;
+        this->blockOffsets = static_cast<size_t *>(HugePages::allocate(blockCount * sizeof(size_t)));
+        Util::checkAllocation(this->blockOffsets, "Can not allocate blockOffsets memory in IndexTable");
+        memcpy(this->blockOffsets, blockOffsets, blockCount * sizeof(size_t));
+    }
+
+    // deep copy, its pages are placed by the thread that creates it
+    IndexTable *copy() {
+        IndexTable *table = new IndexTable(alphabetSize, kmerSize, false);
+        if (isCompressed()) {
+            table->initCompressedTableByExternalDataCopy(size, tableEntriesNum, compressedEntries, kmerOffsets, blockOffsets);
+        } else {
+            table->initTableByExternalDataCopy(size, tableEntriesNum, entries, offsets);
+        }
+        return table;
+    }
+
+    // memory of the entries and offsets
+    size_t getMemorySize() {
+        if (isCompressed()) {
+            return compressedSize + (tableSize + 1) * sizeof(uint32_t) + getBlockOffsetsSize() * sizeof(size_t);
+        }
+        return tableEntriesNum * sizeof(IndexEntryLocal) + (tableSize + 1) * sizeof(size_t);
+    }
+
     void revertPointer() {
         for (size_t i = tableSize; i > 0; i--) {
             offsets[i] = offsets[i - 1];
@@ -337,11 +504,9 @@ public:
         }
     }
 
-    // add k-mers of the sequence to the index table
-    void addSequence (Sequence* s, Indexer * idxer,
-                      IndexEntryLocalTmp * buffer,
-                      int threshold, char * diagonalScore){
-        // iterate over all k-mers of the sequence and add the id of s to the sequence list of the k-mer (tableDummy)
+    // writes the indexed k-mers of the sequence with their first position to the buffer, sorted by k-mer,
+    // and returns their number
+    size_t extractKmers(Sequence *s, Indexer *idxer, IndexEntryLocalTmp *buffer, int threshold, char *diagonalScore) {
         s->resetCurrPos();
         idxer->reset();
         size_t kmerPos = 0;
@@ -368,12 +533,7 @@ public:
                     continue;
                 }
             }
-            unsigned int kmerIdx = idxer->int2index(kmer, 0, kmerSize);
-            // if region got masked do not add kmer
-            if (offsets[kmerIdx + 1] - offsets[kmerIdx] == 0)
-                continue;
-
-            buffer[kmerPos].kmer = kmerIdx;
+            buffer[kmerPos].kmer = idxer->int2index(kmer, 0, kmerSize);
             buffer[kmerPos].seqId      = s->getId();
             buffer[kmerPos].position_j = s->getCurrentPosition();
             kmerPos++;
@@ -383,16 +543,33 @@ public:
             std::sort(buffer, buffer+kmerPos, IndexEntryLocalTmp::comapreByIdAndPos);
         }
 
+        size_t uniqueKmers = 0;
         unsigned int prevKmer = UINT_MAX;
         for(size_t pos = 0; pos < kmerPos; pos++){
-            unsigned int kmerIdx = buffer[pos].kmer;
-            if(kmerIdx != prevKmer){
-                size_t offset = __sync_fetch_and_add(&(offsets[kmerIdx]), 1);
-                IndexEntryLocal *entry = &entries[offset];
-                entry->seqId      = buffer[pos].seqId;
-                entry->position_j = buffer[pos].position_j;
+            if(buffer[pos].kmer != prevKmer){
+                buffer[uniqueKmers] = buffer[pos];
+                uniqueKmers++;
             }
-            prevKmer = kmerIdx;
+            prevKmer = buffer[pos].kmer;
+        }
+        return uniqueKmers;
+    }
+
+    // add k-mers of the sequence to the index table
+    void addSequence (Sequence* s, Indexer * idxer,
+                      IndexEntryLocalTmp * buffer,
+                      int threshold, char * diagonalScore){
+        // add the id of s to the sequence list of every k-mer of s
+        const size_t kmerCount = extractKmers(s, idxer, buffer, threshold, diagonalScore);
+        for(size_t pos = 0; pos < kmerCount; pos++){
+            unsigned int kmerIdx = buffer[pos].kmer;
+            // if region got masked do not add kmer
+            if (offsets[kmerIdx + 1] - offsets[kmerIdx] == 0)
+                continue;
+            size_t offset = __sync_fetch_and_add(&(offsets[kmerIdx]), 1);
+            IndexEntryLocal *entry = &entries[offset];
+            entry->seqId      = buffer[pos].seqId;
+            entry->position_j = buffer[pos].position_j;
         }
     }
 
@@ -424,6 +601,27 @@ public:
     // returns the size of the entry (int for global) (IndexEntryLocal for local)
     size_t getSizeOfEntry() { return sizeof(IndexEntryLocal); }
 
+    unsigned char *getCompressedEntries() {
+        return compressedEntries;
+    }
+
+    // includes the padding of the entries array
+    size_t getCompressedEntriesSize() {
+        return compressedSize;
+    }
+
+    uint32_t *getKmerOffsets() {
+        return kmerOffsets;
+    }
+
+    size_t *getBlockOffsets() {
+        return blockOffsets;
+    }
+
+    size_t getBlockOffsetsSize() {
+        return tableSize / COMPRESSED_BLOCK_KMERS + 1;
+    }
+
     int getKmerSize() {
         return kmerSize;
     }
@@ -461,6 +659,9 @@ public:
         }
     }
 
+    // number of k-mers sharing one 64 bit offset in the compressed layout
+    static const size_t COMPRESSED_BLOCK_KMERS = 256;
+
 protected:
     // alphabetSize**kmerSize
     const size_t tableSize;
@@ -481,7 +682,97 @@ protected:
     IndexEntryLocal *entries;
     size_t *offsets;
 
+    // Compressed layout (createindex --index-compression 1): the list of a k-mer consists of
+    // varint(size) varint(first seqId) uint8(idBits) uint8(posBits) and size bit-packed pairs
+    // of seqId delta (0 for the first) and position. It starts at
+    // compressedEntries + blockOffsets[kmer / COMPRESSED_BLOCK_KMERS] + kmerOffsets[kmer].
+    unsigned char *compressedEntries;
+    size_t compressedSize;
+    uint32_t *kmerOffsets;
+    size_t *blockOffsets;
+
     // sequence lookup
     SequenceLookup *sequenceLookup;
+
+    size_t getCompressedSize(const uint32_t *kmerOffsets, const size_t *blockOffsets) {
+        return blockOffsets[tableSize / COMPRESSED_BLOCK_KMERS] + kmerOffsets[tableSize] + sizeof(uint64_t);
+    }
+
+    static inline size_t readVarint(const unsigned char *&data) {
+        size_t value = 0;
+        int shift = 0;
+        while (*data & 0x80) {
+            value |= static_cast<size_t>(*data & 0x7f) << shift;
+            shift += 7;
+            data++;
+        }
+        value |= static_cast<size_t>(*data) << shift;
+        data++;
+        return value;
+    }
+
+    static size_t writeVarint(size_t value, unsigned char *out) {
+        size_t length = 0;
+        while (value >= 0x80) {
+            if (out != NULL) {
+                out[length] = static_cast<unsigned char>(value | 0x80);
+            }
+            value >>= 7;
+            length++;
+        }
+        if (out != NULL) {
+            out[length] = static_cast<unsigned char>(value);
+        }
+        return length + 1;
+    }
+
+    static unsigned int bitWidth(size_t value) {
+        unsigned int bits = 0;
+        while (value > 0) {
+            bits++;
+            value >>= 1;
+        }
+        return bits;
+    }
+
+    // returns the encoded size of a sorted list, writes it only if out is not NULL
+    static size_t encodeDBSeqList(const IndexEntryLocal *list, size_t listSize, unsigned char *out) {
+        if (listSize == 0) {
+            return 0;
+        }
+        unsigned int maxDelta = 0;
+        unsigned short maxPos = list[0].position_j;
+        for (size_t i = 1; i < listSize; i++) {
+            maxDelta = std::max(maxDelta, list[i].seqId - list[i - 1].seqId);
+            maxPos = std::max(maxPos, list[i].position_j);
+        }
+        const unsigned int idBits = bitWidth(maxDelta);
+        const unsigned int posBits = bitWidth(maxPos);
+        size_t headerSize = writeVarint(listSize, out);
+        headerSize += writeVarint(list[0].seqId, (out != NULL) ? out + headerSize : NULL);
+        const size_t size = headerSize + 2 + (listSize * (idBits + posBits) + 7) / 8;
+        if (out == NULL) {
+            return size;
+        }
+        out[headerSize] = static_cast<unsigned char>(idBits);
+        out[headerSize + 1] = static_cast<unsigned char>(posBits);
+        unsigned char *packed = out + headerSize + 2;
+        size_t bitPos = 0;
+        for (size_t i = 0; i < listSize; i++) {
+            const uint64_t delta = (i == 0) ? 0 : (list[i].seqId - list[i - 1].seqId);
+            uint64_t value = delta | (static_cast<uint64_t>(list[i].position_j) << idBits);
+            // byte-wise, neighbouring lists are written by other threads
+            unsigned int bits = idBits + posBits;
+            while (bits > 0) {
+                const unsigned int shift = bitPos & 7;
+                const unsigned int take = std::min(bits, 8 - shift);
+                packed[bitPos >> 3] |= static_cast<unsigned char>((value & ((1u << take) - 1)) << shift);
+                value >>= take;
+                bits -= take;
+                bitPos += take;
+            }
+        }
+        return size;
+    }
 };
 #endif
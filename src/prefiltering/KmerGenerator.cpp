@@ -2,12 +2,26 @@
 #include <algorithm>    // std::reverse
 #include <MathUtil.h>
 #include "simd.h"
+#include "Timer.h"
+#include "Util.h"
+
+#include <stdint.h>
 
 
 KmerGenerator::KmerGenerator(size_t kmerSize, size_t alphabetSize, short threshold ){
     this->threshold = threshold;
     this->kmerSize = kmerSize;
     this->indexer = new Indexer((int) alphabetSize, (int)kmerSize);
+    this->cacheSlots = NULL;
+    this->cacheMask = 0;
+    this->cacheLists = NULL;
+    this->cacheListsSize = 0;
+    this->cacheUsed = 0;
+    this->cacheGeneration = 1;
+    this->cacheHits = 0;
+    this->cacheMisses = 0;
+    this->sampledMissSeconds = 0.0;
+    this->profileStrategy = false;
 //    calcDivideStrategy();
 }
 
@@ -28,9 +42,12 @@ KmerGenerator::~KmerGenerator(){
     delete [] outputScoreArray;
     delete [] outputIndexArray;
     delete indexer;
+    free(cacheSlots);
+    free(cacheLists);
 }
 
 void KmerGenerator::setDivideStrategy(ScoreMatrix ** one){
+    this->profileStrategy = true;
     this->divideStepCount = kmerSize;
     this->matrixLookup = new ScoreMatrix*[divideStepCount];
     this->divideStep   = new unsigned int[divideStepCount];
@@ -107,7 +124,72 @@ void KmerGenerator::initDataStructure(){
 }
 
 
+void KmerGenerator::setCacheSize(size_t maxBytes) {
+    free(cacheSlots);
+    cacheSlots = NULL;
+    free(cacheLists);
+    cacheLists = NULL;
+    cacheListsSize = 0;
+    cacheMask = 0;
+    cacheUsed = 0;
+    // a quarter of the memory for the slots, the rest for the lists
+    size_t slotCount = 1;
+    while (slotCount * 2 * sizeof(CacheSlot) <= maxBytes / 4) {
+        slotCount *= 2;
+    }
+    if (maxBytes == 0 || slotCount < 2) {
+        return;
+    }
+    // generation 0 marks the slots as empty
+    cacheSlots = static_cast<CacheSlot *>(calloc(slotCount, sizeof(CacheSlot)));
+    Util::checkAllocation(cacheSlots, "Can not allocate cacheSlots memory in KmerGenerator::setCacheSize, reduce --kmer-cache");
+    cacheMask = slotCount - 1;
+    cacheListsSize = (maxBytes - slotCount * sizeof(CacheSlot)) / sizeof(size_t);
+    cacheLists = static_cast<size_t *>(malloc(cacheListsSize * sizeof(size_t)));
+    Util::checkAllocation(cacheLists, "Can not allocate cacheLists memory in KmerGenerator::setCacheSize, reduce --kmer-cache");
+    cacheGeneration = 1;
+}
+
 std::pair<size_t *, size_t> KmerGenerator::generateKmerList(const unsigned char * int_seq, bool addIdentity){
+    if (cacheSlots == NULL || profileStrategy || addIdentity) {
+        return computeKmerList(int_seq, addIdentity);
+    }
+    const size_t kmer = indexer->int2index(int_seq);
+    // mix the k-mer and threshold bits over the whole word, the slot is taken from the upper bits
+    const uint64_t hash = (static_cast<uint64_t>(kmer) * 31 + static_cast<uint64_t>(static_cast<unsigned short>(threshold))) * UINT64_C(0x9E3779B97F4A7C15);
+    CacheSlot &slot = cacheSlots[(hash >> 32) & cacheMask];
+    if (slot.generation == cacheGeneration && slot.kmer == kmer && slot.threshold == threshold) {
+        cacheHits++;
+        return std::make_pair(cacheLists + slot.offset, static_cast<size_t>(slot.size));
+    }
+    cacheMisses++;
+    std::pair<size_t *, size_t> result;
+    if (cacheMisses % MISS_SAMPLE_INTERVAL == 0) {
+        Timer timer;
+        result = computeKmerList(int_seq, false);
+        sampledMissSeconds += timer.getTimediff();
+    } else {
+        result = computeKmerList(int_seq, false);
+    }
+    // lists larger than an eighth of the cache would evict too much
+    if (result.second > cacheListsSize / 8) {
+        return result;
+    }
+    if (cacheUsed + result.second > cacheListsSize) {
+        cacheGeneration++;
+        cacheUsed = 0;
+    }
+    memcpy(cacheLists + cacheUsed, result.first, result.second * sizeof(size_t));
+    slot.kmer = kmer;
+    slot.offset = cacheUsed;
+    slot.size = static_cast<unsigned int>(result.second);
+    slot.generation = cacheGeneration;
+    slot.threshold = threshold;
+    cacheUsed += result.second;
+    return result;
+}
+
+std::pair<size_t *, size_t> KmerGenerator::computeKmerList(const unsigned char * int_seq, bool addIdentity){
     int dividerBefore=0;
     // pre compute phase
     // find first threshold
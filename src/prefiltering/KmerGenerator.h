@@ -15,6 +15,19 @@ class KmerGenerator
         /*calculates the kmer list */
         std::pair<size_t *, size_t> generateKmerList(const unsigned char * intSeq, bool addIdentity = false);
 
+        /* keeps up to maxBytes of generated lists keyed by k-mer and threshold, 0 disables the cache.
+         Only lists of the (3,2) strategy are cached, profile lists depend on the position */
+        void setCacheSize(size_t maxBytes);
+
+        size_t getCacheHits() const { return cacheHits; }
+        size_t getCacheMisses() const { return cacheMisses; }
+        /* estimated time spent generating the lists that were looked up in the cache and missed,
+         only every MISS_SAMPLE_INTERVAL-th miss is timed */
+        double getCacheMissSeconds() const {
+            const size_t sampled = cacheMisses / MISS_SAMPLE_INTERVAL;
+            return (sampled > 0) ? sampledMissSeconds * (static_cast<double>(cacheMisses) / sampled) : 0.0;
+        }
+
         /* kmer splitting stragety (3,2)
          fill up the divide step and calls init_result_list */
         void setDivideStrategy(ScoreMatrix * three, ScoreMatrix * two );
@@ -25,7 +38,30 @@ class KmerGenerator
 
 	    void setThreshold(short threshold);
     private:
-    
+        std::pair<size_t *, size_t> computeKmerList(const unsigned char * intSeq, bool addIdentity);
+
+        struct CacheSlot {
+            size_t kmer;
+            size_t offset;
+            unsigned int size;
+            unsigned int generation;
+            short threshold;
+        };
+        /* direct mapped slots, a list is valid while its generation is current */
+        CacheSlot *cacheSlots;
+        size_t cacheMask;
+        /* the cached lists, all slots are invalidated at once when it is full */
+        size_t *cacheLists;
+        size_t cacheListsSize;
+        size_t cacheUsed;
+        unsigned int cacheGeneration;
+        size_t cacheHits;
+        size_t cacheMisses;
+        /* a timer per miss costs about as much as generating a short list */
+        static const size_t MISS_SAMPLE_INTERVAL = 64;
+        double sampledMissSeconds;
+        bool profileStrategy;
+
         /*creates the product between two arrays and write it to the output array */
         size_t calculateArrayProduct(const short        * __restrict scoreArray1,
                                   const size_t       * __restrict indexArray1,
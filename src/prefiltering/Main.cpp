@@ -1,4 +1,5 @@
 #include "Prefiltering.h"
+#include "Alignment.h"
 #include "Util.h"
 #include "Parameters.h"
 #include "MMseqsMPI.h"
@@ -10,15 +11,10 @@
 #include <omp.h>
 #endif
 
-int prefilter(int argc, const char **argv, const Command& command) {
-    MMseqsMPI::init(argc, argv);
-
-    Parameters& par = Parameters::getInstance();
-    par.parseParameters(argc, argv, command, true, 0, MMseqsParameter::COMMAND_PREFILTER);
-
-    Timer timer;
-    int queryDbType = FileUtil::parseDbType(par.db1.c_str());
-    int targetDbType = FileUtil::parseDbType(par.db2.c_str());
+// resolves the dbtypes of the query and target (or its index) database and rejects unsupported combinations
+static bool getDbTypes(const Parameters &par, int &queryDbType, int &targetDbType) {
+    queryDbType = FileUtil::parseDbType(par.db1.c_str());
+    targetDbType = FileUtil::parseDbType(par.db2.c_str());
     if(Parameters::isEqualDbtype(targetDbType, Parameters::DBTYPE_INDEX_DB) == true) {
         DBReader<unsigned int> dbr(par.db2.c_str(), par.db2Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
         dbr.open(DBReader<unsigned int>::NOSORT);
@@ -28,28 +24,43 @@ int prefilter(int argc, const char **argv, const Command& command) {
     }
     if (queryDbType == -1 || targetDbType == -1) {
         Debug(Debug::ERROR) << "Please recreate your database or add a .dbtype file to your sequence/profile database.\n";
-        return EXIT_FAILURE;
+        return false;
     }
     if (Parameters::isEqualDbtype(queryDbType, Parameters::DBTYPE_HMM_PROFILE) && Parameters::isEqualDbtype(targetDbType, Parameters::DBTYPE_HMM_PROFILE)) {
         Debug(Debug::ERROR) << "Only the query OR the target database can be a profile database.\n";
-        return EXIT_FAILURE;
+        return false;
     }
 
     if (Parameters::isEqualDbtype(queryDbType, Parameters::DBTYPE_AMINO_ACIDS) && Parameters::isEqualDbtype(targetDbType, Parameters::DBTYPE_NUCLEOTIDES)) {
         Debug(Debug::ERROR) << "The prefilter can not search amino acids against nucleotides. Something might got wrong while createdb or createindex.\n";
-        return EXIT_FAILURE;
+        return false;
     }
     if (Parameters::isEqualDbtype(queryDbType, Parameters::DBTYPE_NUCLEOTIDES) && Parameters::isEqualDbtype(targetDbType, Parameters::DBTYPE_AMINO_ACIDS)) {
         Debug(Debug::ERROR) << "The prefilter can not search nucleotides against amino acids. Something might got wrong while createdb or createindex.\n";
-        return EXIT_FAILURE;
+        return false;
     }
     if (Parameters::isEqualDbtype(queryDbType, Parameters::DBTYPE_HMM_PROFILE) == false && Parameters::isEqualDbtype(targetDbType, Parameters::DBTYPE_PROFILE_STATE_SEQ)) {
         Debug(Debug::ERROR) << "The query has to be a profile when using a target profile state database.\n";
-        return EXIT_FAILURE;
+        return false;
     } else if (Parameters::isEqualDbtype(queryDbType, Parameters::DBTYPE_HMM_PROFILE) && Parameters::isEqualDbtype(targetDbType, Parameters::DBTYPE_PROFILE_STATE_SEQ)) {
         queryDbType = Parameters::DBTYPE_PROFILE_STATE_PROFILE;
     }
 
+    return true;
+}
+
+int prefilter(int argc, const char **argv, const Command& command) {
+    MMseqsMPI::init(argc, argv);
+
+    Parameters& par = Parameters::getInstance();
+    par.parseParameters(argc, argv, command, true, 0, MMseqsParameter::COMMAND_PREFILTER);
+
+    int queryDbType;
+    int targetDbType;
+    if (getDbTypes(par, queryDbType, targetDbType) == false) {
+        return EXIT_FAILURE;
+    }
+
     Prefiltering pref(par.db1, par.db1Index, par.db2, par.db2Index, queryDbType, targetDbType, par);
 
 #ifdef HAVE_MPI
@@ -60,3 +71,41 @@ int prefilter(int argc, const char **argv, const Command& command) {
 
     return EXIT_SUCCESS;
 }
+
+int prefilteralign(int argc, const char **argv, const Command& command) {
+    Parameters& par = Parameters::getInstance();
+    par.parseParameters(argc, argv, command, true, 0, MMseqsParameter::COMMAND_PREFILTER | MMseqsParameter::COMMAND_ALIGN);
+
+    int queryDbType;
+    int targetDbType;
+    if (getDbTypes(par, queryDbType, targetDbType) == false) {
+        return EXIT_FAILURE;
+    }
+
+    Prefiltering pref(par.db1, par.db1Index, par.db2, par.db2Index, queryDbType, targetDbType, par);
+    if (pref.getSplits() > 1) {
+        // hits of a query are only complete after the last split, align the merged prefilter result instead.
+        // This includes indices with appended splits, they are streamed once they are merged by createindex --compact 1
+        Debug(Debug::INFO) << "Target database has " << pref.getSplits() << " splits, the alignment starts after the prefilter\n";
+        std::string prefDB = par.prefilterDb.empty() ? (par.db3 + "_pref") : par.prefilterDb;
+        std::pair<std::string, std::string> prefDb = Util::databaseNames(prefDB);
+        pref.runAllSplits(prefDb.first, prefDb.second);
+
+        Alignment aln(par.db1, par.db2, prefDb.first, prefDb.second, par.db3, par.db3Index, par);
+        Debug(Debug::INFO) << "Calculation of alignments\n";
+        aln.run(par.maxAccept, par.maxRejected, par.wrappedScoring);
+        if (par.prefilterDb.empty()) {
+            DBReader<unsigned int>::removeDb(prefDb.first);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    Alignment aln(par.db1, par.db2, "", "", par.db3, par.db3Index, par);
+    std::pair<std::string, std::string> prefDb = par.prefilterDb.empty()
+                                                 ? std::make_pair(std::string(), std::string())
+                                                 : Util::databaseNames(par.prefilterDb);
+    pref.runStreaming(aln, par.db3, par.db3Index, prefDb.first, prefDb.second,
+                      par.maxAccept, par.maxRejected, par.wrappedScoring);
+
+    return EXIT_SUCCESS;
+}
@@ -10,6 +10,12 @@
 #include "ByteParser.h"
 #include "Parameters.h"
 #include "MemoryMapped.h"
+#include "Alignment.h"
+#include "HugePages.h"
+#include "QueryScheduler.h"
+#include "MemoryBudget.h"
+
+#include <algorithm>
 
 namespace prefilter {
 #include "ExpOpt3_8_polished.cs32.lib.h"
@@ -42,6 +48,7 @@ Prefiltering::Prefiltering(const std::string &queryDB,
         seedScoringMatrixFile(par.seedScoringMatrixFile),
         targetSeqType(targetSeqType),
         maxResListLen(par.maxResListLen),
+        mergedResListLen(par.maxResListLen),
         kmerScore(par.kmerScore),
         sensitivity(par.sensitivity),
         maxSeqLen(par.maxSeqLen),
@@ -51,7 +58,10 @@ Prefiltering::Prefiltering(const std::string &queryDB,
         aaBiasCorrection(par.compBiasCorrection != 0),
         covThr(par.covThr), covMode(par.covMode), includeIdentical(par.includeIdentity),
         preloadMode(par.preloadMode),
-        threads(static_cast<unsigned int>(par.threads)), compressed(par.compressed) {
+        threads(static_cast<unsigned int>(par.threads)), writerMode(par.writerMode(par.compressed)), sharedWriter(par.sharedWriter),
+        resultDbtype(par.binaryResults ? (Parameters::DBTYPE_PREFILTER_RES | Parameters::DBTYPE_EXTENDED_BINARY) : Parameters::DBTYPE_PREFILTER_RES),
+        numaMode(par.numaMode), prefilterBatch(static_cast<size_t>(par.prefilterBatch)), kmerCache(par.kmerCache),
+        alignment(NULL), alignmentWriter(NULL), maxAlnNum(0), maxRejected(0), wrappedScoring(false) {
     sameQTDB = isSameQTDB();
 
     // init the substitution matrices
@@ -152,6 +162,10 @@ Prefiltering::Prefiltering(const std::string &queryDB,
             if (data.splits > 1) {
                 splitMode = Parameters::TARGET_DB_SPLIT;
             }
+            const int appendedSplits = PrefilteringIndexReader::getAppendedSplits(tidxdbr);
+            if (appendedSplits > 0) {
+                Debug(Debug::INFO) << "Index has " << appendedSplits << " appended splits, each is searched in its own prefilter step. Merge them with 'createindex --compact 1'\n";
+            }
             spacedKmer = data.spacedKmer != 0;
             spacedKmerPattern = PrefilteringIndexReader::getSpacedPattern(tidxdbr);
             seedScoringMatrixFile = ScoreMatrixFile(PrefilteringIndexReader::getSubstitutionMatrix(tidxdbr));
@@ -168,6 +182,7 @@ Prefiltering::Prefiltering(const std::string &queryDB,
     // restrict amount of allocated memory if all results are requested
     // INT_MAX would allocate 72GB RAM per thread for no reason
     maxResListLen = std::min(tdbr->getSize(), maxResListLen);
+    mergedResListLen = maxResListLen;
 
     // investigate if it makes sense to mask the profile consensus sequence
     if (Parameters::isEqualDbtype(targetSeqType, Parameters::DBTYPE_HMM_PROFILE) || Parameters::isEqualDbtype(targetSeqType, Parameters::DBTYPE_PROFILE_STATE_SEQ)) {
@@ -179,12 +194,7 @@ Prefiltering::Prefiltering(const std::string &queryDB,
                        (Parameters::isEqualDbtype(targetSeqType, Parameters::DBTYPE_NUCLEOTIDES) && Parameters::isEqualDbtype(querySeqType,Parameters::DBTYPE_NUCLEOTIDES));
 
     // memoryLimit in bytes
-    size_t memoryLimit;
-    if (par.splitMemoryLimit > 0) {
-        memoryLimit = par.splitMemoryLimit;
-    } else {
-        memoryLimit = static_cast<size_t>(Util::getTotalSystemMemory() * 0.9);
-    }
+    memoryLimit = MemoryBudget::getLimit();
 
     if (templateDBIsIndex == false && sameQTDB == true) {
         qdbr = tdbr;
@@ -194,9 +204,16 @@ Prefiltering::Prefiltering(const std::string &queryDB,
     }
     Debug(Debug::INFO) << "Query database size: " << qdbr->getSize() << " type: " << Parameters::getDbTypeName(querySeqType) << "\n";
 
+    if (kmerCache > 0) {
+        MemoryBudget::reserve("similar k-mer caches", threads * kmerCache);
+    }
     setupSplit(*tdbr, alphabetSize - 1, querySeqType,
                threads, templateDBIsIndex, memoryLimit, qdbr->getSize(),
-               maxResListLen, kmerSize, splits, splitMode);
+               maxResListLen, kmerSize, splits, splitMode,
+               templateDBIsIndex && PrefilteringIndexReader::isCompressed(tidxdbr));
+    if (numaMode == Parameters::NUMA_MODE_REPLICATE) {
+        checkIndexReplicas(templateDBIsIndex && PrefilteringIndexReader::isCompressed(tidxdbr));
+    }
 
     if(Parameters::isEqualDbtype(targetSeqType, Parameters::DBTYPE_NUCLEOTIDES) == false){
         const bool isProfileSearch = Parameters::isEqualDbtype(querySeqType, Parameters::DBTYPE_HMM_PROFILE) ||
@@ -233,9 +250,7 @@ Prefiltering::~Prefiltering() {
         delete qdbr;
     }
 
-    if (indexTable != NULL) {
-        delete indexTable;
-    }
+    deleteIndexTable();
 
     if (sequenceLookup != NULL) {
         delete sequenceLookup;
@@ -283,10 +298,10 @@ void Prefiltering::reopenTargetDb() {
 
 void Prefiltering::setupSplit(DBReader<unsigned int>& tdbr, const int alphabetSize, const unsigned int querySeqTyp, const int threads,
                               const bool templateDBIsIndex, const size_t memoryLimit, const size_t qDbSize,
-                              size_t &maxResListLen, int &kmerSize, int &split, int &splitMode) {
+                              size_t &maxResListLen, int &kmerSize, int &split, int &splitMode, bool compressedIndex) {
     size_t memoryNeeded = estimateMemoryConsumption(1, tdbr.getSize(), tdbr.getAminoAcidDBSize(), maxResListLen, alphabetSize,
                                                     kmerSize == 0 ? // if auto detect kmerSize
-                                                    IndexTable::computeKmerSize(tdbr.getAminoAcidDBSize()) : kmerSize, querySeqTyp, threads);
+                                                    IndexTable::computeKmerSize(tdbr.getAminoAcidDBSize()) : kmerSize, querySeqTyp, threads, compressedIndex);
 
     int optimalSplitMode = Parameters::TARGET_DB_SPLIT;
     if (memoryNeeded > 0.9 * memoryLimit) {
@@ -319,7 +334,7 @@ void Prefiltering::setupSplit(DBReader<unsigned int>& tdbr, const int alphabetSi
     if (memoryNeeded > 0.9 * memoryLimit) {
         // memory is not enough to compute everything at once
         //TODO add PROFILE_STATE (just 6-mers)
-        std::pair<int, int> splitSettings = Prefiltering::optimizeSplit(memoryLimit, &tdbr, alphabetSize, kmerSize, querySeqTyp, threads);
+        std::pair<int, int> splitSettings = Prefiltering::optimizeSplit(memoryLimit, &tdbr, alphabetSize, kmerSize, querySeqTyp, threads, compressedIndex);
         if (splitSettings.second == -1) {
             Debug(Debug::ERROR) << "Cannot fit databased into " << ByteParser::format(memoryLimit) << ". Please use a computer with more main memory.\n";
             EXIT(EXIT_FAILURE);
@@ -375,9 +390,16 @@ void Prefiltering::setupSplit(DBReader<unsigned int>& tdbr, const int alphabetSi
         Debug(Debug::INFO) << Parameters::getSplitModeName(splitMode) << " split mode. Searching through " << split << " splits\n";
     }
 
-    size_t memoryNeededPerSplit = estimateMemoryConsumption((splitMode == Parameters::TARGET_DB_SPLIT) ? split : 1, tdbr.getSize(),
-                                                            tdbr.getAminoAcidDBSize(), maxResListLen, alphabetSize, kmerSize, querySeqTyp, threads);
+    const MemoryEstimate estimate = estimateMemoryComponents((splitMode == Parameters::TARGET_DB_SPLIT) ? split : 1, tdbr.getSize(),
+                                                             tdbr.getAminoAcidDBSize(), maxResListLen, alphabetSize, kmerSize, querySeqTyp, threads, compressedIndex);
+    MemoryBudget::reserve("index table", estimate.indexTable);
+    MemoryBudget::reserve("diagonal bins and hit lists", estimate.threadBuffers);
+    MemoryBudget::reserve("k-mer score matrices", estimate.matrices);
+    MemoryBudget::reserve("database index", estimate.databaseIndex);
+    MemoryBudget::reserve("result writer buffers", threads * DBWriter::getDefaultBufferSize());
+    size_t memoryNeededPerSplit = estimate.total();
     Debug(Debug::INFO) << "Estimated memory consumption: " << ByteParser::format(memoryNeededPerSplit) << "\n";
+    MemoryBudget::printEstimates();
     if (memoryNeededPerSplit > 0.9 * memoryLimit) {
         Debug(Debug::WARNING) << "Process needs more than " << ByteParser::format(memoryLimit) << " main memory.\n" <<
                               "Increase the size of --split or set it to 0 to automatically optimize target database split.\n";
@@ -387,7 +409,20 @@ void Prefiltering::setupSplit(DBReader<unsigned int>& tdbr, const int alphabetSi
     }
 }
 
-void Prefiltering::mergeTargetSplits(const std::string &outDB, const std::string &outDBIndex, const std::vector<std::pair<std::string, std::string>> &fileNames, unsigned int threads) {
+// keeps the maxHits best hits in a heap, the worst of the kept hits is at its top
+static void pushBoundedHit(std::vector<hit_t> &heap, const hit_t &hit, size_t maxHits) {
+    if (heap.size() < maxHits) {
+        heap.push_back(hit);
+        std::push_heap(heap.begin(), heap.end(), hit_t::compareHitsByScoreAndId);
+    } else if (maxHits > 0 && hit_t::compareHitsByScoreAndId(hit, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), hit_t::compareHitsByScoreAndId);
+        heap.back() = hit;
+        std::push_heap(heap.begin(), heap.end(), hit_t::compareHitsByScoreAndId);
+    }
+}
+
+void Prefiltering::mergeTargetSplits(const std::string &outDB, const std::string &outDBIndex, const std::vector<std::pair<std::string, std::string>> &fileNames,
+                                     unsigned int threads, size_t writerMode, size_t maxResListLen) {
     // we assume that the hits are in the same order
     const size_t splits = fileNames.size();
 
@@ -399,123 +434,92 @@ void Prefiltering::mergeTargetSplits(const std::string &outDB, const std::string
 
     Timer timer;
     Debug(Debug::INFO) << "Merging " << splits << " target splits to " << FileUtil::baseName(outDB) << "\n";
-    DBReader<unsigned int> reader1(fileNames[0].first.c_str(), fileNames[0].second.c_str(), 1, DBReader<unsigned int>::USE_INDEX);
-    reader1.open(DBReader<unsigned int>::NOSORT);
-    DBReader<unsigned int>::Index *index1 = reader1.getIndex();
 
-    size_t totalSize = 0;
-    for (size_t id = 0; id < reader1.getSize(); id++) {
-        totalSize += index1[id].length;
-    }
-    for (size_t i = 1; i < splits; ++i) {
-        DBReader<unsigned int> reader2(fileNames[i].first.c_str(), fileNames[i].second.c_str(), 1, DBReader<unsigned int>::USE_INDEX);
-        reader2.open(DBReader<unsigned int>::NOSORT);
-        DBReader<unsigned int>::Index *index2 = reader2.getIndex();
-        size_t currOffset = 0;
-        for (size_t id = 0; id < reader1.getSize(); id++) {
-            // add length for file1 and file2 and subtract -1 for one null byte
-            size_t seqLen = index1[id].length + index2[id].length - 1;
-            totalSize += index2[id].length - 1;
-            index1[id].length = seqLen;
-            index1[id].offset = currOffset;
-            currOffset += seqLen;
-        }
-        reader2.close();
+    const int dbtype = FileUtil::parseDbType(fileNames[0].first.c_str());
+    const bool binary = Parameters::isBinaryDbtype(dbtype);
+    DBReader<unsigned int> **readers = new DBReader<unsigned int>*[splits];
+    for (size_t i = 0; i < splits; ++i) {
+        readers[i] = new DBReader<unsigned int>(fileNames[i].first.c_str(), fileNames[i].second.c_str(), threads,
+                                                DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_BINARY);
+        readers[i]->open(DBReader<unsigned int>::NOSORT);
     }
-    reader1.setDataSize(totalSize);
+    const size_t dbSize = readers[0]->getSize();
 
-    size_t *starts = new size_t[threads];
-    size_t *lengths = new size_t[threads];
-    size_t **offsetStart = new size_t*[threads];
-    for (size_t i = 0; i < threads; ++i) {
-        reader1.decomposeDomainByAminoAcid(i, threads, &starts[i], &lengths[i]);
-        offsetStart[i] = new size_t[splits];
+    // every thread merges a contiguous range of queries with about the same amount of data, the thread
+    // data files are concatenated with DBWriter::close(true) so the merged result is a single file in query order
+    std::vector<size_t> entrySizes(dbSize, 0);
+    size_t totalSize = 0;
+    for (size_t i = 0; i < splits; ++i) {
+        for (size_t id = 0; id < dbSize; id++) {
+            entrySizes[id] += readers[i]->getEntryLen(id);
+            totalSize += readers[i]->getEntryLen(id);
+        }
     }
-
-    for (size_t s = 0; s < splits; ++s) {
-        DBReader<unsigned int> reader2(fileNames[s].first.c_str(), fileNames[s].second.c_str(), 1, DBReader<unsigned int>::USE_INDEX);
-        reader2.open(DBReader<unsigned int>::NOSORT);
-        DBReader<unsigned int>::Index *index2 = reader2.getIndex();
-        for (size_t t = 0; t < threads; t++) {
-            offsetStart[t][s] = index2[starts[t]].offset;
+    std::vector<size_t> rangeStarts(threads + 1, dbSize);
+    rangeStarts[0] = 0;
+    size_t assigned = 0;
+    unsigned int nextRange = 1;
+    for (size_t id = 0; id < dbSize && nextRange < threads; id++) {
+        if (assigned >= (totalSize / threads) * nextRange) {
+            rangeStarts[nextRange++] = id;
         }
-        reader2.close();
+        assigned += entrySizes[id];
     }
 
-    Debug(Debug::INFO) << "Preparing offsets for merging: " << timer.lap() << "\n";
-    // merge target splits data files and sort the hits at the same time
-    // TODO: compressed?
-    DBWriter writer(outDB.c_str(), outDBIndex.c_str(), threads, 0, Parameters::DBTYPE_PREFILTER_RES);
+    DBWriter writer(outDB.c_str(), outDBIndex.c_str(), threads, writerMode, dbtype);
     writer.open();
 
-    Debug::Progress pregress(reader1.getSize());
+    Debug::Progress progress(dbSize);
 #pragma omp parallel num_threads(threads)
     {
         unsigned int thread_idx = 0;
 #ifdef OPENMP
         thread_idx = static_cast<unsigned int>(omp_get_thread_num());
 #endif
-
         std::string result;
         result.reserve(1024);
-
         std::vector<hit_t> hits;
-        hits.reserve(300);
-
+        hits.reserve(std::min(maxResListLen, static_cast<size_t>(1024)) + 1);
         char buffer[1024];
 
-        size_t id = starts[thread_idx];
-        size_t lastId = id + lengths[thread_idx];
-        FILE** files = new FILE*[splits];
-        for (size_t i = 0; i < splits; ++i) {
-            files[i] = fopen(fileNames[i].first.c_str(), "rb");
-            fseek(files[i], offsetStart[thread_idx][i], SEEK_SET);
-        }
-
-        while (id < lastId) {
-            pregress.updateProgress();
+        for (size_t id = rangeStarts[thread_idx]; id < rangeStarts[thread_idx + 1]; id++) {
+            progress.updateProgress();
             for (size_t i = 0; i < splits; ++i) {
-                int c1 = EOF;
-                size_t pos = 0;
-                while ((c1 = getc_unlocked(files[i])) != EOF) {
-                    buffer[pos++] = (char)c1;
-                    if (c1 == '\n') {
-                        hits.emplace_back(QueryMatcher::parsePrefilterHit(buffer));
-                        pos = 0;
-                    } else if (c1 == '\0') {
-                        break;
+                char *data = readers[i]->getData(id, thread_idx);
+                if (binary) {
+                    const size_t count = BinaryResults::getCount(data);
+                    for (size_t j = 0; j < count; ++j) {
+                        pushBoundedHit(hits, BinaryResults::getHit(data, j), maxResListLen);
+                    }
+                } else {
+                    while (*data != '\0') {
+                        pushBoundedHit(hits, QueryMatcher::parsePrefilterHit(data), maxResListLen);
+                        data = Util::skipLine(data);
                     }
                 }
             }
-
-            if (hits.size() > 1) {
-                std::sort(hits.begin(), hits.end(), hit_t::compareHitsByScoreAndId);
-            }
-            for (size_t i = 0; i < hits.size(); ++i) {
-                int len = QueryMatcher::prefilterHitToBuffer(buffer, hits[i]);
-                result.append(buffer, len);
+            std::sort_heap(hits.begin(), hits.end(), hit_t::compareHitsByScoreAndId);
+            if (binary) {
+                QueryMatcher::prefilterHitsToBinary(result, hits.data(), hits.size());
+            } else {
+                for (size_t i = 0; i < hits.size(); ++i) {
+                    size_t len = QueryMatcher::prefilterHitToBuffer(buffer, hits[i]);
+                    result.append(buffer, len);
+                }
             }
-            writer.writeData(result.c_str(), result.size(), reader1.getDbKey(id), thread_idx);
+            writer.writeData(result.c_str(), result.size(), readers[0]->getDbKey(id), thread_idx);
             hits.clear();
             result.clear();
-            id++;
-        }
-
-        for (size_t i = 0; i < splits; ++i) {
-            fclose(files[i]);
         }
-        delete[] files;
-        delete[] offsetStart[thread_idx];
     }
-    writer.close();
-    reader1.close();
+    writer.close(true);
 
     for (size_t i = 0; i < splits; ++i) {
+        readers[i]->close();
+        delete readers[i];
         DBReader<unsigned int>::removeDb(fileNames[i].first);
     }
-    delete[] offsetStart;
-    delete[] lengths;
-    delete[] starts;
+    delete[] readers;
 
     Debug(Debug::INFO) << "Time for merging target splits: " << timer.lap() << "\n";
 }
@@ -574,6 +578,86 @@ void Prefiltering::getIndexTable(int split, size_t dbFrom, size_t dbSize) {
         tdbr->remapData();
         Debug(Debug::INFO) << "Time for index table init: " << timer.lap() << "\n";
     }
+    placeIndexTable();
+}
+
+void Prefiltering::checkIndexReplicas(bool compressedIndex) {
+    const std::vector<Numa::Node> nodes = Numa::getNodes();
+    if (nodes.size() < 2) {
+        // placeIndexTable reports that there is nothing to replicate
+        return;
+    }
+    // setupSplit plans the splits for a single copy of the index table
+    const int split = (splitMode == Parameters::TARGET_DB_SPLIT) ? splits : 1;
+    const size_t single = estimateMemoryConsumption(split, tdbr->getSize(), tdbr->getAminoAcidDBSize(), maxResListLen, alphabetSize - 1,
+                                                    kmerSize, querySeqType, threads, compressedIndex);
+    const size_t replicated = estimateMemoryConsumption(split, tdbr->getSize(), tdbr->getAminoAcidDBSize(), maxResListLen, alphabetSize - 1,
+                                                        kmerSize, querySeqType, threads, compressedIndex, nodes.size());
+    if (replicated > 0.9 * memoryLimit) {
+        Debug(Debug::WARNING) << "Index table does not fit " << nodes.size() << " times into " << ByteParser::format(memoryLimit)
+                              << ". Interleaving it over the NUMA nodes instead of replicating it.\n";
+        numaMode = Parameters::NUMA_MODE_INTERLEAVE;
+        return;
+    }
+    MemoryBudget::reserve("index table replicas", replicated - single);
+    Debug(Debug::INFO) << "Estimated memory consumption with " << nodes.size() << " index table replicas: " << ByteParser::format(replicated) << "\n";
+}
+
+void Prefiltering::placeIndexTable() {
+    if (numaMode == Parameters::NUMA_MODE_OFF) {
+        return;
+    }
+    if (numaNodes.empty()) {
+        numaNodes = Numa::getNodes();
+        if (numaNodes.size() < 2) {
+            Debug(Debug::WARNING) << "Ignoring --numa-mode, no NUMA system with more than one node was found\n";
+            numaNodes.clear();
+            numaMode = Parameters::NUMA_MODE_OFF;
+            return;
+        }
+    }
+
+    Timer timer;
+    if (numaMode == Parameters::NUMA_MODE_INTERLEAVE) {
+        bool interleaved;
+        if (indexTable->isCompressed()) {
+            interleaved = Numa::interleave(indexTable->getCompressedEntries(), indexTable->getCompressedEntriesSize(), numaNodes)
+                          && Numa::interleave(indexTable->getKmerOffsets(), (indexTable->getTableSize() + 1) * sizeof(uint32_t), numaNodes)
+                          && Numa::interleave(indexTable->getBlockOffsets(), indexTable->getBlockOffsetsSize() * sizeof(size_t), numaNodes);
+        } else {
+            interleaved = Numa::interleave(indexTable->getEntries(), indexTable->getTableEntriesNum() * indexTable->getSizeOfEntry(), numaNodes)
+                          && Numa::interleave(indexTable->getOffsets(), (indexTable->getTableSize() + 1) * sizeof(size_t), numaNodes);
+        }
+        if (interleaved == false) {
+            Debug(Debug::WARNING) << "Could not interleave the index table over the NUMA nodes\n";
+        }
+    } else if (numaMode == Parameters::NUMA_MODE_REPLICATE) {
+        nodeIndexTables.resize(numaNodes.size(), NULL);
+#pragma omp parallel for schedule(static, 1) num_threads(numaNodes.size())
+        for (size_t i = 0; i < numaNodes.size(); i++) {
+            std::vector<int> affinity;
+            Numa::getThreadAffinity(affinity);
+            Numa::setThreadAffinity(numaNodes[i].cpus);
+            // pages are allocated on the node of the thread that touches them first
+            nodeIndexTables[i] = indexTable->copy();
+            Numa::setThreadAffinity(affinity);
+        }
+        delete indexTable;
+        indexTable = nodeIndexTables[0];
+    }
+    Debug(Debug::INFO) << "Time for placing the index table on " << numaNodes.size() << " NUMA nodes: " << timer.lap() << "\n";
+}
+
+void Prefiltering::deleteIndexTable() {
+    if (nodeIndexTables.empty() == false) {
+        for (size_t i = 0; i < nodeIndexTables.size(); i++) {
+            delete nodeIndexTables[i];
+        }
+        nodeIndexTables.clear();
+    } else if (indexTable != NULL) {
+        delete indexTable;
+    }
+    indexTable = NULL;
 }
 
 bool Prefiltering::isSameQTDB() {
@@ -595,14 +679,29 @@ void Prefiltering::runAllSplits(const std::string &resultDB, const std::string &
     runSplits(resultDB, resultDBIndex, 0, splits, false);
 }
 
-#ifdef HAVE_MPI
-void Prefiltering::runMpiSplits(const std::string &resultDB, const std::string &resultDBIndex, const std::string &localTmpPath) {
-    if(compressed == true && splitMode == Parameters::TARGET_DB_SPLIT){
-            Debug(Debug::WARNING) << "The output of the prefilter cannot be compressed during target split mode. "
-                                     "Prefilter result will not be compressed.\n";
-            compressed = false;
+void Prefiltering::runStreaming(Alignment &alignment, const std::string &alnDB, const std::string &alnDBIndex,
+                                const std::string &resultDB, const std::string &resultDBIndex,
+                                unsigned int maxAlnNum, unsigned int maxRejected, bool wrappedScoring) {
+    if (splits != 1) {
+        Debug(Debug::ERROR) << "Streaming the prefilter result to the alignment is only possible without splits\n";
+        EXIT(EXIT_FAILURE);
     }
 
+    DBWriter alnWriter(alnDB.c_str(), alnDBIndex.c_str(), threads, writerMode | (sharedWriter ? Parameters::WRITER_SHARED_MODE : 0), alignment.getDbtype());
+    alnWriter.open();
+    this->alignment = &alignment;
+    this->alignmentWriter = &alnWriter;
+    this->maxAlnNum = maxAlnNum;
+    this->maxRejected = maxRejected;
+    this->wrappedScoring = wrappedScoring;
+    runSplit(resultDB, resultDBIndex, 0, false);
+    this->alignment = NULL;
+    this->alignmentWriter = NULL;
+    alnWriter.close();
+}
+
+#ifdef HAVE_MPI
+void Prefiltering::runMpiSplits(const std::string &resultDB, const std::string &resultDBIndex, const std::string &localTmpPath) {
     // if split size is great than nodes than we have to
     // distribute all splits equally over all nodes
     unsigned int * splitCntPerProc = new unsigned int[MMseqsMPI::numProc];
@@ -701,11 +800,7 @@ int Prefiltering::runSplits(const std::string &resultDB, const std::string &resu
 
     bool hasResult = false;
     if (splitProcessCount > 1) {
-        if(compressed == true && splitMode == Parameters::TARGET_DB_SPLIT){
-            Debug(Debug::WARNING) << "The output of the prefilter cannot be compressed during target split mode. "
-                                     "Prefilter result will not be compressed.\n";
-            compressed = false;
-        }
+        Timer timer;
         // splits template database into x sequence steps
         std::vector<std::pair<std::string, std::string> > splitFiles;
         for (size_t i = fromSplit; i < (fromSplit + splitProcessCount); i++) {
@@ -715,16 +810,20 @@ int Prefiltering::runSplits(const std::string &resultDB, const std::string &resu
 
             }
         }
+        const std::string splitTime = timer.lap();
         if (splitFiles.size() > 0) {
+            timer.reset();
             mergePrefilterSplits(resultDB, resultDBIndex, splitFiles);
-            if (splitFiles.size() > 1) {
-                DBReader<unsigned int> resultReader(resultDB.c_str(), resultDBIndex.c_str(), threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+            Debug(Debug::INFO) << "Time for " << splitProcessCount << " prefiltering steps: " << splitTime
+                               << ", for merging their results: " << timer.lap() << "\n";
+            // the target split merge writes the queries in order already
+            if (splitFiles.size() > 1 && splitMode != Parameters::TARGET_DB_SPLIT) {
+                DBReader<unsigned int> resultReader(resultDB.c_str(), resultDBIndex.c_str(), threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA | DBReader<unsigned int>::USE_BINARY);
                 resultReader.open(DBReader<unsigned int>::NOSORT);
-                resultReader.readMmapedDataInMemory();
                 const std::pair<std::string, std::string> tempDb = Util::databaseNames(resultDB + "_tmp");
-                DBWriter resultWriter(tempDb.first.c_str(), tempDb.second.c_str(), threads, compressed, Parameters::DBTYPE_PREFILTER_RES);
+                DBWriter resultWriter(tempDb.first.c_str(), tempDb.second.c_str(), threads, writerMode, resultDbtype);
                 resultWriter.open();
-                resultWriter.sortDatafileByIdOrder(resultReader);
+                resultWriter.sortDatafileByIdOrder(resultReader, memoryLimit);
                 resultWriter.close(true);
                 resultReader.close();
                 DBReader<unsigned int>::removeDb(resultDB);
@@ -751,15 +850,16 @@ bool Prefiltering::runSplit(const std::string &resultDB, const std::string &resu
 
     // create index table based on split parameter
     if (splitMode == Parameters::TARGET_DB_SPLIT) {
-        tdbr->decomposeDomainByAminoAcid(split, splits, &dbFrom, &dbSize);
+        if (templateDBIsIndex == true) {
+            PrefilteringIndexReader::getSplitRange(split, tidxdbr, tdbr, &dbFrom, &dbSize);
+        } else {
+            tdbr->decomposeDomainByAminoAcid(split, splits, &dbFrom, &dbSize);
+        }
         if (dbSize == 0) {
             return false;
         }
 
-        if (indexTable != NULL) {
-            delete indexTable;
-            indexTable = NULL;
-        }
+        deleteIndexTable();
 
         if (sequenceLookup != NULL) {
             delete sequenceLookup;
@@ -784,6 +884,11 @@ bool Prefiltering::runSplit(const std::string &resultDB, const std::string &resu
     size_t realResSize = 0;
     size_t diagonalOverflow = 0;
     size_t trancatedCounter = 0;
+    size_t copiedMatches = 0;
+    size_t hitBufferThreads = 0;
+    size_t kmerCacheHits = 0;
+    size_t kmerCacheMisses = 0;
+    double kmerCacheMissSeconds = 0.0;
     size_t totalQueryDBSize = querySize;
 
     unsigned int localThreads = 1;
@@ -791,8 +896,15 @@ bool Prefiltering::runSplit(const std::string &resultDB, const std::string &resu
     localThreads = std::min((unsigned int)threads, (unsigned int)querySize);
 #endif
 
-    DBWriter tmpDbw(resultDB.c_str(), resultDBIndex.c_str(), localThreads, compressed, Parameters::DBTYPE_PREFILTER_RES);
-    tmpDbw.open();
+    // while streaming to the alignment the prefilter result is only written on request
+    const bool writeResult = (alignment == NULL || resultDB.empty() == false);
+    DBWriter tmpDbw(resultDB.c_str(), resultDBIndex.c_str(), localThreads, writerMode | (sharedWriter ? Parameters::WRITER_SHARED_MODE : 0), resultDbtype);
+    if (writeResult) {
+        tmpDbw.open();
+    }
+    const bool binaryResults = Parameters::isBinaryDbtype(resultDbtype);
+    size_t alignmentsNum = 0;
+    size_t alignmentsPassed = 0;
 
     // init all thread-specific data structures
     char *notEmpty = new char[querySize];
@@ -808,15 +920,40 @@ bool Prefiltering::runSplit(const std::string &resultDB, const std::string &resu
     Debug(Debug::INFO) << "Target db start " << (dbFrom + 1) << " to " << dbFrom + dbSize << "\n";
     Debug::Progress progress(querySize);
 
-#pragma omp parallel num_threads(localThreads)
+    std::vector<size_t> nodeQueries(numaNodes.size(), 0);
+
+    // the number of k-mer matches and diagonals to score grows with the query length
+    QueryScheduler scheduler(queryFrom, querySize, localThreads);
+#pragma omp parallel for schedule(static) num_threads(localThreads)
+    for (size_t id = queryFrom; id < queryFrom + querySize; id++) {
+        scheduler.setCost(id, qdbr->getSeqLen(id));
+    }
+    scheduler.init();
+    Timer timer;
+
+#pragma omp parallel num_threads(localThreads) reduction (+: kmersPerPos, resSize, dbMatches, doubleMatches, querySeqLenSum, diagonalOverflow, trancatedCounter, copiedMatches, hitBufferThreads, kmerCacheHits, kmerCacheMisses, kmerCacheMissSeconds, alignmentsNum, alignmentsPassed)
     {
         unsigned int thread_idx = 0;
 #ifdef OPENMP
         thread_idx = static_cast<unsigned int>(omp_get_thread_num());
 #endif
+        // threads are spread round robin over the nodes and use the replica of their node
+        IndexTable *localIndexTable = indexTable;
+        size_t numaNode = 0;
+        size_t localQueries = 0;
+        std::vector<int> affinity;
+        if (numaNodes.empty() == false) {
+            numaNode = thread_idx % numaNodes.size();
+            Numa::getThreadAffinity(affinity);
+            Numa::setThreadAffinity(numaNodes[numaNode].cpus);
+            if (nodeIndexTables.empty() == false) {
+                localIndexTable = nodeIndexTables[numaNode];
+            }
+        }
+
         Sequence seq(maxSeqLen, querySeqType, kmerSubMat, kmerSize, spacedKmer, aaBiasCorrection, true, spacedKmerPattern);
 
-        QueryMatcher matcher(indexTable, sequenceLookup, kmerSubMat,  ungappedSubMat,
+        QueryMatcher matcher(localIndexTable, sequenceLookup, kmerSubMat,  ungappedSubMat,
                              kmerThr, kmerSize, dbSize, maxSeqLen, maxResListLen, aaBiasCorrection,
                              diagonalScoring, minDiagScoreThr, takeOnlyBestKmer);
 
@@ -827,18 +964,62 @@ bool Prefiltering::runSplit(const std::string &resultDB, const std::string &resu
         } else {
             matcher.setSubstitutionMatrix(NULL, NULL);
         }
+        matcher.setKmerCacheSize(kmerCache);
+
+        // report once the index and the buffers of all threads are allocated
+        if (HugePages::getMode() != HugePages::MODE_OFF) {
+#pragma omp barrier
+#pragma omp master
+            HugePages::printStatistics();
+        }
 
         char buffer[128];
         std::string result;
         result.reserve(1000000);
 
-#pragma omp for schedule(dynamic, 2) reduction (+: kmersPerPos, resSize, dbMatches, doubleMatches, querySeqLenSum, diagonalOverflow, trancatedCounter)
-        for (size_t id = queryFrom; id < queryFrom + querySize; id++) {
-            progress.updateProgress();
-            // get query sequence
-            char *seqData = qdbr->getData(id, thread_idx);
+        Alignment::Worker *alignmentWorker = NULL;
+        std::string hits;
+        std::string alnResult;
+        if (alignment != NULL) {
+            alignmentWorker = new Alignment::Worker(*alignment, wrappedScoring);
+        }
+
+        // the k-mer generator of a profile query uses the profile of seq, profiles are matched one by one
+        const size_t batchSize = (seq.profile_matrix != NULL) ? 1 : prefilterBatch;
+        std::vector<Sequence *> batchSeqs(1, &seq);
+        for (size_t i = 1; i < batchSize; i++) {
+            batchSeqs.push_back(new Sequence(maxSeqLen, querySeqType, kmerSubMat, kmerSize, spacedKmer, aaBiasCorrection, true, spacedKmerPattern));
+        }
+        std::vector<size_t> batchIds(batchSize);
+        size_t batchCount = 0;
+        size_t batchPos = 0;
+        size_t batchPrepared = 0;
+
+        while (true) {
+            if (batchPos == batchCount) {
+                batchCount = 0;
+                batchPos = 0;
+                batchPrepared = 0;
+                size_t nextId;
+                while (batchCount < batchSize && scheduler.next(thread_idx, nextId)) {
+                    progress.updateProgress();
+                    // get query sequence
+                    char *seqData = qdbr->getData(nextId, thread_idx);
+                    batchSeqs[batchCount]->mapSequence(nextId, qdbr->getDbKey(nextId), seqData, qdbr->getSeqLen(nextId));
+                    batchIds[batchCount] = nextId;
+                    batchCount++;
+                }
+                if (batchCount == 0) {
+                    break;
+                }
+            }
+            if (batchSize > 1 && batchPos == batchPrepared) {
+                batchPrepared += matcher.prepareBatch(&batchSeqs[batchPos], batchCount - batchPos);
+            }
+            const size_t id = batchIds[batchPos];
+            Sequence &seq = *batchSeqs[batchPos];
+            batchPos++;
             unsigned int qKey = qdbr->getDbKey(id);
-            seq.mapSequence(id, qKey, seqData, qdbr->getSeqLen(id));
             size_t targetSeqId = UINT_MAX;
             if (sameQTDB || includeIdentical) {
                 targetSeqId = tdbr->getId(seq.getDbKey());
@@ -855,8 +1036,10 @@ bool Prefiltering::runSplit(const std::string &resultDB, const std::string &resu
             }
             // calculate prefiltering results
             std::pair<hit_t *, size_t> prefResults = matcher.matchQuery(&seq, targetSeqId);
+            localQueries++;
             size_t resultSize = prefResults.second;
             const float queryLength = static_cast<float>(qdbr->getSeqLen(id));
+            size_t writtenHits = 0;
             for (size_t i = 0; i < resultSize; i++) {
                 hit_t *res = prefResults.first + i;
                 // correct the 0 indexed sequence id again to its real identifier
@@ -877,12 +1060,31 @@ bool Prefiltering::runSplit(const std::string &resultDB, const std::string &resu
                     }
                 }
 
+                // compact accepted hits in place, binary results and the alignment use them in one piece below
+                prefResults.first[writtenHits++] = *res;
+                if (binaryResults || writeResult == false) {
+                    continue;
+                }
                 // write prefiltering results to a string
                 int len = QueryMatcher::prefilterHitToBuffer(buffer, *res);
                 result.append(buffer, len);
             }
-            tmpDbw.writeData(result.c_str(), result.length(), qKey, thread_idx);
-            result.clear();
+            if (writeResult) {
+                if (binaryResults) {
+                    QueryMatcher::prefilterHitsToBinary(result, prefResults.first, writtenHits);
+                }
+                tmpDbw.writeData(result.c_str(), result.length(), qKey, thread_idx);
+                result.clear();
+            }
+            if (alignment != NULL) {
+                // the hits are passed in the binary prefilter format, its targets are already replaced by keys
+                QueryMatcher::prefilterHitsToBinary(hits, prefResults.first, writtenHits);
+                alignment->alignQuery(qKey, &hits[0], true, false, maxAlnNum, maxRejected, wrappedScoring,
+                                      *alignmentWorker, alnResult, alignmentsNum, alignmentsPassed, thread_idx);
+                alignmentWriter->writeData(alnResult.c_str(), alnResult.length(), qKey, thread_idx);
+                alnResult.clear();
+                hits.clear();
+            }
 
             // update statistics counters
             if (resultSize != 0) {
@@ -896,12 +1098,32 @@ bool Prefiltering::runSplit(const std::string &resultDB, const std::string &resu
                 querySeqLenSum += seq.L;
                 diagonalOverflow += matcher.getStatistics()->diagonalOverflow;
                 trancatedCounter += matcher.getStatistics()->truncated;
+                copiedMatches += matcher.getStatistics()->copiedMatches;
                 resSize += resultSize;
                 realResSize += std::min(resultSize, maxResListLen);
                 reslens[thread_idx]->emplace_back(resultSize);
             }
         } // step end
+
+        if (matcher.hasHitBuffer()) {
+            hitBufferThreads++;
+        }
+        kmerCacheHits += matcher.getKmerGenerator()->getCacheHits();
+        kmerCacheMisses += matcher.getKmerGenerator()->getCacheMisses();
+        kmerCacheMissSeconds += matcher.getKmerGenerator()->getCacheMissSeconds();
+        for (size_t i = 1; i < batchSeqs.size(); i++) {
+            delete batchSeqs[i];
+        }
+        if (alignmentWorker != NULL) {
+            delete alignmentWorker;
+        }
+
+        if (numaNodes.empty() == false) {
+            __sync_fetch_and_add(&nodeQueries[numaNode], localQueries);
+            Numa::setThreadAffinity(affinity);
+        }
     }
+    const double seconds = timer.getTimediff();
 
     if (Debug::debugLevel >= Debug::INFO) {
         statistics_t stats(kmersPerPos / static_cast<double>(totalQueryDBSize),
@@ -909,6 +1131,7 @@ bool Prefiltering::runSplit(const std::string &resultDB, const std::string &resu
                            doubleMatches / totalQueryDBSize,
                            querySeqLenSum, diagonalOverflow,
                            resSize / totalQueryDBSize, trancatedCounter);
+        stats.copiedMatches = copiedMatches / totalQueryDBSize;
 
         size_t empty = 0;
         for (size_t id = 0; id < querySize; id++) {
@@ -917,18 +1140,39 @@ bool Prefiltering::runSplit(const std::string &resultDB, const std::string &resu
             }
         }
 
-        printStatistics(stats, reslens, localThreads, empty, maxResListLen);
+        printStatistics(stats, reslens, localThreads, empty, maxResListLen, nodeQueries, seconds);
+        // the k-mer lists of the other matches were binned without a copy. Only the copied volume is known,
+        // the time of the copies depends on the length of the lists and is not measured
+        const size_t hitBufferSize = QueryMatcher::getHitBufferSize(dbSize);
+        Debug(Debug::INFO) << "Hit copy buffers of " << ByteParser::format(hitBufferSize) << " needed by " << hitBufferThreads
+                           << " of " << localThreads << " threads, " << ByteParser::format((localThreads - hitBufferThreads) * hitBufferSize) << " not allocated\n";
+        Debug(Debug::INFO) << ByteParser::format((dbMatches - std::min(copiedMatches, dbMatches)) * sizeof(IndexEntryLocal))
+                           << " of k-mer list entries binned without a copy\n";
+        const size_t kmerCacheLookups = kmerCacheHits + kmerCacheMisses;
+        if (kmerCacheLookups > 0) {
+            // a hit saves the average time of generating a list that missed
+            const double savedSeconds = (kmerCacheMisses > 0) ? kmerCacheHits * (kmerCacheMissSeconds / kmerCacheMisses) : 0.0;
+            Debug(Debug::INFO) << "Similar k-mer cache: " << kmerCacheHits << " of " << kmerCacheLookups << " lookups hit ("
+                               << (100.0 * kmerCacheHits / kmerCacheLookups) << "%), about " << savedSeconds
+                               << "s of k-mer generation saved over all threads\n";
+        }
+        scheduler.printStatistics();
+        if (alignment != NULL) {
+            Alignment::printStatistics(alignmentsNum, alignmentsPassed, totalQueryDBSize);
+        }
     }
 
-    if (splitMode == Parameters::TARGET_DB_SPLIT && splits == 1) {
+    if (writeResult) {
+        if (splitMode == Parameters::TARGET_DB_SPLIT && splits == 1) {
 #ifdef HAVE_MPI
-        // if a mpi rank processed a single split, it must have it merged before all ranks can be united
-        tmpDbw.close(true);
+            // if a mpi rank processed a single split, it must have it merged before all ranks can be united
+            tmpDbw.close(true);
 #else
-        tmpDbw.close(merge);
+            tmpDbw.close(merge);
 #endif
-    } else {
-        tmpDbw.close(merge);
+        } else {
+            tmpDbw.close(merge);
+        }
     }
 
     // sort by ids
@@ -936,17 +1180,13 @@ bool Prefiltering::runSplit(const std::string &resultDB, const std::string &resu
     // sorts this datafile according to the index file
     if (splitMode == Parameters::TARGET_DB_SPLIT && splits > 1) {
         // delete indexTable to free memory:
-        if (indexTable != NULL) {
-            delete indexTable;
-            indexTable = NULL;
-        }
-        DBReader<unsigned int> resultReader(tmpDbw.getDataFileName(), tmpDbw.getIndexFileName(), threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
+        deleteIndexTable();
+        DBReader<unsigned int> resultReader(tmpDbw.getDataFileName(), tmpDbw.getIndexFileName(), threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_BINARY);
         resultReader.open(DBReader<unsigned int>::NOSORT);
-        resultReader.readMmapedDataInMemory();
         const std::pair<std::string, std::string> tempDb = Util::databaseNames((resultDB + "_tmp"));
-        DBWriter resultWriter(tempDb.first.c_str(), tempDb.second.c_str(), localThreads, compressed, Parameters::DBTYPE_PREFILTER_RES);
+        DBWriter resultWriter(tempDb.first.c_str(), tempDb.second.c_str(), localThreads, writerMode, resultDbtype);
         resultWriter.open();
-        resultWriter.sortDatafileByIdOrder(resultReader);
+        resultWriter.sortDatafileByIdOrder(resultReader, memoryLimit);
         resultWriter.close(true);
         resultReader.close();
         DBReader<unsigned int>::removeDb(resultDB);
@@ -964,7 +1204,8 @@ bool Prefiltering::runSplit(const std::string &resultDB, const std::string &resu
 }
 
 void Prefiltering::printStatistics(const statistics_t &stats, std::list<int> **reslens,
-                                   unsigned int resLensSize, size_t empty, size_t maxResults) {
+                                   unsigned int resLensSize, size_t empty, size_t maxResults,
+                                   const std::vector<size_t> &nodeQueries, double seconds) {
     // sort and merge the result list lengths (for median calculation)
     reslens[0]->sort();
     for (unsigned int i = 1; i < resLensSize; i++) {
@@ -973,6 +1214,7 @@ void Prefiltering::printStatistics(const statistics_t &stats, std::list<int> **r
     }
     Debug(Debug::INFO) << "\n" << stats.kmersPerPos << " k-mers per position\n";
     Debug(Debug::INFO) << stats.dbMatches << " DB matches per sequence\n";
+    Debug(Debug::INFO) << stats.copiedMatches << " DB matches per sequence copied before binning\n";
     Debug(Debug::INFO) << stats.diagonalOverflow << " overflows\n";
     Debug(Debug::INFO) << stats.truncated << " queries produce too much hits (truncated result)\n";
     Debug(Debug::INFO) << stats.resultsPassedPrefPerSeq << " sequences passed prefiltering per query sequence";
@@ -986,6 +1228,12 @@ void Prefiltering::printStatistics(const statistics_t &stats, std::list<int> **r
     std::advance(it, mid);
     Debug(Debug::INFO) << *it << " median result list length\n";
     Debug(Debug::INFO) << empty << " sequences with 0 size result lists\n";
+    for (size_t i = 0; i < nodeQueries.size(); i++) {
+        // interleaved pages are spread evenly
+        size_t memory = nodeIndexTables.empty() ? indexTable->getMemorySize() / numaNodes.size() : nodeIndexTables[i]->getMemorySize();
+        Debug(Debug::INFO) << "NUMA node " << numaNodes[i].id << ": " << ByteParser::format(memory) << " index table, "
+                           << nodeQueries[i] << " queries, " << (seconds > 0 ? nodeQueries[i] / seconds : 0.0) << " queries/s\n";
+    }
 }
 
 
@@ -1010,9 +1258,9 @@ BaseMatrix *Prefiltering::getSubstitutionMatrix(const ScoreMatrixFile &scoringMa
 void Prefiltering::mergePrefilterSplits(const std::string &outDB, const std::string &outDBIndex,
                               const std::vector<std::pair<std::string, std::string>> &splitFiles) {
     if (splitMode == Parameters::TARGET_DB_SPLIT) {
-        mergeTargetSplits(outDB, outDBIndex, splitFiles, threads);
+        mergeTargetSplits(outDB, outDBIndex, splitFiles, threads, writerMode, mergedResListLen);
     } else if (splitMode == Parameters::QUERY_DB_SPLIT) {
-        DBWriter::mergeResults(outDB, outDBIndex, splitFiles);
+        DBWriter::mergeResults(outDB, outDBIndex, splitFiles, (writerMode & Parameters::WRITER_BINARY_INDEX_MODE) != 0);
     }
 }
 
@@ -1052,15 +1300,27 @@ int Prefiltering::getKmerThreshold(const float sensitivity, const bool isProfile
     return static_cast<int>(kmerThrBest);
 }
 
-size_t Prefiltering::estimateMemoryConsumption(int split, size_t dbSize, size_t resSize,
-                                               size_t maxResListLen,
-                                               int alphabetSize, int kmerSize, unsigned int querySeqType,
-                                               int threads) {
+Prefiltering::MemoryEstimate Prefiltering::estimateMemoryComponents(int split, size_t dbSize, size_t resSize,
+                                                                    size_t maxResListLen,
+                                                                    int alphabetSize, int kmerSize, unsigned int querySeqType,
+                                                                    int threads, bool compressedIndex, size_t indexReplicas) {
     // for each residue in the database we need 7 byte
     size_t dbSizeSplit = (dbSize) / split;
     size_t residueSize = (resSize / split * 7);
     // 21^7 * pointer size is needed for the index
     size_t indexTableSize = static_cast<size_t>(pow(alphabetSize, kmerSize)) * sizeof(size_t);
+    if (compressedIndex) {
+        // a compressed entry needs the bits of the average seq. id gap in a k-mer list plus up to 16 bits for
+        // the position, each k-mer a 32 bit offset and each non-empty list a header of about 8 bytes
+        const double tableSize = pow(alphabetSize, kmerSize);
+        const double entries = static_cast<double>(resSize / split);
+        const double entriesPerKmer = std::max(1.0, entries / tableSize);
+        const double idBits = ceil(log2(static_cast<double>(dbSizeSplit) / entriesPerKmer + 1.0)) + 1.0;
+        residueSize = static_cast<size_t>(entries * (1.0 + (idBits + 16.0) / 8.0));
+        indexTableSize = static_cast<size_t>(tableSize * sizeof(uint32_t) + std::min(tableSize, entries) * 8.0);
+    }
+    residueSize *= indexReplicas;
+    indexTableSize *= indexReplicas;
     // memory needed for the threads
     // This memory is an approx. for Countint32Array and QueryTemplateLocalFast
     size_t threadSize = threads * (
@@ -1080,8 +1340,21 @@ size_t Prefiltering::estimateMemoryConsumption(int split, size_t dbSize, size_t
     }
     // some memory needed to keep the index, ....
     size_t background = dbSize * 22;
-    // return result in bytes
-    return residueSize + indexTableSize + threadSize + background + extendedMatrix + dbReaderSize;
+    // result in bytes
+    MemoryEstimate estimate;
+    estimate.indexTable = residueSize + indexTableSize;
+    estimate.threadBuffers = threadSize;
+    estimate.matrices = extendedMatrix;
+    estimate.databaseIndex = dbReaderSize + background;
+    return estimate;
+}
+
+size_t Prefiltering::estimateMemoryConsumption(int split, size_t dbSize, size_t resSize,
+                                               size_t maxResListLen,
+                                               int alphabetSize, int kmerSize, unsigned int querySeqType,
+                                               int threads, bool compressedIndex, size_t indexReplicas) {
+    return estimateMemoryComponents(split, dbSize, resSize, maxResListLen, alphabetSize, kmerSize, querySeqType,
+                                    threads, compressedIndex, indexReplicas).total();
 }
 
 size_t Prefiltering::estimateHDDMemoryConsumption(size_t dbSize, size_t maxResListLen) {
@@ -1091,7 +1364,8 @@ size_t Prefiltering::estimateHDDMemoryConsumption(size_t dbSize, size_t maxResLi
 }
 
 std::pair<int, int> Prefiltering::optimizeSplit(size_t totalMemoryInByte, DBReader<unsigned int> *tdbr,
-                                                int alphabetSize, int externalKmerSize, unsigned int querySeqType, unsigned int threads) {
+                                                int alphabetSize, int externalKmerSize, unsigned int querySeqType, unsigned int threads,
+                                                bool compressedIndex) {
 
     int startKmerSize = (externalKmerSize == 0) ? 6 : externalKmerSize;
     int endKmerSize   = (externalKmerSize == 0) ? 7 : externalKmerSize;
@@ -1115,7 +1389,7 @@ std::pair<int, int> Prefiltering::optimizeSplit(size_t totalMemoryInByte, DBRead
                 size_t neededSize = estimateMemoryConsumption(optSplit, tdbr->getSize(),
                                                               tdbr->getAminoAcidDBSize(),
                                                               0, alphabetSize, optKmerSize, querySeqType,
-                                                              threads);
+                                                              threads, compressedIndex);
                 if (neededSize < 0.9 * totalMemoryInByte) {
                     return std::make_pair(optKmerSize, optSplit);
                 }
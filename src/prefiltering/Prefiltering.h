@@ -9,11 +9,13 @@
 #include "ScoreMatrix.h"
 #include "PrefilteringIndexReader.h"
 #include "QueryMatcher.h"
+#include "Numa.h"
 
 #include <string>
 #include <list>
 #include <utility>
 
+class Alignment;
 
 class Prefiltering {
 public:
@@ -35,6 +37,17 @@ public:
 
     int runSplits(const std::string &resultDB, const std::string &resultDBIndex, size_t fromSplit, size_t splitProcessCount, bool merge);
 
+    // hands the hits of every query to the gapped alignment of the same thread as soon as it is prefiltered,
+    // instead of aligning a written prefilter database afterwards. The prefilter result is only written if
+    // resultDB is not empty. Needs the whole target database in a single split.
+    void runStreaming(Alignment &alignment, const std::string &alnDB, const std::string &alnDBIndex,
+                      const std::string &resultDB, const std::string &resultDBIndex,
+                      unsigned int maxAlnNum, unsigned int maxRejected, bool wrappedScoring);
+
+    int getSplits() const {
+        return splits;
+    }
+
     // merge file
     void mergePrefilterSplits(const std::string &outDb, const std::string &outDBIndex,
                     const std::vector<std::pair<std::string, std::string>> &splitFiles);
@@ -44,12 +57,14 @@ public:
 
     static void setupSplit(DBReader<unsigned int>& dbr, const int alphabetSize, const unsigned int querySeqType, const int threads,
                            const bool templateDBIsIndex, const size_t memoryLimit, const size_t qDbSize,
-                           size_t& maxResListLen, int& kmerSize, int& split, int& splitMode);
+                           size_t& maxResListLen, int& kmerSize, int& split, int& splitMode, bool compressedIndex = false);
 
     static int getKmerThreshold(const float sensitivity, const bool isProfile, const int kmerScore, const int kmerSize);
 
+    // merges the results of the target splits into the maxResListLen best hits per query
     static void mergeTargetSplits(const std::string &outDB, const std::string &outDBIndex,
-                                  const std::vector<std::pair<std::string, std::string>> &fileNames, unsigned int threads);
+                                  const std::vector<std::pair<std::string, std::string>> &fileNames, unsigned int threads,
+                                  size_t writerMode, size_t maxResListLen);
 
 private:
     const std::string queryDB;
@@ -79,12 +94,16 @@ private:
     int maskMode;
     int maskLowerCaseMode;
     int splitMode;
+    // --split-memory-limit or 90% of the system memory
+    size_t memoryLimit;
     int kmerThr;
     ScoreMatrixFile scoringMatrixFile;
     ScoreMatrixFile seedScoringMatrixFile;
     int targetSeqType;
     bool takeOnlyBestKmer;
     size_t maxResListLen;
+    // maxResListLen before it is reduced per target split, the bound of the merged target split result
+    size_t mergedResListLen;
 
     const int kmerScore;
     const float sensitivity;
@@ -98,19 +117,59 @@ private:
     const bool includeIdentical;
     int preloadMode;
     const unsigned int threads;
-    int compressed;
+    // DBWriter mode of --compressed, --compression-dict and --binary-index
+    const size_t writerMode;
+    // all threads write into one data file (WRITER_SHARED_MODE)
+    const bool sharedWriter;
+    // prefilter dbtype, optionally flagged as binary
+    const int resultDbtype;
+
+    int numaMode;
+    // queries a thread matches together, see QueryMatcher::prepareBatch
+    const size_t prefilterBatch;
+    // bytes per thread for similar k-mer lists, see KmerGenerator::setCacheSize
+    const size_t kmerCache;
+    // nodes the index table is placed on, empty without --numa-mode
+    std::vector<Numa::Node> numaNodes;
+    // one replica per node in NUMA_MODE_REPLICATE, the first one is indexTable
+    std::vector<IndexTable *> nodeIndexTables;
+
+    // set during runStreaming
+    Alignment *alignment;
+    DBWriter *alignmentWriter;
+    unsigned int maxAlnNum;
+    unsigned int maxRejected;
+    bool wrappedScoring;
 
     bool runSplit(const std::string &resultDB, const std::string &resultDBIndex, size_t split, bool merge);
 
     // compute kmer size and split size for index table
     static std::pair<int, int> optimizeSplit(size_t totalMemoryInByte, DBReader<unsigned int> *tdbr, int alphabetSize, int kmerSize,
-                                             unsigned int querySeqType, unsigned int threads);
+                                             unsigned int querySeqType, unsigned int threads, bool compressedIndex);
+
+    // estimated memory consumption while runtime, split into the components that are reserved in the MemoryBudget
+    struct MemoryEstimate {
+        size_t indexTable;
+        size_t threadBuffers;
+        size_t matrices;
+        size_t databaseIndex;
+
+        size_t total() const {
+            return indexTable + threadBuffers + matrices + databaseIndex;
+        }
+    };
+
+    // indexReplicas is the number of copies of the index table (one per node with --numa-mode 2)
+    static MemoryEstimate estimateMemoryComponents(int split, size_t dbSize, size_t resSize,
+                                                   size_t maxHitsPerQuery,
+                                                   int alphabetSize, int kmerSize, unsigned int querySeqType,
+                                                   int threads, bool compressedIndex, size_t indexReplicas = 1);
 
     // estimates memory consumption while runtime
     static size_t estimateMemoryConsumption(int split, size_t dbSize, size_t resSize,
                                             size_t maxHitsPerQuery,
                                             int alphabetSize, int kmerSize, unsigned int querySeqType,
-                                            int threads);
+                                            int threads, bool compressedIndex, size_t indexReplicas = 1);
 
     static size_t estimateHDDMemoryConsumption(size_t dbSize, size_t maxResListLen);
 
@@ -120,8 +179,17 @@ private:
     // needed for index lookup
     void getIndexTable(int split, size_t dbFrom, size_t dbSize);
 
+    // falls back to interleaving if a copy of the index table for each NUMA node does not fit into the memory limit
+    void checkIndexReplicas(bool compressedIndex);
+
+    // interleaves or replicates the index table over the NUMA nodes
+    void placeIndexTable();
+
+    void deleteIndexTable();
+
     void printStatistics(const statistics_t &stats, std::list<int> **reslens,
-                         unsigned int resLensSize, size_t empty, size_t maxResults);
+                         unsigned int resLensSize, size_t empty, size_t maxResults,
+                         const std::vector<size_t> &nodeQueries, double seconds);
 
     bool isSameQTDB();
 
@@ -5,8 +5,14 @@
 #include "FileUtil.h"
 #include "IndexBuilder.h"
 #include "Parameters.h"
+#include "ByteParser.h"
 
-const char*  PrefilteringIndexReader::CURRENT_VERSION = "16";
+#include <algorithm>
+#include <vector>
+
+const char*  PrefilteringIndexReader::CURRENT_VERSION = "17";
+// indices of version 16 have no split ranges and are read like version 17 indices without appended splits
+static const char* COMPATIBLE_VERSION = "16";
 unsigned int PrefilteringIndexReader::VERSION = 0;
 unsigned int PrefilteringIndexReader::META = 1;
 unsigned int PrefilteringIndexReader::SCOREMATRIXNAME = 2;
@@ -30,15 +36,209 @@ unsigned int PrefilteringIndexReader::HDR2INDEX = 20;
 unsigned int PrefilteringIndexReader::HDR2DATA = 21;
 unsigned int PrefilteringIndexReader::GENERATOR = 22;
 unsigned int PrefilteringIndexReader::SPACEDPATTERN = 23;
+unsigned int PrefilteringIndexReader::ENTRIESBLOCKOFFSETS = 24;
+unsigned int PrefilteringIndexReader::DBR1DICT = 25;
+unsigned int PrefilteringIndexReader::DBR2DICT = 26;
+unsigned int PrefilteringIndexReader::HDR1DICT = 27;
+unsigned int PrefilteringIndexReader::HDR2DICT = 28;
+// first entry and number of entries of the target database in a split
+unsigned int PrefilteringIndexReader::SPLITRANGE = 29;
+// offsets of the sequence and header data that an appended split adds to the embedded databases
+unsigned int PrefilteringIndexReader::SEGMENTOFFSETS = 30;
 
 extern const char* version;
 
+// compression dictionary of a database that is stored in the index
+static void writeDictionary(DBWriter &writer, DBReader<unsigned int> *dbr, unsigned int key) {
+    const std::string &dictionary = dbr->getDictionary();
+    if (dictionary.empty()) {
+        return;
+    }
+    Debug(Debug::INFO) << "Write dictionary (" << key << ")\n";
+    writer.writeData(dictionary.c_str(), dictionary.size(), key, 0);
+    writer.alignToPageSize();
+}
+
+static void readDictionary(DBReader<unsigned int> *dbr, unsigned int dataIdx, DBReader<unsigned int> *reader) {
+    unsigned int key;
+    if (dataIdx == PrefilteringIndexReader::DBR1DATA) {
+        key = PrefilteringIndexReader::DBR1DICT;
+    } else if (dataIdx == PrefilteringIndexReader::DBR2DATA) {
+        key = PrefilteringIndexReader::DBR2DICT;
+    } else if (dataIdx == PrefilteringIndexReader::HDR1DATA) {
+        key = PrefilteringIndexReader::HDR1DICT;
+    } else {
+        key = PrefilteringIndexReader::HDR2DICT;
+    }
+    size_t id = dbr->getId(key);
+    if (id != UINT_MAX) {
+        reader->setDictionary(dbr->getDataUncompressed(id), dbr->getEntryLen(id) - 1);
+    }
+}
+
+// The embedded databases of an index with appended splits consist of a block per split that added sequences:
+// the data written by createindex and the data of every appended split (key 1000 * split + dataIdx).
+// The offsets of the database index continue from one block to the next, the blocks are mapped like data files.
+struct DataSegment {
+    size_t id;
+    size_t start;
+    size_t size;
+};
+
+static std::vector<DataSegment> getDataSegments(DBReader<unsigned int> *dbr, unsigned int dataIdx) {
+    std::vector<DataSegment> segments;
+    DataSegment base;
+    base.id = dbr->getId(dataIdx);
+    base.start = 0;
+    segments.push_back(base);
+    const bool headers = (dataIdx == PrefilteringIndexReader::HDR1DATA || dataIdx == PrefilteringIndexReader::HDR2DATA);
+    // only prefilter indices with split ranges can be appended to, other indices (e.g. of kmerindexdb) have a single block
+    const int splits = (dbr->getId(PrefilteringIndexReader::SPLITRANGE) != UINT_MAX) ? PrefilteringIndexReader::getMetadata(dbr).splits : 1;
+    for (int split = 1; split < splits; split++) {
+        size_t id = dbr->getId(1000 * split + dataIdx);
+        if (id == UINT_MAX) {
+            continue;
+        }
+        size_t *offsets = (size_t *) dbr->getDataUncompressed(dbr->getId(1000 * split + PrefilteringIndexReader::SEGMENTOFFSETS));
+        DataSegment segment;
+        segment.id = id;
+        segment.start = offsets[headers ? 1 : 0];
+        segments.push_back(segment);
+    }
+    // a block reaches up to the next entry of the index file
+    for (size_t i = 0; i < segments.size(); i++) {
+        if (i + 1 < segments.size()) {
+            segments[i].size = segments[i + 1].start - segments[i].start;
+        } else {
+            segments[i].size = dbr->findNextOffsetid(segments[i].id) - dbr->getOffset(segments[i].id);
+        }
+    }
+    return segments;
+}
+
+static void setDataSegments(DBReader<unsigned int> *dbr, unsigned int dataIdx, DBReader<unsigned int> *reader, bool touchData) {
+    std::vector<DataSegment> segments = getDataSegments(dbr, dataIdx);
+    for (size_t i = 0; i < segments.size(); i++) {
+        if (touchData) {
+            dbr->touchData(segments[i].id);
+        }
+        reader->addData(dbr->getDataUncompressed(segments[i].id), segments[i].size);
+    }
+}
+
+// writes the k-mer index table and the sequence lookup of a split, the table is compressed with indexCompression
+static void writeIndexTable(DBWriter &writer, unsigned int thrIdx, unsigned int keyOffset, IndexTable &indexTable,
+                            SequenceLookup *sequenceLookup, int indexCompression) {
+    // save the entries
+    if (indexCompression != 0) {
+        const size_t uncompressedSize = indexTable.getTableEntriesNum() * indexTable.getSizeOfEntry()
+                                        + (indexTable.getTableSize() + 1) * sizeof(size_t);
+        indexTable.compressEntries();
+        const size_t compressedSize = indexTable.getCompressedEntriesSize()
+                                      + (indexTable.getTableSize() + 1) * sizeof(uint32_t)
+                                      + indexTable.getBlockOffsetsSize() * sizeof(size_t);
+        Debug(Debug::INFO) << "Compressed index table from " << ByteParser::format(uncompressedSize)
+                           << " to " << ByteParser::format(compressedSize) << "\n";
+
+        Debug(Debug::INFO) << "Write ENTRIES (" << (keyOffset + PrefilteringIndexReader::ENTRIES) << ")\n";
+        writer.writeData((char *) indexTable.getCompressedEntries(), indexTable.getCompressedEntriesSize(), (keyOffset + PrefilteringIndexReader::ENTRIES), thrIdx);
+        writer.alignToPageSize(thrIdx);
+
+        Debug(Debug::INFO) << "Write ENTRIESOFFSETS (" << (keyOffset + PrefilteringIndexReader::ENTRIESOFFSETS) << ")\n";
+        writer.writeData((char *) indexTable.getKmerOffsets(), (indexTable.getTableSize() + 1) * sizeof(uint32_t), (keyOffset + PrefilteringIndexReader::ENTRIESOFFSETS), thrIdx);
+        writer.alignToPageSize(thrIdx);
+
+        Debug(Debug::INFO) << "Write ENTRIESBLOCKOFFSETS (" << (keyOffset + PrefilteringIndexReader::ENTRIESBLOCKOFFSETS) << ")\n";
+        writer.writeData((char *) indexTable.getBlockOffsets(), indexTable.getBlockOffsetsSize() * sizeof(size_t), (keyOffset + PrefilteringIndexReader::ENTRIESBLOCKOFFSETS), thrIdx);
+        writer.alignToPageSize(thrIdx);
+    } else {
+        Debug(Debug::INFO) << "Write ENTRIES (" << (keyOffset + PrefilteringIndexReader::ENTRIES) << ")\n";
+        char *entries = (char *) indexTable.getEntries();
+        size_t entriesSize = indexTable.getTableEntriesNum() * indexTable.getSizeOfEntry();
+        writer.writeData(entries, entriesSize, (keyOffset + PrefilteringIndexReader::ENTRIES), thrIdx);
+        writer.alignToPageSize(thrIdx);
+
+        // save the size
+        Debug(Debug::INFO) << "Write ENTRIESOFFSETS (" << (keyOffset + PrefilteringIndexReader::ENTRIESOFFSETS) << ")\n";
+        char *offsets = (char*)indexTable.getOffsets();
+        size_t offsetsSize = (indexTable.getTableSize() + 1) * sizeof(size_t);
+        writer.writeData(offsets, offsetsSize, (keyOffset + PrefilteringIndexReader::ENTRIESOFFSETS), thrIdx);
+        writer.alignToPageSize(thrIdx);
+    }
+    indexTable.deleteEntries();
+
+    Debug(Debug::INFO) << "Write SEQINDEXDATASIZE (" << (keyOffset + PrefilteringIndexReader::SEQINDEXDATASIZE) << ")\n";
+    int64_t seqindexDataSize = sequenceLookup->getDataSize();
+    char *seqindexDataSizePtr = (char *) &seqindexDataSize;
+    writer.writeData(seqindexDataSizePtr, 1 * sizeof(int64_t), (keyOffset + PrefilteringIndexReader::SEQINDEXDATASIZE), thrIdx);
+    writer.alignToPageSize(thrIdx);
+
+    size_t *sequenceOffsets = sequenceLookup->getOffsets();
+    size_t sequenceCount = sequenceLookup->getSequenceCount();
+    Debug(Debug::INFO) << "Write SEQINDEXSEQOFFSET (" << (keyOffset + PrefilteringIndexReader::SEQINDEXSEQOFFSET) << ")\n";
+    writer.writeData((char *) sequenceOffsets, (sequenceCount + 1) * sizeof(size_t), (keyOffset + PrefilteringIndexReader::SEQINDEXSEQOFFSET), thrIdx);
+    writer.alignToPageSize(thrIdx);
+
+    Debug(Debug::INFO) << "Write SEQINDEXDATA (" << (keyOffset + PrefilteringIndexReader::SEQINDEXDATA) << ")\n";
+    writer.writeData(sequenceLookup->getData(), (sequenceLookup->getDataSize() + 1) * sizeof(char), (keyOffset + PrefilteringIndexReader::SEQINDEXDATA), thrIdx);
+    writer.alignToPageSize(thrIdx);
+
+    // ENTRIESNUM
+    Debug(Debug::INFO) << "Write ENTRIESNUM (" << (keyOffset + PrefilteringIndexReader::ENTRIESNUM) << ")\n";
+    uint64_t entriesNum = indexTable.getTableEntriesNum();
+    char *entriesNumPtr = (char *) &entriesNum;
+    writer.writeData(entriesNumPtr, 1 * sizeof(uint64_t), (keyOffset + PrefilteringIndexReader::ENTRIESNUM), thrIdx);
+    writer.alignToPageSize(thrIdx);
+
+    // SEQCOUNT
+    Debug(Debug::INFO) << "Write SEQCOUNT (" << (keyOffset + PrefilteringIndexReader::SEQCOUNT) << ")\n";
+    size_t tablesize = indexTable.getSize();
+    char *tablesizePtr = (char *) &tablesize;
+    writer.writeData(tablesizePtr, 1 * sizeof(size_t), (keyOffset + PrefilteringIndexReader::SEQCOUNT), thrIdx);
+    writer.alignToPageSize(thrIdx);
+}
+
+// writes the k-mer index table and the sequence lookup of the target database entries [dbFrom, dbFrom + dbSize)
+static void writeSplit(DBWriter &writer, unsigned int thrIdx, int split, DBReader<unsigned int> *dbr, size_t dbFrom, size_t dbSize,
+                       BaseMatrix *subMat, Sequence *seq, int adjustAlphabetSize, int kmerSize, int maskMode, int maskLowerCase,
+                       int kmerThr, int indexCompression) {
+    unsigned int keyOffset = 1000 * split;
+    Debug(Debug::INFO) << "Write SPLITRANGE (" << (keyOffset + PrefilteringIndexReader::SPLITRANGE) << ")\n";
+    size_t range[] = {dbFrom, dbSize};
+    writer.writeData((char *) range, sizeof(range), (keyOffset + PrefilteringIndexReader::SPLITRANGE), thrIdx);
+    writer.alignToPageSize(thrIdx);
+    if (dbSize == 0) {
+        return;
+    }
+
+    IndexTable indexTable(adjustAlphabetSize, kmerSize, false);
+    SequenceLookup *sequenceLookup = NULL;
+    IndexBuilder::fillDatabase(&indexTable,
+                               (maskMode == 1 || maskLowerCase == 1) ? &sequenceLookup : NULL,
+                               (maskMode == 0 ) ? &sequenceLookup : NULL,
+                               *subMat, seq, dbr, dbFrom, dbFrom + dbSize, kmerThr, maskMode, maskLowerCase);
+    indexTable.printStatistics(subMat->num2aa);
+
+    if (sequenceLookup == NULL) {
+        Debug(Debug::ERROR) << "Invalid mask mode. No sequence lookup created!\n";
+        EXIT(EXIT_FAILURE);
+    }
+
+    writeIndexTable(writer, thrIdx, keyOffset, indexTable, sequenceLookup, indexCompression);
+    delete sequenceLookup;
+}
+
 bool PrefilteringIndexReader::checkIfIndexFile(DBReader<unsigned int>* reader) {
     char * version = reader->getDataByDBKey(VERSION, 0);
     if(version == NULL){
         return false;
     }
-    return (strncmp(version, CURRENT_VERSION, strlen(CURRENT_VERSION)) == 0 ) ? true : false;
+    return isCompatibleVersion(version);
+}
+
+bool PrefilteringIndexReader::isCompatibleVersion(const char *version) {
+    return strncmp(version, CURRENT_VERSION, strlen(CURRENT_VERSION)) == 0
+           || strncmp(version, COMPATIBLE_VERSION, strlen(COMPATIBLE_VERSION)) == 0;
 }
 
 std::string PrefilteringIndexReader::indexName(const std::string &outDB) {
@@ -53,7 +253,8 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB,
                                               BaseMatrix *subMat, int maxSeqLen,
                                               bool hasSpacedKmer, const std::string &spacedKmerPattern,
                                               bool compBiasCorrection, int alphabetSize, int kmerSize,
-                                              int maskMode, int maskLowerCase, int kmerThr, int splits) {
+                                              int maskMode, int maskLowerCase, int kmerThr, int splits,
+                                              int indexCompression) {
     DBWriter writer(outDB.c_str(), std::string(outDB).append(".index").c_str(), splits, Parameters::WRITER_ASCII_MODE, Parameters::DBTYPE_INDEX_DB);
     writer.open();
 
@@ -109,6 +310,33 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB,
         writer.alignToPageSize();
     }
 
+    writeDatabases(writer, dbr1, dbr2, hdbr1, hdbr2);
+
+    Debug(Debug::INFO) << "Write GENERATOR (" << GENERATOR << ")\n";
+    writer.writeData(version, strlen(version), GENERATOR, 0);
+    writer.alignToPageSize();
+
+    Sequence seq(maxSeqLen, seqType, subMat, kmerSize, hasSpacedKmer, compBiasCorrection, true, spacedKmerPattern);
+    // remove x (not needed in index)
+    const int adjustAlphabetSize =
+            (Parameters::isEqualDbtype(seqType, Parameters::DBTYPE_NUCLEOTIDES) || Parameters::isEqualDbtype(seqType, Parameters::DBTYPE_AMINO_ACIDS))
+                ? alphabetSize -1: alphabetSize;
+
+    for (int s = 0; s < splits; s++) {
+        size_t dbFrom = 0;
+        size_t dbSize = 0;
+        dbr1->decomposeDomainByAminoAcid(s, splits, &dbFrom, &dbSize);
+        writeSplit(writer, s, s, dbr1, dbFrom, dbSize, subMat, &seq, adjustAlphabetSize, kmerSize,
+                   maskMode, maskLowerCase, kmerThr, indexCompression);
+    }
+
+    writer.close(false);
+}
+
+// writes the databases (sequences and headers) that are embedded into the index, a database that is not given
+// refers to the first one
+void PrefilteringIndexReader::writeDatabases(DBWriter &writer, DBReader<unsigned int> *dbr1, DBReader<unsigned int> *dbr2,
+                                             DBReader<unsigned int> *hdbr1, DBReader<unsigned int> *hdbr2) {
     Debug(Debug::INFO) << "Write DBR1INDEX (" << DBR1INDEX << ")\n";
     char* data = DBReader<unsigned int>::serialize(*dbr1);
     size_t offsetIndex = writer.getOffset(0);
@@ -124,10 +352,12 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB,
     writer.writeEnd(DBR1DATA, 0);
     writer.alignToPageSize();
     free(data);
+    writeDictionary(writer, dbr1, DBR1DICT);
 
     if (dbr2 == NULL) {
         writer.writeIndexEntry(DBR2INDEX, offsetIndex, DBReader<unsigned int>::indexMemorySize(*dbr1)+1, 0);
         writer.writeIndexEntry(DBR2DATA,  offsetData,  dbr1->getTotalDataSize()+1, 0);
+        writeDictionary(writer, dbr1, DBR2DICT);
     } else {
         Debug(Debug::INFO) << "Write DBR2INDEX (" << DBR2INDEX << ")\n";
         data = DBReader<unsigned int>::serialize(*dbr2);
@@ -141,6 +371,7 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB,
         writer.writeEnd(DBR2DATA, 0);
         writer.alignToPageSize();
         free(data);
+        writeDictionary(writer, dbr2, DBR2DICT);
     }
 
     if (hdbr1 != NULL) {
@@ -159,9 +390,11 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB,
         writer.writeEnd(HDR1DATA, 0);
         writer.alignToPageSize();
         free(data);
+        writeDictionary(writer, hdbr1, HDR1DICT);
         if (hdbr2 == NULL) {
             writer.writeIndexEntry(HDR2INDEX, offsetIndex, DBReader<unsigned int>::indexMemorySize(*hdbr1)+1, 0);
             writer.writeIndexEntry(HDR2DATA,  offsetData, hdbr1->getTotalDataSize()+1, 0);
+            writeDictionary(writer, hdbr1, HDR2DICT);
         }
     }
     if (hdbr2 != NULL) {
@@ -177,87 +410,442 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB,
         writer.writeEnd(HDR2DATA, 0);
         writer.alignToPageSize();
         free(data);
+        writeDictionary(writer, hdbr2, HDR2DICT);
+    }
+}
+
+// copies the entries [from, dbr->getSize()) of dbr into a block of the index and appends them to the index of the
+// embedded database, their offsets start at blockStart. Header entries are found by the key of the sequence.
+// Returns the size of the block
+static size_t appendEntries(DBWriter &writer, unsigned int key, DBReader<unsigned int> *dbr, DBReader<unsigned int> *seqDbr,
+                          size_t from, size_t blockStart, std::vector<DBReader<unsigned int>::Index> &index) {
+    writer.writeStart(0);
+    size_t blockOffset = 0;
+    for (size_t i = from; i < seqDbr->getSize(); i++) {
+        const unsigned int dbKey = seqDbr->getDbKey(i);
+        const size_t id = (dbr == seqDbr) ? i : dbr->getId(dbKey);
+        const size_t length = dbr->getEntryLen(id);
+        writer.writeAdd(dbr->getDataUncompressed(id), length, 0);
+        DBReader<unsigned int>::Index entry;
+        entry.id = dbKey;
+        entry.offset = blockStart + blockOffset;
+        entry.length = length;
+        index.push_back(entry);
+        blockOffset += length;
+    }
+    writer.writeEnd(key, 0);
+    writer.alignToPageSize();
+    return blockOffset;
+}
+
+bool PrefilteringIndexReader::appendToIndexFile(const std::string &outDB, DBReader<unsigned int> *dbr1, DBReader<unsigned int> *hdbr1,
+                                                BaseMatrix *subMat, int maxSeqLen, bool hasSpacedKmer, const std::string &spacedKmerPattern,
+                                                bool compBiasCorrection, int alphabetSize, int kmerSize, int maskMode, int maskLowerCase,
+                                                int kmerThr, int indexCompression) {
+    DBReader<unsigned int> index(outDB.c_str(), (outDB + ".index").c_str(), 1, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    index.open(DBReader<unsigned int>::NOSORT);
+    PrefilteringIndexData meta = getMetadata(&index);
+
+    // translated and nucleotide indices embed the source database as second database, it is not appended to
+    if (index.getOffset(index.getId(DBR1DATA)) != index.getOffset(index.getId(DBR2DATA))) {
+        Debug(Debug::WARNING) << "Only an index of a database searched by itself can be appended to\n";
+        index.close();
+        return false;
+    }
+    if (dbr1->isCompressed() || dbr1->getDictionary().empty() == false) {
+        Debug(Debug::WARNING) << "Sequences of a compressed database can not be appended to an index\n";
+        index.close();
+        return false;
+    }
+
+    DBReader<unsigned int> *oldDbr = openNewReader(&index, DBR1DATA, DBR1INDEX, true, 1, false, false);
+    DBReader<unsigned int> *oldHdbr = NULL;
+    if (meta.headers1 == 1 && hdbr1 != NULL) {
+        oldHdbr = openNewReader(&index, HDR1DATA, HDR1INDEX, false, 1, false, false);
+    }
+    const size_t oldSize = oldDbr->getSize();
+    bool extends = dbr1->getSize() > oldSize;
+    // the k-mer lists of the indexed sequences are kept, their sequences must not have changed
+    size_t changed = 0;
+    if (extends) {
+#pragma omp parallel for schedule(dynamic, 1000) reduction(+:changed)
+        for (size_t id = 0; id < oldSize; id++) {
+            const size_t length = dbr1->getEntryLen(id);
+            if (dbr1->getDbKey(id) != oldDbr->getDbKey(id) || length != oldDbr->getEntryLen(id)
+                || memcmp(dbr1->getDataUncompressed(id), oldDbr->getDataUncompressed(id), length) != 0) {
+                changed++;
+            }
+        }
+    }
+    if (changed > 0) {
+        Debug(Debug::WARNING) << changed << " of the indexed sequences were changed in the database\n";
+        extends = false;
+    }
+    for (size_t id = oldSize; extends && oldHdbr != NULL && id < dbr1->getSize(); id++) {
+        extends = hdbr1->getId(dbr1->getDbKey(id)) != UINT_MAX;
     }
+    if (extends == false) {
+        Debug(Debug::WARNING) << "Database does not extend the indexed database by new entries behind the indexed ones\n";
+        if (oldHdbr != NULL) {
+            oldHdbr->close();
+            delete oldHdbr;
+        }
+        oldDbr->close();
+        delete oldDbr;
+        index.close();
+        return false;
+    }
+
+    const int split = meta.splits;
+    const unsigned int keyOffset = 1000 * split;
+    Debug(Debug::INFO) << "Append " << (dbr1->getSize() - oldSize) << " sequences as split " << (split + 1) << "\n";
+    // every split is searched in its own prefilter step
+    const int appendedSplits = getAppendedSplits(&index) + 1;
+
+    // written next to the index and moved behind its data files, the offsets continue after them
+    const std::string appendDB = outDB + ".append";
+    const size_t indexDataSize = index.getTotalDataSize();
+    DBWriter writer(appendDB.c_str(), (appendDB + ".index").c_str(), 1, Parameters::WRITER_ASCII_MODE, Parameters::DBTYPE_INDEX_DB);
+    writer.open();
+
+    // the new blocks of the embedded databases continue after the existing ones.
+    // Written first, entries that are replaced later would let the last entry of the previous data file reach into this one
+    size_t segmentOffsets[] = {0, 0};
+    std::vector<DataSegment> segments = getDataSegments(&index, DBR1DATA);
+    segmentOffsets[0] = segments.back().start + segments.back().size;
+    if (oldHdbr != NULL) {
+        segments = getDataSegments(&index, HDR1DATA);
+        segmentOffsets[1] = segments.back().start + segments.back().size;
+    }
+    Debug(Debug::INFO) << "Write SEGMENTOFFSETS (" << (keyOffset + SEGMENTOFFSETS) << ")\n";
+    writer.writeData((char *) segmentOffsets, sizeof(segmentOffsets), keyOffset + SEGMENTOFFSETS, 0);
+    writer.alignToPageSize();
+
+    Debug(Debug::INFO) << "Write VERSION (" << VERSION << ")\n";
+    writer.writeData((char *) CURRENT_VERSION, strlen(CURRENT_VERSION) * sizeof(char), VERSION, 0);
+    writer.alignToPageSize();
+
+    Debug(Debug::INFO) << "Write META (" << META << ")\n";
+    int metadata[12];
+    memcpy(metadata, index.getDataByDBKey(META, 0), sizeof(metadata));
+    metadata[11] = split + 1;
+    writer.writeData((char *) metadata, sizeof(metadata), META, 0);
+    writer.alignToPageSize();
+
+    // splits of the index were taken by amino acids of the indexed database, the appended database is split differently
+    for (int s = 0; s < split; s++) {
+        if (index.getId(1000 * s + SPLITRANGE) != UINT_MAX) {
+            continue;
+        }
+        Debug(Debug::INFO) << "Write SPLITRANGE (" << (1000 * s + SPLITRANGE) << ")\n";
+        size_t range[2];
+        oldDbr->decomposeDomainByAminoAcid(s, split, &range[0], &range[1]);
+        writer.writeData((char *) range, sizeof(range), 1000 * s + SPLITRANGE, 0);
+        writer.alignToPageSize();
+    }
+
+    Debug(Debug::INFO) << "Write DBR1DATA (" << (keyOffset + DBR1DATA) << ")\n";
+    const size_t offsetData = writer.getOffset(0);
+    DBReader<unsigned int>::Index *oldIndex = oldDbr->getIndex();
+    std::vector<DBReader<unsigned int>::Index> seqIndex(oldIndex, oldIndex + oldSize);
+    const size_t dataSize = appendEntries(writer, keyOffset + DBR1DATA, dbr1, dbr1, oldSize, segmentOffsets[0], seqIndex);
+    writer.writeIndexEntry(keyOffset + DBR2DATA, offsetData, dataSize + 1, 0);
+
+    Debug(Debug::INFO) << "Write DBR1INDEX (" << DBR1INDEX << ")\n";
+    DBReader<unsigned int> seqReader(seqIndex.data(), seqIndex.size(), dbr1->getDataSize(), dbr1->getLastKey(),
+                                     oldDbr->getDbtype(), dbr1->getMaxSeqLen(), 1);
+    char *data = DBReader<unsigned int>::serialize(seqReader);
+    const size_t offsetIndex = writer.getOffset(0);
+    writer.writeData(data, DBReader<unsigned int>::indexMemorySize(seqReader), DBR1INDEX, 0);
+    writer.alignToPageSize();
+    writer.writeIndexEntry(DBR2INDEX, offsetIndex, DBReader<unsigned int>::indexMemorySize(seqReader) + 1, 0);
+    free(data);
+
+    if (oldHdbr != NULL) {
+        Debug(Debug::INFO) << "Write HDR1DATA (" << (keyOffset + HDR1DATA) << ")\n";
+        const size_t offsetHeaderData = writer.getOffset(0);
+        DBReader<unsigned int>::Index *oldHeaderIndex = oldHdbr->getIndex();
+        std::vector<DBReader<unsigned int>::Index> headerIndex(oldHeaderIndex, oldHeaderIndex + oldHdbr->getSize());
+        const size_t headerDataSize = appendEntries(writer, keyOffset + HDR1DATA, hdbr1, dbr1, oldSize, segmentOffsets[1], headerIndex);
+        writer.writeIndexEntry(keyOffset + HDR2DATA, offsetHeaderData, headerDataSize + 1, 0);
+
+        Debug(Debug::INFO) << "Write HDR1INDEX (" << HDR1INDEX << ")\n";
+        DBReader<unsigned int> headerReader(headerIndex.data(), headerIndex.size(), hdbr1->getDataSize(), hdbr1->getLastKey(),
+                                            oldHdbr->getDbtype(), hdbr1->getMaxSeqLen(), 1);
+        data = DBReader<unsigned int>::serialize(headerReader);
+        const size_t offsetHeaderIndex = writer.getOffset(0);
+        writer.writeData(data, DBReader<unsigned int>::indexMemorySize(headerReader), HDR1INDEX, 0);
+        writer.alignToPageSize();
+        writer.writeIndexEntry(HDR2INDEX, offsetHeaderIndex, DBReader<unsigned int>::indexMemorySize(headerReader) + 1, 0);
+        free(data);
+    }
+
     Debug(Debug::INFO) << "Write GENERATOR (" << GENERATOR << ")\n";
     writer.writeData(version, strlen(version), GENERATOR, 0);
     writer.alignToPageSize();
 
-    Sequence seq(maxSeqLen, seqType, subMat, kmerSize, hasSpacedKmer, compBiasCorrection, true, spacedKmerPattern);
-    // remove x (not needed in index)
+    Sequence seq(maxSeqLen, meta.seqType, subMat, kmerSize, hasSpacedKmer, compBiasCorrection, true, spacedKmerPattern);
     const int adjustAlphabetSize =
-            (Parameters::isEqualDbtype(seqType, Parameters::DBTYPE_NUCLEOTIDES) || Parameters::isEqualDbtype(seqType, Parameters::DBTYPE_AMINO_ACIDS))
-                ? alphabetSize -1: alphabetSize;
+            (Parameters::isEqualDbtype(meta.seqType, Parameters::DBTYPE_NUCLEOTIDES) || Parameters::isEqualDbtype(meta.seqType, Parameters::DBTYPE_AMINO_ACIDS))
+            ? alphabetSize - 1 : alphabetSize;
+    writeSplit(writer, 0, split, dbr1, oldSize, dbr1->getSize() - oldSize, subMat, &seq, adjustAlphabetSize, kmerSize,
+               maskMode, maskLowerCase, kmerThr, indexCompression);
+    writer.close(false);
 
-    for (int s = 0; s < splits; s++) {
-        size_t dbFrom = 0;
-        size_t dbSize = 0;
-        dbr1->decomposeDomainByAminoAcid(s, splits, &dbFrom, &dbSize);
-        if (dbSize == 0) {
+    // entries that were written again replace the old ones, their data stays unreferenced in the old data files
+    std::vector<DBReader<unsigned int>::Index> entries;
+    DBReader<unsigned int>::Index *indexEntries = index.getIndex();
+    for (size_t i = 0; i < index.getSize(); i++) {
+        const unsigned int key = indexEntries[i].id;
+        if (key != VERSION && key != META && key != GENERATOR
+            && key != DBR1INDEX && key != DBR2INDEX && key != HDR1INDEX && key != HDR2INDEX) {
+            entries.push_back(indexEntries[i]);
+        }
+    }
+    if (oldHdbr != NULL) {
+        oldHdbr->close();
+        delete oldHdbr;
+    }
+    oldDbr->close();
+    delete oldDbr;
+    index.close();
+
+    DBReader<unsigned int> appended(appendDB.c_str(), (appendDB + ".index").c_str(), 1, DBReader<unsigned int>::USE_INDEX);
+    appended.open(DBReader<unsigned int>::NOSORT);
+    DBReader<unsigned int>::Index *appendedEntries = appended.getIndex();
+    for (size_t i = 0; i < appended.getSize(); i++) {
+        DBReader<unsigned int>::Index entry = appendedEntries[i];
+        entry.offset += indexDataSize;
+        entries.push_back(entry);
+    }
+    appended.close();
+    std::sort(entries.begin(), entries.end(), DBReader<unsigned int>::Index::compareById);
+
+    std::vector<std::string> dataFiles = FileUtil::findDatafiles(outDB.c_str());
+    if (dataFiles.size() == 1 && dataFiles[0] == outDB) {
+        FileUtil::move(outDB.c_str(), (outDB + ".0").c_str());
+    }
+    FileUtil::move(appendDB.c_str(), (outDB + "." + SSTR(dataFiles.size())).c_str());
+    FileUtil::remove((appendDB + ".index").c_str());
+    FileUtil::remove((appendDB + ".dbtype").c_str());
+    const std::string appendBinaryIndex = DBReader<unsigned int>::binaryIndexFileName(appendDB + ".index");
+    if (FileUtil::fileExists(appendBinaryIndex.c_str())) {
+        FileUtil::remove(appendBinaryIndex.c_str());
+    }
+
+    const std::string indexFile = outDB + ".index";
+    FILE *indexFh = FileUtil::openAndDelete(indexFile.c_str(), "w");
+    DBWriter::writeIndex(indexFh, entries.size(), entries.data());
+    if (fclose(indexFh) != 0) {
+        Debug(Debug::ERROR) << "Can not close index file " << indexFile << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    // like the index writers the appended index does not get a binary index
+    DBWriter::updateBinaryIndex(indexFile.c_str(), false);
+    Debug(Debug::INFO) << "Index has " << appendedSplits << " appended splits, each is searched in its own prefilter step. Merge them with --compact 1\n";
+    return true;
+}
+
+// copies the list of the k-mer into out, if it is not NULL, and returns its size
+static size_t copyDBSeqList(IndexTable *table, size_t kmer, IndexEntryLocal *out) {
+    size_t listSize;
+    if (table->isCompressed()) {
+        const unsigned char *list = table->getCompressedDBSeqList(kmer, &listSize);
+        if (out != NULL && listSize > 0) {
+            IndexTable::decodeDBSeqList(list, listSize, out);
+        }
+    } else {
+        IndexEntryLocal *list = table->getDBSeqList(kmer, &listSize);
+        if (out != NULL) {
+            memcpy(out, list, listSize * sizeof(IndexEntryLocal));
+        }
+    }
+    return listSize;
+}
+
+static bool isSplitEntry(unsigned int key) {
+    const unsigned int idx = key % 1000;
+    return idx == PrefilteringIndexReader::ENTRIES || idx == PrefilteringIndexReader::ENTRIESOFFSETS
+           || idx == PrefilteringIndexReader::ENTRIESGRIDSIZE || idx == PrefilteringIndexReader::ENTRIESBLOCKOFFSETS
+           || idx == PrefilteringIndexReader::ENTRIESNUM || idx == PrefilteringIndexReader::SEQCOUNT
+           || idx == PrefilteringIndexReader::SEQINDEXDATA || idx == PrefilteringIndexReader::SEQINDEXDATASIZE
+           || idx == PrefilteringIndexReader::SEQINDEXSEQOFFSET || idx == PrefilteringIndexReader::SPLITRANGE
+           || idx == PrefilteringIndexReader::SEGMENTOFFSETS;
+}
+
+static bool isDatabaseEntry(unsigned int key) {
+    const unsigned int idx = key % 1000;
+    return idx == PrefilteringIndexReader::DBR1INDEX || idx == PrefilteringIndexReader::DBR1DATA
+           || idx == PrefilteringIndexReader::DBR2INDEX || idx == PrefilteringIndexReader::DBR2DATA
+           || idx == PrefilteringIndexReader::HDR1INDEX || idx == PrefilteringIndexReader::HDR1DATA
+           || idx == PrefilteringIndexReader::HDR2INDEX || idx == PrefilteringIndexReader::HDR2DATA
+           || idx == PrefilteringIndexReader::DBR1DICT || idx == PrefilteringIndexReader::DBR2DICT
+           || idx == PrefilteringIndexReader::HDR1DICT || idx == PrefilteringIndexReader::HDR2DICT;
+}
+
+bool PrefilteringIndexReader::compactIndexFile(const std::string &outDB) {
+    DBReader<unsigned int> index(outDB.c_str(), (outDB + ".index").c_str(), 1, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    index.open(DBReader<unsigned int>::NOSORT);
+    PrefilteringIndexData meta = getMetadata(&index);
+    const int appendedSplits = getAppendedSplits(&index);
+    if (appendedSplits == 0) {
+        Debug(Debug::INFO) << "Index has no appended splits to merge\n";
+        index.close();
+        return true;
+    }
+
+    // splits are only appended behind the splits of createindex, they continue its last split
+    const int mergedSplit = meta.splits - appendedSplits - 1;
+    DBReader<unsigned int> *dbr = openNewReader(&index, DBR1DATA, DBR1INDEX, true, 1, false, false);
+    DBReader<unsigned int> *hdbr = NULL;
+    if (meta.headers1 == 1) {
+        hdbr = openNewHeaderReader(&index, HDR1DATA, HDR1INDEX, 1, false, false);
+    }
+    size_t dbFrom;
+    size_t dbSize;
+    getSplitRange(mergedSplit, &index, dbr, &dbFrom, &dbSize);
+    size_t dbTo = dbFrom;
+    std::vector<IndexTable *> tables;
+    std::vector<SequenceLookup *> lookups;
+    std::vector<size_t> idOffsets;
+    bool contiguous = true;
+    for (int split = mergedSplit; split < meta.splits; split++) {
+        size_t splitFrom;
+        size_t splitSize;
+        getSplitRange(split, &index, dbr, &splitFrom, &splitSize);
+        contiguous = contiguous && (splitFrom == dbTo);
+        dbTo = splitFrom + splitSize;
+        // splits without entries have no tables
+        if (index.getId(1000 * split + ENTRIESNUM) == UINT_MAX) {
             continue;
         }
+        tables.push_back(getIndexTable(split, &index, Parameters::PRELOAD_MODE_MMAP));
+        lookups.push_back(getSequenceLookup(split, &index, Parameters::PRELOAD_MODE_MMAP));
+        idOffsets.push_back(splitFrom - dbFrom);
+    }
+    if (contiguous == false || dbTo != dbr->getSize()) {
+        Debug(Debug::WARNING) << "Appended splits do not continue the last split of the index\n";
+        for (size_t i = 0; i < tables.size(); i++) {
+            delete tables[i];
+            delete lookups[i];
+        }
+        if (hdbr != NULL) {
+            hdbr->close();
+            delete hdbr;
+        }
+        dbr->close();
+        delete dbr;
+        index.close();
+        return false;
+    }
+    Debug(Debug::INFO) << "Merge " << appendedSplits << " appended splits into split " << (mergedSplit + 1) << "\n";
 
-        IndexTable indexTable(adjustAlphabetSize, kmerSize, false);
-        SequenceLookup *sequenceLookup = NULL;
-        IndexBuilder::fillDatabase(&indexTable,
-                                   (maskMode == 1 || maskLowerCase == 1) ? &sequenceLookup : NULL,
-                                   (maskMode == 0 ) ? &sequenceLookup : NULL,
-                                   *subMat, &seq, dbr1, dbFrom, dbFrom + dbSize, kmerThr, maskMode, maskLowerCase);
-        indexTable.printStatistics(subMat->num2aa);
-
-        if (sequenceLookup == NULL) {
-            Debug(Debug::ERROR) << "Invalid mask mode. No sequence lookup created!\n";
-            EXIT(EXIT_FAILURE);
+    // the lists of a k-mer are concatenated in the order of the splits, the ids of every split are shifted
+    // behind the previous ones, so the lists stay sorted by id
+    const int adjustAlphabetSize =
+            (Parameters::isEqualDbtype(meta.seqType, Parameters::DBTYPE_NUCLEOTIDES) || Parameters::isEqualDbtype(meta.seqType, Parameters::DBTYPE_AMINO_ACIDS))
+            ? meta.alphabetSize - 1 : meta.alphabetSize;
+    IndexTable indexTable(adjustAlphabetSize, meta.kmerSize, false);
+    const size_t tableSize = indexTable.getTableSize();
+    size_t *offsets = indexTable.getOffsets();
+    size_t entriesNum = 0;
+    for (size_t i = 0; i < tables.size(); i++) {
+        entriesNum += tables[i]->getTableEntriesNum();
+    }
+#pragma omp parallel for schedule(static)
+    for (size_t kmer = 0; kmer < tableSize; kmer++) {
+        for (size_t i = 0; i < tables.size(); i++) {
+            offsets[kmer] += copyDBSeqList(tables[i], kmer, NULL);
+        }
+    }
+    indexTable.init();
+    indexTable.initMemory(dbTo - dbFrom, entriesNum);
+    IndexEntryLocal *entries = indexTable.getEntries();
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (size_t kmer = 0; kmer < tableSize; kmer++) {
+        IndexEntryLocal *list = entries + offsets[kmer];
+        for (size_t i = 0; i < tables.size(); i++) {
+            const size_t listSize = copyDBSeqList(tables[i], kmer, list);
+            for (size_t j = 0; j < listSize; j++) {
+                list[j].seqId += static_cast<unsigned int>(idOffsets[i]);
+            }
+            list += listSize;
         }
+    }
 
-        // save the entries
-        unsigned int keyOffset = 1000 * s;
-        Debug(Debug::INFO) << "Write ENTRIES (" << (keyOffset + ENTRIES) << ")\n";
-        char *entries = (char *) indexTable.getEntries();
-        size_t entriesSize = indexTable.getTableEntriesNum() * indexTable.getSizeOfEntry();
-        writer.writeData(entries, entriesSize, (keyOffset + ENTRIES), s);
-        writer.alignToPageSize(s);
+    size_t dataSize = 0;
+    for (size_t i = 0; i < lookups.size(); i++) {
+        dataSize += lookups[i]->getDataSize();
+    }
+    SequenceLookup *sequenceLookup = new SequenceLookup(dbTo - dbFrom, dataSize);
+    size_t dataOffset = 0;
+    for (size_t i = 0; i < lookups.size(); i++) {
+        for (size_t id = 0; id < lookups[i]->getSequenceCount(); id++) {
+            std::pair<const unsigned char *, const unsigned int> seq = lookups[i]->getSequence(id);
+            sequenceLookup->addSequence(const_cast<unsigned char *>(seq.first), seq.second, idOffsets[i] + id, dataOffset);
+            dataOffset += seq.second;
+        }
+    }
 
-        // save the size
-        Debug(Debug::INFO) << "Write ENTRIESOFFSETS (" << (keyOffset + ENTRIESOFFSETS) << ")\n";
-        char *offsets = (char*)indexTable.getOffsets();
-        size_t offsetsSize = (indexTable.getTableSize() + 1) * sizeof(size_t);
-        writer.writeData(offsets, offsetsSize, (keyOffset + ENTRIESOFFSETS), s);
-        writer.alignToPageSize(s);
-        indexTable.deleteEntries();
-
-        Debug(Debug::INFO) << "Write SEQINDEXDATASIZE (" << (keyOffset + SEQINDEXDATASIZE) << ")\n";
-        int64_t seqindexDataSize = sequenceLookup->getDataSize();
-        char *seqindexDataSizePtr = (char *) &seqindexDataSize;
-        writer.writeData(seqindexDataSizePtr, 1 * sizeof(int64_t), (keyOffset + SEQINDEXDATASIZE), s);
-        writer.alignToPageSize(s);
-
-        size_t *sequenceOffsets = sequenceLookup->getOffsets();
-        size_t sequenceCount = sequenceLookup->getSequenceCount();
-        Debug(Debug::INFO) << "Write SEQINDEXSEQOFFSET (" << (keyOffset + SEQINDEXSEQOFFSET) << ")\n";
-        writer.writeData((char *) sequenceOffsets, (sequenceCount + 1) * sizeof(size_t), (keyOffset + SEQINDEXSEQOFFSET), s);
-        writer.alignToPageSize(s);
-
-        Debug(Debug::INFO) << "Write SEQINDEXDATA (" << (keyOffset + SEQINDEXDATA) << ")\n";
-        writer.writeData(sequenceLookup->getData(), (sequenceLookup->getDataSize() + 1) * sizeof(char), (keyOffset + SEQINDEXDATA), s);
-        writer.alignToPageSize(s);
-        delete sequenceLookup;
-
-        // ENTRIESNUM
-        Debug(Debug::INFO) << "Write ENTRIESNUM (" << (keyOffset + ENTRIESNUM) << ")\n";
-        uint64_t entriesNum = indexTable.getTableEntriesNum();
-        char *entriesNumPtr = (char *) &entriesNum;
-        writer.writeData(entriesNumPtr, 1 * sizeof(uint64_t), (keyOffset + ENTRIESNUM), s);
-        writer.alignToPageSize(s);
-
-        // SEQCOUNT
-        Debug(Debug::INFO) << "Write SEQCOUNT (" << (keyOffset + SEQCOUNT) << ")\n";
-        size_t tablesize = indexTable.getSize();
-        char *tablesizePtr = (char *) &tablesize;
-        writer.writeData(tablesizePtr, 1 * sizeof(size_t), (keyOffset + SEQCOUNT), s);
-        writer.alignToPageSize(s);
+    // the merged index is written next to the index and replaces it
+    const std::string compactDB = outDB + ".compact";
+    DBWriter writer(compactDB.c_str(), (compactDB + ".index").c_str(), 1, Parameters::WRITER_ASCII_MODE, Parameters::DBTYPE_INDEX_DB);
+    writer.open();
+
+    Debug(Debug::INFO) << "Write VERSION (" << VERSION << ")\n";
+    writer.writeData((char *) CURRENT_VERSION, strlen(CURRENT_VERSION) * sizeof(char), VERSION, 0);
+    writer.alignToPageSize();
+
+    Debug(Debug::INFO) << "Write META (" << META << ")\n";
+    int metadata[12];
+    memcpy(metadata, index.getDataByDBKey(META, 0), sizeof(metadata));
+    metadata[11] = mergedSplit + 1;
+    writer.writeData((char *) metadata, sizeof(metadata), META, 0);
+    writer.alignToPageSize();
+
+    // score matrices, spaced pattern and the splits in front of the merged one are kept as they are
+    for (size_t i = 0; i < index.getSize(); i++) {
+        const unsigned int key = index.getDbKey(i);
+        if (key == VERSION || key == META || key == GENERATOR || isDatabaseEntry(key)
+            || (isSplitEntry(key) && static_cast<int>(key / 1000) >= mergedSplit)) {
+            continue;
+        }
+        Debug(Debug::INFO) << "Copy entry (" << key << ")\n";
+        writer.writeData(index.getData(i, 0), index.getEntryLen(i) - 1, key, 0);
+        writer.alignToPageSize();
     }
 
+    // the blocks of the embedded databases are written as one
+    writeDatabases(writer, dbr, NULL, hdbr, NULL);
+
+    Debug(Debug::INFO) << "Write GENERATOR (" << GENERATOR << ")\n";
+    writer.writeData(version, strlen(version), GENERATOR, 0);
+    writer.alignToPageSize();
+
+    const unsigned int keyOffset = 1000 * mergedSplit;
+    Debug(Debug::INFO) << "Write SPLITRANGE (" << (keyOffset + SPLITRANGE) << ")\n";
+    size_t range[] = {dbFrom, dbTo - dbFrom};
+    writer.writeData((char *) range, sizeof(range), keyOffset + SPLITRANGE, 0);
+    writer.alignToPageSize();
+    writeIndexTable(writer, 0, keyOffset, indexTable, sequenceLookup, isCompressed(&index) ? 1 : 0);
     writer.close(false);
+    delete sequenceLookup;
+
+    for (size_t i = 0; i < tables.size(); i++) {
+        delete tables[i];
+        delete lookups[i];
+    }
+    if (hdbr != NULL) {
+        hdbr->close();
+        delete hdbr;
+    }
+    dbr->close();
+    delete dbr;
+    index.close();
+
+    DBReader<unsigned int>::removeDb(outDB);
+    DBReader<unsigned int>::moveDb(compactDB, outDB);
+    return true;
 }
 
 DBReader<unsigned int> *PrefilteringIndexReader::openNewHeaderReader(DBReader<unsigned int>*dbr, unsigned int dataIdx, unsigned int indexIdx, int threads,  bool touchIndex, bool touchData) {
@@ -267,21 +855,11 @@ DBReader<unsigned int> *PrefilteringIndexReader::openNewHeaderReader(DBReader<un
         dbr->touchData(indexId);
     }
 
-    size_t dataId = dbr->getId(dataIdx);
-    char *data = dbr->getData(dataId, 0);
-
-    size_t currDataOffset = dbr->getOffset(dataId);
-    size_t nextDataOffset = dbr->findNextOffsetid(dataId);
-    size_t dataSize = nextDataOffset-currDataOffset;
-
-    if (touchData) {
-        dbr->touchData(dataId);
-    }
-
     DBReader<unsigned int> *reader = DBReader<unsigned int>::unserialize(indexData, threads);
     reader->open(DBReader<unsigned int>::NOSORT);
-    reader->setData(data, dataSize);
+    setDataSegments(dbr, dataIdx, reader, touchData);
     reader->setMode(DBReader<unsigned int>::USE_DATA);
+    readDictionary(dbr, dataIdx, reader);
     return reader;
 }
 
@@ -297,17 +875,11 @@ DBReader<unsigned int> *PrefilteringIndexReader::openNewReader(DBReader<unsigned
         if (id == UINT_MAX) {
             return NULL;
         }
-        if (touchData) {
-            dbr->touchData(id);
-        }
-
         DBReader<unsigned int> *reader = DBReader<unsigned int>::unserialize(data, threads);
         reader->open(DBReader<unsigned int>::NOSORT);
-        size_t currDataOffset = dbr->getOffset(id);
-        size_t nextDataOffset = dbr->findNextOffsetid(id);
-        size_t dataSize = nextDataOffset-currDataOffset;
-        reader->setData(dbr->getDataUncompressed(id), dataSize);
+        setDataSegments(dbr, dataIdx, reader, touchData);
         reader->setMode(DBReader<unsigned int>::USE_DATA);
+        readDictionary(dbr, dataIdx, reader);
         return reader;
     }
 
@@ -383,6 +955,31 @@ IndexTable *PrefilteringIndexReader::getIndexTable(unsigned int split, DBReader<
         adjustAlphabetSize = data.alphabetSize;
     }
 
+    // only indices created with --index-compression 1 have block offsets
+    size_t blockOffsetsDataId = dbr->getId(splitOffset + ENTRIESBLOCKOFFSETS);
+    if (blockOffsetsDataId != UINT_MAX) {
+        char *blockOffsetsData = dbr->getDataUncompressed(blockOffsetsDataId);
+        if (preloadMode == Parameters::PRELOAD_MODE_FREAD) {
+            IndexTable* table = new IndexTable(adjustAlphabetSize, data.kmerSize, false);
+            table->initCompressedTableByExternalDataCopy(sequenceCount, entriesNum, (unsigned char *) entriesData,
+                                                         (uint32_t *) entriesOffsetsData, (size_t *) blockOffsetsData);
+            return table;
+        }
+
+        if (preloadMode == Parameters::PRELOAD_MODE_MMAP_TOUCH) {
+            dbr->touchData(entriesNumId);
+            dbr->touchData(sequenceCountId);
+            dbr->touchData(entriesDataId);
+            dbr->touchData(entriesOffsetsDataId);
+            dbr->touchData(blockOffsetsDataId);
+        }
+
+        IndexTable* table = new IndexTable(adjustAlphabetSize, data.kmerSize, true);
+        table->initCompressedTableByExternalData(sequenceCount, entriesNum, (unsigned char *) entriesData,
+                                                 (uint32_t *) entriesOffsetsData, (size_t *) blockOffsetsData);
+        return table;
+    }
+
     if (preloadMode == Parameters::PRELOAD_MODE_FREAD) {
         IndexTable* table = new IndexTable(adjustAlphabetSize, data.kmerSize, false);
         table->initTableByExternalDataCopy(sequenceCount, entriesNum, (IndexEntryLocal*) entriesData, (size_t *)entriesOffsetsData);
@@ -401,6 +998,28 @@ IndexTable *PrefilteringIndexReader::getIndexTable(unsigned int split, DBReader<
     return table;
 }
 
+void PrefilteringIndexReader::getSplitRange(unsigned int split, DBReader<unsigned int> *dbr, DBReader<unsigned int> *seqDbr, size_t *dbFrom, size_t *dbSize) {
+    size_t id = dbr->getId(split * 1000 + SPLITRANGE);
+    if (id == UINT_MAX) {
+        seqDbr->decomposeDomainByAminoAcid(split, getMetadata(dbr).splits, dbFrom, dbSize);
+        return;
+    }
+    size_t *range = (size_t *) dbr->getDataUncompressed(id);
+    *dbFrom = range[0];
+    *dbSize = range[1];
+}
+
+int PrefilteringIndexReader::getAppendedSplits(DBReader<unsigned int> *dbr) {
+    int appended = 0;
+    const int splits = (dbr->getId(SPLITRANGE) != UINT_MAX) ? getMetadata(dbr).splits : 1;
+    for (int split = 1; split < splits; split++) {
+        if (dbr->getId(1000 * split + SEGMENTOFFSETS) != UINT_MAX) {
+            appended++;
+        }
+    }
+    return appended;
+}
+
 void PrefilteringIndexReader::printSummary(DBReader<unsigned int> *dbr) {
     Debug(Debug::INFO) << "Index version: " << dbr->getDataByDBKey(VERSION, 0) << "\n";
 
@@ -423,6 +1042,10 @@ void PrefilteringIndexReader::printSummary(DBReader<unsigned int> *dbr) {
         pos++;
     }
     Debug(Debug::INFO) << "ScoreMatrix:  " << std::string(subMatData, pos+4) << "\n";
+    const int appendedSplits = getAppendedSplits(dbr);
+    if (appendedSplits > 0) {
+        Debug(Debug::INFO) << "Appended splits: " << appendedSplits << "\n";
+    }
 }
 
 void PrefilteringIndexReader::printMeta(int *metadata_tmp) {
@@ -462,6 +1085,10 @@ PrefilteringIndexData PrefilteringIndexReader::getMetadata(DBReader<unsigned int
     return data;
 }
 
+bool PrefilteringIndexReader::isCompressed(DBReader<unsigned int> *dbr) {
+    return dbr->getId(ENTRIESBLOCKOFFSETS) != UINT_MAX;
+}
+
 std::string PrefilteringIndexReader::getSubstitutionMatrixName(DBReader<unsigned int> *dbr) {
     unsigned int key = dbr->getDbKey(SCOREMATRIXNAME);
     if (key == UINT_MAX) {
@@ -6,6 +6,8 @@
 #include "DBReader.h"
 #include <string>
 
+class DBWriter;
+
 struct PrefilteringIndexData {
     int maxSeqLength;
     int kmerSize;
@@ -29,6 +31,7 @@ public:
     static unsigned int ENTRIES;
     static unsigned int ENTRIESOFFSETS;
     static unsigned int ENTRIESGRIDSIZE;
+    static unsigned int ENTRIESBLOCKOFFSETS;
     static unsigned int SEQINDEXDATA;
     static unsigned int SEQINDEXDATASIZE;
     static unsigned int SEQINDEXSEQOFFSET;
@@ -49,15 +52,44 @@ public:
     static unsigned int HDR2DATA;
     static unsigned int GENERATOR;
     static unsigned int SPACEDPATTERN;
+    static unsigned int DBR1DICT;
+    static unsigned int DBR2DICT;
+    static unsigned int HDR1DICT;
+    static unsigned int HDR2DICT;
+    static unsigned int SPLITRANGE;
+    static unsigned int SEGMENTOFFSETS;
 
     static bool checkIfIndexFile(DBReader<unsigned int> *reader);
+    // current version or an older version that is read the same way
+    static bool isCompatibleVersion(const char *version);
     static std::string indexName(const std::string &outDB);
 
     static void createIndexFile(const std::string &outDb,
                                 DBReader<unsigned int> *dbr1, DBReader<unsigned int> *dbr2,
                                 DBReader<unsigned int> *hdbr1, DBReader<unsigned int> *hdbr2,
                                 BaseMatrix *seedSubMat, int maxSeqLen, bool spacedKmer, const std::string &spacedKmerPattern,
-                                bool compBiasCorrection, int alphabetSize, int kmerSize, int maskMode, int maskLowerCase, int kmerThr, int splits);
+                                bool compBiasCorrection, int alphabetSize, int kmerSize, int maskMode, int maskLowerCase, int kmerThr, int splits,
+                                int indexCompression);
+
+    // Indexes the sequences that dbr1 has in addition to the indexed database as a further split of the index
+    // (delta segment). Only the new sequences are read, the existing data files of the index are kept.
+    // dbr1 has to extend the indexed database: same keys and sequences for the indexed entries, new keys behind them.
+    // Returns false if it does not, the index has to be recreated then
+    static bool appendToIndexFile(const std::string &outDb, DBReader<unsigned int> *dbr1, DBReader<unsigned int> *hdbr1,
+                                  BaseMatrix *seedSubMat, int maxSeqLen, bool spacedKmer, const std::string &spacedKmerPattern,
+                                  bool compBiasCorrection, int alphabetSize, int kmerSize, int maskMode, int maskLowerCase, int kmerThr,
+                                  int indexCompression);
+
+    // Merges the splits added by appendToIndexFile into the last split that was created by createIndexFile.
+    // The k-mer lists and sequence lookups of the splits are concatenated, no k-mers are extracted again.
+    // Returns false if the index can not be compacted, the index has to be recreated then
+    static bool compactIndexFile(const std::string &outDb);
+
+    // target database entries of a split, seqDbr is the database reader opened from the index
+    static void getSplitRange(unsigned int split, DBReader<unsigned int> *dbr, DBReader<unsigned int> *seqDbr, size_t *dbFrom, size_t *dbSize);
+
+    // number of splits that were added by appendToIndexFile
+    static int getAppendedSplits(DBReader<unsigned int> *dbr);
 
     static DBReader<unsigned int> *openNewHeaderReader(DBReader<unsigned int>*dbr, unsigned int dataIdx, unsigned int indexIdx, int threads, bool touchIndex, bool touchData);
 
@@ -71,6 +103,8 @@ public:
 
     static PrefilteringIndexData getMetadata(DBReader<unsigned int> *dbr);
 
+    static bool isCompressed(DBReader<unsigned int> *dbr);
+
     static std::string getSubstitutionMatrixName(DBReader<unsigned int> *dbr);
 
     static std::string getSubstitutionMatrix(DBReader<unsigned int> *dbr);
@@ -87,6 +121,9 @@ public:
 
 private:
     static void printMeta(int *meta);
+
+    static void writeDatabases(DBWriter &writer, DBReader<unsigned int> *dbr1, DBReader<unsigned int> *dbr2,
+                               DBReader<unsigned int> *hdbr1, DBReader<unsigned int> *hdbr2);
 };
 
 #endif
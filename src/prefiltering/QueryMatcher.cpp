@@ -7,6 +7,8 @@
 #include "SubstitutionMatrix.h"
 #include "QueryMatcher.h"
 #include "Util.h"
+#include "HugePages.h"
+#include "simd.h"
 
 #define FE_1(WHAT, X) WHAT(X)
 #define FE_2(WHAT, X, ...) WHAT(X)FE_1(WHAT, __VA_ARGS__)
@@ -48,11 +50,13 @@ QueryMatcher::QueryMatcher(IndexTable *indexTable, SequenceLookup *sequenceLooku
     // we can never find more hits than dbSize
     this->maxHitsPerQuery = std::min(maxHitsPerQuery, dbSize);
     this->resList = (hit_t *) mem_align(ALIGN_INT, maxHitsPerQuery * sizeof(hit_t) );
-    this->databaseHits = new(std::nothrow) IndexEntryLocal[maxDbMatches];
-    Util::checkAllocation(databaseHits, "Can not allocate databaseHits memory in QueryMatcher");
-    this->foundDiagonals = (CounterResult*)calloc(counterResultSize, sizeof(CounterResult));
+    // k-mer lists are hashed into the diagonal bins straight from the index table, the copy buffer is only
+    // allocated once a query has too many matches for the bins or queries are matched in batches
+    this->databaseHits = NULL;
+    this->foundDiagonals = static_cast<CounterResult *>(HugePages::allocate(counterResultSize * sizeof(CounterResult)));
     Util::checkAllocation(foundDiagonals, "Can not allocate foundDiagonals memory in QueryMatcher");
-    this->lastSequenceHit = this->databaseHits + maxDbMatches;
+    memset(foundDiagonals, 0, counterResultSize * sizeof(CounterResult));
+    this->lastSequenceHit = NULL;
     this->indexPointer = new(std::nothrow) IndexEntryLocal*[maxSeqLen + 1];
     Util::checkAllocation(indexPointer, "Can not allocate indexPointer memory in QueryMatcher");
     this->diagonalScoring = diagonalScoring;
@@ -69,15 +73,16 @@ QueryMatcher::QueryMatcher(IndexTable *indexTable, SequenceLookup *sequenceLooku
         ungappedAlignment = new UngappedAlignment(maxSeqLen, ungappedAlignmentSubMat, sequenceLookup);
     }
     compositionBias = new float[maxSeqLen];
+    batchPos = 0;
 }
 
 QueryMatcher::~QueryMatcher(){
     deleteDiagonalMatcher(activeCounter);
     free(resList);
     delete [] scoreSizes;
-    delete [] databaseHits;
+    HugePages::release(databaseHits);
     delete [] indexPointer;
-    free(foundDiagonals);
+    HugePages::release(foundDiagonals);
     delete [] compositionBias;
     if(ungappedAlignment != NULL){
         delete ungappedAlignment;
@@ -86,6 +91,20 @@ QueryMatcher::~QueryMatcher(){
     delete kmerGenerator;
 }
 
+void QueryMatcher::allocateDatabaseHits() {
+    if (databaseHits != NULL) {
+        return;
+    }
+    databaseHits = static_cast<IndexEntryLocal *>(HugePages::allocate(maxDbMatches * sizeof(IndexEntryLocal)));
+    Util::checkAllocation(databaseHits, "Can not allocate databaseHits memory in QueryMatcher");
+    lastSequenceHit = databaseHits + maxDbMatches;
+}
+
+size_t QueryMatcher::getHitBufferSize(size_t dbSize) {
+    // maxDbMatches entries
+    return std::max((size_t)1000000, dbSize) * 2 * sizeof(IndexEntryLocal);
+}
+
 size_t QueryMatcher::evaluateBins(IndexEntryLocal **hitsByIndex,
                                   CounterResult *output,
                                   size_t outputSize,
@@ -106,18 +125,22 @@ std::pair<hit_t *, size_t> QueryMatcher::matchQuery (Sequence * querySeq, unsign
 //    std::cout << "Id: " << querySeq->getId() << std::endl;
     memset(scoreSizes, 0, SCORE_RANGE * sizeof(unsigned int));
 
-    // bias correction
-    if(aaBiasCorrection == true){
-        if(Parameters::isEqualDbtype(querySeq->getSeqType(), Parameters::DBTYPE_AMINO_ACIDS)) {
-            SubstitutionMatrix::calcLocalAaBiasCorrection(kmerSubMat, querySeq->numSequence, querySeq->L, compositionBias);
-        }else{
-            memset(compositionBias, 0, sizeof(float) * querySeq->L);
-        }
+    size_t resultSize;
+    if (batchPos < batchQueries.size() && batchQueries[batchPos].seq == querySeq && batchQueries[batchPos].prepared) {
+        resultSize = matchPrepared(batchQueries[batchPos]);
+        batchPos++;
     } else {
-        memset(compositionBias, 0, sizeof(float) * querySeq->L);
+        // the single path reuses databaseHits, a prepared batch cannot be continued afterwards
+        batchQueries.clear();
+        batchPos = 0;
+        computeCompositionBias(querySeq, compositionBias);
+        if (matchDirect(querySeq, compositionBias, resultSize) == false) {
+            // the bins cannot take all matches at once, match copies them and evaluates them in parts
+            allocateDatabaseHits();
+            querySeq->resetCurrPos();
+            resultSize = match(querySeq, compositionBias);
+        }
     }
-
-    size_t resultSize = match(querySeq, compositionBias);
     std::pair<hit_t *, size_t > queryResult;
     if (diagonalScoring) {
         // write diagonal scores in count value
@@ -189,41 +212,20 @@ size_t QueryMatcher::match(Sequence *seq, float *compositionBias) {
     unsigned short indexStart = 0;
     unsigned short indexTo = 0;
     const unsigned char xIndex = kmerSubMat->aa2num[static_cast<int>('X')];
+    const bool compressedIndex = indexTable->isCompressed();
 
     while(seq->hasNextKmer()){
         const unsigned char * kmer = seq->nextKmer();
-        const unsigned char * pos = seq->getAAPosInSpacedPattern();
         const unsigned short current_i = seq->getCurrentPosition();
 
-        float biasCorrection = 0;
-        int xCount = 0;
-        for (int i = 0; i < kmerSize; i++){
-            xCount += (kmer[i] == xIndex);
-            biasCorrection += compositionBias[current_i + static_cast<short>(pos[i])];
-        }
-        if(xCount > 0){
-            indexTo = current_i;
-            indexPointer[current_i] = sequenceHits;
-            continue;
-        }
-        // round bias to next higher or lower value
-        short bias = static_cast<short>((biasCorrection < 0.0) ? biasCorrection - 0.5: biasCorrection + 0.5);
-        short kmerMatchScore = std::max(kmerThr - bias, 0);
-
-        // adjust kmer threshold based on composition bias
-        kmerGenerator->setThreshold(kmerMatchScore);
-
         const size_t * index;
         size_t exactKmer;
         size_t kmerElementSize;
-        if(takeOnlyBestKmer){
-            kmerElementSize = 1;
-            exactKmer = idx.int2index(kmer);
-            index = &exactKmer;
-        }else{
-            std::pair<size_t*, size_t> kmerList = kmerGenerator->generateKmerList(kmer);
-            kmerElementSize = kmerList.second;
-            index = kmerList.first;
+        if (similarKmers(kmer, seq->getAAPosInSpacedPattern(), current_i, compositionBias,
+                         xIndex, index, kmerElementSize, exactKmer) == false) {
+            indexTo = current_i;
+            indexPointer[current_i] = sequenceHits;
+            continue;
         }
         //std::cout << kmer << std::endl;
         indexPointer[current_i] = sequenceHits;
@@ -238,7 +240,13 @@ size_t QueryMatcher::match(Sequence *seq, float *compositionBias) {
 //                        idx.printKmer(index[kmerPos], kmerSize, m->num2aa);
 //                        std::cout << std::endl;
 
-            const IndexEntryLocal *entries = indexTable->getDBSeqList(index[kmerPos], &seqListSize);
+            const IndexEntryLocal *entries = NULL;
+            const unsigned char *compressedEntries = NULL;
+            if (compressedIndex) {
+                compressedEntries = indexTable->getCompressedDBSeqList(index[kmerPos], &seqListSize);
+            } else {
+                entries = indexTable->getDBSeqList(index[kmerPos], &seqListSize);
+            }
 
             /////DEBUG
            /* 
@@ -277,7 +285,11 @@ size_t QueryMatcher::match(Sequence *seq, float *compositionBias) {
                     goto outer;
                 }
             };
-            memcpy(sequenceHits, entries, sizeof(IndexEntryLocal) * seqListSize);
+            if (compressedIndex) {
+                IndexTable::decodeDBSeqList(compressedEntries, seqListSize, sequenceHits);
+            } else {
+                memcpy(sequenceHits, entries, sizeof(IndexEntryLocal) * seqListSize);
+            }
             sequenceHits += seqListSize;
             numMatches += seqListSize;
         }
@@ -291,6 +303,12 @@ size_t QueryMatcher::match(Sequence *seq, float *compositionBias) {
     if(overflowHitCount != 0){ // overflow occurred
         hitCount = mergeElements(foundDiagonals, overflowHitCount + hitCount);
     }
+    updateMatchStatistics(seq, hitCount, kmerListLen, overflowNumMatches + numMatches);
+    stats->copiedMatches = overflowNumMatches + numMatches;
+    return hitCount;
+}
+
+void QueryMatcher::updateMatchStatistics(Sequence *seq, size_t hitCount, size_t kmerListLen, size_t numMatches) {
     stats->doubleMatches = 0;
     if (diagonalScoring == false) {
         // remove double entries
@@ -299,8 +317,243 @@ size_t QueryMatcher::match(Sequence *seq, float *compositionBias) {
     }
     stats->kmersPerPos   = ((double)kmerListLen/(double)seq->L);
     stats->querySeqLen   = seq->L;
-    stats->dbMatches     = overflowNumMatches + numMatches;
+    stats->dbMatches     = numMatches;
+}
+
+bool QueryMatcher::matchDirect(Sequence *seq, float *compositionBias, size_t &hitCount) {
+    bool matched = false;
+#define DIRECT_CASE(x) case x: matched = matchDirect(cachedOperation##x, seq, compositionBias, hitCount); break;
+    switch (activeCounter){
+        FOR_EACH(DIRECT_CASE,2,4,8,16,32,64,128,256,512,1024,2048)
+    }
+#undef DIRECT_CASE
+    return matched;
+}
+
+template <unsigned int BINSIZE>
+bool QueryMatcher::matchDirect(CacheFriendlyOperations<BINSIZE> *operations, Sequence *seq, float *compositionBias, size_t &hitCount) {
+    const unsigned char xIndex = kmerSubMat->aa2num[static_cast<int>('X')];
+    const bool compressedIndex = indexTable->isCompressed();
+    size_t kmerListLen;
+    size_t numMatches;
+    do {
+        kmerListLen = 0;
+        numMatches = 0;
+        operations->startHashing();
+        seq->resetCurrPos();
+        while (seq->hasNextKmer()) {
+            const unsigned char *kmer = seq->nextKmer();
+            const unsigned short current_i = seq->getCurrentPosition();
+            // evaluateBins in match counts the matches of the last position but does not bin them
+            const bool lastPosition = (seq->hasNextKmer() == false);
+
+            const size_t *index;
+            size_t exactKmer;
+            size_t kmerElementSize;
+            if (similarKmers(kmer, seq->getAAPosInSpacedPattern(), current_i, compositionBias,
+                             xIndex, index, kmerElementSize, exactKmer) == false) {
+                continue;
+            }
+            kmerListLen += kmerElementSize;
+            for (size_t kmerPos = 0; kmerPos < kmerElementSize; kmerPos++) {
+                size_t seqListSize;
+                const IndexEntryLocal *entries = NULL;
+                const unsigned char *compressedEntries = NULL;
+                if (compressedIndex) {
+                    compressedEntries = indexTable->getCompressedDBSeqList(index[kmerPos], &seqListSize);
+                } else {
+                    entries = indexTable->getDBSeqList(index[kmerPos], &seqListSize);
+                }
+                // match would overflow databaseHits here, its partial evaluation has to be kept
+                if (numMatches + seqListSize >= maxDbMatches) {
+                    return false;
+                }
+                numMatches += seqListSize;
+                if (lastPosition) {
+                    continue;
+                }
+                if (compressedIndex) {
+                    if (decodedEntries.size() < seqListSize) {
+                        decodedEntries.resize(seqListSize);
+                    }
+                    IndexTable::decodeDBSeqList(compressedEntries, seqListSize, decodedEntries.data());
+                    entries = decodedEntries.data();
+                }
+                operations->hashEntries(current_i, entries, seqListSize);
+            }
+        }
+        // on a bin overflow the bins were enlarged and the lists are hashed again
+    } while (operations->findHashedDuplicates(foundDiagonals, counterResultSize, (diagonalScoring == false), hitCount) == false);
+
+    stats->diagonalOverflow = false;
+    updateMatchStatistics(seq, hitCount, kmerListLen, numMatches);
+    stats->copiedMatches = 0;
+    return true;
+}
+
+void QueryMatcher::computeCompositionBias(Sequence *querySeq, float *bias) {
+    if (aaBiasCorrection == true && Parameters::isEqualDbtype(querySeq->getSeqType(), Parameters::DBTYPE_AMINO_ACIDS)) {
+        SubstitutionMatrix::calcLocalAaBiasCorrection(kmerSubMat, querySeq->numSequence, querySeq->L, bias);
+    } else {
+        memset(bias, 0, sizeof(float) * querySeq->L);
+    }
+}
+
+bool QueryMatcher::similarKmers(const unsigned char *kmer, const unsigned char *pos, unsigned short current_i,
+                                const float *compositionBias, unsigned char xIndex,
+                                const size_t *&index, size_t &kmerElementSize, size_t &exactKmer) {
+    float biasCorrection = 0;
+    int xCount = 0;
+    for (int i = 0; i < kmerSize; i++){
+        xCount += (kmer[i] == xIndex);
+        biasCorrection += compositionBias[current_i + static_cast<short>(pos[i])];
+    }
+    if(xCount > 0){
+        return false;
+    }
+    // round bias to next higher or lower value
+    short bias = static_cast<short>((biasCorrection < 0.0) ? biasCorrection - 0.5: biasCorrection + 0.5);
+    short kmerMatchScore = std::max(kmerThr - bias, 0);
+
+    // adjust kmer threshold based on composition bias
+    kmerGenerator->setThreshold(kmerMatchScore);
+
+    if(takeOnlyBestKmer){
+        kmerElementSize = 1;
+        exactKmer = idx.int2index(kmer);
+        index = &exactKmer;
+    }else{
+        std::pair<size_t*, size_t> kmerList = kmerGenerator->generateKmerList(kmer);
+        kmerElementSize = kmerList.second;
+        index = kmerList.first;
+    }
+    return true;
+}
+
+size_t QueryMatcher::prepareBatch(Sequence **querySeqs, size_t count) {
+    allocateDatabaseHits();
+    batchQueries.clear();
+    batchPos = 0;
+    kmerRequests.clear();
+    positionOffsets.clear();
+    batchCompositionBias.clear();
+
+    const unsigned char xIndex = kmerSubMat->aa2num[static_cast<int>('X')];
+    const bool compressedIndex = indexTable->isCompressed();
+    size_t hitOffset = 0;
+    for (size_t q = 0; q < count; q++) {
+        Sequence *seq = querySeqs[q];
+        BatchQuery query;
+        query.seq = seq;
+        query.prepared = true;
+        query.positionStart = positionOffsets.size();
+        query.biasStart = batchCompositionBias.size();
+        query.kmerListLen = 0;
+        const size_t requestStart = kmerRequests.size();
+
+        batchCompositionBias.resize(query.biasStart + seq->L);
+        float *bias = &batchCompositionBias[query.biasStart];
+        computeCompositionBias(seq, bias);
+
+        // the layout of the hits is the same as in match, so that the bins are evaluated in the same order
+        size_t numMatches = 0;
+        unsigned short indexTo = 0;
+        seq->resetCurrPos();
+        while (seq->hasNextKmer()) {
+            const unsigned char *kmer = seq->nextKmer();
+            const unsigned short current_i = seq->getCurrentPosition();
+            positionOffsets.push_back(hitOffset + numMatches);
+            indexTo = current_i;
 
+            const size_t *index;
+            size_t exactKmer;
+            size_t kmerElementSize;
+            if (similarKmers(kmer, seq->getAAPosInSpacedPattern(), current_i, bias,
+                             xIndex, index, kmerElementSize, exactKmer) == false) {
+                continue;
+            }
+            query.kmerListLen += kmerElementSize;
+            for (size_t kmerPos = 0; kmerPos < kmerElementSize; kmerPos++) {
+                size_t seqListSize;
+                if (compressedIndex) {
+                    indexTable->getCompressedDBSeqList(index[kmerPos], &seqListSize);
+                } else {
+                    indexTable->getDBSeqList(index[kmerPos], &seqListSize);
+                }
+                KmerRequest request;
+                request.kmer = index[kmerPos];
+                request.offset = hitOffset + numMatches;
+                kmerRequests.push_back(request);
+                numMatches += seqListSize;
+            }
+        }
+        // end of the last position, position 0 has no hits if the query has no k-mer
+        if (positionOffsets.size() == query.positionStart) {
+            positionOffsets.push_back(hitOffset);
+        }
+        positionOffsets.push_back(hitOffset + numMatches);
+
+        // match would overflow for this query, it has to be evaluated in parts by match alone
+        if (hitOffset + numMatches >= maxDbMatches) {
+            kmerRequests.resize(requestStart);
+            positionOffsets.resize(query.positionStart);
+            batchCompositionBias.resize(query.biasStart);
+            if (q > 0) {
+                break;
+            }
+            query.prepared = false;
+            batchQueries.push_back(query);
+            return 1;
+        }
+        query.indexTo = indexTo;
+        query.numMatches = numMatches;
+        batchQueries.push_back(query);
+        hitOffset += numMatches;
+    }
+
+    // every posting list is read once and copied to all queries of the batch that contain its k-mer
+    std::sort(kmerRequests.begin(), kmerRequests.end(), KmerRequest::compareByKmer);
+    for (size_t i = 0; i < kmerRequests.size();) {
+        const size_t kmer = kmerRequests[i].kmer;
+        size_t next = i + 1;
+        while (next < kmerRequests.size() && kmerRequests[next].kmer == kmer) {
+            next++;
+        }
+        size_t seqListSize;
+        const IndexEntryLocal *entries;
+        if (compressedIndex) {
+            const unsigned char *compressedEntries = indexTable->getCompressedDBSeqList(kmer, &seqListSize);
+            // decoded once into the first query, the other queries copy from it
+            if (seqListSize > 0) {
+                IndexTable::decodeDBSeqList(compressedEntries, seqListSize, databaseHits + kmerRequests[i].offset);
+            }
+            entries = databaseHits + kmerRequests[i].offset;
+            i++;
+        } else {
+            entries = indexTable->getDBSeqList(kmer, &seqListSize);
+        }
+        if (next + PREFETCH_DISTANCE < kmerRequests.size() && compressedIndex == false) {
+            size_t prefetchSize;
+            __builtin_prefetch(indexTable->getDBSeqList(kmerRequests[next + PREFETCH_DISTANCE].kmer, &prefetchSize));
+        }
+        for (; i < next; i++) {
+            memcpy(databaseHits + kmerRequests[i].offset, entries, sizeof(IndexEntryLocal) * seqListSize);
+        }
+    }
+    return batchQueries.size();
+}
+
+size_t QueryMatcher::matchPrepared(const BatchQuery &query) {
+    Sequence *seq = query.seq;
+    memcpy(compositionBias, &batchCompositionBias[query.biasStart], sizeof(float) * seq->L);
+    const size_t *offsets = &positionOffsets[query.positionStart];
+    for (size_t i = 0; i <= static_cast<size_t>(query.indexTo) + 1; i++) {
+        indexPointer[i] = databaseHits + offsets[i];
+    }
+    stats->diagonalOverflow = false;
+    size_t hitCount = evaluateBins(indexPointer, foundDiagonals, counterResultSize, 0, query.indexTo, (diagonalScoring == false));
+    updateMatchStatistics(seq, hitCount, query.kmerListLen, query.numMatches);
+    stats->copiedMatches = query.numMatches;
     return hitCount;
 }
 
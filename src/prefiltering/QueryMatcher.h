@@ -11,6 +11,7 @@
 #include "CacheFriendlyOperations.h"
 #include "UngappedAlignment.h"
 #include "KmerGenerator.h"
+#include "BinaryResults.h"
 
 
 struct statistics_t{
@@ -21,7 +22,9 @@ struct statistics_t{
     size_t diagonalOverflow;
     size_t resultsPassedPrefPerSeq;
     size_t truncated;
-    statistics_t() : kmersPerPos(0.0) , dbMatches(0) , doubleMatches(0), querySeqLen(0), diagonalOverflow(0), resultsPassedPrefPerSeq(0), truncated(0) {};
+    // DB matches copied to the hit buffer before they were binned
+    size_t copiedMatches;
+    statistics_t() : kmersPerPos(0.0) , dbMatches(0) , doubleMatches(0), querySeqLen(0), diagonalOverflow(0), resultsPassedPrefPerSeq(0), truncated(0), copiedMatches(0) {};
     statistics_t(double kmersPerPos, size_t dbMatches,
                  size_t doubleMatches, size_t querySeqLen, size_t diagonalOverflow, size_t resultsPassedPrefPerSeq, size_t truncated) : kmersPerPos(kmersPerPos),
                                                                                                                       dbMatches(dbMatches),
@@ -29,25 +32,8 @@ struct statistics_t{
                                                                                                                       querySeqLen(querySeqLen),
                                                                                                                       diagonalOverflow(diagonalOverflow),
                                                                                                                       resultsPassedPrefPerSeq(resultsPassedPrefPerSeq),
-                                                                                                                      truncated(truncated){};
-};
-
-struct hit_t {
-    unsigned int seqId;
-    int prefScore;
-    unsigned short diagonal;
-
-    static bool compareHitsByScoreAndId(hit_t first, hit_t second){
-        if(first.prefScore > second.prefScore )
-            return true;
-        if(second.prefScore > first.prefScore )
-            return false;
-        if(first.seqId < second.seqId )
-            return true;
-        if(second.seqId < first.seqId )
-            return false;
-        return false;
-    }
+                                                                                                                      truncated(truncated),
+                                                                                                                      copiedMatches(0){};
 };
 
 class QueryMatcher {
@@ -63,6 +49,20 @@ public:
     // identityId is the id of the identitical sequence in the target database if there is any, UINT_MAX otherwise
     std::pair<hit_t *, size_t>  matchQuery(Sequence * querySeq, unsigned int identityId);
 
+    // matches the k-mers of a batch of queries against the IndexTable in one pass. The similar k-mers of all
+    // queries are sorted by k-mer, so that each posting list is read once and copied to every query that needs it.
+    // Returns the number of queries from the front of querySeqs in the batch, matchQuery has to be called for
+    // them in this order. A query that overflows databaseHits on its own is left to matchQuery as a batch of one
+    size_t prepareBatch(Sequence **querySeqs, size_t count);
+
+    // true once the hit copy buffer was needed
+    bool hasHitBuffer() {
+        return databaseHits != NULL;
+    }
+
+    // bytes of the hit copy buffer of a matcher for a target database of dbSize sequences
+    static size_t getHitBufferSize(size_t dbSize);
+
     // find duplicates in the diagonal bins
     size_t evaluateBins(IndexEntryLocal **hitsByIndex, CounterResult *output,
                         size_t outputSize, unsigned short indexFrom, unsigned short indexTo, bool computeTotalScore);
@@ -79,6 +79,15 @@ public:
         this->kmerGenerator->setDivideStrategy(three, two );
     }
 
+    // cache of similar k-mer lists of the KmerGenerator, call after the substitution matrix is set
+    void setKmerCacheSize(size_t maxBytes) {
+        this->kmerGenerator->setCacheSize(maxBytes);
+    }
+
+    const KmerGenerator *getKmerGenerator() {
+        return kmerGenerator;
+    }
+
     // get statistics
     const statistics_t * getStatistics(){
         return stats;
@@ -124,17 +133,22 @@ public:
 
     static size_t prefilterHitToBuffer(char *buff1, hit_t &h)
     {
-        char * basePos = buff1;
-        char * tmpBuff = Itoa::u32toa_sse2((uint32_t) h.seqId, buff1);
-        *(tmpBuff-1) = '\t';
-        int score = static_cast<int>(h.prefScore);
-        tmpBuff = Itoa::i32toa_sse2(score, tmpBuff);
-        *(tmpBuff-1) = '\t';
-        int32_t diagonal = static_cast<short>(h.diagonal);
-        tmpBuff = Itoa::i32toa_sse2(diagonal, tmpBuff);
-        *(tmpBuff-1) = '\n';
-        *(tmpBuff) = '\0';
-        return tmpBuff - basePos;
+        return BinaryResults::hitToBuffer(buff1, h);
+    }
+
+    // see BinaryResults.h for the layout of binary prefilter entries
+    // hit_t has trailing padding, the fields are copied into a zeroed record so that no indeterminate bytes reach the disk
+    static void prefilterHitsToBinary(std::string &out, const hit_t *hits, size_t count) {
+        const unsigned int cnt = static_cast<unsigned int>(count);
+        out.append(reinterpret_cast<const char *>(&cnt), sizeof(unsigned int));
+        char record[sizeof(hit_t)];
+        for (size_t i = 0; i < count; i++) {
+            memset(record, 0, sizeof(hit_t));
+            memcpy(record + offsetof(hit_t, seqId), &hits[i].seqId, sizeof(hits[i].seqId));
+            memcpy(record + offsetof(hit_t, prefScore), &hits[i].prefScore, sizeof(hits[i].prefScore));
+            memcpy(record + offsetof(hit_t, diagonal), &hits[i].diagonal, sizeof(hits[i].diagonal));
+            out.append(record, sizeof(hit_t));
+        }
     }
 
 protected:
@@ -207,6 +221,65 @@ protected:
     // match sequence against the IndexTable
     size_t match(Sequence *seq, float *pDouble);
 
+    // match without copying the k-mer lists, they are hashed into the diagonal bins directly.
+    // false if the query has too many matches for it, match has to evaluate them in parts
+    bool matchDirect(Sequence *seq, float *compositionBias, size_t &hitCount);
+
+    void allocateDatabaseHits();
+
+    void updateMatchStatistics(Sequence *seq, size_t hitCount, size_t kmerListLen, size_t numMatches);
+
+    // matchDirect with the active CacheFriendlyOperations, the hashing is inlined into the k-mer loop
+    template <unsigned int BINSIZE>
+    bool matchDirect(CacheFriendlyOperations<BINSIZE> *operations, Sequence *seq, float *compositionBias, size_t &hitCount);
+
+    // a compressed k-mer list is decoded here before it is hashed
+    std::vector<IndexEntryLocal> decodedEntries;
+
+    // a query of the current batch, its hits are at positionOffsets in databaseHits
+    struct BatchQuery {
+        Sequence *seq;
+        bool prepared;
+        size_t positionStart;
+        size_t biasStart;
+        unsigned short indexTo;
+        size_t kmerListLen;
+        size_t numMatches;
+    };
+
+    // posting list of kmer is copied to offset in databaseHits
+    struct KmerRequest {
+        size_t kmer;
+        size_t offset;
+
+        static bool compareByKmer(const KmerRequest &first, const KmerRequest &second) {
+            if (first.kmer != second.kmer) {
+                return first.kmer < second.kmer;
+            }
+            return first.offset < second.offset;
+        }
+    };
+
+    // posting lists the batch fill prefetches ahead
+    static const size_t PREFETCH_DISTANCE = 8;
+
+    std::vector<BatchQuery> batchQueries;
+    size_t batchPos;
+    std::vector<KmerRequest> kmerRequests;
+    // hit offset of every position of the batch queries and the end of their last position
+    std::vector<size_t> positionOffsets;
+    std::vector<float> batchCompositionBias;
+
+    // evaluates the hits that prepareBatch copied for the query
+    size_t matchPrepared(const BatchQuery &query);
+
+    void computeCompositionBias(Sequence *querySeq, float *bias);
+
+    // similar k-mers of the k-mer at position current_i, false if the k-mer contains an X
+    bool similarKmers(const unsigned char *kmer, const unsigned char *pos, unsigned short current_i,
+                      const float *compositionBias, unsigned char xIndex,
+                      const size_t *&index, size_t &kmerElementSize, size_t &exactKmer);
+
     // extract result from databaseHits
     template <int TYPE>
     std::pair<hit_t *, size_t> getResult(CounterResult * results,
@@ -176,7 +176,7 @@ int ungappedprefilter(int argc, const char **argv, const Command &command) {
 
     qdbr.decomposeDomainByAminoAcid(MMseqsMPI::rank, MMseqsMPI::numProc, &dbFrom, &dbSize);
     std::pair<std::string, std::string> tmpOutput = Util::createTmpFileNames(par.db3, par.db3Index, MMseqsMPI::rank);
-    DBWriter resultWriter(tmpOutput.first.c_str(), tmpOutput.second.c_str(), par.threads,  par.compressed, Parameters::DBTYPE_PREFILTER_RES);
+    DBWriter resultWriter(tmpOutput.first.c_str(), tmpOutput.second.c_str(), par.threads,  par.writerMode(par.compressed), Parameters::DBTYPE_PREFILTER_RES);
     resultWriter.open();
     int status = doRescorealldiagonal(par, qdbr, resultWriter, dbFrom, dbSize);
     resultWriter.close();
@@ -188,10 +188,10 @@ int ungappedprefilter(int argc, const char **argv, const Command &command) {
             std::pair<std::string, std::string> tmpFile = Util::createTmpFileNames(par.db3, par.db3Index, proc);
             splitFiles.push_back(std::make_pair(tmpFile.first,  tmpFile.second));
         }
-        DBWriter::mergeResults(par.db3, par.db3Index, splitFiles);
+        DBWriter::mergeResults(par.db3, par.db3Index, splitFiles, par.binaryIndex);
     }
 #else
-    DBWriter resultWriter(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_PREFILTER_RES);
+    DBWriter resultWriter(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_PREFILTER_RES);
     resultWriter.open();
     int status = doRescorealldiagonal(par, qdbr, resultWriter, 0, qdbr.getSize());
     resultWriter.close();
@@ -89,7 +89,7 @@ int aggregatetax(int argc, const char **argv, const Command& command) {
     DBReader<unsigned int> taxSeqReader(par.db3.c_str(), par.db3Index.c_str(), par.threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
     taxSeqReader.open(DBReader<unsigned int>::NOSORT);
 
-    DBWriter writer(par.db4.c_str(), par.db4Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_TAXONOMICAL_RESULT);
+    DBWriter writer(par.db4.c_str(), par.db4Index.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_TAXONOMICAL_RESULT);
     writer.open();
 
     std::vector<std::string> ranks = NcbiTaxonomy::parseRanks(par.lcaRanks);
@@ -19,7 +19,7 @@ int filtertaxdb(int argc, const char **argv, const Command& command) {
     DBReader<unsigned int> reader(par.db2.c_str(), par.db2Index.c_str(), par.threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
     reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.compressed, reader.getDbtype());
+    DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.writerMode(par.compressed), reader.getDbtype());
     writer.open();
 
     // a few NCBI taxa are blacklisted by default, they contain unclassified sequences (e.g. metagenomes) or other sequences (e.g. plasmids)
@@ -42,8 +42,8 @@ int filtertaxdb(int argc, const char **argv, const Command& command) {
             progress.updateProgress();
 
             unsigned int key = reader.getDbKey(i);
-            char *data = reader.getData(i, thread_idx);
-            size_t length = reader.getEntryLen(i);
+            size_t length;
+            char *data = reader.getData(i, thread_idx, &length);
 
             if (length == 1) {
                 continue;
@@ -32,7 +32,7 @@ int lca(int argc, const char **argv, const Command& command) {
     DBReader<unsigned int> reader(par.db2.c_str(), par.db2Index.c_str(), par.threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
     reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_TAXONOMICAL_RESULT);
+    DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_TAXONOMICAL_RESULT);
     writer.open();
 
     std::vector<std::string> ranks = NcbiTaxonomy::parseRanks(par.lcaRanks);
@@ -77,8 +77,8 @@ int lca(int argc, const char **argv, const Command& command) {
             progress.updateProgress();
 
             unsigned int key = reader.getDbKey(i);
-            char *data = reader.getData(i, thread_idx);
-            size_t length = reader.getEntryLen(i);
+            size_t length;
+            char *data = reader.getData(i, thread_idx, &length);
 
             std::vector<int> taxa;
             while (*data != '\0') {
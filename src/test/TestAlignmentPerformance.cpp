@@ -22,6 +22,8 @@
 #include "ExtendedSubstitutionMatrix.h"
 #include "SubstitutionMatrix.h"
 #include "StripedSmithWaterman.h"
+#include "SimdDispatch.h"
+#include "Timer.h"
 
 const char* binary_name = "test_alignmentperformance";
 
@@ -51,7 +53,7 @@ std::vector<std::string> readData(std::string fasta_filename){
     fclose(fasta_file);
     return retVec;
 }
-int main (int, const char**) {
+int main (int argc, const char** argv) {
     const size_t kmer_size=6;
 
     Parameters& par = Parameters::getInstance();
@@ -68,7 +70,6 @@ int main (int, const char**) {
     Sequence* query = new Sequence(10000, 0, &subMat, kmer_size, true, false);
     Sequence* dbSeq = new Sequence(10000, 0, &subMat, kmer_size, true, false);
     //dbSeq->mapSequence(1,"lala2",ref_seq);
-    SmithWaterman aligner(15000, subMat.alphabetSize, false);
     int8_t * tinySubMat = new int8_t[subMat.alphabetSize*subMat.alphabetSize];
     for (int i = 0; i < subMat.alphabetSize; i++) {
         for (int j = 0; j < subMat.alphabetSize; j++) {
@@ -83,24 +84,72 @@ int main (int, const char**) {
     int gap_extend = 1;
     int mode = 0;
     size_t cells = 0;
-    std::vector<std::string> sequences = readData("/Users/mad/Documents/databases/rfam/Rfam.fasta");
-    for(size_t seq_i = 0; seq_i < sequences.size(); seq_i++){
-        query->mapSequence(1,1,sequences[seq_i].c_str(), sequences[seq_i].size());
-        aligner.ssw_init(query, tinySubMat, &subMat, subMat.alphabetSize, 2);
+    std::vector<std::string> sequences = readData(argc > 1 ? argv[1] : "/Users/mad/Documents/databases/rfam/Rfam.fasta");
+    EvalueComputation evalueComputation(100000, &subMat, gap_open, gap_extend);
+    // throughput of each instruction set that is available, sse2_byte switches to sse2_word for scores >= 255
+    // and of the inter-sequence engine
+    for (int level = SimdDispatch::LEVEL_SSE41; level <= SimdDispatch::LEVEL_AVX512BW; level++) {
+        if (SimdDispatch::isAvailable(level) == false) {
+            continue;
+        }
+        SimdDispatch::setLevel(level);
+        SmithWaterman aligner(15000, subMat.alphabetSize, false);
+        cells = 0;
+        size_t scoreSum = 0;
+        Timer timer;
+        for(size_t seq_i = 0; seq_i < sequences.size(); seq_i++){
+            query->mapSequence(1,1,sequences[seq_i].c_str(), sequences[seq_i].size());
+            aligner.ssw_init(query, tinySubMat, &subMat, subMat.alphabetSize, 2);
 
-        for(size_t seq_j = 0; seq_j < sequences.size(); seq_j++) {
-            dbSeq->mapSequence(2, 2, sequences[seq_j].c_str(),  sequences[seq_j].size());
-            int32_t maskLen = query->L / 2;
-            EvalueComputation evalueComputation(100000, &subMat, gap_open, gap_extend);
-            s_align alignment = aligner.ssw_align(dbSeq->numSequence, dbSeq->L, gap_open, gap_extend, 0, 10000, &evalueComputation, 0, 0.0, maskLen);
-            if(mode == 0 ){
+            for(size_t seq_j = 0; seq_j < sequences.size(); seq_j++) {
+                dbSeq->mapSequence(2, 2, sequences[seq_j].c_str(),  sequences[seq_j].size());
+                int32_t maskLen = query->L / 2;
+                s_align alignment = aligner.ssw_align(dbSeq->numSequence, dbSeq->L, gap_open, gap_extend, mode, 10000, &evalueComputation, 0, 0.0, maskLen);
                 cells += query->L * dbSeq->L;
-                std::cout << alignment.qEndPos1 << " " << alignment.dbEndPos1 << "\n";
-            } else {
-                std::cout << alignment.qStartPos1 << " " << alignment.qEndPos1 << " "
-                        << alignment.dbStartPos1 << " " << alignment.dbEndPos1 << "\n";
+                scoreSum += alignment.score1;
+                delete [] alignment.cigar;
+            }
+        }
+        double seconds = timer.getTimediff();
+        std::cout << SimdDispatch::getLevelName(level) << ": " << seconds << "s "
+                  << (cells / seconds / 1e9) << " GCUPS (score sum " << scoreSum << ")" << std::endl;
+
+        // inter-sequence engine, targets whose score does not fit into 8 bits are recomputed by ssw_align
+        std::vector<Sequence *> batchTargets;
+        std::vector<const unsigned char *> batchSequences;
+        std::vector<int32_t> batchLengths;
+        for(size_t seq_j = 0; seq_j < sequences.size(); seq_j++) {
+            Sequence *target = new Sequence(10000, 0, &subMat, kmer_size, true, false);
+            target->mapSequence(2, 2, sequences[seq_j].c_str(), sequences[seq_j].size());
+            batchTargets.push_back(target);
+            batchSequences.push_back(target->numSequence);
+            batchLengths.push_back(target->L);
+        }
+        cells = 0;
+        scoreSum = 0;
+        timer.reset();
+        for(size_t seq_i = 0; seq_i < sequences.size(); seq_i++){
+            query->mapSequence(1,1,sequences[seq_i].c_str(), sequences[seq_i].size());
+            aligner.ssw_init(query, tinySubMat, &subMat, subMat.alphabetSize, 2);
+            std::vector<s_align> results(sequences.size());
+            aligner.ssw_align_batch(batchSequences.data(), batchLengths.data(), sequences.size(), gap_open, gap_extend, results.data());
+            for(size_t seq_j = 0; seq_j < sequences.size(); seq_j++) {
+                uint32_t score = results[seq_j].score1;
+                if (score == 255) {
+                    s_align alignment = aligner.ssw_align(batchSequences[seq_j], batchLengths[seq_j], gap_open, gap_extend, mode, 10000, &evalueComputation, 0, 0.0, query->L / 2);
+                    score = alignment.score1;
+                    delete [] alignment.cigar;
+                }
+                cells += query->L * batchLengths[seq_j];
+                scoreSum += score;
             }
         }
+        seconds = timer.getTimediff();
+        std::cout << SimdDispatch::getLevelName(level) << " inter-sequence: " << seconds << "s "
+                  << (cells / seconds / 1e9) << " GCUPS (score sum " << scoreSum << ")" << std::endl;
+        for (size_t k = 0; k < batchTargets.size(); k++) {
+            delete batchTargets[k];
+        }
     }
     std::cerr << "Cells : " << cells << std::endl;
     delete [] tinySubMat;
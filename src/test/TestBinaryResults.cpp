@@ -0,0 +1,59 @@
+//
+// Writes the same prefilter hits twice from buffers with different garbage in the padding of hit_t.
+// Both binary entries have to be byte identical and read back to the same hits.
+//
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "QueryMatcher.h"
+
+const char* binary_name = "test_binaryresults";
+
+static void fillHits(hit_t *hits, size_t count, unsigned char garbage) {
+    memset(hits, garbage, count * sizeof(hit_t));
+    for (size_t i = 0; i < count; i++) {
+        hits[i].seqId = static_cast<unsigned int>(i * 7);
+        hits[i].prefScore = static_cast<int>(i) - 50;
+        hits[i].diagonal = static_cast<unsigned short>(i * 3);
+    }
+}
+
+int main (int, const char**) {
+    const size_t count = 100;
+    hit_t *first = static_cast<hit_t *>(malloc(count * sizeof(hit_t)));
+    hit_t *second = static_cast<hit_t *>(malloc(count * sizeof(hit_t)));
+    fillHits(first, count, 0xAA);
+    fillHits(second, count, 0x55);
+
+    std::string firstEntry;
+    std::string secondEntry;
+    QueryMatcher::prefilterHitsToBinary(firstEntry, first, count);
+    QueryMatcher::prefilterHitsToBinary(secondEntry, second, count);
+
+    if (firstEntry.size() != sizeof(unsigned int) + count * sizeof(hit_t)) {
+        std::cout << "Binary entry has " << firstEntry.size() << " bytes\n";
+        return EXIT_FAILURE;
+    }
+    if (firstEntry != secondEntry) {
+        std::cout << "Binary entries of the same hits differ\n";
+        return EXIT_FAILURE;
+    }
+    if (BinaryResults::getCount(firstEntry.c_str()) != count) {
+        std::cout << "Binary entry has a wrong count\n";
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < count; i++) {
+        hit_t hit = BinaryResults::getHit(firstEntry.c_str(), i);
+        if (hit.seqId != first[i].seqId || hit.prefScore != first[i].prefScore || hit.diagonal != first[i].diagonal) {
+            std::cout << "Hit " << i << " differs after reading it back\n";
+            return EXIT_FAILURE;
+        }
+    }
+    free(first);
+    free(second);
+    std::cout << "Binary entries of the same hits are identical\n";
+    return EXIT_SUCCESS;
+}
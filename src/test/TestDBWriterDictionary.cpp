@@ -0,0 +1,93 @@
+//
+// Writes a compressed database with WRITER_TRAIN_DICTIONARY_MODE from two threads and checks that reading it
+// back through the .zdict returns every entry byte for byte. The small database is trained on all entries
+// on close, the large one once the sample is complete while the threads are still writing.
+//
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "FileUtil.h"
+#include "Parameters.h"
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+const char* binary_name = "test_dbwriterdictionary";
+
+static int testDictionary(const std::vector<std::string> &entries) {
+    const std::string name = "test_dbwriterdictionary";
+    const std::string index = name + ".index";
+    const unsigned int threads = 2;
+    DBWriter writer(name.c_str(), index.c_str(), threads, Parameters::WRITER_COMPRESSED_MODE | Parameters::WRITER_TRAIN_DICTIONARY_MODE, Parameters::DBTYPE_GENERIC_DB);
+    writer.open();
+#pragma omp parallel num_threads(threads)
+    {
+        unsigned int thread_idx = 0;
+#ifdef OPENMP
+        thread_idx = static_cast<unsigned int>(omp_get_thread_num());
+#endif
+#pragma omp for schedule(dynamic, 100)
+        for (size_t key = 0; key < entries.size(); key++) {
+            writer.writeData(entries[key].c_str(), entries[key].size(), static_cast<unsigned int>(key), thread_idx);
+        }
+    }
+    writer.close(true);
+    const bool hasDictionary = FileUtil::fileExists(DBReader<unsigned int>::dictionaryFileName(name).c_str());
+
+    size_t mismatches = 0;
+    DBReader<unsigned int> reader(name.c_str(), index.c_str(), 1, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    reader.open(DBReader<unsigned int>::NOSORT);
+    const bool isCompressed = reader.isCompressed();
+    const size_t size = reader.getSize();
+    for (size_t id = 0; id < size; id++) {
+        const unsigned int key = reader.getDbKey(id);
+        const char *data = reader.getData(id, 0);
+        if (key >= entries.size() || entries[key].size() != strlen(data) || memcmp(entries[key].c_str(), data, entries[key].size()) != 0) {
+            mismatches++;
+        }
+    }
+    reader.close();
+    DBReader<unsigned int>::removeDb(name);
+
+    if (hasDictionary == false || isCompressed == false) {
+        std::cout << "Database of " << entries.size() << " entries was not compressed with a dictionary\n";
+        return EXIT_FAILURE;
+    }
+    if (size != entries.size() || mismatches != 0) {
+        std::cout << mismatches << " of " << entries.size() << " entries differ after the compression\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "All " << entries.size() << " entries are identical after the compression with a dictionary\n";
+    return EXIT_SUCCESS;
+}
+
+int main (int, const char**) {
+    // random entries of few distinct words, so that the dictionary has something to learn
+    const char *words[] = {"MKVLAAGIVG", "LLLASWWHPC", "YFEMNQRSTD", "\t1.000\t", "GGSGGSGGS", "PEPTIDE", "\n"};
+    const size_t wordCount = sizeof(words) / sizeof(words[0]);
+    srand(1);
+    std::vector<std::string> entries;
+    // the large database exceeds the dictionary sample of about 11 MB
+    for (size_t i = 0; i < 60000; i++) {
+        std::string entry;
+        const int length = 10 + rand() % 40;
+        for (int j = 0; j < length; j++) {
+            entry.append(words[rand() % wordCount]);
+        }
+        entry.push_back('\n');
+        entries.push_back(entry);
+    }
+
+    int status = testDictionary(std::vector<std::string>(entries.begin(), entries.begin() + 5000));
+    if (status == EXIT_SUCCESS) {
+        status = testDictionary(entries);
+    }
+    return status;
+}
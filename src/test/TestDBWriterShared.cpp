@@ -0,0 +1,158 @@
+//
+// Writes the same entries from several threads once with the default writer, which merges one data file
+// per thread, and once into the shared data file of WRITER_SHARED_MODE. Small extents are flushed many
+// times during the run and each thread spills its index entries in many sorted runs. Both databases have
+// to contain the same entries under the same keys, and the merged index of the shared mode has to be
+// sorted by key and cover the data file without gaps. The WRITER_KEY_ORDER_MODE writer has to merge the
+// thread data files into one data file in key order.
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "FileUtil.h"
+#include "Parameters.h"
+#include "TestHelper.h"
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+const char* binary_name = "test_dbwritershared";
+
+static void writeDatabase(const std::string &name, const std::vector<std::string> &entries, unsigned int threads, size_t mode, bool merge = false) {
+    DBWriter writer(name.c_str(), (name + ".index").c_str(), threads, mode, Parameters::DBTYPE_GENERIC_DB);
+    // far smaller than the default buffer, so that each thread flushes many extents
+    writer.open(4096);
+#pragma omp parallel num_threads(threads)
+    {
+        unsigned int thread_idx = 0;
+#ifdef OPENMP
+        thread_idx = static_cast<unsigned int>(omp_get_thread_num());
+#endif
+#pragma omp for schedule(dynamic, 7)
+        for (size_t key = 0; key < entries.size(); key++) {
+            if (key % 3 == 0) {
+                // entries written in parts have to end up in one extent
+                const size_t half = entries[key].size() / 2;
+                writer.writeStart(thread_idx);
+                writer.writeAdd(entries[key].c_str(), half, thread_idx);
+                writer.writeAdd(entries[key].c_str() + half, entries[key].size() - half, thread_idx);
+                writer.writeEnd(static_cast<unsigned int>(key), thread_idx);
+            } else {
+                writer.writeData(entries[key].c_str(), entries[key].size(), static_cast<unsigned int>(key), thread_idx);
+            }
+        }
+    }
+    writer.close(merge);
+}
+
+static bool isInKeyOrder(const std::string &name) {
+    DBReader<unsigned int> reader(name.c_str(), (name + ".index").c_str(), 1, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    reader.open(DBReader<unsigned int>::NOSORT);
+    bool ordered = FileUtil::findDatafiles(name.c_str()).size() == 1;
+    for (size_t id = 1; ordered && id < reader.getSize(); id++) {
+        ordered = reader.getOffset(id - 1) < reader.getOffset(id);
+    }
+    reader.close();
+    return ordered;
+}
+
+static bool compareDatabases(const std::string &defaultName, const std::string &sharedName, const std::vector<std::string> &entries) {
+    DBReader<unsigned int> defaultReader(defaultName.c_str(), (defaultName + ".index").c_str(), 1, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    defaultReader.open(DBReader<unsigned int>::NOSORT);
+    DBReader<unsigned int> sharedReader(sharedName.c_str(), (sharedName + ".index").c_str(), 1, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    sharedReader.open(DBReader<unsigned int>::NOSORT);
+
+    bool equal = defaultReader.getSize() == entries.size() && sharedReader.getSize() == entries.size();
+    if (equal == false) {
+        std::cout << "Databases contain " << defaultReader.getSize() << " and " << sharedReader.getSize() << " instead of " << entries.size() << " entries\n";
+    }
+    // the k-way merge of the thread indices is sorted by key
+    for (size_t id = 0; equal && id < sharedReader.getSize(); id++) {
+        if (sharedReader.getDbKey(id) != id || defaultReader.getDbKey(id) != id) {
+            std::cout << "Index entry " << id << " has key " << sharedReader.getDbKey(id) << "\n";
+            equal = false;
+        }
+    }
+    for (size_t id = 0; equal && id < sharedReader.getSize(); id++) {
+        const std::string sharedData = sharedReader.getData(id, 0);
+        const std::string defaultData = defaultReader.getData(id, 0);
+        if (sharedData != entries[id] || defaultData != entries[id] || sharedReader.getEntryLen(id) != defaultReader.getEntryLen(id)) {
+            std::cout << "Entry " << id << " differs\n";
+            equal = false;
+        }
+    }
+
+    // the extents follow each other in the shared data file, the index of compressed entries
+    // holds the decompressed length instead of the one in the data file
+    if (sharedReader.isCompressed() == false) {
+        std::vector<std::pair<size_t, size_t> > ranges;
+        size_t length = 0;
+        for (size_t id = 0; id < sharedReader.getSize(); id++) {
+            ranges.push_back(std::make_pair(sharedReader.getOffset(id), sharedReader.getEntryLen(id)));
+            length += sharedReader.getEntryLen(id);
+        }
+        std::sort(ranges.begin(), ranges.end());
+        size_t expectedOffset = 0;
+        for (size_t i = 0; equal && i < ranges.size(); i++) {
+            if (ranges[i].first != expectedOffset) {
+                std::cout << "Entry at offset " << ranges[i].first << " does not follow the previous one at " << expectedOffset << "\n";
+                equal = false;
+            }
+            expectedOffset = ranges[i].first + ranges[i].second;
+        }
+        if (equal && FileUtil::getFileSize(sharedName) != length) {
+            std::cout << "Shared data file has " << FileUtil::getFileSize(sharedName) << " bytes instead of " << length << "\n";
+            equal = false;
+        }
+    }
+    sharedReader.close();
+    defaultReader.close();
+    return equal;
+}
+
+int main (int, const char**) {
+    const unsigned int threads = 4;
+    srand(1);
+    std::vector<std::string> entries;
+    for (size_t key = 0; key < 20000; key++) {
+        // a few entries are larger than an extent
+        const int length = (key % 1000 == 0) ? 10000 : 1 + rand() % 300;
+        std::string entry = randomSequence(length);
+        entry.push_back('\n');
+        entries.push_back(entry);
+    }
+
+    const size_t modes[] = {Parameters::WRITER_ASCII_MODE, Parameters::WRITER_COMPRESSED_MODE};
+    const char *modeNames[] = {"uncompressed", "compressed"};
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        writeDatabase("test_dbwritershared_default", entries, threads, modes[i]);
+        writeDatabase("test_dbwritershared_shared", entries, threads, modes[i] | Parameters::WRITER_SHARED_MODE);
+        const bool equal = compareDatabases("test_dbwritershared_default", "test_dbwritershared_shared", entries);
+        DBReader<unsigned int>::removeDb("test_dbwritershared_shared");
+        if (equal == false) {
+            DBReader<unsigned int>::removeDb("test_dbwritershared_default");
+            std::cout << "Shared and default writer differ for " << modeNames[i] << " entries\n";
+            return EXIT_FAILURE;
+        }
+        std::cout << "Shared and default writer are identical for " << modeNames[i] << " entries\n";
+
+        writeDatabase("test_dbwritershared_keyorder", entries, threads, modes[i] | Parameters::WRITER_KEY_ORDER_MODE, true);
+        const bool ordered = compareDatabases("test_dbwritershared_default", "test_dbwritershared_keyorder", entries)
+                             && isInKeyOrder("test_dbwritershared_keyorder");
+        DBReader<unsigned int>::removeDb("test_dbwritershared_default");
+        DBReader<unsigned int>::removeDb("test_dbwritershared_keyorder");
+        if (ordered == false) {
+            std::cout << "Key order writer is not in key order for " << modeNames[i] << " entries\n";
+            return EXIT_FAILURE;
+        }
+        std::cout << "Key order writer is in key order for " << modeNames[i] << " entries\n";
+    }
+    return EXIT_SUCCESS;
+}
@@ -8,6 +8,8 @@
 #include "UngappedAlignment.h"
 #include "ExtendedSubstitutionMatrix.h"
 #include "FileUtil.h"
+#include "SimdDispatch.h"
+#include "Timer.h"
 
 #include "kseq.h"
 #include <unistd.h> // read
@@ -21,7 +23,7 @@ KSEQ_INIT(int, read)
 
 const char* binary_name = "test_diagonalscoringperformance";
 
-int main (int, const char**) {
+int main (int argc, const char** argv) {
     size_t kmer_size = 6;
     Parameters& par = Parameters::getInstance();
     SubstitutionMatrix subMat(par.scoringMatrixFile.aminoacids, 8.0, 0.0);
@@ -39,7 +41,8 @@ int main (int, const char**) {
     Sequence s2(10000,  0, &subMat, kmer_size, true, false);
     s2.mapSequence(0,0,S2char, S2.size());
 
-    FILE *fasta_file = FileUtil::openFileOrDie("/Users/mad/Documents/databases/mmseqs_benchmark/benchmarks/clustering_benchmark/db/db_full.fas", "r", true);
+    const char *fasta_filename = argc > 1 ? argv[1] : "/Users/mad/Documents/databases/mmseqs_benchmark/benchmarks/clustering_benchmark/db/db_full.fas";
+    FILE *fasta_file = FileUtil::openFileOrDie(fasta_filename, "r", true);
     kseq_t *seq = kseq_init(fileno(fasta_file));
     size_t dbEntrySize = 0;
     size_t dbCnt = 0;
@@ -54,7 +57,7 @@ int main (int, const char**) {
     size_t maxLen = 0;
     for(size_t i = 0; i < 10; i++){
         fclose(fasta_file);
-        fasta_file = FileUtil::openFileOrDie("/Users/mad/Documents/databases/mmseqs_benchmark/benchmarks/clustering_benchmark/db/db_full.fas", "r", true);
+        fasta_file = FileUtil::openFileOrDie(fasta_filename, "r", true);
         kseq_rewind(seq);
         while (kseq_read(seq) >= 0) {
             dbSeq.mapSequence(id,id,seq->seq.s, seq->seq.l);
@@ -71,19 +74,19 @@ int main (int, const char**) {
     std::cout << maxLen << std::endl;
     UngappedAlignment matcher(maxLen, &subMat, &lookup);
     CounterResult hits[16000];
-    hits[0].id =142424;
+    hits[0].id = 142424 % id;
     hits[0].diagonal = 50;
-    hits[1].id = 191382;
+    hits[1].id = 191382 % id;
     hits[1].diagonal = 4;
-    hits[2].id = 135950;
+    hits[2].id = 135950 % id;
     hits[2].diagonal = 4;
-    hits[3].id = 63969;
+    hits[3].id = 63969 % id;
     hits[3].diagonal = 4;
-    hits[4].id = 244188;
+    hits[4].id = 244188 % id;
     hits[4].diagonal = 4;
 
     for(size_t i = 5; i < 16; i++) {
-        hits[i].id = 159147;
+        hits[i].id = 159147 % id;
         hits[i].diagonal = 31;
     }
 
@@ -107,13 +110,31 @@ int main (int, const char**) {
     std::cout << (int)hits[1].count<< " ";
     std::cout << (int)hits[2].count<< " ";
     std::cout << (int)hits[3].count<< std::endl;
-    for(size_t i = 0; i < 10000; i++){
-        for(int j = 1; j < 16000; j++){
-            hits[j].id = rand()%dbCnt;
-            hits[j].diagonal =  rand()%s1.L;
+    // throughput of each instruction set that is available
+    for (int level = SimdDispatch::LEVEL_SSE41; level <= SimdDispatch::LEVEL_AVX512BW; level++) {
+        if (SimdDispatch::isAvailable(level) == false) {
+            continue;
         }
-        //   std::reverse(hits, hits+1000);
-        matcher.processQuery(&s1, compositionBias, hits, 16000);
+        SimdDispatch::setLevel(level);
+        UngappedAlignment levelMatcher(maxLen, &subMat, &lookup);
+        srand(1);
+        double seconds = 0.0;
+        size_t scoreSum = 0;
+        for(size_t i = 0; i < 10000; i++){
+            for(int j = 1; j < 16000; j++){
+                hits[j].id = rand()%dbCnt;
+                hits[j].diagonal =  rand()%s1.L;
+            }
+            //   std::reverse(hits, hits+1000);
+            Timer timer;
+            levelMatcher.processQuery(&s1, compositionBias, hits, 16000);
+            seconds += timer.getTimediff();
+            for(int j = 0; j < 16000; j++){
+                scoreSum += hits[j].count;
+            }
+        }
+        std::cout << SimdDispatch::getLevelName(level) << ": " << seconds << "s "
+                  << (10000.0 * 16000.0 / seconds / 1e6) << " M diagonals/s (score sum " << scoreSum << ")" << std::endl;
     }
 //    std::cout << ExtendedSubstitutionMatrix::calcScore(s1.sequence, s1.sequence,s1.L, subMat.subMatrix) << " " << (int)hits[0].diagonalScore <<  std::endl;
 //    std::cout << (int)hits[0].diagonalScore <<  std::endl;
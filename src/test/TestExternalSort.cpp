@@ -0,0 +1,103 @@
+//
+// Sorts records with many equal keys once within a tiny memory budget, so that they are spilled into
+// several run files, and once in memory, from one and from several threads. The records of every thread
+// have to be returned in the order of a stable sort by key.
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ExternalSort.h"
+#include "FileUtil.h"
+#include "Util.h"
+
+const char* binary_name = "test_externalsort";
+
+static bool compareKey(const std::pair<unsigned int, std::string> &first, const std::pair<unsigned int, std::string> &second) {
+    return first.first < second.first;
+}
+
+// record i is added by thread i % threads, its payload starts with i
+static bool sortAndCompare(const std::vector<std::pair<unsigned int, std::string> > &records,
+                           size_t memoryBudget, unsigned int threads, size_t &runCount) {
+    std::vector<std::vector<std::pair<unsigned int, std::string> > > expected(threads);
+    for (size_t i = 0; i < records.size(); i++) {
+        expected[i % threads].push_back(records[i]);
+    }
+    for (unsigned int thread = 0; thread < threads; thread++) {
+        std::stable_sort(expected[thread].begin(), expected[thread].end(), compareKey);
+    }
+
+    const std::string prefix = "test_externalsort";
+    bool equal = true;
+    {
+        ExternalSort sorter(prefix, memoryBudget, threads);
+        for (size_t i = 0; i < records.size(); i++) {
+            sorter.add(records[i].first, records[i].second.c_str(), records[i].second.size(), static_cast<unsigned int>(i % threads));
+        }
+        sorter.finish();
+        runCount = sorter.getRunCount();
+
+        unsigned int key;
+        const char *data;
+        size_t size;
+        unsigned int prevKey = 0;
+        size_t count = 0;
+        std::vector<size_t> positions(threads, 0);
+        while (sorter.next(key, data, size)) {
+            const std::string payload(data, size);
+            const unsigned int thread = static_cast<unsigned int>(strtoul(payload.c_str(), NULL, 10) % threads);
+            const size_t pos = positions[thread]++;
+            if (key < prevKey || pos >= expected[thread].size()
+                || key != expected[thread][pos].first || payload != expected[thread][pos].second) {
+                equal = false;
+            }
+            prevKey = key;
+            count++;
+        }
+        equal = equal && (count == records.size());
+    }
+    // the run files are removed with the sorter
+    for (size_t i = 0; i < runCount; i++) {
+        if (FileUtil::fileExists((prefix + ".run." + SSTR(i)).c_str())) {
+            std::cout << "Run file " << i << " was not removed\n";
+            equal = false;
+        }
+    }
+    return equal;
+}
+
+int main (int, const char**) {
+    // few distinct keys, the payload is the input position so that the order of equal keys is checked
+    srand(1);
+    std::vector<std::pair<unsigned int, std::string> > records;
+    for (size_t i = 0; i < 20000; i++) {
+        std::string payload = SSTR(i) + "\t" + std::string(rand() % 20, 'A') + "\n";
+        records.push_back(std::make_pair(static_cast<unsigned int>(rand() % 500), payload));
+    }
+
+    const unsigned int threads[] = {1, 4};
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+        size_t runCount;
+        if (sortAndCompare(records, 16 * 1024, threads[i], runCount) == false) {
+            std::cout << "Order of the sort from " << threads[i] << " threads with " << runCount << " runs differs from a stable sort\n";
+            return EXIT_FAILURE;
+        }
+        if (runCount < 2) {
+            std::cout << "Sort from " << threads[i] << " threads wrote " << runCount << " runs instead of several\n";
+            return EXIT_FAILURE;
+        }
+        std::cout << "Sort from " << threads[i] << " threads with " << runCount << " runs is stable\n";
+
+        if (sortAndCompare(records, 1024 * 1024 * 1024, threads[i], runCount) == false || runCount != 0) {
+            std::cout << "Order of the sort from " << threads[i] << " threads in memory differs from a stable sort\n";
+            return EXIT_FAILURE;
+        }
+        std::cout << "Sort from " << threads[i] << " threads in memory is stable\n";
+    }
+    return EXIT_SUCCESS;
+}
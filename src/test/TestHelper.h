@@ -0,0 +1,86 @@
+//
+// Fixtures shared by the tests: random amino acid sequences, a sequence database with headers built from them
+// and running modules in a child process.
+//
+
+#ifndef MMSEQS_TESTHELPER_H
+#define MMSEQS_TESTHELPER_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Command.h"
+#include "DBWriter.h"
+#include "Parameters.h"
+#include "Util.h"
+
+extern std::vector<Command> baseCommands;
+
+static const char TEST_AMINO_ACIDS[] = "ACDEFGHIKLMNPQRSTVWY";
+
+static inline char randomAminoAcid() {
+    return TEST_AMINO_ACIDS[rand() % 20];
+}
+
+static inline std::string randomSequence(size_t length) {
+    std::string seq;
+    for (size_t i = 0; i < length; i++) {
+        seq.push_back(randomAminoAcid());
+    }
+    return seq;
+}
+
+// writes the sequences (with their trailing newline) under the keys 0..n-1 and a header "seq<key>" for each to name_h
+static inline void writeSequenceDatabase(const std::string &name, const std::vector<std::string> &sequences) {
+    DBWriter seqWriter(name.c_str(), (name + ".index").c_str(), 1, Parameters::WRITER_ASCII_MODE, Parameters::DBTYPE_AMINO_ACIDS);
+    seqWriter.open();
+    const std::string headerName = name + "_h";
+    DBWriter headerWriter(headerName.c_str(), (headerName + ".index").c_str(), 1, Parameters::WRITER_ASCII_MODE, Parameters::DBTYPE_GENERIC_DB);
+    headerWriter.open();
+    for (unsigned int key = 0; key < sequences.size(); key++) {
+        seqWriter.writeData(sequences[key].c_str(), sequences[key].size(), key, 0);
+        std::string header = "seq" + SSTR(key) + "\n";
+        headerWriter.writeData(header.c_str(), header.size(), key, 0);
+    }
+    seqWriter.close(true);
+    headerWriter.close(true);
+}
+
+// runs a module in a child process, the modules exit on errors and keep global state
+static inline pid_t runCommand(const char *name, const std::vector<const char *> &argv) {
+    Command *command = NULL;
+    for (size_t i = 0; i < baseCommands.size(); i++) {
+        if (strcmp(baseCommands[i].cmd, name) == 0) {
+            command = &baseCommands[i];
+        }
+    }
+    if (command == NULL) {
+        std::cout << "Unknown module " << name << "\n";
+        return -1;
+    }
+    // buffered output would be written by both processes
+    fflush(NULL);
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        _exit(command->commandFunction(static_cast<int>(argv.size()), const_cast<const char **>(argv.data()), *command));
+    }
+    return pid;
+}
+
+static inline int waitForCommand(pid_t pid) {
+    int status;
+    if (pid == -1 || waitpid(pid, &status, 0) == -1 || WIFEXITED(status) == false) {
+        return EXIT_FAILURE;
+    }
+    return WEXITSTATUS(status);
+}
+
+#endif
@@ -0,0 +1,152 @@
+//
+// Appends sequences to the index of a random database with indexdb --append and checks that the prefilter
+// finds the same hits with the appended index, with the index compacted by --compact and with an index that
+// was recreated for the whole database. An append to a database whose indexed sequences changed has to
+// recreate the index.
+//
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "CommandDeclarations.h"
+#include "DBReader.h"
+#include "PrefilteringIndexReader.h"
+#include "TestHelper.h"
+
+const char* binary_name = "test_indexappend";
+
+static int runModule(const char *name, std::vector<const char *> argv) {
+    argv.push_back("--threads");
+    argv.push_back("1");
+    argv.push_back("-v");
+    argv.push_back("1");
+    return waitForCommand(runCommand(name, argv));
+}
+
+static bool readResults(const char *name, std::vector<std::string> &results) {
+    DBReader<unsigned int> reader(name, (std::string(name) + ".index").c_str(), 1, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    reader.open(DBReader<unsigned int>::SORT_BY_ID);
+    for (size_t i = 0; i < reader.getSize(); i++) {
+        results.push_back(SSTR(reader.getDbKey(i)) + "\n" + reader.getData(i, 0));
+    }
+    reader.close();
+    return results.empty() == false;
+}
+
+static void getSplits(const std::string &indexDB, int *splits, int *appendedSplits) {
+    DBReader<unsigned int> index(indexDB.c_str(), (indexDB + ".index").c_str(), 1, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    index.open(DBReader<unsigned int>::NOSORT);
+    *splits = PrefilteringIndexReader::getMetadata(&index).splits;
+    *appendedSplits = PrefilteringIndexReader::getAppendedSplits(&index);
+    index.close();
+}
+
+static int testAppend(const std::vector<std::string> &sequences, const char *compression) {
+    const std::string indexDB = PrefilteringIndexReader::indexName("test_indexappend_db");
+    std::vector<const char *> indexArgv = {"test_indexappend_db", "test_indexappend_db", "--index-compression", compression};
+    std::vector<const char *> appendArgv = indexArgv;
+    appendArgv.push_back("--append");
+    appendArgv.push_back("1");
+    std::vector<const char *> compactArgv = indexArgv;
+    compactArgv.push_back("--compact");
+    compactArgv.push_back("1");
+    std::vector<const char *> prefilterArgv = {"test_indexappend_db", indexDB.c_str(), "test_indexappend_appended"};
+
+    // index the first 600 sequences and append the rest in two steps
+    const size_t steps[] = {600, 800, 1000};
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        writeSequenceDatabase("test_indexappend_db", std::vector<std::string>(sequences.begin(), sequences.begin() + steps[i]));
+        if (runModule("indexdb", appendArgv) != EXIT_SUCCESS) {
+            std::cout << "Could not create index with " << steps[i] << " sequences\n";
+            return EXIT_FAILURE;
+        }
+    }
+    int splits;
+    int appendedSplits;
+    getSplits(indexDB, &splits, &appendedSplits);
+    if (appendedSplits != 2) {
+        std::cout << "Index has " << appendedSplits << " appended splits instead of 2\n";
+        return EXIT_FAILURE;
+    }
+    if (runModule("prefilter", prefilterArgv) != EXIT_SUCCESS) {
+        std::cout << "Prefilter with the appended index failed\n";
+        return EXIT_FAILURE;
+    }
+
+    prefilterArgv[2] = "test_indexappend_compacted";
+    if (runModule("indexdb", compactArgv) != EXIT_SUCCESS || runModule("prefilter", prefilterArgv) != EXIT_SUCCESS) {
+        std::cout << "Prefilter with the compacted index failed\n";
+        return EXIT_FAILURE;
+    }
+    getSplits(indexDB, &splits, &appendedSplits);
+    if (splits != 1 || appendedSplits != 0) {
+        std::cout << "Compacted index has " << splits << " splits and " << appendedSplits << " appended splits\n";
+        return EXIT_FAILURE;
+    }
+
+    DBReader<unsigned int>::removeDb(indexDB);
+    prefilterArgv[2] = "test_indexappend_recreated";
+    if (runModule("indexdb", indexArgv) != EXIT_SUCCESS || runModule("prefilter", prefilterArgv) != EXIT_SUCCESS) {
+        std::cout << "Prefilter with the recreated index failed\n";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::string> appended;
+    std::vector<std::string> compacted;
+    std::vector<std::string> recreated;
+    const bool read = readResults("test_indexappend_appended", appended)
+                      && readResults("test_indexappend_compacted", compacted)
+                      && readResults("test_indexappend_recreated", recreated);
+    DBReader<unsigned int>::removeDb("test_indexappend_appended");
+    DBReader<unsigned int>::removeDb("test_indexappend_compacted");
+    DBReader<unsigned int>::removeDb("test_indexappend_recreated");
+    if (read == false || appended.size() != sequences.size() || appended != recreated || compacted != recreated) {
+        std::cout << "Prefilter results of the appended, compacted and recreated index differ\n";
+        return EXIT_FAILURE;
+    }
+
+    // a changed residue of an indexed sequence keeps its length, the index must not be appended to
+    std::vector<std::string> changed(sequences);
+    changed[10][0] = (changed[10][0] == 'A') ? 'C' : 'A';
+    changed.push_back(sequences[0]);
+    writeSequenceDatabase("test_indexappend_db", changed);
+    if (runModule("indexdb", appendArgv) != EXIT_SUCCESS) {
+        std::cout << "Could not index the changed database\n";
+        return EXIT_FAILURE;
+    }
+    getSplits(indexDB, &splits, &appendedSplits);
+    if (appendedSplits != 0) {
+        std::cout << "Sequences were appended to the index of a changed database\n";
+        return EXIT_FAILURE;
+    }
+    DBReader<unsigned int>::removeDb(indexDB);
+
+    std::cout << "Prefilter results of " << appended.size() << " queries are identical with --index-compression " << compression << "\n";
+    return EXIT_SUCCESS;
+}
+
+int main (int, const char**) {
+    // random sequences, every tenth one shares a motif so that the lists contain hits of both segments
+    srand(1);
+    std::vector<std::string> sequences;
+    for (unsigned int key = 0; key < 1000; key++) {
+        std::string seq = randomSequence(50 + rand() % 300);
+        if (key % 10 == 0) {
+            seq.insert(rand() % seq.size(), "MKVLAAGIVGLLLASWWHPCYFEMN");
+        }
+        seq.push_back('\n');
+        sequences.push_back(seq);
+    }
+
+    const char *compressions[] = {"0", "1"};
+    int status = EXIT_SUCCESS;
+    for (size_t i = 0; i < sizeof(compressions) / sizeof(compressions[0]) && status == EXIT_SUCCESS; i++) {
+        status = testAppend(sequences, compressions[i]);
+    }
+    DBReader<unsigned int>::removeDb(PrefilteringIndexReader::indexName("test_indexappend_db"));
+    DBReader<unsigned int>::removeDb("test_indexappend_db");
+    DBReader<unsigned int>::removeDb("test_indexappend_db_h");
+    return status;
+}
@@ -2,36 +2,90 @@
 // Written by Maria Hauser mhauser@genzentrum.lmu.de
 //
 // Test class for k-mer generation and index table testing.
+// Builds the index table of a random database with the atomic k-mer counts and the radix buckets
+// and checks that both tables are identical.
 //
 
 #include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include "SubstitutionMatrix.h"
 #include "IndexTable.h"
 #include "IndexBuilder.h"
+#include "DBWriter.h"
 #include "Parameters.h"
+#include "TestHelper.h"
 
 const char* binary_name = "test_indextable";
 
+static IndexTable *buildTable(SubstitutionMatrix &subMat, DBReader<unsigned int> &dbr, int kmerThr, bool radixBuild,
+                              SequenceLookup **lookup) {
+    Sequence s(32000, Parameters::DBTYPE_AMINO_ACIDS, &subMat, 6, true, false);
+    IndexTable *t = new IndexTable(subMat.alphabetSize - 1, 6, false);
+    IndexBuilder::fillDatabase(t, lookup, NULL, subMat, &s, &dbr, 0, dbr.getSize(), kmerThr, true, true, radixBuild);
+    return t;
+}
+
 int main (int, const char**) {
     Parameters &par = Parameters::getInstance();
     SubstitutionMatrix subMat(par.scoringMatrixFile.aminoacids, 8.0, -0.2f);
-    DBReader<unsigned int> dbr(
-                               "/Users/mad/Documents/databases/db_small/db_small",
-//                               "/Users/mad/Documents/databases/mmseqs_benchmark/benchmarks/protein_search_uniscop/db/mmseqs/db_sw",
-                               "/Users/mad/Documents/databases/db_small/db_small.index"
-//                               "/Users/mad/Documents/databases/mmseqs_benchmark/benchmarks/protein_search_uniscop/db/mmseqs/db_sw.index"
-                               , 1, 0);
-    dbr.open(DBReader<unsigned int>::LINEAR_ACCCESS);
-
-    Sequence *s = new Sequence(32000, Parameters::DBTYPE_AMINO_ACIDS, &subMat, 6, true, false);
-    IndexTable t(subMat.alphabetSize, 6, false);
-    IndexBuilder::fillDatabase(&t, NULL, NULL, subMat, s, &dbr, 0, dbr.getSize(), 0, 1, 1);
-    t.printStatistics(subMat.num2aa);
-
-    delete s;
+
+    // random sequences with low complexity regions, lower case stretches and frequent motifs for hot k-mers
+    srand(1);
+    DBWriter writer("test_indextable_db", "test_indextable_db.index", 1, Parameters::WRITER_ASCII_MODE, Parameters::DBTYPE_AMINO_ACIDS);
+    writer.open();
+    for (unsigned int key = 0; key < 5000; key++) {
+        std::string seq;
+        const int length = 10 + rand() % 800;
+        for (int i = 0; i < length; i++) {
+            const int r = rand() % 100;
+            if (r == 0) {
+                seq.append("MKVLAAGIVGLLLAS");
+            } else if (r == 1) {
+                seq.append(20, 'Q');
+            } else if (r == 2) {
+                for (int j = 0; j < 10; j++) {
+                    seq.push_back(static_cast<char>(tolower(randomAminoAcid())));
+                }
+            } else {
+                seq.push_back(randomAminoAcid());
+            }
+        }
+        seq.push_back('\n');
+        writer.writeData(seq.c_str(), seq.size(), key, 0);
+    }
+    writer.close(true);
+
+    DBReader<unsigned int> dbr("test_indextable_db", "test_indextable_db.index", 1, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    dbr.open(DBReader<unsigned int>::NOSORT);
+
+    const int thresholds[] = {0, 100};
+    for (size_t i = 0; i < sizeof(thresholds) / sizeof(thresholds[0]); i++) {
+        SequenceLookup *atomicLookup = NULL;
+        SequenceLookup *radixLookup = NULL;
+        IndexTable *atomicTable = buildTable(subMat, dbr, thresholds[i], false, &atomicLookup);
+        IndexTable *radixTable = buildTable(subMat, dbr, thresholds[i], true, &radixLookup);
+        atomicTable->printStatistics(subMat.num2aa);
+
+        const size_t entries = atomicTable->getTableEntriesNum();
+        if (entries != radixTable->getTableEntriesNum()
+            || memcmp(atomicTable->getOffsets(), radixTable->getOffsets(), (atomicTable->getTableSize() + 1) * sizeof(size_t)) != 0
+            || memcmp(atomicTable->getEntries(), radixTable->getEntries(), entries * sizeof(IndexEntryLocal)) != 0) {
+            std::cout << "Index tables differ at k-mer threshold " << thresholds[i] << "\n";
+            return EXIT_FAILURE;
+        }
+        std::cout << "Index tables with " << entries << " entries are identical at k-mer threshold " << thresholds[i] << "\n";
+
+        delete atomicTable;
+        delete radixTable;
+        delete atomicLookup;
+        delete radixLookup;
+    }
+
     dbr.close();
+    remove("test_indextable_db");
+    remove("test_indextable_db.index");
+    remove("test_indextable_db.dbtype");
 
-    return 0;
+    return EXIT_SUCCESS;
 }
-
@@ -5,6 +5,8 @@
 //  Copyright (c) 2012 -. All rights reserved.
 //
 #include <iostream>
+#include <algorithm>
+#include <vector>
 #include "Sequence.h"
 #include "Indexer.h"
 #include "ExtendedSubstitutionMatrix.h"
@@ -76,6 +78,41 @@ int main (int, const char**) {
         }
     }
 
+    // cached lists have to match the generated ones, also after the cache was invalidated by a full list storage
+    const char* repeatSequence = "PATWPCLVALGPATWPCLVALGMKVLAAGPATWPCLVALGMKVLAAG";
+    Sequence repeats(10000, Parameters::DBTYPE_AMINO_ACIDS, &subMat, kmer_size, false, false);
+    repeats.mapSequence(1, 1, repeatSequence, strlen(repeatSequence));
+    const size_t cacheSizes[] = { 16 * 1024 * 1024, 4 * 1024 };
+    const short thresholds[] = { 161, 110, 161 };
+    for (size_t c = 0; c < 2; c++) {
+        KmerGenerator cachedGen(kmer_size, subMat.alphabetSize, 161);
+        cachedGen.setDivideStrategy(&extMatthree, &extMattwo);
+        cachedGen.setCacheSize(cacheSizes[c]);
+        for (size_t t = 0; t < 3; t++) {
+            kmerGen.setThreshold(thresholds[t]);
+            cachedGen.setThreshold(thresholds[t]);
+            repeats.resetCurrPos();
+            while (repeats.hasNextKmer()) {
+                const unsigned char * kmer = repeats.nextKmer();
+                std::pair<size_t *, size_t> expected = kmerGen.generateKmerList(kmer);
+                std::vector<size_t> expectedList(expected.first, expected.first + expected.second);
+                std::pair<size_t *, size_t> cached = cachedGen.generateKmerList(kmer);
+                if (cached.second != expectedList.size() || std::equal(expectedList.begin(), expectedList.end(), cached.first) == false) {
+                    std::cout << "Cached k-mer list differs at position " << repeats.getCurrentPosition()
+                              << " with threshold " << thresholds[t] << "\n";
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+        std::cout << "Cache of " << cacheSizes[c] << " bytes: " << cachedGen.getCacheHits() << " hits, "
+                  << cachedGen.getCacheMisses() << " misses\n";
+        if (cachedGen.getCacheHits() == 0) {
+            std::cout << "Cache was never hit\n";
+            return EXIT_FAILURE;
+        }
+    }
+    std::cout << "Cached k-mer lists OK\n";
+
     ExtendedSubstitutionMatrix::freeScoreMatrix(extMatthree);
     ExtendedSubstitutionMatrix::freeScoreMatrix(extMattwo);
 
@@ -0,0 +1,124 @@
+//
+// Starts the server on the index of a small random database and sends two requests over its socket.
+// The first query is a sequence of the database and has to find itself, the second one is longer than
+// the maximum sequence length and has to be rejected with an error line. Both requests are sent while
+// another client is connected that never finishes its request, they must not wait for its read timeout.
+//
+
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "CommandDeclarations.h"
+#include "FileUtil.h"
+#include "TestHelper.h"
+
+const char* binary_name = "test_server";
+
+// the server is ready once it accepts connections
+static int connectToServer(const char *socketFile) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketFile, sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    for (int i = 0; i < 600; i++) {
+        if (connect(fd, (struct sockaddr *) &address, sizeof(address)) == 0) {
+            return fd;
+        }
+        usleep(100000);
+    }
+    close(fd);
+    return -1;
+}
+
+static bool request(const char *socketFile, const std::string &query, std::string &response) {
+    int fd = connectToServer(socketFile);
+    if (fd == -1) {
+        return false;
+    }
+    if (write(fd, query.c_str(), query.size()) != static_cast<ssize_t>(query.size())) {
+        close(fd);
+        return false;
+    }
+    shutdown(fd, SHUT_WR);
+    char buffer[4096];
+    ssize_t count;
+    while ((count = read(fd, buffer, sizeof(buffer))) > 0) {
+        response.append(buffer, count);
+    }
+    close(fd);
+    return true;
+}
+
+int main (int, const char**) {
+    srand(1);
+    std::vector<std::string> sequences;
+    for (unsigned int key = 0; key < 200; key++) {
+        sequences.push_back(randomSequence(50 + rand() % 300) + "\n");
+    }
+    writeSequenceDatabase("test_server_db", sequences);
+    const std::string query = ">query\n" + sequences[42];
+
+    std::vector<const char *> indexArgv = {"test_server_db", "test_server_db", "--threads", "1", "-v", "1"};
+    if (waitForCommand(runCommand("indexdb", indexArgv)) != EXIT_SUCCESS) {
+        std::cout << "Could not create index\n";
+        return EXIT_FAILURE;
+    }
+
+    const char *socketFile = "test_server.sock";
+    std::vector<const char *> serverArgv = {"test_server_db", socketFile, "--threads", "1", "-v", "1"};
+    pid_t server = runCommand("server", serverArgv);
+    const int stalledFd = connectToServer(socketFile);
+    const std::string stalledQuery = ">stalled\nACDEF";
+    const bool stalledSent = stalledFd != -1 && write(stalledFd, stalledQuery.c_str(), stalledQuery.size()) == static_cast<ssize_t>(stalledQuery.size());
+    const time_t start = time(NULL);
+    std::string response;
+    const bool answered = request(socketFile, query, response);
+    std::string longQuery = ">long\n" + std::string(70000, 'A') + "\n";
+    std::string longResponse;
+    const bool answeredLong = request(socketFile, longQuery, longResponse);
+    const time_t elapsed = time(NULL) - start;
+    if (stalledFd != -1) {
+        close(stalledFd);
+    }
+    kill(server, SIGTERM);
+    const int status = waitForCommand(server);
+
+    FileUtil::remove("test_server_db");
+    FileUtil::remove("test_server_db.index");
+    FileUtil::remove("test_server_db.dbtype");
+    FileUtil::remove("test_server_db_h");
+    FileUtil::remove("test_server_db_h.index");
+    FileUtil::remove("test_server_db_h.dbtype");
+    FileUtil::remove("test_server_db.idx");
+    FileUtil::remove("test_server_db.idx.index");
+    FileUtil::remove("test_server_db.idx.dbtype");
+
+    std::cout << response << longResponse;
+    if (answered == false || answeredLong == false || status != EXIT_SUCCESS) {
+        std::cout << "Server did not answer\n";
+        return EXIT_FAILURE;
+    }
+    if (stalledSent == false || elapsed >= 30) {
+        std::cout << "Requests waited " << elapsed << "s for a client that did not finish its request\n";
+        return EXIT_FAILURE;
+    }
+    if (response.compare(0, strlen("query\tseq42\t"), "query\tseq42\t") != 0) {
+        std::cout << "Query did not find itself\n";
+        return EXIT_FAILURE;
+    }
+    if (longResponse.compare(0, strlen("ERROR\tQuery long "), "ERROR\tQuery long ") != 0) {
+        std::cout << "Query longer than the maximum sequence length was not rejected\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "Round trip passed\n";
+    return EXIT_SUCCESS;
+}
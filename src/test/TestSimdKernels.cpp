@@ -0,0 +1,258 @@
+// Compares the SIMD kernels of every instruction set available on this machine
+// against scalar reference implementations
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <limits>
+#include <map>
+
+#include "Parameters.h"
+#include "SubstitutionMatrix.h"
+#include "Sequence.h"
+#include "SequenceLookup.h"
+#include "StripedSmithWaterman.h"
+#include "UngappedAlignment.h"
+#include "CacheFriendlyOperations.h"
+#include "EvalueComputation.h"
+#include "SimdDispatch.h"
+#include "TestHelper.h"
+
+const char* binary_name = "test_simdkernels";
+
+// substitutions, insertions and deletions with the given probability
+std::string mutateSequence(const std::string &seq, int percent) {
+    std::string mutated;
+    for (size_t i = 0; i < seq.size(); i++) {
+        int r = rand() % 100;
+        if (r < percent / 2) {
+            mutated.push_back(randomAminoAcid());
+        } else if (r < (percent / 2 + percent / 4)) {
+            mutated.push_back(seq[i]);
+            mutated.push_back(randomAminoAcid());
+        } else if (r >= percent) {
+            mutated.push_back(seq[i]);
+        }
+    }
+    return mutated;
+}
+
+// Gotoh local alignment, a gap of length k costs gapOpen + (k - 1) * gapExtend
+int scalarSmithWaterman(const unsigned char *query, int queryLen, const unsigned char *target, int targetLen,
+                        const int8_t *mat, int alphabetSize, int gapOpen, int gapExtend) {
+    std::vector<int> H(queryLen + 1, 0);
+    std::vector<int> E(queryLen + 1, 0);
+    int max = 0;
+    for (int j = 0; j < targetLen; j++) {
+        int hDiag = 0;
+        int hUp = 0;
+        int F = 0;
+        for (int i = 1; i <= queryLen; i++) {
+            E[i] = std::max(E[i] - gapExtend, H[i] - gapOpen);
+            F = std::max(F - gapExtend, hUp - gapOpen);
+            int h = hDiag + mat[query[i - 1] * alphabetSize + target[j]];
+            h = std::max(std::max(h, 0), std::max(E[i], F));
+            hDiag = H[i];
+            H[i] = h;
+            hUp = h;
+            max = std::max(max, h);
+        }
+    }
+    return max;
+}
+
+// score of the traceback computed by banded_sw
+int cigarScore(const s_align &aln, const unsigned char *query, const unsigned char *target,
+               const int8_t *mat, int alphabetSize, int gapOpen, int gapExtend) {
+    int score = 0;
+    int qPos = aln.qStartPos1;
+    int tPos = aln.dbStartPos1;
+    for (int32_t c = 0; c < aln.cigarLen; c++) {
+        char op = SmithWaterman::cigar_int_to_op(aln.cigar[c]);
+        uint32_t length = SmithWaterman::cigar_int_to_len(aln.cigar[c]);
+        if (op == 'M') {
+            for (uint32_t i = 0; i < length; i++) {
+                score += mat[query[qPos++] * alphabetSize + target[tPos++]];
+            }
+        } else {
+            score -= gapOpen + (length - 1) * gapExtend;
+            if (op == 'I') {
+                qPos += length;
+            } else {
+                tPos += length;
+            }
+        }
+    }
+    return score;
+}
+
+int main (int, const char**) {
+    const size_t kmer_size = 6;
+    const int gapOpen = 11;
+    const int gapExtend = 1;
+    Parameters& par = Parameters::getInstance();
+    SubstitutionMatrix subMat(par.scoringMatrixFile.aminoacids, 2.0, 0.0);
+    int8_t *tinySubMat = new int8_t[subMat.alphabetSize * subMat.alphabetSize];
+    for (int i = 0; i < subMat.alphabetSize; i++) {
+        for (int j = 0; j < subMat.alphabetSize; j++) {
+            tinySubMat[i * subMat.alphabetSize + j] = (int8_t) subMat.subMatrix[i][j];
+        }
+    }
+
+    srand(1);
+    std::vector<std::string> queries;
+    std::vector<std::string> targets;
+    for (size_t i = 0; i < 20; i++) {
+        std::string query = randomSequence(20 + rand() % 1000);
+        queries.push_back(query);
+        // unrelated (8 bit scores) and related targets (16 bit scores)
+        targets.push_back(randomSequence(20 + rand() % 1000));
+        targets.push_back(mutateSequence(query, 10 + rand() % 60));
+        targets.push_back(mutateSequence(query.substr(query.size() / 3), 20));
+    }
+
+    Sequence query(10000, 0, &subMat, kmer_size, true, false);
+    Sequence target(10000, 0, &subMat, kmer_size, true, false);
+    EvalueComputation evalueComputation(100000, &subMat, gapOpen, gapExtend);
+    size_t failed = 0;
+    for (int level = SimdDispatch::LEVEL_SSE41; level <= SimdDispatch::LEVEL_AVX512BW; level++) {
+        if (SimdDispatch::isAvailable(level) == false) {
+            std::cout << SimdDispatch::getLevelName(level) << ": not available\n";
+            continue;
+        }
+        SimdDispatch::setLevel(level);
+        size_t checks = 0;
+        size_t levelFailed = 0;
+
+        // striped Smith-Waterman (sw_sse2_byte/sw_sse2_word) against scalar Gotoh and banded_sw traceback,
+        // and the inter-sequence engine (ssw_align_batch) against the striped one
+        SmithWaterman aligner(10000, subMat.alphabetSize, false);
+        for (size_t i = 0; i < queries.size(); i++) {
+            query.mapSequence(0, 0, queries[i].c_str(), queries[i].size());
+            aligner.ssw_init(&query, tinySubMat, &subMat, subMat.alphabetSize, 2);
+            for (size_t j = 0; j < targets.size(); j++) {
+                target.mapSequence(1, 1, targets[j].c_str(), targets[j].size());
+                s_align aln = aligner.ssw_align(target.numSequence, target.L, gapOpen, gapExtend, 2,
+                                                std::numeric_limits<double>::max(), &evalueComputation, 0, 0.0, query.L / 2);
+                int expected = scalarSmithWaterman(query.numSequence, query.L, target.numSequence, target.L,
+                                                   tinySubMat, subMat.alphabetSize, gapOpen, gapExtend);
+                int traceback = cigarScore(aln, query.numSequence, target.numSequence,
+                                           tinySubMat, subMat.alphabetSize, gapOpen, gapExtend);
+                if ((int) aln.score1 != expected || traceback != expected) {
+                    std::cout << "SW mismatch query " << i << " target " << j << ": " << aln.score1
+                              << " scalar " << expected << " traceback " << traceback << "\n";
+                    levelFailed++;
+                }
+                delete [] aln.cigar;
+                checks++;
+            }
+
+            // inter-sequence engine against the first pass of ssw_align, continuing from the batch results
+            // has to give the same alignments. Every target is passed twice, so lanes have to be refilled.
+            std::vector<Sequence *> batchTargets;
+            std::vector<const unsigned char *> batchSequences;
+            std::vector<int32_t> batchLengths;
+            for (size_t k = 0; k < 2 * targets.size(); k++) {
+                Sequence *seq = new Sequence(10000, 0, &subMat, kmer_size, true, false);
+                const std::string &sequence = targets[k % targets.size()];
+                seq->mapSequence(k, k, sequence.c_str(), sequence.size());
+                batchTargets.push_back(seq);
+                batchSequences.push_back(seq->numSequence);
+                batchLengths.push_back(seq->L);
+            }
+            std::vector<s_align> batchResults(batchSequences.size());
+            aligner.ssw_align_batch(batchSequences.data(), batchLengths.data(), batchSequences.size(),
+                                    gapOpen, gapExtend, batchResults.data());
+            for (size_t k = 0; k < batchSequences.size(); k++) {
+                s_align striped = aligner.ssw_align(batchSequences[k], batchLengths[k], gapOpen, gapExtend, 2,
+                                                    std::numeric_limits<double>::max(), &evalueComputation, 0, 0.0, query.L / 2);
+                s_align continued = aligner.ssw_align(batchSequences[k], batchLengths[k], gapOpen, gapExtend, 2,
+                                                      std::numeric_limits<double>::max(), &evalueComputation, 0, 0.0, query.L / 2,
+                                                      &batchResults[k]);
+                const s_align &batch = batchResults[k];
+                bool overflow = batch.score1 == 255;
+                if ((overflow == false && (batch.score1 != striped.score1 || batch.dbEndPos1 != striped.dbEndPos1 || batch.qEndPos1 != striped.qEndPos1))
+                    || continued.score1 != striped.score1 || continued.qStartPos1 != striped.qStartPos1
+                    || continued.dbStartPos1 != striped.dbStartPos1 || continued.cigarLen != striped.cigarLen) {
+                    std::cout << "Batch mismatch query " << i << " target " << k << ": " << batch.score1
+                              << " " << batch.qEndPos1 << " " << batch.dbEndPos1 << " striped " << striped.score1
+                              << " " << striped.qEndPos1 << " " << striped.dbEndPos1 << "\n";
+                    levelFailed++;
+                }
+                delete [] striped.cigar;
+                delete [] continued.cigar;
+                checks++;
+            }
+            for (size_t k = 0; k < batchTargets.size(); k++) {
+                delete batchTargets[k];
+            }
+        }
+
+        // vectorDiagonalScoring against scalarDiagonalScoring
+        SequenceLookup lookup(targets.size(), 10000 * targets.size());
+        for (size_t j = 0; j < targets.size(); j++) {
+            target.mapSequence(j, j, targets[j].c_str(), targets[j].size());
+            lookup.addSequence(&target);
+        }
+        UngappedAlignment matcher(10000, &subMat, &lookup);
+        float *compositionBias = new float[10000];
+        CounterResult hits[64];
+        for (size_t i = 0; i < queries.size(); i++) {
+            query.mapSequence(0, 0, queries[i].c_str(), queries[i].size());
+            SubstitutionMatrix::calcLocalAaBiasCorrection(&subMat, query.numSequence, query.L, compositionBias);
+            for (int diagonal = -50; diagonal <= 50; diagonal += 10) {
+                // all hits share one diagonal, so they are scored together in one vector
+                for (size_t j = 0; j < 64; j++) {
+                    hits[j].id = j % targets.size();
+                    hits[j].diagonal = static_cast<unsigned short>(diagonal);
+                    hits[j].count = 0;
+                }
+                matcher.processQuery(&query, compositionBias, hits, 64);
+                for (size_t j = 0; j < 64; j++) {
+                    unsigned short minDistToDiagonal = static_cast<unsigned short>(abs(diagonal));
+                    int expected = matcher.scoreSingleSequence(lookup.getSequence(hits[j].id),
+                                                               static_cast<unsigned short>(diagonal), minDistToDiagonal);
+                    expected = std::min(255 - matcher.getQueryBias(), expected);
+                    if (hits[j].count != expected) {
+                        std::cout << "Diagonal mismatch query " << i << " target " << hits[j].id
+                                  << " diagonal " << diagonal << ": " << (int) hits[j].count
+                                  << " scalar " << expected << "\n";
+                        levelFailed++;
+                    }
+                    checks++;
+                }
+            }
+        }
+        delete [] compositionBias;
+
+        // binning kernels, keepMaxScoreElementOnly keeps one hit with the highest count per target
+        CacheFriendlyOperations<8> operations(500, 2000 / 8);
+        std::vector<CounterResult> elements(2000);
+        std::map<unsigned int, unsigned char> maxCount;
+        for (size_t j = 0; j < elements.size(); j++) {
+            elements[j].id = rand() % 500;
+            elements[j].diagonal = static_cast<unsigned short>(rand() % 100);
+            elements[j].count = static_cast<unsigned char>(1 + rand() % 255);
+            maxCount[elements[j].id] = std::max(maxCount[elements[j].id], elements[j].count);
+        }
+        size_t kept = operations.keepMaxScoreElementOnly(elements.data(), elements.size());
+        if (kept != maxCount.size()) {
+            std::cout << "Binning kept " << kept << " hits for " << maxCount.size() << " targets\n";
+            levelFailed++;
+        }
+        for (size_t j = 0; j < kept; j++) {
+            if (elements[j].count != maxCount[elements[j].id]) {
+                std::cout << "Binning mismatch target " << elements[j].id << ": " << (int) elements[j].count
+                          << " scalar " << (int) maxCount[elements[j].id] << "\n";
+                levelFailed++;
+            }
+        }
+        checks++;
+
+        std::cout << SimdDispatch::getLevelName(level) << ": " << checks << " checks, "
+                  << levelFailed << " failed\n";
+        failed += levelFailed;
+    }
+    delete [] tinySubMat;
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -35,7 +35,7 @@ int alignall(int argc, const char **argv, const Command &command) {
     DBReader<unsigned int> dbr_res(par.db2.c_str(), par.db2Index.c_str(), par.threads, DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX);
     dbr_res.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    DBWriter resultWriter(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_ALIGNMENT_RES);
+    DBWriter resultWriter(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_ALIGNMENT_RES);
     resultWriter.open();
 
     EvalueComputation evaluer(tdbr.getAminoAcidDBSize(), subMat, par.gapOpen, par.gapExtend);
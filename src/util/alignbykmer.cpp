@@ -10,6 +10,7 @@
 #include "ReducedMatrix.h"
 #include "ExtendedSubstitutionMatrix.h"
 #include "IndexReader.h"
+#include "MemoryBudget.h"
 #include <string>
 #include <vector>
 
@@ -88,7 +89,7 @@ int alignbykmer(int argc, const char **argv, const Command &command) {
 
     EvalueComputation evaluer(tdbr->getAminoAcidDBSize(), subMat, par.gapOpen, par.gapExtend);
 
-    DBWriter resultWriter(par.db4.c_str(), par.db4Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_ALIGNMENT_RES);
+    DBWriter resultWriter(par.db4.c_str(), par.db4Index.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_ALIGNMENT_RES);
     resultWriter.open();
 
     struct KmerPos {
@@ -153,9 +154,8 @@ int alignbykmer(int argc, const char **argv, const Command &command) {
     };
 
 
-    size_t totalMemory = Util::getTotalSystemMemory();
     size_t flushSize = 100000000;
-    if (totalMemory > dbr_res.getTotalDataSize()) {
+    if (MemoryBudget::getLimit() > dbr_res.getTotalDataSize()) {
         flushSize = dbr_res.getSize();
     }
     size_t iterations = static_cast<int>(ceil(static_cast<double>(dbr_res.getSize()) / static_cast<double>(flushSize)));
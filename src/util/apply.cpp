@@ -333,7 +333,7 @@ int apply(int argc, const char **argv, const Command& command) {
                 std::pair<std::string, std::string> outDb = Util::createTmpFileNames(par.db2, par.db2Index, thread);
 #endif
 
-                DBWriter writer(outDb.first.c_str(), outDb.second.c_str(), 1, par.compressed, Parameters::DBTYPE_GENERIC_DB);
+                DBWriter writer(outDb.first.c_str(), outDb.second.c_str(), 1, par.writerMode(par.compressed), Parameters::DBTYPE_GENERIC_DB);
                 writer.open();
 
                 char **local_environ = local_environment();
@@ -346,13 +346,14 @@ int apply(int argc, const char **argv, const Command& command) {
                     }
 
                     unsigned int key = reader.getDbKey(i);
-                    char *data = reader.getData(i, thread);
+                    size_t entryLen;
+                    char *data = reader.getData(i, thread, &entryLen);
                     if (*data == '\0') {
                         writer.writeData(NULL, 0, key, 0);
                         continue;
                     }
 
-                    size_t size = reader.getEntryLen(i) - 1;
+                    size_t size = entryLen - 1;
                     int status = apply_by_entry(data, size, key, writer, par.restArgv[0], const_cast<char**>(par.restArgv), local_environ, 0);
                     if (status == -1) {
                         Debug(Debug::WARNING) << "Entry " << key << " system error number " << errno << "!\n";
@@ -400,7 +401,7 @@ int apply(int argc, const char **argv, const Command& command) {
     for (int proc_idx = 0; proc_idx < par.threads; ++proc_idx) {
         splitFiles.emplace_back(Util::createTmpFileNames(outDb.first, outDb.second, proc_idx));
     }
-    DBWriter::mergeResults(outDb.first, outDb.second, splitFiles);
+    DBWriter::mergeResults(outDb.first, outDb.second, splitFiles, par.binaryIndex);
 
 #ifdef HAVE_MPI
     MPI_Barrier(MPI_COMM_WORLD);
@@ -410,7 +411,7 @@ int apply(int argc, const char **argv, const Command& command) {
         for (int proc = 0; proc < MMseqsMPI::numProc; ++proc) {
             splitFiles.emplace_back(Util::createTmpFileNames(par.db2, par.db2Index, proc));
         }
-        DBWriter::mergeResults(par.db2, par.db2Index, splitFiles);
+        DBWriter::mergeResults(par.db2, par.db2Index, splitFiles, par.binaryIndex);
     }
 #endif
 
@@ -0,0 +1,24 @@
+#include "Parameters.h"
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "FileUtil.h"
+#include "Debug.h"
+
+int binaryindex(int argc, const char **argv, const Command& command) {
+    Parameters& par = Parameters::getInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    // without a text index the reader falls back to the binary index, the text index is restored from it
+    const bool restoreText = FileUtil::fileExists(par.db1Index.c_str()) == false;
+    DBReader<unsigned int> reader(par.db1.c_str(), par.db1Index.c_str(), 1, DBReader<unsigned int>::USE_INDEX);
+    reader.open(DBReader<unsigned int>::NOSORT);
+    if (restoreText) {
+        FILE *indexFile = FileUtil::openAndDelete(par.db1Index.c_str(), "w");
+        DBWriter::writeIndex(indexFile, reader.getSize(), reader.getIndex());
+        fclose(indexFile);
+        Debug(Debug::INFO) << "Restored " << par.db1Index << " from its binary index\n";
+    }
+    DBWriter::writeBinaryIndex(par.db1Index.c_str(), reader);
+    reader.close();
+    return EXIT_SUCCESS;
+}
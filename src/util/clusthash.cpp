@@ -32,7 +32,7 @@ int clusthash(int argc, const char **argv, const Command &command) {
         subMat = new ReducedMatrix(sMat.probMatrix, sMat.subMatrixPseudoCounts, sMat.aa2num, sMat.num2aa, sMat.alphabetSize, par.alphabetSize, 2.0);
     }
 
-    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_ALIGNMENT_RES);
+    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_ALIGNMENT_RES);
     writer.open();
     Debug(Debug::INFO) << "Hashing sequences...\n";
     std::pair<size_t, unsigned int> *hashSeqPair = new std::pair<size_t, unsigned int>[reader.getSize() + 1];
@@ -24,7 +24,7 @@ int doCompression(int argc, const char **argv, const Command& command, bool shou
 
     int dbtype = reader.getDbtype();
     dbtype = shouldCompress ? dbtype | (1 << 31) : dbtype & ~(1 << 31);
-    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, shouldCompress, dbtype);
+    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.writerMode(shouldCompress), dbtype);
     writer.open();
     Debug::Progress progress(reader.getSize());
 
@@ -38,7 +38,9 @@ int doCompression(int argc, const char **argv, const Command& command, bool shou
 #pragma omp for schedule(dynamic, 1)
         for (size_t i = 0; i < reader.getSize(); ++i) {
             progress.updateProgress();
-            writer.writeData(reader.getData(i, thread_idx), std::max(static_cast<unsigned int>(reader.getEntryLen(i)), 1u) - 1u, reader.getDbKey(i), thread_idx);
+            size_t entryLen;
+            char *data = reader.getData(i, thread_idx, &entryLen);
+            writer.writeData(data, std::max(entryLen, static_cast<size_t>(1)) - 1, reader.getDbKey(i), thread_idx);
         }
     }
     writer.close();
@@ -256,7 +256,11 @@ int convertalignments(int argc, const char **argv, const Command &command) {
         evaluer = new EvalueComputation(tDbr->sequenceReader->getAminoAcidDBSize(), subMat, par.gapOpen, par.gapExtend);
     }
 
-    DBReader<unsigned int> alnDbr(par.db3.c_str(), par.db3Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
+    // binary alignment records are read directly, everything else as text
+    const int alnDbtype = FileUtil::parseDbType(par.db3.c_str());
+    const bool isBinary = Parameters::isBinaryDbtype(alnDbtype) && Parameters::isEqualDbtype(alnDbtype, Parameters::DBTYPE_ALIGNMENT_RES);
+    DBReader<unsigned int> alnDbr(par.db3.c_str(), par.db3Index.c_str(), par.threads,
+                                  DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA|(isBinary ? DBReader<unsigned int>::USE_BINARY : 0));
     alnDbr.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
     unsigned int localThreads = 1;
@@ -266,7 +270,7 @@ int convertalignments(int argc, const char **argv, const Command &command) {
 
     const bool shouldCompress = par.dbOut == true && par.compressed == true;
     const int dbType = par.dbOut == true ? Parameters::DBTYPE_GENERIC_DB : Parameters::DBTYPE_OMIT_FILE;
-    DBWriter resultWriter(par.db4.c_str(), par.db4Index.c_str(), localThreads, shouldCompress, dbType);
+    DBWriter resultWriter(par.db4.c_str(), par.db4Index.c_str(), localThreads, par.writerMode(shouldCompress), dbType);
     resultWriter.open();
 
     const bool isDb = par.dbOut;
@@ -283,10 +287,18 @@ int convertalignments(int argc, const char **argv, const Command &command) {
 
         for (size_t i = 0; i < alnDbr.getSize(); i++) {
             char *data = alnDbr.getData(i, 0);
-            while (*data != '\0') {
-                char dbKeyBuffer[255 + 1];
-                Util::parseKey(data, dbKeyBuffer);
-                const unsigned int dbKey = (unsigned int) strtoul(dbKeyBuffer, NULL, 10);
+            const size_t binaryCount = isBinary ? BinaryResults::getCount(data) : 0;
+            size_t binaryPos = 0;
+            while (isBinary ? (binaryPos < binaryCount) : (*data != '\0')) {
+                unsigned int dbKey;
+                if (isBinary) {
+                    dbKey = BinaryResults::getAlignment(data, binaryPos++).dbKey;
+                } else {
+                    char dbKeyBuffer[255 + 1];
+                    Util::parseKey(data, dbKeyBuffer);
+                    dbKey = (unsigned int) strtoul(dbKeyBuffer, NULL, 10);
+                    data = Util::skipLine(data);
+                }
                 if (headerWritten[dbKey] == false) {
                     headerWritten[dbKey] = true;
                     unsigned int tId = tDbr->sequenceReader->getId(dbKey);
@@ -303,7 +315,6 @@ int convertalignments(int argc, const char **argv, const Command &command) {
                     resultWriter.writeAdd(buffer, count, 0);
                 }
                 resultWriter.writeEnd(0, 0, false, 0);
-                data = Util::skipLine(data);
             }
         }
         delete[] headerWritten;
@@ -369,9 +380,17 @@ int convertalignments(int argc, const char **argv, const Command &command) {
             }
 
             char *data = alnDbr.getData(i, thread_idx);
-            while (*data != '\0') {
-                Matcher::result_t res = Matcher::parseAlignmentRecord(data, true);
-                data = Util::skipLine(data);
+            const size_t binaryCount = isBinary ? BinaryResults::getCount(data) : 0;
+            size_t binaryPos = 0;
+            const char *binaryBacktraces = isBinary ? BinaryResults::getBacktraces(data, binaryCount) : NULL;
+            while (isBinary ? (binaryPos < binaryCount) : (*data != '\0')) {
+                Matcher::result_t res;
+                if (isBinary) {
+                    res = Matcher::binaryToResult(BinaryResults::getAlignment(data, binaryPos++), binaryBacktraces, true);
+                } else {
+                    res = Matcher::parseAlignmentRecord(data, true);
+                    data = Util::skipLine(data);
+                }
 
                 if (res.backtrace.empty() && needBacktrace == true) {
                     Debug(Debug::ERROR) << "Backtrace cigar is missing in the alignment result. Please recompute the alignment with the -a flag.\n"
@@ -21,7 +21,7 @@ int convertca3m(int argc, const char **argv, const Command &command) {
     DBReader<unsigned int> sequences((par.db1 + "_sequence.ffdata").c_str(), (par.db1 + "_sequence.ffindex").c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
     sequences.open(DBReader<unsigned int>::SORT_BY_LINE);
 
-    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_CA3M_DB);
+    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_CA3M_DB);
     writer.open();
 
     Debug::Progress progress(reader.getSize());
@@ -44,7 +44,9 @@ int convertca3m(int argc, const char **argv, const Command &command) {
             results.clear();
 
             unsigned int key;
-            CompressedA3M::extractMatcherResults(key, results, reader.getData(i, thread_idx), reader.getEntryLen(i), sequences, true);
+            size_t length;
+            char *data = reader.getData(i, thread_idx, &length);
+            CompressedA3M::extractMatcherResults(key, results, data, length, sequences, true);
 
             writer.writeStart(thread_idx);
             for (size_t j = 0; j < results.size(); j++) {
@@ -33,7 +33,7 @@ int convertmsa(int argc, const char **argv, const Command &command) {
         return EXIT_FAILURE;
     }
 
-    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), 1, par.compressed, Parameters::DBTYPE_MSA_DB);
+    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), 1, par.writerMode(par.compressed), Parameters::DBTYPE_MSA_DB);
     writer.open();
 
     std::string line;
@@ -140,10 +140,10 @@ int convertprofiledb(int argc, const char **argv, const Command &command) {
     DBReader<std::string> reader(data.c_str(), index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
     reader.open(DBReader<std::string>::NOSORT);
 
-    DBWriter profileWriter(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_HMM_PROFILE);
+    DBWriter profileWriter(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_HMM_PROFILE);
     profileWriter.open();
 
-    DBWriter headerWriter(par.hdr2.c_str(), par.hdr2Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_GENERIC_DB);
+    DBWriter headerWriter(par.hdr2.c_str(), par.hdr2Index.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_GENERIC_DB);
     headerWriter.open();
 
     SubstitutionMatrix subMat(par.scoringMatrixFile.aminoacids, 2.0, 0.0);
@@ -10,8 +10,212 @@
 #include "Debug.h"
 #include "Util.h"
 #include "KSeqWrapper.h"
+#include "KSeqBufferReader.h"
 #include "itoa.h"
 
+#include <algorithm>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+KSEQ_INIT(kseq_buffer_t*, kseq_buffer_reader)
+
+// entries of one input file, either a record aligned chunk of FASTA text that is parsed by a worker thread
+// or entries that were already parsed by the reading thread. The strings of all records are stored back to back in data
+struct SequenceChunk {
+    struct Record {
+        size_t name;
+        size_t nameLength;
+        size_t comment;
+        size_t commentLength;
+        size_t sequence;
+        size_t sequenceLength;
+        unsigned int id;
+    };
+
+    size_t fileIdx;
+    std::string input;
+    std::string data;
+    std::vector<Record> records;
+
+    void add(const kstring_t &name, const kstring_t &comment, const kstring_t &sequence) {
+        Record record;
+        record.name = data.size();
+        record.nameLength = name.l;
+        data.append(name.s, name.l);
+        record.comment = data.size();
+        record.commentLength = comment.l;
+        data.append(comment.s, comment.l);
+        record.sequence = data.size();
+        record.sequenceLength = sequence.l;
+        data.append(sequence.s, sequence.l);
+        record.id = 0;
+        records.push_back(record);
+    }
+
+    void parse() {
+        if (input.empty()) {
+            return;
+        }
+        kseq_buffer_t buffer(const_cast<char *>(input.c_str()), input.size());
+        kseq_t *seq = kseq_init(&buffer);
+        while (kseq_read(seq) >= 0) {
+            add(seq->name, seq->comment, seq->seq);
+        }
+        kseq_destroy(seq);
+        input.clear();
+    }
+
+    void clear() {
+        input.clear();
+        data.clear();
+        records.clear();
+    }
+};
+
+struct SequenceBatch {
+    // only the first chunkCount chunks are in use, the others keep their buffers
+    std::vector<SequenceChunk> chunks;
+    size_t chunkCount;
+    size_t bytes;
+    size_t entries;
+    // chunk and record indices of the entries that are written to each writer slot, in key order
+    std::vector<std::vector<std::pair<size_t, size_t> > > slots;
+
+    SequenceBatch() : chunkCount(0), bytes(0), entries(0) {}
+
+    SequenceChunk &addChunk(size_t fileIdx) {
+        if (chunkCount == chunks.size()) {
+            chunks.emplace_back();
+        }
+        SequenceChunk &chunk = chunks[chunkCount++];
+        chunk.clear();
+        chunk.fileIdx = fileIdx;
+        return chunk;
+    }
+
+    bool empty() const {
+        return chunkCount == 0;
+    }
+
+    void clear() {
+        chunkCount = 0;
+        bytes = 0;
+        entries = 0;
+        for (size_t i = 0; i < slots.size(); i++) {
+            slots[i].clear();
+        }
+    }
+};
+
+// decompressed bytes of a plain or gzip compressed input file
+struct RawInput {
+    FILE *file;
+#ifdef HAVE_ZLIB
+    gzFile gzipFile;
+#endif
+
+    RawInput(const std::string &fileName) : file(NULL) {
+#ifdef HAVE_ZLIB
+        gzipFile = NULL;
+        if (Util::endsWith(".gz", fileName)) {
+            gzipFile = gzopen(fileName.c_str(), "r");
+            if (gzipFile == NULL) {
+                perror(fileName.c_str());
+                EXIT(EXIT_FAILURE);
+            }
+            return;
+        }
+#endif
+        file = FileUtil::openFileOrDie(fileName.c_str(), "r", true);
+    }
+
+    ~RawInput() {
+        if (file != NULL) {
+            fclose(file);
+        }
+#ifdef HAVE_ZLIB
+        if (gzipFile != NULL) {
+            gzclose(gzipFile);
+        }
+#endif
+    }
+
+    size_t read(char *buffer, size_t size) {
+#ifdef HAVE_ZLIB
+        if (gzipFile != NULL) {
+            int count = gzread(gzipFile, buffer, static_cast<unsigned int>(size));
+            if (count < 0) {
+                Debug(Debug::ERROR) << "Can not decompress input\n";
+                EXIT(EXIT_FAILURE);
+            }
+            return static_cast<size_t>(count);
+        }
+#endif
+        return fread(buffer, sizeof(char), size, file);
+    }
+
+    // reads at least chunkSize bytes into chunk, starting with the rest of the previous chunk in carry.
+    // The chunk ends before the last line that starts with '>', which begins the next chunk. Returns false at the end of the file
+    bool readChunk(std::string &carry, std::string &chunk, size_t chunkSize) {
+        chunk.swap(carry);
+        carry.clear();
+        while (true) {
+            const size_t searchFrom = std::max(chunk.size(), static_cast<size_t>(1));
+            chunk.resize(chunk.size() + chunkSize);
+            const size_t count = read(&chunk[chunk.size() - chunkSize], chunkSize);
+            chunk.resize(chunk.size() - chunkSize + count);
+            if (count == 0) {
+                return chunk.empty() == false;
+            }
+            for (size_t i = chunk.size() - 1; i >= searchFrom; i--) {
+                if (chunk[i] == '>' && chunk[i - 1] == '\n') {
+                    carry.assign(chunk, i, std::string::npos);
+                    chunk.resize(i);
+                    return true;
+                }
+            }
+        }
+    }
+};
+
+// stdin and bzip2 input is parsed serially, like FASTQ input that is recognized by the first chunk
+static bool isChunkedInput(const std::string &fileName, bool softMode) {
+    return softMode == false && fileName != "stdin" && Util::endsWith(".bz2", fileName) == false;
+}
+
+static void sampleSequenceType(const char *sequence, size_t length, size_t &sampleCount, size_t &isNuclCnt) {
+    const size_t testForNucSequence = 100;
+    // check for the first 10 sequences if they are nucleotide sequences
+    if (sampleCount < 10 || (sampleCount % 100) == 0) {
+        if (sampleCount < testForNucSequence) {
+            size_t cnt = 0;
+            for (size_t i = 0; i < length; i++) {
+                switch (toupper(sequence[i])) {
+                    case 'T':
+                    case 'A':
+                    case 'G':
+                    case 'C':
+                    case 'U':
+                    case 'N':
+                        cnt++;
+                        break;
+                }
+            }
+            const float nuclDNAFraction = static_cast<float>(cnt) / static_cast<float>(length);
+            if (nuclDNAFraction > 0.9) {
+                isNuclCnt += true;
+            }
+        }
+        sampleCount++;
+    }
+}
+
 int createdb(int argc, const char **argv, const Command& command) {
     Parameters &par = Parameters::getInstance();
     par.parseParameters(argc, argv, command, true, Parameters::PARSE_VARIADIC, 0);
@@ -61,7 +265,6 @@ int createdb(int argc, const char **argv, const Command& command) {
 
     const char newline = '\n';
 
-    const size_t testForNucSequence = 100;
     size_t isNuclCnt = 0;
     Debug::Progress progress;
     std::vector<unsigned short>* sourceLookup = new std::vector<unsigned short>[shuffleSplits]();
@@ -78,109 +281,219 @@ int createdb(int argc, const char **argv, const Command& command) {
         Debug(Debug::ERROR) << "Can not open " << sourceFile << " for writing!\n";
         EXIT(EXIT_FAILURE);
     }
-    DBWriter hdrWriter(hdrDataFile.c_str(), hdrIndexFile.c_str(), shuffleSplits, par.compressed, Parameters::DBTYPE_GENERIC_DB);
+    // every writer slot is filled by one thread at a time in key order. With shuffling the slots are the shuffle
+    // splits, otherwise each thread gets a contiguous key range of every batch and the slots are merged in key
+    // order to keep the data file in input order
+    const bool softMode = par.createdbMode == Parameters::SEQUENCE_SPLIT_MODE_SOFT;
+    const unsigned int slots = par.shuffleDatabase ? shuffleSplits : (softMode ? 1 : static_cast<unsigned int>(std::max(par.threads, 1)));
+    const size_t writerMode = par.writerMode(par.compressed) | ((par.shuffleDatabase || softMode) ? 0 : Parameters::WRITER_KEY_ORDER_MODE);
+    DBWriter hdrWriter(hdrDataFile.c_str(), hdrIndexFile.c_str(), slots, writerMode, Parameters::DBTYPE_GENERIC_DB);
     hdrWriter.open();
-    DBWriter seqWriter(dataFile.c_str(), indexFile.c_str(), shuffleSplits, par.compressed, (dbType == -1) ? Parameters::DBTYPE_OMIT_FILE : dbType );
+    DBWriter seqWriter(dataFile.c_str(), indexFile.c_str(), slots, writerMode, (dbType == -1) ? Parameters::DBTYPE_OMIT_FILE : dbType );
     seqWriter.open();
-    for (size_t fileIdx = 0; fileIdx < filenames.size(); fileIdx++) {
-        unsigned int numEntriesInCurrFile = 0;
-        std::string header;
-        header.reserve(1024);
-
-        char buffer[4096];
-        size_t len = snprintf(buffer, sizeof(buffer), "%zu\t%s\n", fileIdx, FileUtil::baseName(filenames[fileIdx]).c_str());
-        int written = fwrite(buffer, sizeof(char), len, source);
-        if (written != (int) len) {
-            Debug(Debug::ERROR) << "Cannot write to source file " << sourceFile << "\n";
-            EXIT(EXIT_FAILURE);
-        }
-
-        KSeqWrapper* kseq = KSeqFactory(filenames[fileIdx].c_str());
-        while (kseq->ReadEntry()) {
-            progress.updateProgress();
-            const KSeqWrapper::KSeqEntry &e = kseq->entry;
-            if (e.name.l == 0) {
-                Debug(Debug::ERROR) << "Fasta entry: " << entries_num << " is invalid.\n";
-                EXIT(EXIT_FAILURE);
-            }
 
-            // header
-            if(par.createdbMode == Parameters::SEQUENCE_SPLIT_MODE_HARD){
-                header.append(e.name.s, e.name.l);
-                if (e.comment.l > 0) {
-                    header.append(" ", 1);
-                    header.append(e.comment.s, e.comment.l);
+    // three stage pipeline: thread 0 reads the record aligned chunks of the next batch while all threads
+    // parse the chunks of the current batch and write the entries of the previous one
+    const size_t chunkSize = 8 * 1024 * 1024;
+    const size_t batchBytes = static_cast<size_t>(std::max(par.threads, 1)) * chunkSize;
+    const size_t batchEntries = 1024 * 1024;
+    SequenceBatch batches[3];
+    for (size_t i = 0; i < 3; i++) {
+        batches[i].slots.resize(slots);
+    }
+    unsigned int current = 0;
+    size_t fileIdx = 0;
+    KSeqWrapper *kseq = NULL;
+    RawInput *rawInput = NULL;
+    std::string carry;
+    bool inputLeft = filenames.size() > 0;
+    bool redo = false;
+    do {
+        SequenceBatch &readBatch = batches[current];
+        SequenceBatch &parseBatch = batches[(current + 2) % 3];
+        SequenceBatch &writeBatch = batches[(current + 1) % 3];
+        size_t nextItem = 0;
+#pragma omp parallel num_threads(par.threads)
+        {
+            unsigned int thread_idx = 0;
+#ifdef OPENMP
+            thread_idx = static_cast<unsigned int>(omp_get_thread_num());
+#endif
+            while (thread_idx == 0 && inputLeft && readBatch.bytes < batchBytes && readBatch.entries < batchEntries) {
+                if (kseq == NULL && rawInput == NULL) {
+                    char buffer[4096];
+                    size_t len = snprintf(buffer, sizeof(buffer), "%zu\t%s\n", fileIdx, FileUtil::baseName(filenames[fileIdx]).c_str());
+                    int written = fwrite(buffer, sizeof(char), len, source);
+                    if (written != (int) len) {
+                        Debug(Debug::ERROR) << "Cannot write to source file " << sourceFile << "\n";
+                        EXIT(EXIT_FAILURE);
+                    }
+                    if (isChunkedInput(filenames[fileIdx], softMode)) {
+                        rawInput = new RawInput(filenames[fileIdx]);
+                        SequenceChunk &chunk = readBatch.addChunk(fileIdx);
+                        rawInput->readChunk(carry, chunk.input, chunkSize);
+                        readBatch.bytes += chunk.input.size();
+                        const size_t first = chunk.input.find_first_not_of(" \t\r\n");
+                        if (first == std::string::npos || chunk.input[first] != '>') {
+                            // not FASTA, parsed serially from the start of the file
+                            readBatch.bytes -= chunk.input.size();
+                            readBatch.chunkCount--;
+                            delete rawInput;
+                            rawInput = NULL;
+                            carry.clear();
+                            kseq = KSeqFactory(filenames[fileIdx].c_str());
+                        }
+                        continue;
+                    }
+                    kseq = KSeqFactory(filenames[fileIdx].c_str());
                 }
 
-                std::string headerId = Util::parseFastaHeader(header.c_str());
-                if (headerId.empty()) {
-                    // An identifier is necessary for these two cases, so we should just give up
-                    Debug(Debug::WARNING) << "Can not extract identifier from entry " << entries_num << ".\n";
+                bool fileDone;
+                if (rawInput != NULL) {
+                    SequenceChunk &chunk = readBatch.addChunk(fileIdx);
+                    fileDone = rawInput->readChunk(carry, chunk.input, chunkSize) == false;
+                    if (fileDone) {
+                        readBatch.chunkCount--;
+                    } else {
+                        readBatch.bytes += chunk.input.size();
+                    }
+                } else {
+                    fileDone = kseq->ReadEntry() == false;
                 }
-                header.push_back('\n');
-            }
-            unsigned int id = par.identifierOffset + entries_num;
-            if (dbType == -1) {
-                // check for the first 10 sequences if they are nucleotide sequences
-                if (sampleCount < 10 || (sampleCount % 100) == 0) {
-                    if (sampleCount < testForNucSequence) {
-                        size_t cnt = 0;
-                        for (size_t i = 0; i < e.sequence.l; i++) {
-                            switch (toupper(e.sequence.s[i])) {
-                                case 'T':
-                                case 'A':
-                                case 'G':
-                                case 'C':
-                                case 'U':
-                                case 'N':
-                                    cnt++;
-                                    break;
-                            }
-                        }
-                        const float nuclDNAFraction = static_cast<float>(cnt) / static_cast<float>(e.sequence.l);
-                        if (nuclDNAFraction > 0.9) {
-                            isNuclCnt += true;
+                if (fileDone) {
+                    delete kseq;
+                    kseq = NULL;
+                    delete rawInput;
+                    rawInput = NULL;
+                    fileIdx++;
+                    if (fileIdx == filenames.size()) {
+                        inputLeft = false;
+                    }
+                    continue;
+                }
+                if (kseq == NULL) {
+                    continue;
+                }
+
+                const KSeqWrapper::KSeqEntry &e = kseq->entry;
+                if (softMode) {
+                    progress.updateProgress();
+                    if (e.name.l == 0) {
+                        Debug(Debug::ERROR) << "Fasta entry: " << entries_num << " is invalid.\n";
+                        EXIT(EXIT_FAILURE);
+                    }
+                    if (dbType == -1) {
+                        sampleSequenceType(e.sequence.s, e.sequence.l, sampleCount, isNuclCnt);
+                        if (e.multiline == true) {
+                            redo = true;
+                            inputLeft = false;
+                            break;
                         }
                     }
-                    sampleCount++;
+                    unsigned int id = par.identifierOffset + entries_num;
+                    sourceLookup[id % shuffleSplits].emplace_back(fileIdx);
+                    // +2 to emulate the \n\0
+                    hdrWriter.writeIndexEntry(id, e.headerOffset, (e.sequenceOffset-e.headerOffset)+1, 0);
+                    seqWriter.writeIndexEntry(id, e.sequenceOffset, e.sequence.l+2, 0);
+                    entries_num++;
+                } else {
+                    // serially parsed entries of a file are collected in one chunk per batch
+                    if (readBatch.empty() || readBatch.chunks[readBatch.chunkCount - 1].fileIdx != fileIdx) {
+                        readBatch.addChunk(fileIdx);
+                    }
+                    SequenceChunk &chunk = readBatch.chunks[readBatch.chunkCount - 1];
+                    const size_t before = chunk.data.size();
+                    chunk.add(e.name, e.comment, e.sequence);
+                    readBatch.bytes += chunk.data.size() - before;
+                    readBatch.entries++;
                 }
-                if(par.createdbMode == Parameters::SEQUENCE_SPLIT_MODE_SOFT && e.multiline == true){
-                    Debug(Debug::WARNING) << "Multiline fasta can not be combined with --createdb-mode 0.\n";
-                    Debug(Debug::WARNING) << "We recompute with --createdb-mode 1.\n";
-                    par.createdbMode = Parameters::SEQUENCE_SPLIT_MODE_HARD;
-                    progress.reset(SIZE_MAX);
-                    hdrWriter.close();
-                    seqWriter.close();
-                    delete kseq;
-                    fclose(source);
-                    for (size_t i = 0; i < shuffleSplits; ++i) {
-                        sourceLookup[i].clear();
+            }
+
+            std::string header;
+            header.reserve(1024);
+            size_t item;
+            while ((item = __sync_fetch_and_add(&nextItem, 1)) < parseBatch.chunkCount + slots) {
+                if (item < parseBatch.chunkCount) {
+                    parseBatch.chunks[item].parse();
+                    continue;
+                }
+                const unsigned int slot = static_cast<unsigned int>(item - parseBatch.chunkCount);
+                const std::vector<std::pair<size_t, size_t> > &records = writeBatch.slots[slot];
+                for (size_t i = 0; i < records.size(); i++) {
+                    const SequenceChunk &chunk = writeBatch.chunks[records[i].first];
+                    const SequenceChunk::Record &record = chunk.records[records[i].second];
+                    const char *data = chunk.data.c_str();
+                    header.append(data + record.name, record.nameLength);
+                    if (record.commentLength > 0) {
+                        header.append(" ", 1);
+                        header.append(data + record.comment, record.commentLength);
+                    }
+
+                    std::string headerId = Util::parseFastaHeader(header.c_str());
+                    if (headerId.empty()) {
+                        // An identifier is necessary for these two cases, so we should just give up
+                        Debug(Debug::WARNING) << "Can not extract identifier from entry " << (record.id - par.identifierOffset) << ".\n";
                     }
-                    goto redoComputation;
+                    header.push_back('\n');
+
+                    hdrWriter.writeData(header.c_str(), header.length(), record.id, slot);
+                    seqWriter.writeStart(slot);
+                    seqWriter.writeAdd(data + record.sequence, record.sequenceLength, slot);
+                    seqWriter.writeAdd(&newline, 1, slot);
+                    seqWriter.writeEnd(record.id, slot, true);
+                    header.clear();
                 }
             }
+        }
 
-            // Finally write down the entry
-            unsigned int splitIdx = id % shuffleSplits;
-            sourceLookup[splitIdx].emplace_back(fileIdx);
-            if(par.createdbMode == Parameters::SEQUENCE_SPLIT_MODE_SOFT){
-                // +2 to emulate the \n\0
-                hdrWriter.writeIndexEntry(id, e.headerOffset, (e.sequenceOffset-e.headerOffset)+1, 0);
-                seqWriter.writeIndexEntry(id, e.sequenceOffset, e.sequence.l+2, 0);
-            }else{
-                hdrWriter.writeData(header.c_str(), header.length(), id, splitIdx);
-                seqWriter.writeStart(splitIdx);
-                seqWriter.writeAdd(e.sequence.s, e.sequence.l, splitIdx);
-                seqWriter.writeAdd(&newline, 1, splitIdx);
-                seqWriter.writeEnd(id, splitIdx, true);
+        if (redo) {
+            Debug(Debug::WARNING) << "Multiline fasta can not be combined with --createdb-mode 0.\n";
+            Debug(Debug::WARNING) << "We recompute with --createdb-mode 1.\n";
+            par.createdbMode = Parameters::SEQUENCE_SPLIT_MODE_HARD;
+            progress.reset(SIZE_MAX);
+            hdrWriter.close();
+            seqWriter.close();
+            delete kseq;
+            fclose(source);
+            for (size_t i = 0; i < shuffleSplits; ++i) {
+                sourceLookup[i].clear();
             }
+            entries_num = 0;
+            sampleCount = 0;
+            isNuclCnt = 0;
+            goto redoComputation;
+        }
 
-            entries_num++;
-            numEntriesInCurrFile++;
-            header.clear();
+        // keys are assigned in input order once the chunks of a batch are parsed
+        size_t batchRecords = 0;
+        for (size_t c = 0; c < parseBatch.chunkCount; c++) {
+            batchRecords += parseBatch.chunks[c].records.size();
         }
-        delete kseq;
-    }
+        size_t batchPos = 0;
+        for (size_t c = 0; c < parseBatch.chunkCount; c++) {
+            SequenceChunk &chunk = parseBatch.chunks[c];
+            for (size_t i = 0; i < chunk.records.size(); i++) {
+                SequenceChunk::Record &record = chunk.records[i];
+                progress.updateProgress();
+                if (record.nameLength == 0) {
+                    Debug(Debug::ERROR) << "Fasta entry: " << entries_num << " is invalid.\n";
+                    EXIT(EXIT_FAILURE);
+                }
+                if (dbType == -1) {
+                    sampleSequenceType(chunk.data.c_str() + record.sequence, record.sequenceLength, sampleCount, isNuclCnt);
+                }
+                record.id = par.identifierOffset + entries_num;
+                const unsigned int splitIdx = record.id % shuffleSplits;
+                sourceLookup[splitIdx].emplace_back(chunk.fileIdx);
+                const size_t slot = par.shuffleDatabase ? splitIdx : (batchPos * slots) / batchRecords;
+                parseBatch.slots[slot].push_back(std::make_pair(c, i));
+                batchPos++;
+                entries_num++;
+            }
+        }
+        writeBatch.clear();
+        current = (current + 1) % 3;
+    } while (inputLeft || batches[(current + 1) % 3].empty() == false || batches[(current + 2) % 3].empty() == false);
     Debug(Debug::INFO) << "\n";
     fclose(source);
     hdrWriter.close(true);
@@ -209,8 +522,21 @@ int createdb(int argc, const char **argv, const Command& command) {
     }
 
     // fix ids
-    DBWriter::createRenumberedDB(dataFile, indexFile, "", "", DBReader<unsigned int>::LINEAR_ACCCESS);
-    DBWriter::createRenumberedDB(hdrDataFile, hdrIndexFile, "", "", DBReader<unsigned int>::LINEAR_ACCCESS);
+#pragma omp parallel num_threads(std::min(par.threads, 2))
+    {
+#pragma omp single
+        {
+#pragma omp task
+            {
+                DBWriter::createRenumberedDB(dataFile, indexFile, "", "", par.binaryIndex, DBReader<unsigned int>::LINEAR_ACCCESS);
+            }
+
+#pragma omp task
+            {
+                DBWriter::createRenumberedDB(hdrDataFile, hdrIndexFile, "", "", par.binaryIndex, DBReader<unsigned int>::LINEAR_ACCCESS);
+            }
+        }
+    }
     if(par.createdbMode == Parameters::SEQUENCE_SPLIT_MODE_SOFT) {
         if(filenames.size() == 1){
             FileUtil::symlinkAbs(filenames[0], dataFile);
@@ -27,7 +27,7 @@ int createseqfiledb(int argc, const char **argv, const Command &command) {
     DBReader<unsigned int> resultDb(par.db2.c_str(), par.db2Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
     resultDb.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), static_cast<unsigned int>(par.threads), par.compressed, Parameters::DBTYPE_GENERIC_DB);
+    DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), static_cast<unsigned int>(par.threads), par.writerMode(par.compressed), Parameters::DBTYPE_GENERIC_DB);
     writer.open();
 
     Debug::Progress progress(resultDb.getSize());
@@ -46,9 +46,10 @@ int createseqfiledb(int argc, const char **argv, const Command &command) {
             progress.updateProgress();
 
             unsigned int key = resultDb.getDbKey(i);
-            char *data = resultDb.getData(i, thread_idx);
+            size_t entryLen;
+            char *data = resultDb.getData(i, thread_idx, &entryLen);
 
-            size_t entries = Util::countLines(data, resultDb.getEntryLen(i) - 1);
+            size_t entries = Util::countLines(data, entryLen - 1);
             if (entries < (unsigned int) par.minSequences || entries > (unsigned int) par.maxSequences) {
                 continue;
             }
@@ -131,7 +131,7 @@ int expandaln(int argc, const char **argv, const Command& command) {
     }
 
     Debug(Debug::INFO) << "Output database: " << par.db5 << "\n";
-    DBWriter writer(par.db5.c_str(), par.db5Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_ALIGNMENT_RES);
+    DBWriter writer(par.db5.c_str(), par.db5Index.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_ALIGNMENT_RES);
     writer.open();
 
     BacktraceTranslator translator;
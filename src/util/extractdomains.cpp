@@ -235,7 +235,7 @@ int doExtract(Parameters &par, DBReader<unsigned int> &blastTabReader,
     DBReader<unsigned int> msaReader(msaDataName.c_str(), msaIndexName.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
     msaReader.open(DBReader<unsigned int>::NOSORT);
 
-    DBWriter writer(resultdb.first.c_str(), resultdb.second.c_str(), static_cast<unsigned int>(par.threads), par.compressed, Parameters::DBTYPE_ALIGNMENT_RES);
+    DBWriter writer(resultdb.first.c_str(), resultdb.second.c_str(), static_cast<unsigned int>(par.threads), par.writerMode(par.compressed), Parameters::DBTYPE_ALIGNMENT_RES);
     writer.open();
 
     Debug::Progress progress(dbSize);
@@ -258,8 +258,9 @@ int doExtract(Parameters &par, DBReader<unsigned int> &blastTabReader,
             }
 
 
-            char *tabData = blastTabReader.getData(i, thread_idx);
-            size_t tabLength = blastTabReader.getEntryLen(i) - 1;
+            size_t tabLength;
+            char *tabData = blastTabReader.getData(i, thread_idx, &tabLength);
+            tabLength -= 1;
             const std::vector<Domain> result = getEntries(std::string(tabData, tabLength));
             if (result.size() == 0) {
                 Debug(Debug::WARNING) << "Can not map any entries for entry " << id << "!\n";
@@ -339,7 +340,7 @@ int doExtract(Parameters &par, const unsigned int mpiRank, const unsigned int mp
             std::pair<std::string, std::string> tmpFile = Util::createTmpFileNames(par.db3, par.db3Index, proc);
             splitFiles.push_back(std::make_pair(tmpFile.first,  tmpFile.second));
         }
-        DBWriter::mergeResults(par.db3, par.db3Index, splitFiles);
+        DBWriter::mergeResults(par.db3, par.db3Index, splitFiles, par.binaryIndex);
     }
 
     return status;
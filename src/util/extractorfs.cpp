@@ -29,10 +29,10 @@ int extractorfs(int argc, const char **argv, const Command& command) {
     if(par.translate) {
         outputDbtype = Parameters::DBTYPE_AMINO_ACIDS;
     }
-    DBWriter sequenceWriter(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.compressed, outputDbtype);
+    DBWriter sequenceWriter(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.writerMode(par.compressed), outputDbtype);
     sequenceWriter.open();
 
-    DBWriter headerWriter(par.hdr2.c_str(), par.hdr2Index.c_str(), par.threads, false, Parameters::DBTYPE_GENERIC_DB);
+    DBWriter headerWriter(par.hdr2.c_str(), par.hdr2Index.c_str(), par.threads, par.writerMode(false), Parameters::DBTYPE_GENERIC_DB);
     headerWriter.open();
 
     if ((par.orfStartMode == 1) && (par.contigStartMode < 2)) {
@@ -139,12 +139,12 @@ int extractorfs(int argc, const char **argv, const Command& command) {
         {
 #pragma omp task
             {
-                DBWriter::createRenumberedDB(par.hdr2, par.hdr2Index, "", "");
+                DBWriter::createRenumberedDB(par.hdr2, par.hdr2Index, "", "", par.binaryIndex);
             }
 
 #pragma omp task
             {
-                DBWriter::createRenumberedDB(par.db2, par.db2Index, par.createLookup ? par.db1 : "", par.createLookup ? par.db1Index : "");
+                DBWriter::createRenumberedDB(par.db2, par.db2Index, par.createLookup ? par.db1 : "", par.createLookup ? par.db1Index : "", par.binaryIndex);
             }
         }
     }
@@ -96,7 +96,7 @@ int filterdb(int argc, const char **argv, const Command &command) {
     DBReader<unsigned int> reader(par.db1.c_str(), par.db1Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
     reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.compressed, reader.getDbtype());
+    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.writerMode(par.compressed), reader.getDbtype());
     writer.open();
 
     // FILE_FILTERING
@@ -232,9 +232,9 @@ int filterdb(int argc, const char **argv, const Command &command) {
         for (size_t id = 0; id < reader.getSize(); ++id) {
             progress.updateProgress();
 
-            char *data = reader.getData(id, thread_idx);
+            size_t dataLength;
+            char *data = reader.getData(id, thread_idx, &dataLength);
             unsigned int queryKey = reader.getDbKey(id);
-            size_t dataLength = reader.getEntryLen(id);
             int counter = 0;
 
             bool addSelfMatch = false;
@@ -321,17 +321,18 @@ int filterdb(int argc, const char **argv, const Command &command) {
                         size_t originalLength = strlen(lineBuffer);
                         // Replace the last \n
                         lineBuffer[originalLength - 1] = '\t';
-                        char *fullLine = helper->getData(newId, thread_idx);
+                        // binary results are decoded, the length is the one of the decoded entry
+                        size_t fullLineLength;
+                        char *fullLine = helper->getData(newId, thread_idx, &fullLineLength);
                         if (columnToTake == -1) {
                             // either append the full line (default mode)
-                            size_t fullLineLength = helper->getEntryLen(newId);
                             // Appending join database entry to query database entry
                             memcpy(lineBuffer + originalLength, fullLine, fullLineLength);
                         } else if (*fullLine != '\0') {
                             // or a specified column
                             std::vector<std::string> splittedLine = Util::split(fullLine, "\t");
                             char *newValue = const_cast<char *>(splittedLine[columnToTake].c_str());
-                            size_t valueLength = helper->getEntryLen(newId);
+                            size_t valueLength = splittedLine[columnToTake].size() + 1;
                             // Appending join database entry to query database entry
                             memcpy(lineBuffer + originalLength, newValue, valueLength);
                         }
@@ -21,9 +21,9 @@ int gff2db(int argc, const char **argv, const Command &command) {
     DBReader<unsigned int> headerReader(par.hdr2.c_str(), par.hdr2Index.c_str(), 1, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
     headerReader.open(DBReader<unsigned int>::NOSORT);
 
-    DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), 1, par.compressed, Parameters::DBTYPE_NUCLEOTIDES);
+    DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), 1, par.writerMode(par.compressed), Parameters::DBTYPE_NUCLEOTIDES);
     writer.open();
-    DBWriter headerWriter(par.hdr3.c_str(), par.hdr3Index.c_str(), 1, par.compressed, Parameters::DBTYPE_GENERIC_DB);
+    DBWriter headerWriter(par.hdr3.c_str(), par.hdr3Index.c_str(), 1, par.writerMode(par.compressed), Parameters::DBTYPE_GENERIC_DB);
     headerWriter.open();
 
     bool shouldCompareType = par.gffType.length() > 0;
@@ -4,16 +4,20 @@
 #include "PrefilteringIndexReader.h"
 #include "Prefiltering.h"
 #include "Parameters.h"
+#include "MemoryBudget.h"
 
 #ifdef OPENMP
 #include <omp.h>
 #endif
 
+// every appended split is searched in its own prefilter step, they are merged before there are more
+static const int MAX_APPENDED_SPLITS = 4;
+
 void setIndexDbDefaults(Parameters *p) {
     p->sensitivity = 5.7;
 }
 
-std::string findIncompatibleParameter(DBReader<unsigned int>& index, const Parameters& par, const int dbtype) {
+std::string findIncompatibleParameter(DBReader<unsigned int>& index, const Parameters& par, const int dbtype, const size_t dbSize) {
     PrefilteringIndexData meta = PrefilteringIndexReader::getMetadata(&index);
     if (meta.compBiasCorr != par.compBiasCorrection)
         return "compBiasCorrection";
@@ -35,6 +39,14 @@ std::string findIncompatibleParameter(DBReader<unsigned int>& index, const Param
         return "seedScoringMatrixFile";
     if (par.spacedKmerPattern != PrefilteringIndexReader::getSpacedPattern(&index))
         return "spacedKmerPattern";
+    if (PrefilteringIndexReader::isCompressed(&index) != (par.indexCompression != 0))
+        return "indexCompression";
+    DBReader<unsigned int> *indexedDbr = PrefilteringIndexReader::openNewReader(&index, PrefilteringIndexReader::DBR1DATA, PrefilteringIndexReader::DBR1INDEX, false, 1, false, false);
+    const size_t indexedSize = indexedDbr->getSize();
+    indexedDbr->close();
+    delete indexedDbr;
+    if (indexedSize != dbSize)
+        return "database";
     return "";
 }
 
@@ -60,16 +72,11 @@ int indexdb(int argc, const char **argv, const Command &command) {
     BaseMatrix *seedSubMat = Prefiltering::getSubstitutionMatrix(par.seedScoringMatrixFile, par.alphabetSize, 8.0f, false, (db1IsNucl && db2IsNucl));
 
     // memoryLimit in bytes
-    size_t memoryLimit;
-    if (par.splitMemoryLimit > 0) {
-        memoryLimit = par.splitMemoryLimit;
-    } else {
-        memoryLimit = static_cast<size_t>(Util::getTotalSystemMemory() * 0.9);
-    }
+    size_t memoryLimit = MemoryBudget::getLimit();
 
     int splitMode = Parameters::TARGET_DB_SPLIT;
     par.maxResListLen = std::min(dbr.getSize(), par.maxResListLen);
-    Prefiltering::setupSplit(dbr, seedSubMat->alphabetSize - 1, dbr.getDbtype(), par.threads, false, memoryLimit, 1, par.maxResListLen, par.kmerSize, par.split, splitMode);
+    Prefiltering::setupSplit(dbr, seedSubMat->alphabetSize - 1, dbr.getDbtype(), par.threads, false, memoryLimit, 1, par.maxResListLen, par.kmerSize, par.split, splitMode, par.indexCompression != 0);
 
     bool kScoreSet = false;
     for (size_t i = 0; i < par.indexdb.size(); i++) {
@@ -95,8 +102,10 @@ int indexdb(int argc, const char **argv, const Command &command) {
 
     int status = EXIT_SUCCESS;
     bool recreate = true;
+    bool append = false;
+    bool compact = false;
     std::string indexDbType = indexDB + ".dbtype";
-    if (par.checkCompatible > 0 && FileUtil::fileExists(indexDbType.c_str())) {
+    if ((par.checkCompatible > 0 || par.indexAppend || par.indexCompact) && FileUtil::fileExists(indexDbType.c_str())) {
         Debug(Debug::INFO) << "Check index " << indexDB << "\n";
         DBReader<unsigned int> index(indexDB.c_str(), (indexDB + ".index").c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
         index.open(DBReader<unsigned int>::NOSORT);
@@ -106,11 +115,21 @@ int indexdb(int argc, const char **argv, const Command &command) {
         }
 
         std::string check;
-        const bool compatible = PrefilteringIndexReader::checkIfIndexFile(&index) && (check = findIncompatibleParameter(index, par, dbr.getDbtype())) == "";
+        const bool compatible = PrefilteringIndexReader::checkIfIndexFile(&index) && (check = findIncompatibleParameter(index, par, dbr.getDbtype(), dbr.getSize())) == "";
+        const int appendedSplits = (check == "database") ? PrefilteringIndexReader::getAppendedSplits(&index) : 0;
         index.close();
         if (compatible) {
             Debug(Debug::INFO) << "Index is up to date and compatible. Force recreation with --check-compatibility 0 parameter.\n";
             recreate = false;
+            compact = par.indexCompact;
+        } else if (par.indexAppend && check == "database") {
+            Debug(Debug::INFO) << "Index is compatible, the sequences added to the database will be appended\n";
+            append = true;
+            recreate = false;
+            if (appendedSplits >= MAX_APPENDED_SPLITS) {
+                Debug(Debug::INFO) << "Index has " << appendedSplits << " appended splits, they will be merged with the new one\n";
+            }
+            compact = par.indexCompact || appendedSplits >= MAX_APPENDED_SPLITS;
         } else {
             if (par.checkCompatible == 2) {
                 Debug(Debug::ERROR) << "Index is incompatible. Incompatible parameter: " << check << "\n";
@@ -123,7 +142,7 @@ int indexdb(int argc, const char **argv, const Command &command) {
         }
     }
 
-    if (recreate) {
+    if (recreate || append || compact) {
         DBReader<unsigned int> hdbr1(par.hdr1.c_str(), par.hdr1Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
         hdbr1.open(DBReader<unsigned int>::NOSORT);
 
@@ -133,11 +152,26 @@ int indexdb(int argc, const char **argv, const Command &command) {
             hdbr2->open(DBReader<unsigned int>::NOSORT);
         }
 
-        DBReader<unsigned int>::removeDb(indexDB);
-        PrefilteringIndexReader::createIndexFile(indexDB, &dbr, dbr2, &hdbr1, hdbr2, seedSubMat, par.maxSeqLen,
-                                                 par.spacedKmer, par.spacedKmerPattern, par.compBiasCorrection,
-                                                 seedSubMat->alphabetSize, par.kmerSize, par.maskMode, par.maskLowerCaseMode,
-                                                 par.kmerScore, par.split);
+        if (append && PrefilteringIndexReader::appendToIndexFile(indexDB, &dbr, &hdbr1, seedSubMat, par.maxSeqLen,
+                                                                 par.spacedKmer, par.spacedKmerPattern, par.compBiasCorrection,
+                                                                 seedSubMat->alphabetSize, par.kmerSize, par.maskMode, par.maskLowerCaseMode,
+                                                                 par.kmerScore, par.indexCompression) == false) {
+            Debug(Debug::WARNING) << "Index can not be appended to and will be recreated\n";
+            recreate = true;
+        }
+
+        if (compact && recreate == false && PrefilteringIndexReader::compactIndexFile(indexDB) == false) {
+            Debug(Debug::WARNING) << "Index can not be compacted and will be recreated\n";
+            recreate = true;
+        }
+
+        if (recreate) {
+            DBReader<unsigned int>::removeDb(indexDB);
+            PrefilteringIndexReader::createIndexFile(indexDB, &dbr, dbr2, &hdbr1, hdbr2, seedSubMat, par.maxSeqLen,
+                                                     par.spacedKmer, par.spacedKmerPattern, par.compBiasCorrection,
+                                                     seedSubMat->alphabetSize, par.kmerSize, par.maskMode, par.maskLowerCaseMode,
+                                                     par.kmerScore, par.split, par.indexCompression);
+        }
 
         if (hdbr2 != NULL) {
             hdbr2->close();
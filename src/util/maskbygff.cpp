@@ -82,21 +82,24 @@ int maskbygff(int argc, const char **argv, const Command& command) {
     }
     gffFile.close();
 
-    DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), 1, par.compressed, reader.getDbtype());
+    DBWriter writer(par.db3.c_str(), par.db3Index.c_str(), 1, par.writerMode(par.compressed), reader.getDbtype());
     writer.open();
 
     DBReader<std::string> headerReader(par.hdr2.c_str(), par.hdr2Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
     headerReader.open(DBReader<std::string>::NOSORT);
 
-    DBWriter headerWriter(par.hdr3.c_str(), par.hdr3Index.c_str(), 1, par.compressed, Parameters::DBTYPE_GENERIC_DB);
+    DBWriter headerWriter(par.hdr3.c_str(), par.hdr3Index.c_str(), 1, par.writerMode(par.compressed), Parameters::DBTYPE_GENERIC_DB);
     headerWriter.open();
 
     for(size_t i = 0; i < reader.getSize(); ++i ) {
         unsigned int id = par.identifierOffset + i;
 
         // ignore nulls
-        writer.writeData(reader.getData(i, 0), reader.getEntryLen(i) - 1, id);
-        headerWriter.writeData(headerReader.getData(i, 0), headerReader.getEntryLen(i) - 1, id);
+        size_t length;
+        char *data = reader.getData(i, 0, &length);
+        writer.writeData(data, length - 1, id);
+        char *header = headerReader.getData(i, 0, &length);
+        headerWriter.writeData(header, length - 1, id);
     }
     headerWriter.close();
     writer.close();
@@ -107,7 +107,7 @@ int mergeclusters(int argc, const char **argv, const Command &command) {
     }
 
     Debug(Debug::INFO) << "Write merged clustering\n";
-    DBWriter dbw(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_CLUSTER_RES);
+    DBWriter dbw(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_CLUSTER_RES);
     dbw.open();
     progress.reset(dbr.getSize());
 #pragma omp parallel
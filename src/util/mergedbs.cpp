@@ -22,8 +22,9 @@ int mergedbs(int argc, const char **argv, const Command& command) {
     std::vector<std::string> prefixes = Util::split(par.mergePrefixes, ",");
     const bool touch = (par.preloadMode != Parameters::PRELOAD_MODE_MMAP);
     IndexReader qDbr(par.db1, par.threads,  IndexReader::SEQUENCES, (touch) ? (IndexReader::PRELOAD_INDEX | IndexReader::PRELOAD_DATA) : 0, DBReader<unsigned int>::USE_INDEX);
-    int dbtype = FileUtil::parseDbType(filenames[0].first.c_str());
-    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), 1, par.compressed, dbtype);
+    // binary results are decoded while merging and written as text
+    int dbtype = FileUtil::parseDbType(filenames[0].first.c_str()) & ~Parameters::DBTYPE_EXTENDED_BINARY;
+    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), 1, par.writerMode(par.compressed), dbtype);
     writer.open();
     writer.mergeFiles(*qDbr.sequenceReader, filenames, prefixes);
     writer.close();
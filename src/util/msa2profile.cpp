@@ -6,6 +6,7 @@
 #include "FileUtil.h"
 #include "CompressedA3M.h"
 #include "MathUtil.h"
+#include "simd.h"
 
 #include "kseq.h"
 #include "KSeqBufferReader.h"
@@ -113,10 +114,10 @@ int msa2profile(int argc, const char **argv, const Command &command) {
     maxSeqLength *= (VECSIZE_INT * 4);
 
     unsigned int threads = (unsigned int) par.threads;
-    DBWriter resultWriter(par.db2.c_str(), par.db2Index.c_str(), threads, par.compressed, Parameters::DBTYPE_HMM_PROFILE);
+    DBWriter resultWriter(par.db2.c_str(), par.db2Index.c_str(), threads, par.writerMode(par.compressed), Parameters::DBTYPE_HMM_PROFILE);
     resultWriter.open();
 
-    DBWriter headerWriter(par.hdr2.c_str(), par.hdr2Index.c_str(), threads, par.compressed, Parameters::DBTYPE_GENERIC_DB);
+    DBWriter headerWriter(par.hdr2.c_str(), par.hdr2Index.c_str(), threads, par.writerMode(par.compressed), Parameters::DBTYPE_GENERIC_DB);
     headerWriter.open();
 
     Debug::Progress progress(qDbr.getSize());
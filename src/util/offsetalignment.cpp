@@ -331,7 +331,7 @@ int offsetalignment(int argc, const char **argv, const Command &command) {
     }
 
     Debug(Debug::INFO) << "Writing results to: " << par.db6 << "\n";
-    DBWriter resultWriter(par.db6.c_str(), par.db6Index.c_str(), localThreads, par.compressed, Parameters::DBTYPE_ALIGNMENT_RES);
+    DBWriter resultWriter(par.db6.c_str(), par.db6Index.c_str(), localThreads, par.writerMode(par.compressed), Parameters::DBTYPE_ALIGNMENT_RES);
     resultWriter.open();
 
     size_t entryCount = alnDbr.getSize();
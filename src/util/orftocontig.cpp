@@ -23,7 +23,7 @@ int orftocontig(int argn, const char **argv, const Command& command) {
     orfHeadersReader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
     // writing in alignment format:
-    DBWriter alignmentFormatWriter(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_ALIGNMENT_RES);
+    DBWriter alignmentFormatWriter(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_ALIGNMENT_RES);
     alignmentFormatWriter.open();
     Debug::Progress progress(orfHeadersReader.getSize());
 
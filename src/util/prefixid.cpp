@@ -10,14 +10,13 @@
 
 
 int addid(const std::string &db1, const std::string &db1Index, const std::string &db2, const std::string &db2Index,
-const bool tsvOut, const std::string &mappingFile, const std::string &userStrToAdd, const bool isPrefix, const int threads, const int compressed) {
+const bool tsvOut, const std::string &mappingFile, const std::string &userStrToAdd, const bool isPrefix, const int threads, const size_t writerMode) {
     DBReader<unsigned int> reader(db1.c_str(), db1Index.c_str(), threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
     reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    const bool shouldCompress = tsvOut == false && compressed == true;
     // TODO: does generic db make more sense than copying db type here?
     const int dbType = tsvOut == true ? Parameters::DBTYPE_OMIT_FILE : reader.getDbtype();
-    DBWriter writer(db2.c_str(), db2Index.c_str(), threads, shouldCompress, dbType);
+    DBWriter writer(db2.c_str(), db2Index.c_str(), threads, writerMode, dbType);
     writer.open();
     const bool shouldWriteNullByte = !tsvOut;
 
@@ -86,12 +85,12 @@ const bool tsvOut, const std::string &mappingFile, const std::string &userStrToA
 int prefixid(int argc, const char **argv, const Command& command) {
     Parameters& par = Parameters::getInstance();
     par.parseParameters(argc, argv, command, true, 0, 0);
-    return(addid(par.db1, par.db1Index, par.db2, par.db2Index, par.tsvOut, par.mappingFile, par.prefix, true, par.threads, par.compressed));
+    return(addid(par.db1, par.db1Index, par.db2, par.db2Index, par.tsvOut, par.mappingFile, par.prefix, true, par.threads, par.writerMode(par.tsvOut == false && par.compressed == true)));
 }
 
 int suffixid(int argc, const char **argv, const Command& command) {
     Parameters& par = Parameters::getInstance();
     par.parseParameters(argc, argv, command, true, 0, 0);
-    return(addid(par.db1, par.db1Index, par.db2, par.db2Index, par.tsvOut, par.mappingFile, par.prefix, false, par.threads, par.compressed));
+    return(addid(par.db1, par.db1Index, par.db2, par.db2Index, par.tsvOut, par.mappingFile, par.prefix, false, par.threads, par.writerMode(par.tsvOut == false && par.compressed == true)));
 }
 
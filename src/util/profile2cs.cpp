@@ -30,7 +30,7 @@ int profile2cs(int argc, const char **argv, const Command &command) {
             dbIndex +=  "." + SSTR(alphabetSize[i]);
         }
         dbIndex += ".index";
-        DBWriter writer(dbName.c_str(), dbIndex.c_str(), par.threads, par.compressed, Parameters::DBTYPE_PROFILE_STATE_SEQ);
+        DBWriter writer(dbName.c_str(), dbIndex.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_PROFILE_STATE_SEQ);
         writer.open();
         size_t alphSize = alphabetSize[i];
         size_t entries = profileReader.getSize();
@@ -21,7 +21,7 @@ int profile2pssm(int argc, const char **argv, const Command &command) {
     const bool isDbOutput = par.dbOut;
     const bool shouldCompress = isDbOutput == true && par.compressed == true;
     const int dbType = isDbOutput == true ? Parameters::DBTYPE_GENERIC_DB : Parameters::DBTYPE_OMIT_FILE;
-    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, shouldCompress, dbType);
+    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.writerMode(shouldCompress), dbType);
     writer.open();
 
     SubstitutionMatrix subMat(par.scoringMatrixFile.aminoacids, 2.0f, 0.0);
@@ -17,7 +17,7 @@ int profile2seq(int argc, const char **argv, const Command &command, bool consen
     DBReader<unsigned int> reader(par.db1.c_str(), par.db1Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
     reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_AMINO_ACIDS);
+    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_AMINO_ACIDS);
     writer.open();
 
     SubstitutionMatrix subMat(par.scoringMatrixFile.aminoacids, 2.0f, 0.0);
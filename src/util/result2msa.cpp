@@ -63,7 +63,7 @@ int result2msa(Parameters &par, const std::string &resultData, const std::string
     DBReader<unsigned int> resultReader(par.db3.c_str(), par.db3Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
     resultReader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    size_t mode = par.compressed;
+    size_t mode = par.writerMode(par.compressed);
     int type = Parameters::DBTYPE_MSA_DB;
     if (par.compressMSA) {
         mode |= Parameters::WRITER_LEXICOGRAPHIC_MODE;
@@ -121,6 +121,12 @@ int result2msa(Parameters &par, const std::string &resultData, const std::string
         for (size_t id = dbFrom; id < (dbFrom + dbSize); id++) {
             progress.updateProgress();
 
+            // the next entry of the chunk is read while this one is computed
+            if (id + 1 < dbFrom + dbSize) {
+                resultReader.readahead(id + 1, thread_idx);
+                qDbr.readahead(qDbr.getId(resultReader.getDbKey(id + 1)), thread_idx);
+            }
+
             // Get the sequence from the queryDB
             unsigned int queryKey = resultReader.getDbKey(id);
             size_t queryId = qDbr.getId(queryKey);
@@ -440,7 +446,7 @@ int result2msa(Parameters &par, const unsigned int mpiRank, const unsigned int m
             splitFiles.push_back(std::make_pair(tmpFile.first, tmpFile.second));
 
         }
-        DBWriter::mergeResults(outDb, outIndex, splitFiles, par.compressMSA);
+        DBWriter::mergeResults(outDb, outIndex, splitFiles, par.binaryIndex, par.compressMSA);
     }
 
     return status;
@@ -45,7 +45,7 @@ int computeProfileProfile(Parameters &par,const std::string &outpath,
 
     DBReader<unsigned int> *resultReader = new DBReader<unsigned int>(par.db3.c_str(), par.db3Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
     resultReader->open(DBReader<unsigned int>::LINEAR_ACCCESS);
-    DBWriter resultWriter(outpath.c_str(), (outpath + ".index").c_str(), par.threads, par.compressed, Parameters::DBTYPE_HMM_PROFILE);
+    DBWriter resultWriter(outpath.c_str(), (outpath + ".index").c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_HMM_PROFILE);
     resultWriter.open();
     SubstitutionMatrix subMat(par.scoringMatrixFile.aminoacids, 2.0f, 0.0f);
 
@@ -313,7 +313,7 @@ int computeProfileProfile(Parameters &par,const unsigned int mpiRank, const unsi
             splitFiles.push_back(std::make_pair(tmpFile.first ,  tmpFile.first + ".index"));
 
         }
-        DBWriter::mergeResults(outname , outname + ".index", splitFiles);
+        DBWriter::mergeResults(outname , outname + ".index", splitFiles, par.binaryIndex);
     }
 
     return status;
@@ -71,7 +71,7 @@ int result2profile(DBReader<unsigned int> &resultReader, Parameters &par, const
         tDbr->readMmapedDataInMemory();
     }
 
-    DBWriter resultWriter(outDb.c_str(), outIndex.c_str(), localThreads, par.compressed, Parameters::DBTYPE_HMM_PROFILE);
+    DBWriter resultWriter(outDb.c_str(), outIndex.c_str(), localThreads, par.writerMode(par.compressed), Parameters::DBTYPE_HMM_PROFILE);
     resultWriter.open();
 
     // + 1 for query
@@ -126,6 +126,12 @@ int result2profile(DBReader<unsigned int> &resultReader, Parameters &par, const
         for (size_t id = dbFrom; id < (dbFrom + dbSize); id++) {
             progress.updateProgress();
 
+            // the next entry of the chunk is read while this one is computed
+            if (id + 1 < dbFrom + dbSize) {
+                resultReader.readahead(id + 1, thread_idx);
+                qDbr->readahead(qDbr->getId(resultReader.getDbKey(id + 1)), thread_idx);
+            }
+
             unsigned int queryKey = resultReader.getDbKey(id);
             size_t queryId = qDbr->getId(queryKey);
             if (queryId == UINT_MAX) {
@@ -135,24 +141,44 @@ int result2profile(DBReader<unsigned int> &resultReader, Parameters &par, const
             centerSequence.mapSequence(0, queryKey, qDbr->getData(queryId, thread_idx), qDbr->getSeqLen(queryId));
 
             char *data = resultReader.getData(id, thread_idx);
-            while (*data != '\0') {
-                Util::parseKey(data, dbKey);
-                const unsigned int key = (unsigned int) strtoul(dbKey, NULL, 10);
-                // in the same database case, we have the query repeated
-                if ((key == queryKey && sameDatabase == true)) {
-                    data = Util::skipLine(data);
-                    continue;
-                }
+            const bool binaryEntry = resultReader.isBinary();
+            const size_t binaryCount = binaryEntry ? BinaryResults::getCount(data) : 0;
+            size_t binaryPos = 0;
+            const char *binaryBacktraces = binaryEntry ? BinaryResults::getBacktraces(data, binaryCount) : NULL;
+            while (binaryEntry ? (binaryPos < binaryCount) : (*data != '\0')) {
+                unsigned int key;
+                bool hasInclusionEval;
+                if (binaryEntry) {
+                    const Matcher::result_bin_t record = BinaryResults::getAlignment(data, binaryPos++);
+                    key = record.dbKey;
+                    // in the same database case, we have the query repeated
+                    if ((key == queryKey && sameDatabase == true)) {
+                        continue;
+                    }
+                    hasInclusionEval = (static_cast<float>(record.eval) < par.evalProfile);
+                    if (hasInclusionEval && record.backtraceLength > 0) {
+                        alnResults.push_back(Matcher::binaryToResult(record, binaryBacktraces));
+                    }
+                } else {
+                    Util::parseKey(data, dbKey);
+                    key = (unsigned int) strtoul(dbKey, NULL, 10);
+                    // in the same database case, we have the query repeated
+                    if ((key == queryKey && sameDatabase == true)) {
+                        data = Util::skipLine(data);
+                        continue;
+                    }
 
-                const size_t columns = Util::getWordsOfLine(data, entry, 255);
-                float evalue = 0.0;
-                if (columns >= 4) {
-                    evalue = strtod(entry[3], NULL);
-                }
-                bool hasInclusionEval = (evalue < par.evalProfile);
-                if (hasInclusionEval && columns > Matcher::ALN_RES_WITH_OUT_BT_COL_CNT) {
-                    Matcher::result_t res = Matcher::parseAlignmentRecord(data);
-                    alnResults.push_back(res);
+                    const size_t columns = Util::getWordsOfLine(data, entry, 255);
+                    float evalue = 0.0;
+                    if (columns >= 4) {
+                        evalue = strtod(entry[3], NULL);
+                    }
+                    hasInclusionEval = (evalue < par.evalProfile);
+                    if (hasInclusionEval && columns > Matcher::ALN_RES_WITH_OUT_BT_COL_CNT) {
+                        Matcher::result_t res = Matcher::parseAlignmentRecord(data);
+                        alnResults.push_back(res);
+                    }
+                    data = Util::skipLine(data);
                 }
                 if (hasInclusionEval) {
                     const size_t edgeId = tDbr->getId(key);
@@ -164,7 +190,6 @@ int result2profile(DBReader<unsigned int> &resultReader, Parameters &par, const
                     edgeSequence->mapSequence(0, key, tDbr->getData(edgeId, thread_idx), tDbr->getSeqLen(edgeId));
                     seqSet.push_back(edgeSequence);
                 }
-                data = Util::skipLine(data);
             }
 
             // Recompute if not all the backtraces are present
@@ -275,7 +300,7 @@ int result2profile(DBReader<unsigned int> &resultReader, Parameters &par, const
             splitFiles.push_back(std::make_pair(tmpFile.first, tmpFile.second));
 
         }
-        DBWriter::mergeResults(outname, outnameIndex, splitFiles);
+        DBWriter::mergeResults(outname, outnameIndex, splitFiles, par.binaryIndex);
     }
 
     return status;
@@ -293,7 +318,11 @@ int result2profile(int argc, const char **argv, const Command &command) {
     par.evalProfile = (par.evalThr < par.evalProfile) ? par.evalThr : par.evalProfile;
     par.printParameters(command.cmd, argc, argv, *command.params);
 
-    DBReader<unsigned int> resultReader(par.db3.c_str(), par.db3Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    // binary alignment records are read directly, everything else as text
+    const int resultDbtype = FileUtil::parseDbType(par.db3.c_str());
+    const bool isBinary = Parameters::isBinaryDbtype(resultDbtype) && Parameters::isEqualDbtype(resultDbtype, Parameters::DBTYPE_ALIGNMENT_RES);
+    DBReader<unsigned int> resultReader(par.db3.c_str(), par.db3Index.c_str(), par.threads,
+                                        DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA | (isBinary ? DBReader<unsigned int>::USE_BINARY : 0));
     resultReader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 #ifdef HAVE_MPI
     size_t dbFrom = 0;
@@ -14,7 +14,7 @@ int result2rbh(int argc, const char **argv, const Command &command) {
     DBReader<unsigned int> resultReader(par.db1.c_str(), par.db1Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
     resultReader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    DBWriter dbw(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.compressed, resultReader.getDbtype());
+    DBWriter dbw(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.writerMode(par.compressed), resultReader.getDbtype());
     dbw.open();
     Debug::Progress progress(resultReader.getSize());
 
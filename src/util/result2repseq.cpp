@@ -18,7 +18,7 @@ int result2repseq(int argc, const char **argv, const Command &command) {
     DBReader<unsigned int> resultReader(par.db2.c_str(), par.db2Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
     resultReader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
 
-    DBWriter resultWriter(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.compressed, seqReader.getDbtype());
+    DBWriter resultWriter(par.db3.c_str(), par.db3Index.c_str(), par.threads, par.writerMode(par.compressed), seqReader.getDbtype());
     resultWriter.open();
     Debug::Progress progress(resultReader.getSize());
 
@@ -42,7 +42,9 @@ int result2repseq(int argc, const char **argv, const Command &command) {
             Util::parseKey(results, dbKey);
             const unsigned int key = (unsigned int) strtoul(dbKey, NULL, 10);
             const size_t edgeId = seqReader.getId(key);
-            resultWriter.writeData(seqReader.getData(edgeId, thread_idx), seqReader.getEntryLen(edgeId) - 1, resultReader.getDbKey(id), thread_idx);
+            size_t length;
+            char *data = seqReader.getData(edgeId, thread_idx, &length);
+            resultWriter.writeData(data, length - 1, resultReader.getDbKey(id), thread_idx);
         }
     }
     resultWriter.close(true);
@@ -59,7 +59,7 @@ StatsComputer::StatsComputer(const Parameters &par)
 
     const bool shouldCompress = tsvOut == false && par.compressed == true;
     const int dbType = tsvOut == true ? Parameters::DBTYPE_OMIT_FILE : Parameters::DBTYPE_GENERIC_DB;
-    statWriter = new DBWriter(par.db4.c_str(), par.db4Index.c_str(), (unsigned int) par.threads, shouldCompress, dbType);
+    statWriter = new DBWriter(par.db4.c_str(), par.db4Index.c_str(), (unsigned int) par.threads, par.writerMode(shouldCompress), dbType);
     statWriter->open();
 }
 
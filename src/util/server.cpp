@@ -0,0 +1,513 @@
+#include "Util.h"
+#include "Parameters.h"
+#include "Debug.h"
+#include "DBReader.h"
+#include "Matcher.h"
+#include "Alignment.h"
+#include "Prefiltering.h"
+#include "PrefilteringIndexReader.h"
+#include "QueryMatcher.h"
+#include "SubstitutionMatrix.h"
+#include "ExtendedSubstitutionMatrix.h"
+#include "FileUtil.h"
+#include "Timer.h"
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+// The server keeps the index table, the sequence lookup and the target sequences of a precomputed
+// index (createindex) in memory. They are only read after loading, so all worker threads share them.
+// A client connects to the unix socket, sends query sequences in FASTA format and closes its writing
+// side. The server then streams back one line per accepted alignment:
+// queryId targetId score seqId eval qStart qEnd qLen tStart tEnd tLen [backtrace]
+// Failed requests are answered with a line: ERROR <message>
+// The requests of all connected clients are read concurrently, so a client that is slow to send its request
+// does not hold up the others. Complete requests are answered one after the other, each with all threads.
+
+// a client has to send its request within this time and size
+static const int READ_TIMEOUT_SECONDS = 60;
+static const size_t MAX_REQUEST_SIZE = 256 * 1024 * 1024;
+// a client that does not read its results for this time is dropped
+static const int SEND_TIMEOUT_SECONDS = 60;
+// clients that are still sending their request
+static const size_t MAX_CLIENTS = 64;
+
+static volatile sig_atomic_t serverStop = 0;
+
+static void handleStopSignal(int) {
+    serverStop = 1;
+}
+
+static void setSignalHandler(int signal, void (*handler)(int)) {
+    struct sigaction action;
+    action.sa_handler = handler;
+    sigemptyset(&action.sa_mask);
+    // no SA_RESTART, accept has to return to notice serverStop
+    action.sa_flags = 0;
+    sigaction(signal, &action, NULL);
+}
+
+struct FastaEntry {
+    std::string name;
+    std::string sequence;
+};
+
+struct Client {
+    int fd;
+    time_t deadline;
+    std::string request;
+};
+
+enum RequestState {
+    REQUEST_READING,
+    REQUEST_COMPLETE,
+    REQUEST_FAILED
+};
+
+static void parseFasta(const std::string &data, std::vector<FastaEntry> &entries) {
+    size_t pos = 0;
+    while (pos < data.size()) {
+        size_t lineEnd = data.find('\n', pos);
+        if (lineEnd == std::string::npos) {
+            lineEnd = data.size();
+        }
+        if (data[pos] == '>') {
+            FastaEntry entry;
+            entry.name = Util::parseFastaHeader(data.c_str() + pos + 1);
+            entries.push_back(entry);
+        } else if (entries.empty() == false) {
+            std::string &sequence = entries.back().sequence;
+            for (size_t i = pos; i < lineEnd; i++) {
+                if (isspace(data[i]) == false) {
+                    sequence.push_back(data[i]);
+                }
+            }
+        }
+        pos = lineEnd + 1;
+    }
+}
+
+static bool sendAll(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t written = send(fd, data, length, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        length -= written;
+    }
+    return true;
+}
+
+static void sendError(int fd, const std::string &message) {
+    Debug(Debug::WARNING) << message << "\n";
+    std::string line = "ERROR\t" + message + "\n";
+    sendAll(fd, line.c_str(), line.size());
+}
+
+// reads what a non-blocking client has sent so far,
+// the request ends when the client shuts down its side of the connection
+static RequestState readRequest(Client &client, char *buffer, size_t bufferSize) {
+    while (true) {
+        ssize_t count = read(client.fd, buffer, bufferSize);
+        if (count == 0) {
+            return REQUEST_COMPLETE;
+        }
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return REQUEST_READING;
+            }
+            Debug(Debug::WARNING) << "Could not read request: " << strerror(errno) << "\n";
+            return REQUEST_FAILED;
+        }
+        if (client.request.size() + count > MAX_REQUEST_SIZE) {
+            sendError(client.fd, "Request exceeds " + SSTR(MAX_REQUEST_SIZE) + " bytes");
+            return REQUEST_FAILED;
+        }
+        client.request.append(buffer, count);
+    }
+}
+
+static void setNonBlocking(int fd, bool nonBlocking) {
+    const int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, nonBlocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+}
+
+int server(int argc, const char **argv, const Command &command) {
+    Parameters &par = Parameters::getInstance();
+    par.parseParameters(argc, argv, command, true, 0, 0);
+
+    std::string indexDB = par.db1;
+    if (Parameters::isEqualDbtype(FileUtil::parseDbType(indexDB.c_str()), Parameters::DBTYPE_INDEX_DB) == false) {
+        indexDB = PrefilteringIndexReader::searchForIndex(par.db1);
+        if (indexDB.empty()) {
+            Debug(Debug::ERROR) << "No index found for " << par.db1 << ". Please create one with createindex!\n";
+            EXIT(EXIT_FAILURE);
+        }
+    }
+
+    Timer timer;
+    DBReader<unsigned int> tidxdbr(indexDB.c_str(), (indexDB + ".index").c_str(), par.threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+    tidxdbr.open(DBReader<unsigned int>::NOSORT);
+    if (PrefilteringIndexReader::checkIfIndexFile(&tidxdbr) == false) {
+        Debug(Debug::ERROR) << "Outdated index version. Please recompute it with 'createindex'!\n";
+        EXIT(EXIT_FAILURE);
+    }
+    PrefilteringIndexReader::printSummary(&tidxdbr);
+    PrefilteringIndexData data = PrefilteringIndexReader::getMetadata(&tidxdbr);
+    if (Parameters::isEqualDbtype(data.seqType, Parameters::DBTYPE_AMINO_ACIDS) == false) {
+        Debug(Debug::ERROR) << "Only protein sequence indices are supported by server\n";
+        EXIT(EXIT_FAILURE);
+    }
+    // the server keeps a single index table in memory, the tables of appended splits would not be searched
+    const int appendedSplits = PrefilteringIndexReader::getAppendedSplits(&tidxdbr);
+    if (appendedSplits > 0) {
+        Debug(Debug::ERROR) << "Index has " << appendedSplits << " appended splits. Please merge them with 'createindex --compact 1' to use it with server\n";
+        EXIT(EXIT_FAILURE);
+    }
+    if (data.splits != 1) {
+        Debug(Debug::ERROR) << "Index was created with --split " << data.splits << ". Please recreate it with --split 1 to use it with server\n";
+        EXIT(EXIT_FAILURE);
+    }
+
+    // the page cache backs the index, unless it was explicitly requested to be read into private memory
+    int preloadMode = par.preloadMode;
+    if (preloadMode == Parameters::PRELOAD_MODE_AUTO) {
+        preloadMode = Parameters::PRELOAD_MODE_MMAP_TOUCH;
+    }
+    const bool touch = (preloadMode != Parameters::PRELOAD_MODE_MMAP);
+    DBReader<unsigned int> *tdbr = PrefilteringIndexReader::openNewReader(&tidxdbr, PrefilteringIndexReader::DBR1DATA, PrefilteringIndexReader::DBR1INDEX, true, par.threads, touch, touch);
+    if (tdbr == NULL) {
+        Debug(Debug::ERROR) << "Index does not contain the target sequences. Please recreate it with 'createindex'!\n";
+        EXIT(EXIT_FAILURE);
+    }
+    DBReader<unsigned int> *thdbr;
+    if (data.headers1 == 1) {
+        thdbr = PrefilteringIndexReader::openNewHeaderReader(&tidxdbr, PrefilteringIndexReader::HDR1DATA, PrefilteringIndexReader::HDR1INDEX, par.threads, touch, touch);
+    } else {
+        std::string headerDB = PrefilteringIndexReader::dbPathWithoutIndex(indexDB) + "_h";
+        thdbr = new DBReader<unsigned int>(headerDB.c_str(), (headerDB + ".index").c_str(), par.threads, DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA);
+        thdbr->open(DBReader<unsigned int>::NOSORT);
+        if (touch) {
+            thdbr->readMmapedDataInMemory();
+        }
+    }
+
+    const int querySeqType = Parameters::DBTYPE_AMINO_ACIDS;
+    const int alphabetSize = data.alphabetSize;
+    const int kmerSize = data.kmerSize;
+    const bool spacedKmer = data.spacedKmer != 0;
+    const bool aaBiasCorrection = data.compBiasCorr != 0;
+    const std::string spacedKmerPattern = PrefilteringIndexReader::getSpacedPattern(&tidxdbr);
+    const size_t maxSeqLen = std::max(par.maxSeqLen, (size_t) data.maxSeqLength);
+    const size_t maxResListLen = std::min(tdbr->getSize(), par.maxResListLen);
+    const short kmerThr = Prefiltering::getKmerThreshold(par.sensitivity, false, par.kmerScore, kmerSize);
+    const bool takeOnlyBestKmer = (par.exactKmerMatching == 1);
+
+    BaseMatrix *kmerSubMat = Prefiltering::getSubstitutionMatrix(par.seedScoringMatrixFile, alphabetSize, 8.0, false, false);
+    BaseMatrix *ungappedSubMat = Prefiltering::getSubstitutionMatrix(par.scoringMatrixFile, alphabetSize, 2.0, false, false);
+    ScoreMatrix _2merSubMatrix = PrefilteringIndexReader::get2MerScoreMatrix(&tidxdbr, preloadMode);
+    ScoreMatrix _3merSubMatrix = PrefilteringIndexReader::get3MerScoreMatrix(&tidxdbr, preloadMode);
+    IndexTable *indexTable = PrefilteringIndexReader::getIndexTable(0, &tidxdbr, preloadMode);
+    SequenceLookup *sequenceLookup = NULL;
+    // only the ungapped alignment needs the sequence lookup
+    if (par.diagonalScoring) {
+        sequenceLookup = PrefilteringIndexReader::getSequenceLookup(0, &tidxdbr, preloadMode);
+    }
+
+    // keep score bias at 0.0 (improved ROC)
+    SubstitutionMatrix subMat(par.scoringMatrixFile.aminoacids, 2.0, par.scoreBias);
+    EvalueComputation evaluer(tdbr->getAminoAcidDBSize(), &subMat, par.gapOpen, par.gapExtend);
+    unsigned int swMode = Matcher::SCORE_ONLY;
+    if (par.addBacktrace || par.alignmentMode == Parameters::ALIGNMENT_MODE_SCORE_COV_SEQID
+        || (par.alignmentMode == Parameters::ALIGNMENT_MODE_FAST_AUTO && par.covThr > 0.0 && par.seqIdThr > 0.0)) {
+        swMode = Matcher::SCORE_COV_SEQID;
+    } else if (par.alignmentMode == Parameters::ALIGNMENT_MODE_SCORE_COV
+               || (par.alignmentMode == Parameters::ALIGNMENT_MODE_FAST_AUTO && par.covThr > 0.0)) {
+        swMode = Matcher::SCORE_COV;
+    }
+    const bool addBacktrace = par.addBacktrace;
+    Debug(Debug::INFO) << "Index loaded in " << timer.lap() << "\n";
+
+    // the thread specific state is created once and reused by every request
+    unsigned int threads = static_cast<unsigned int>(par.threads);
+    std::vector<Sequence *> kmerSeqs(threads);
+    std::vector<Sequence *> querySeqs(threads);
+    std::vector<Sequence *> targetSeqs(threads);
+    std::vector<QueryMatcher *> prefilters(threads);
+    std::vector<Matcher *> aligners(threads);
+    for (unsigned int i = 0; i < threads; i++) {
+        kmerSeqs[i] = new Sequence(maxSeqLen, querySeqType, kmerSubMat, kmerSize, spacedKmer, aaBiasCorrection, true, spacedKmerPattern);
+        querySeqs[i] = new Sequence(maxSeqLen, querySeqType, &subMat, 0, false, par.compBiasCorrection);
+        targetSeqs[i] = new Sequence(maxSeqLen, data.seqType, &subMat, 0, false, par.compBiasCorrection);
+        prefilters[i] = new QueryMatcher(indexTable, sequenceLookup, kmerSubMat, ungappedSubMat,
+                                         kmerThr, kmerSize, tdbr->getSize(), maxSeqLen, maxResListLen, aaBiasCorrection,
+                                         par.diagonalScoring, par.minDiagScoreThr, takeOnlyBestKmer);
+        if (_3merSubMatrix.isValid() && _2merSubMatrix.isValid()) {
+            prefilters[i]->setSubstitutionMatrix(&_3merSubMatrix, &_2merSubMatrix);
+        } else {
+            prefilters[i]->setSubstitutionMatrix(NULL, NULL);
+        }
+        aligners[i] = new Matcher(querySeqType, maxSeqLen, &subMat, &evaluer, par.compBiasCorrection, par.gapOpen, par.gapExtend);
+    }
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd == -1) {
+        Debug(Debug::ERROR) << "Could not create socket: " << strerror(errno) << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (par.db2.size() >= sizeof(address.sun_path)) {
+        Debug(Debug::ERROR) << "Socket path " << par.db2 << " is too long\n";
+        EXIT(EXIT_FAILURE);
+    }
+    strncpy(address.sun_path, par.db2.c_str(), sizeof(address.sun_path) - 1);
+    // remove a stale socket of a previous server, but never a regular file
+    struct stat st;
+    if (lstat(par.db2.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        unlink(par.db2.c_str());
+    }
+    if (bind(listenFd, (struct sockaddr *) &address, sizeof(address)) == -1) {
+        Debug(Debug::ERROR) << "Could not bind socket " << par.db2 << ": " << strerror(errno) << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    if (listen(listenFd, 16) == -1) {
+        Debug(Debug::ERROR) << "Could not listen on socket " << par.db2 << ": " << strerror(errno) << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    setSignalHandler(SIGINT, handleStopSignal);
+    setSignalHandler(SIGTERM, handleStopSignal);
+    setNonBlocking(listenFd, true);
+    Debug(Debug::INFO) << "Listening on " << par.db2 << "\n";
+
+    std::vector<Client> clients;
+    std::vector<Client> completed;
+    std::vector<struct pollfd> pollFds;
+    std::vector<FastaEntry> queries;
+    char readBuffer[65536];
+    while (serverStop == 0) {
+        // the listening socket is followed by the clients in the order of the clients vector
+        time_t now = time(NULL);
+        int pollTimeout = -1;
+        pollFds.resize(clients.size() + 1);
+        pollFds[0].fd = listenFd;
+        pollFds[0].events = POLLIN;
+        pollFds[0].revents = 0;
+        for (size_t i = 0; i < clients.size(); i++) {
+            pollFds[i + 1].fd = clients[i].fd;
+            pollFds[i + 1].events = POLLIN;
+            pollFds[i + 1].revents = 0;
+            const int remaining = static_cast<int>(std::max(clients[i].deadline - now, static_cast<time_t>(0))) * 1000;
+            pollTimeout = (pollTimeout == -1) ? remaining : std::min(pollTimeout, remaining);
+        }
+        if (poll(pollFds.data(), pollFds.size(), pollTimeout) == -1) {
+            if (errno != EINTR) {
+                Debug(Debug::WARNING) << "Could not wait for connections: " << strerror(errno) << "\n";
+            }
+            continue;
+        }
+
+        now = time(NULL);
+        size_t kept = 0;
+        for (size_t i = 0; i < clients.size(); i++) {
+            RequestState state = REQUEST_READING;
+            if (pollFds[i + 1].revents != 0) {
+                state = readRequest(clients[i], readBuffer, sizeof(readBuffer));
+            }
+            if (state == REQUEST_READING && now >= clients[i].deadline) {
+                sendError(clients[i].fd, "Request was not completed within " + SSTR(READ_TIMEOUT_SECONDS) + " seconds");
+                state = REQUEST_FAILED;
+            }
+            if (state == REQUEST_COMPLETE) {
+                completed.push_back(Client());
+                completed.back().fd = clients[i].fd;
+                completed.back().request.swap(clients[i].request);
+            } else if (state == REQUEST_FAILED) {
+                close(clients[i].fd);
+            } else {
+                if (kept != i) {
+                    clients[kept].fd = clients[i].fd;
+                    clients[kept].deadline = clients[i].deadline;
+                    clients[kept].request.swap(clients[i].request);
+                }
+                kept++;
+            }
+        }
+        clients.resize(kept);
+
+        if (pollFds[0].revents & POLLIN) {
+            int clientFd = accept(listenFd, NULL, NULL);
+            if (clientFd == -1) {
+                if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
+                    Debug(Debug::WARNING) << "Could not accept connection: " << strerror(errno) << "\n";
+                }
+            } else if (clients.size() >= MAX_CLIENTS) {
+                sendError(clientFd, "Server is already reading the requests of " + SSTR(MAX_CLIENTS) + " clients");
+                close(clientFd);
+            } else {
+                // a client that never finishes its request must not block the server
+                setNonBlocking(clientFd, true);
+                clients.push_back(Client());
+                clients.back().fd = clientFd;
+                clients.back().deadline = now + READ_TIMEOUT_SECONDS;
+            }
+        }
+
+        // requests are answered in the order they were completed
+        for (size_t c = 0; c < completed.size(); c++) {
+            const int clientFd = completed[c].fd;
+            // results are sent with blocking writes, a client that stops reading them is dropped
+            setNonBlocking(clientFd, false);
+            struct timeval timeout;
+            timeout.tv_sec = SEND_TIMEOUT_SECONDS;
+            timeout.tv_usec = 0;
+            setsockopt(clientFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            queries.clear();
+            parseFasta(completed[c].request, queries);
+            completed[c].request.clear();
+            timer.reset();
+
+            // results are computed in parallel but sent in the order of the queries
+            std::atomic<bool> clientLost(false);
+#pragma omp parallel num_threads(threads)
+            {
+                unsigned int thread_idx = 0;
+#ifdef OPENMP
+                thread_idx = static_cast<unsigned int>(omp_get_thread_num());
+#endif
+                Sequence &kmerSeq = *kmerSeqs[thread_idx];
+                Sequence &qSeq = *querySeqs[thread_idx];
+                Sequence &dbSeq = *targetSeqs[thread_idx];
+                QueryMatcher &prefilter = *prefilters[thread_idx];
+                Matcher &matcher = *aligners[thread_idx];
+
+                char buffer[1024 + 32768];
+                std::string result;
+                result.reserve(1024 * 1024);
+                std::vector<Matcher::result_t> swResults;
+                swResults.reserve(300);
+
+#pragma omp for schedule(dynamic, 1) ordered
+                for (size_t id = 0; id < queries.size(); id++) {
+                    const FastaEntry &query = queries[id];
+                    // the sequence, prefilter and alignment buffers are allocated for maxSeqLen residues
+                    if (clientLost.load() == false && query.sequence.size() > maxSeqLen) {
+                        result.append("ERROR\tQuery " + query.name + " is longer than the maximum sequence length " + SSTR(maxSeqLen) + "\n");
+                    } else if (clientLost.load() == false && query.sequence.empty() == false) {
+                        kmerSeq.mapSequence(id, id, query.sequence.c_str(), query.sequence.size());
+                        std::pair<hit_t *, size_t> prefResults = prefilter.matchQuery(&kmerSeq, UINT_MAX);
+
+                        qSeq.mapSequence(id, id, query.sequence.c_str(), query.sequence.size());
+                        matcher.initQuery(&qSeq);
+                        const float queryLength = static_cast<float>(qSeq.L);
+                        size_t passedNum = 0;
+                        int rejected = 0;
+                        for (size_t i = 0; i < prefResults.second && passedNum < static_cast<size_t>(par.maxAccept) && rejected < par.maxRejected; i++) {
+                            const hit_t &hit = prefResults.first[i];
+                            const unsigned int dbKey = tdbr->getDbKey(hit.seqId);
+                            const unsigned int dbLength = tdbr->getSeqLen(hit.seqId);
+                            if (Util::canBeCovered(par.covThr, par.covMode, queryLength, static_cast<float>(dbLength)) == false) {
+                                rejected++;
+                                continue;
+                            }
+                            dbSeq.mapSequence(hit.seqId, dbKey, tdbr->getData(hit.seqId, thread_idx), dbLength);
+                            Matcher::result_t res = matcher.getSWResult(&dbSeq, static_cast<short>(hit.diagonal), false, par.covMode, par.covThr,
+                                                                        par.evalThr, swMode, par.seqIdMode, false);
+                            if (Alignment::checkCriteria(res, false, par.evalThr, par.seqIdThr, par.alnLenThr, par.covMode, par.covThr)) {
+                                swResults.emplace_back(res);
+                                passedNum++;
+                                rejected = 0;
+                            } else {
+                                rejected++;
+                            }
+                        }
+                        if (swResults.size() > 1) {
+                            std::sort(swResults.begin(), swResults.end(), Matcher::compareHits);
+                        }
+
+                        for (size_t i = 0; i < swResults.size(); i++) {
+                            size_t headerId = thdbr->getId(swResults[i].dbKey);
+                            if (headerId == UINT_MAX) {
+                                result.append("ERROR\tTarget " + SSTR(swResults[i].dbKey) + " of query " + query.name + " is not contained in the target header database\n");
+                                continue;
+                            }
+                            std::string targetId = Util::parseFastaHeader(thdbr->getData(headerId, thread_idx));
+                            size_t len = Matcher::resultToBuffer(buffer, swResults[i], addBacktrace);
+                            // replace the target key by its identifier
+                            char *record = strchr(buffer, '\t');
+                            result.append(query.name);
+                            result.push_back('\t');
+                            result.append(targetId);
+                            result.append(record, len - (record - buffer));
+                        }
+                        swResults.clear();
+                    }
+
+#pragma omp ordered
+                    {
+                        if (clientLost.load() == false && sendAll(clientFd, result.c_str(), result.size()) == false) {
+                            Debug(Debug::WARNING) << "Client closed connection: " << strerror(errno) << "\n";
+                            clientLost.store(true);
+                        }
+                    }
+                    result.clear();
+                }
+            }
+            close(clientFd);
+            Debug(Debug::INFO) << "Answered " << queries.size() << " queries in " << timer.lap() << "\n";
+        }
+        completed.clear();
+    }
+
+    Debug(Debug::INFO) << "Shutting down server\n";
+    for (size_t i = 0; i < clients.size(); i++) {
+        close(clients[i].fd);
+    }
+    close(listenFd);
+    unlink(par.db2.c_str());
+
+    for (unsigned int i = 0; i < threads; i++) {
+        delete aligners[i];
+        delete prefilters[i];
+        delete targetSeqs[i];
+        delete querySeqs[i];
+        delete kmerSeqs[i];
+    }
+    delete indexTable;
+    if (sequenceLookup != NULL) {
+        delete sequenceLookup;
+    }
+    if (preloadMode == Parameters::PRELOAD_MODE_FREAD) {
+        ExtendedSubstitutionMatrix::freeScoreMatrix(_3merSubMatrix);
+        ExtendedSubstitutionMatrix::freeScoreMatrix(_2merSubMatrix);
+    }
+    delete ungappedSubMat;
+    delete kmerSubMat;
+    thdbr->close();
+    delete thdbr;
+    tdbr->close();
+    delete tdbr;
+    tidxdbr.close();
+
+    return EXIT_SUCCESS;
+}
@@ -24,7 +24,7 @@ int splitdb(int argc, const char **argv, const Command& command) {
 
     for (int split = 0; split < par.split; split++) {
         std::string outDb = par.db2 + "_" + SSTR(split) + "_" + SSTR(par.split);
-        DBWriter writer(outDb.c_str(), std::string(outDb + ".index").c_str(), 1, par.compressed, dbr.getDbtype());
+        DBWriter writer(outDb.c_str(), std::string(outDb + ".index").c_str(), 1, par.writerMode(par.compressed), dbr.getDbtype());
         writer.open();
 
         size_t startIndex = 0;
@@ -37,8 +37,9 @@ int splitdb(int argc, const char **argv, const Command& command) {
 
         for (size_t i = startIndex; i < (startIndex + domainSize); i++) {
             unsigned int outerKey = dbr.getDbKey(i);
-            char *data = dbr.getData(i, 0);
-            writer.writeData(data, dbr.getEntryLen(i), outerKey);
+            size_t entryLen;
+            char *data = dbr.getData(i, 0, &entryLen);
+            writer.writeData(data, entryLen, outerKey);
         }
         writer.close();
     }
@@ -47,10 +47,10 @@ int splitsequence(int argc, const char **argv, const Command& command) {
         par.compressed = 0;
     }
 
-    DBWriter sequenceWriter(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.compressed, reader.getDbtype());
+    DBWriter sequenceWriter(par.db2.c_str(), par.db2Index.c_str(), par.threads, par.writerMode(par.compressed), reader.getDbtype());
     sequenceWriter.open();
 
-    DBWriter headerWriter(par.hdr2.c_str(), par.hdr2Index.c_str(), par.threads, false, Parameters::DBTYPE_GENERIC_DB);
+    DBWriter headerWriter(par.hdr2.c_str(), par.hdr2Index.c_str(), par.threads, par.writerMode(false), Parameters::DBTYPE_GENERIC_DB);
     headerWriter.open();
 
     size_t sequenceOverlap = par.sequenceOverlap;
@@ -126,12 +126,12 @@ int splitsequence(int argc, const char **argv, const Command& command) {
         {
 #pragma omp task
             {
-                DBWriter::createRenumberedDB(par.hdr2, par.hdr2Index, "", "");
+                DBWriter::createRenumberedDB(par.hdr2, par.hdr2Index, "", "", par.binaryIndex);
             }
 
 #pragma omp task
             {
-                DBWriter::createRenumberedDB(par.db2, par.db2Index, par.createLookup ? par.db1 : "", par.createLookup ? par.db1Index : "");
+                DBWriter::createRenumberedDB(par.db2, par.db2Index, par.createLookup ? par.db1 : "", par.createLookup ? par.db1Index : "", par.binaryIndex);
             }
         }
     }
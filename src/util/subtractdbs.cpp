@@ -19,7 +19,7 @@
 #endif
 
 void dosubstractresult(std::string leftDb, std::string rightDb, std::string outDb,
-                       size_t maxLineLength, double evalThreshold, int threads, int compressed)
+                       size_t maxLineLength, double evalThreshold, int threads, size_t writerMode)
 {
     Debug(Debug::INFO) << "Remove " << rightDb << " ids from " << leftDb << "\n";
     DBReader<unsigned int> leftDbr(leftDb.c_str(), (leftDb + std::string(".index")).c_str(), threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
@@ -28,7 +28,7 @@ void dosubstractresult(std::string leftDb, std::string rightDb, std::string outD
     rightDbr.open(DBReader<unsigned int>::NOSORT);
 
     Debug(Debug::INFO) << "Output databse: " << outDb << "\n";
-    DBWriter writer(outDb.c_str(), (outDb + std::string(".index")).c_str(), threads, compressed, leftDbr.getDbtype());
+    DBWriter writer(outDb.c_str(), (outDb + std::string(".index")).c_str(), threads, writerMode, leftDbr.getDbtype());
     writer.open();
     const size_t LINE_BUFFER_SIZE = 1000000;
 #pragma omp parallel
@@ -121,6 +121,6 @@ int subtractdbs(int argc, const char **argv, const Command& command) {
     par.evalProfile = (par.evalThr < par.evalProfile) ? par.evalThr : par.evalProfile;
     std::vector<MMseqsParameter*>* params = command.params;
     par.printParameters(command.cmd, argc, argv, *params);
-    dosubstractresult(par.db1, par.db2, par.db3, 1000000, par.evalProfile, par.threads, par.compressed);
+    dosubstractresult(par.db1, par.db2, par.db3, 1000000, par.evalProfile, par.threads, par.writerMode(par.compressed));
     return EXIT_SUCCESS;
 }
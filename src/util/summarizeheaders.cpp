@@ -22,7 +22,7 @@ int summarizeheaders(int argc, const char **argv, const Command& command) {
     DBReader<unsigned int> reader(par.db3.c_str(), par.db3Index.c_str(), par.threads, DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_DATA);
     reader.open(DBReader<unsigned int>::NOSORT);
 
-    DBWriter writer(par.db4.c_str(), par.db4Index.c_str(), par.threads, par.compressed, Parameters::DBTYPE_GENERIC_DB);
+    DBWriter writer(par.db4.c_str(), par.db4Index.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_GENERIC_DB);
     writer.open();
 
     HeaderSummarizer * summarizer;
@@ -34,7 +34,7 @@ int summarizeresult(int argc, const char **argv, const Command &command) {
 #endif
 
     unsigned int localThreads = std::min((unsigned int)par.threads, (unsigned int)dbSize);
-    DBWriter writer(outData, outIndex, localThreads, par.compressed, Parameters::DBTYPE_ALIGNMENT_RES);
+    DBWriter writer(outData, outIndex, localThreads, par.writerMode(par.compressed), Parameters::DBTYPE_ALIGNMENT_RES);
     writer.open();
 
     Debug::Progress progress(dbSize);
@@ -98,7 +98,7 @@ int summarizeresult(int argc, const char **argv, const Command &command) {
         for (int i = 0; i < MMseqsMPI::numProc; ++i) {
             splitFiles.push_back(Util::createTmpFileNames(par.db2, par.db2Index, i));
         }
-        DBWriter::mergeResults(par.db2, par.db2Index, splitFiles);
+        DBWriter::mergeResults(par.db2, par.db2Index, splitFiles, par.binaryIndex);
     }
 #endif
 
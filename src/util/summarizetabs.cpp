@@ -128,7 +128,7 @@ std::vector<Domain> getEntries(unsigned int queryId, char *data, size_t length,
 int doAnnotate(Parameters &par, DBReader<unsigned int> &blastTabReader,
                const std::pair<std::string, std::string>& resultdb,
                const size_t dbFrom, const size_t dbSize, bool merge) {
-    DBWriter writer(resultdb.first.c_str(), resultdb.second.c_str(), static_cast<unsigned int>(par.threads), par.compressed, Parameters::DBTYPE_ALIGNMENT_RES);
+    DBWriter writer(resultdb.first.c_str(), resultdb.second.c_str(), static_cast<unsigned int>(par.threads), par.writerMode(par.compressed), Parameters::DBTYPE_ALIGNMENT_RES);
     writer.open();
 
     std::map<std::string, unsigned int> lengths = readLength(par.db2);
@@ -146,8 +146,9 @@ int doAnnotate(Parameters &par, DBReader<unsigned int> &blastTabReader,
             progress.updateProgress();
             unsigned int id = blastTabReader.getDbKey(i);
 
-            char *tabData = blastTabReader.getData(i, thread_idx);
-            size_t tabLength = blastTabReader.getEntryLen(i) - 1;
+            size_t tabLength;
+            char *tabData = blastTabReader.getData(i, thread_idx, &tabLength);
+            tabLength -= 1;
             const std::vector<Domain> entries = getEntries(id, tabData, tabLength, lengths);
             if (entries.size() == 0) {
                 Debug(Debug::WARNING) << "Can not map any entries for entry " << id << "!\n";
@@ -202,7 +203,7 @@ int doAnnotate(Parameters &par, const unsigned int mpiRank, const unsigned int m
             std::pair<std::string, std::string> tmpFile = Util::createTmpFileNames(par.db3, par.db3Index, proc);
             splitFiles.push_back(std::make_pair(tmpFile.first,  tmpFile.second));
         }
-        DBWriter::mergeResults(par.db3, par.db3Index, splitFiles);
+        DBWriter::mergeResults(par.db3, par.db3Index, splitFiles, par.binaryIndex);
     }
     return status;
 }
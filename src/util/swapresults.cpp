@@ -9,6 +9,8 @@
 #include "AlignmentSymmetry.h"
 #include "PrefilteringIndexReader.h"
 #include "IndexReader.h"
+#include "ExternalSort.h"
+#include "MemoryBudget.h"
 
 #ifdef OPENMP
 #include <omp.h>
@@ -128,12 +130,7 @@ int doswap(Parameters& par, bool isGeneralMode) {
     }
 
     // memoryLimit in bytes
-    size_t memoryLimit;
-    if (par.splitMemoryLimit > 0) {
-        memoryLimit = par.splitMemoryLimit;
-    } else {
-        memoryLimit = static_cast<size_t>(Util::getTotalSystemMemory() * 0.9);
-    }
+    size_t memoryLimit = MemoryBudget::getLimit();
     size_t bytesForTargetElements = sizeof(size_t) * (maxTargetId + 2);
     memoryLimit = (memoryLimit > bytesForTargetElements) ? (memoryLimit - bytesForTargetElements) : 0;
 
@@ -151,16 +148,13 @@ int doswap(Parameters& par, bool isGeneralMode) {
     splits.push_back(std::make_pair(maxTargetId, bytesToWrite));
     AlignmentSymmetry::computeOffsetFromCounts(targetElementSize, maxTargetId + 1);
 
-    const char empty = '\0';
-
-    unsigned int prevDbKeyToWrite = 0;
-    size_t prevBytesToWrite = 0;
-    for (size_t split = 0; split < splits.size(); split++) {
-        unsigned int dbKeyToWrite = splits[split].first;
-        size_t bytesToWrite = splits[split].second;
-        char *tmpData = new char[bytesToWrite];
-        Util::checkAllocation(tmpData, "Can not allocate tmpData memory in doswap");
-        Debug(Debug::INFO) << "\nReading results.\n";
+    // with more than one split the swapped lines are sorted by target key on disk in a single pass
+    // over the results, every split is then filled from the sorted lines instead of reading all results again.
+    // Every thread sorts its lines into its own runs.
+    ExternalSort *sorter = NULL;
+    if (splits.size() > 1) {
+        sorter = new ExternalSort(parOutDbStr + "_sort", memoryLimit, static_cast<unsigned int>(par.threads));
+        Debug(Debug::INFO) << "Sorting results by target.\n";
         Debug::Progress progress(resultSize);
 #pragma omp parallel
         {
@@ -168,6 +162,7 @@ int doswap(Parameters& par, bool isGeneralMode) {
 #ifdef OPENMP
             thread_idx = omp_get_thread_num();
 #endif
+            std::string line;
 
 #pragma omp for schedule(dynamic, 10)
             for (size_t i = 0; i < resultSize; ++i) {
@@ -184,25 +179,86 @@ int doswap(Parameters& par, bool isGeneralMode) {
                     size_t targetKeyLen = strlen(dbKeyBuffer);
                     char *nextLine = Util::skipLine(data);
                     size_t oldLineLen = nextLine - data;
-                    size_t newLineLen = oldLineLen;
-                    newLineLen -= targetKeyLen;
-                    newLineLen += queryKeyLen;
                     const unsigned int dbKey = (unsigned int) strtoul(dbKeyBuffer, NULL, 10);
-                    // update offset but do not copy memory
-                    size_t offset = __sync_fetch_and_add(&(targetElementSize[dbKey]), newLineLen) - prevBytesToWrite;
-                    if(dbKey >= prevDbKeyToWrite && dbKey <=  dbKeyToWrite){
-                        memcpy(&tmpData[offset], queryKeyStr, queryKeyLen);
-                        memcpy(&tmpData[offset + queryKeyLen], data + targetKeyLen, oldLineLen - targetKeyLen);
-                    }
+                    line.assign(queryKeyStr, queryKeyLen);
+                    line.append(data + targetKeyLen, oldLineLen - targetKeyLen);
+                    sorter->add(dbKey, line.data(), line.size(), static_cast<unsigned int>(thread_idx));
                     data = nextLine;
                 }
             }
         }
-        //revert offsets
-        for (unsigned int i = maxTargetId + 1; i > 0; i--) {
-            targetElementSize[i] = targetElementSize[i - 1];
+        sorter->finish();
+    }
+    unsigned int sortedKey = 0;
+    const char *sortedLine = NULL;
+    size_t sortedLineLen = 0;
+    bool hasSortedLine = false;
+
+    const char empty = '\0';
+
+    unsigned int prevDbKeyToWrite = 0;
+    size_t prevBytesToWrite = 0;
+    for (size_t split = 0; split < splits.size(); split++) {
+        unsigned int dbKeyToWrite = splits[split].first;
+        size_t bytesToWrite = splits[split].second;
+        char *tmpData = new char[bytesToWrite];
+        Util::checkAllocation(tmpData, "Can not allocate tmpData memory in doswap");
+        if (sorter != NULL) {
+            // the lines of the split follow each other in the order of their target offsets
+            size_t offset = 0;
+            while (hasSortedLine || (hasSortedLine = sorter->next(sortedKey, sortedLine, sortedLineLen))) {
+                if (sortedKey > dbKeyToWrite) {
+                    break;
+                }
+                memcpy(tmpData + offset, sortedLine, sortedLineLen);
+                offset += sortedLineLen;
+                hasSortedLine = false;
+            }
+        } else {
+            Debug(Debug::INFO) << "\nReading results.\n";
+            Debug::Progress progress(resultSize);
+#pragma omp parallel
+            {
+                int thread_idx = 0;
+#ifdef OPENMP
+                thread_idx = omp_get_thread_num();
+#endif
+
+#pragma omp for schedule(dynamic, 10)
+                for (size_t i = 0; i < resultSize; ++i) {
+                    progress.updateProgress();
+                    char *data = resultDbr.getData(i, thread_idx);
+                    unsigned int queryKey = resultDbr.getDbKey(i);
+                    char queryKeyStr[1024];
+                    char *tmpBuff = Itoa::u32toa_sse2((uint32_t) queryKey, queryKeyStr);
+                    *(tmpBuff) = '\0';
+                    size_t queryKeyLen = strlen(queryKeyStr);
+                    char dbKeyBuffer[255 + 1];
+                    while (*data != '\0') {
+                        Util::parseKey(data, dbKeyBuffer);
+                        size_t targetKeyLen = strlen(dbKeyBuffer);
+                        char *nextLine = Util::skipLine(data);
+                        size_t oldLineLen = nextLine - data;
+                        size_t newLineLen = oldLineLen;
+                        newLineLen -= targetKeyLen;
+                        newLineLen += queryKeyLen;
+                        const unsigned int dbKey = (unsigned int) strtoul(dbKeyBuffer, NULL, 10);
+                        // update offset but do not copy memory
+                        size_t offset = __sync_fetch_and_add(&(targetElementSize[dbKey]), newLineLen) - prevBytesToWrite;
+                        if(dbKey >= prevDbKeyToWrite && dbKey <=  dbKeyToWrite){
+                            memcpy(&tmpData[offset], queryKeyStr, queryKeyLen);
+                            memcpy(&tmpData[offset + queryKeyLen], data + targetKeyLen, oldLineLen - targetKeyLen);
+                        }
+                        data = nextLine;
+                    }
+                }
+            }
+            //revert offsets
+            for (unsigned int i = maxTargetId + 1; i > 0; i--) {
+                targetElementSize[i] = targetElementSize[i - 1];
+            }
+            targetElementSize[0] = 0;
         }
-        targetElementSize[0] = 0;
 
         Debug(Debug::INFO) << "\nOutput database: " << parOutDbStr << "\n";
         bool isAlignmentResult = false;
@@ -225,7 +281,7 @@ int doswap(Parameters& par, bool isGeneralMode) {
         splitFileNames.push_back(splitNamePair);
         Debug::Progress progress2(dbKeyToWrite - prevDbKeyToWrite  + 1);
 
-        DBWriter resultWriter(splitNamePair.first.c_str(), splitNamePair.second.c_str(), par.threads, par.compressed, resultDbr.getDbtype());
+        DBWriter resultWriter(splitNamePair.first.c_str(), splitNamePair.second.c_str(), par.threads, par.writerMode(par.compressed), resultDbr.getDbtype());
         resultWriter.open();
 #pragma omp parallel
         {
@@ -320,9 +376,12 @@ int doswap(Parameters& par, bool isGeneralMode) {
         delete[] tmpData;
     }
     if(splits.size() > 1){
-        DBWriter::mergeResults(parOutDbStr, parOutDbIndexStr, splitFileNames);
+        DBWriter::mergeResults(parOutDbStr, parOutDbIndexStr, splitFileNames, par.binaryIndex);
     }
 
+    if (sorter != NULL) {
+        delete sorter;
+    }
     resultDbr.close();
     if (targetElementExists != NULL) {
         delete[] targetElementExists;
@@ -91,7 +91,7 @@ int tar2db(int argc, const char **argv, const Command& command) {
     std::string lookupFile = dataFile + ".lookup";
     FILE *lookup = FileUtil::openAndDelete(lookupFile.c_str(), "w");
 
-    DBWriter writer(dataFile.c_str(), indexFile.c_str(), 1, par.compressed, par.outputDbType);
+    DBWriter writer(dataFile.c_str(), indexFile.c_str(), 1, par.writerMode(par.compressed), par.outputDbType);
     writer.open();
     Debug::Progress progress;
     char buffer[4096];
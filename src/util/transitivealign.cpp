@@ -11,6 +11,7 @@
 #include "BacktraceTranslator.h"
 #include "AlignmentSymmetry.h"
 #include "DistanceCalculator.h"
+#include "MemoryBudget.h"
 
 #ifdef OPENMP
 #include <omp.h>
@@ -118,7 +119,7 @@ int transitivealign(int argc, const char **argv, const Command &command) {
 
     std::string tmpRes = par.db3+".tmp";
     std::string tmpResIndex = par.db3+".tmp.index";
-    DBWriter resultWriter(tmpRes.c_str(), tmpResIndex.c_str(), par.threads, par.compressed, Parameters::DBTYPE_ALIGNMENT_RES);
+    DBWriter resultWriter(tmpRes.c_str(), tmpResIndex.c_str(), par.threads, par.writerMode(par.compressed), Parameters::DBTYPE_ALIGNMENT_RES);
     resultWriter.open();
 
     EvalueComputation evaluer(sequenceDbr.getAminoAcidDBSize(), subMat, par.gapOpen, par.gapExtend);
@@ -281,12 +282,7 @@ int transitivealign(int argc, const char **argv, const Command &command) {
     }
 
     // memoryLimit in bytes
-    size_t memoryLimit;
-    if (par.splitMemoryLimit > 0) {
-        memoryLimit = par.splitMemoryLimit;
-    } else {
-        memoryLimit = static_cast<size_t>(Util::getTotalSystemMemory() * 0.9);
-    }
+    size_t memoryLimit = MemoryBudget::getLimit();
     // compute splits
     std::vector<std::pair<unsigned int, size_t > > splits;
     std::vector<std::pair<std::string , std::string > > splitFileNames;
@@ -360,7 +356,7 @@ int transitivealign(int argc, const char **argv, const Command &command) {
                                                             std::make_pair(par.db3, par.db3Index);
         splitFileNames.push_back(splitNamePair);
 
-        DBWriter resultWriter(splitNamePair.first.c_str(), splitNamePair.second.c_str(), par.threads, par.compressed,
+        DBWriter resultWriter(splitNamePair.first.c_str(), splitNamePair.second.c_str(), par.threads, par.writerMode(par.compressed),
                               resultDbr.getDbtype());
         resultWriter.open();
 #pragma omp parallel
@@ -403,7 +399,7 @@ int transitivealign(int argc, const char **argv, const Command &command) {
     DBReader<unsigned int>::removeDb(tmpRes);
 
     if(splits.size() > 1){
-        DBWriter::mergeResults(parOutDbStr, parOutDbIndexStr, splitFileNames);
+        DBWriter::mergeResults(parOutDbStr, parOutDbIndexStr, splitFileNames, par.binaryIndex);
     }
 
     sequenceDbr.close();
@@ -28,7 +28,7 @@ int translatenucs(int argc, const char **argv, const Command& command) {
     size_t entries = reader.getSize();
     unsigned int localThreads = std::max(std::min((unsigned int)par.threads, (unsigned int)entries), 1u);
 
-    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), localThreads, par.compressed, Parameters::DBTYPE_AMINO_ACIDS);
+    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), localThreads, par.writerMode(par.compressed), Parameters::DBTYPE_AMINO_ACIDS);
     writer.open();
 
     Debug::Progress progress(entries);
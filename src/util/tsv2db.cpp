@@ -15,7 +15,7 @@ int tsv2db(int argc, const char **argv, const Command& command) {
         Debug(Debug::INFO) << "Consider setting --output-dbtype.\n";
     }
 
-    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), 1, par.compressed, par.outputDbType);
+    DBWriter writer(par.db2.c_str(), par.db2Index.c_str(), 1, par.writerMode(par.compressed), par.outputDbType);
     writer.open();
 
     std::ifstream tsv(par.db1);
@@ -432,6 +432,16 @@ int search(int argc, const char **argv, const Command& command) {
         } else {
             cmd.addVariable("ALIGNMENT_PAR", par.createParameterString(par.align).c_str());
         }
+        // prefilteralign has no MPI support
+        if (par.streamAlignment && isUngappedMode == false && par.runner.empty()) {
+            std::vector<MMseqsParameter*> prefilteralignWithoutS;
+            for (size_t i = 0; i < par.prefilteralign.size(); i++) {
+                if (par.prefilteralign[i]->uniqid != par.PARAM_S.uniqid) {
+                    prefilteralignWithoutS.push_back(par.prefilteralign[i]);
+                }
+            }
+            cmd.addVariable("PREFILTER_ALIGNMENT_PAR", par.createParameterString(prefilteralignWithoutS).c_str());
+        }
         FileUtil::writeFile(tmpDir + "/blastp.sh", blastp_sh, blastp_sh_len);
         program = std::string(tmpDir + "/blastp.sh");
     }